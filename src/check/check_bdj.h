@@ -27,10 +27,13 @@ Suite *     colorutils_suite (void);
 Suite *     dirop_suite (void);
 Suite *     filedata_suite (void);
 Suite *     filemanip_suite (void);
+Suite *     fadecurve_suite (void);
 Suite *     fileop_suite (void);
 Suite *     fileop_dir_suite (void);
 Suite *     fileshared_suite (void);
+Suite *     ipcstats_suite (void);
 Suite *     mdebug_suite (void);
+Suite *     mp3hdr_suite (void);
 Suite *     osdir_suite (void);
 Suite *     osdirutil_suite (void);
 Suite *     osnetutils_suite (void);
@@ -47,14 +50,18 @@ Suite *     procutil_suite (void);
 Suite *     queue_suite (void);
 Suite *     rafile_suite (void);
 Suite *     roman_suite (void);
+Suite *     shmring_suite (void);
 Suite *     sock_suite (void);
+Suite *     sockh_suite (void);
 Suite *     tmutil_suite (void);
 Suite *     vsencdec_suite (void);
+Suite *     workpool_suite (void);
 
 /* libbasic */
 Suite *     bdjopt_suite (void);
 Suite *     datafile_suite (void);
 Suite *     dirlist_suite (void);
+Suite *     dirwatch_suite (void);
 Suite *     ilist_suite (void);
 Suite *     istring_suite (void);
 Suite *     nlist_suite (void);
@@ -62,17 +69,21 @@ Suite *     progstate_suite (void);
 Suite *     slist_suite (void);
 
 /* libbdj4 */
+Suite *     aafilter_suite (void);
 Suite *     aesencdec_suite (void);
 Suite *     autosel_suite (void);
 Suite *     bdjvarsdf_suite (void);
 Suite *     bdjvarsdfload_suite (void);
+Suite *     bpmdetect_suite (void);
 Suite *     dancesel_suite (void);
 Suite *     dispsel_suite (void);
 Suite *     dnctypes_suite (void);
 Suite *     dance_suite (void);
 Suite *     genre_suite (void);
+Suite *     itunes_suite (void);
 Suite *     level_suite (void);
 Suite *     lock_suite (void);
+Suite *     loudness_suite (void);
 Suite *     msgparse_suite (void);
 Suite *     musicdb_suite (void);
 Suite *     musicq_suite (void);
@@ -82,6 +93,7 @@ Suite *     rating_suite (void);
 Suite *     playlist_suite (void);
 Suite *     samesong_suite (void);
 Suite *     sequence_suite (void);
+Suite *     silencedet_suite (void);
 Suite *     song_suite (void);
 Suite *     songfav_suite (void);
 Suite *     songfilter_suite (void);
@@ -89,7 +101,9 @@ Suite *     songlist_suite (void);
 Suite *     songutil_suite (void);
 Suite *     sortopt_suite (void);
 Suite *     status_suite (void);
+Suite *     tagcache_suite (void);
 Suite *     tagdef_suite (void);
+Suite *     tagwriter_suite (void);
 Suite *     templateutil_suite (void);
 Suite *     validate_suite (void);
 Suite *     volreg_suite (void);
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "chkaudio.h"
+#include "mdebug.h"
+
+static void chkaudioSend (const float *buff, int frames, int channels, int chunk, chkaudiocb_t cb, void *udata);
+
+double
+chkaudioAmplitude (double dbfs)
+{
+  return pow (10.0, dbfs / 20.0);
+}
+
+/* each tone is generated in turn, and passed to the callback */
+/* in pieces of chunk frames */
+void
+chkaudioTones (const chkaudiotone_t *tones, int count, int rate,
+    int channels, int chunk, chkaudiocb_t cb, void *udata)
+{
+  float   *buff;
+
+  for (int t = 0; t < count; ++t) {
+    int     frames = (int) (rate * tones [t].secs);
+
+    buff = mdmalloc (sizeof (float) * frames * channels);
+    for (int i = 0; i < frames; ++i) {
+      float   val;
+
+      val = (float) (tones [t].amp *
+          sin (2.0 * M_PI * tones [t].freq * i / rate + tones [t].phase));
+      for (int c = 0; c < channels; ++c) {
+        buff [i * channels + c] = val;
+      }
+    }
+    chkaudioSend (buff, frames, channels, chunk, cb, udata);
+    mdfree (buff);
+  }
+}
+
+/* a mono click track: short decaying 1kHz bursts with a little noise */
+void
+chkaudioClickTrack (double bpm, double secs, int rate, int chunk,
+    chkaudiocb_t cb, void *udata)
+{
+  float   *buff;
+  int     frames = (int) (rate * secs);
+  double  period;
+
+  buff = mdmalloc (sizeof (float) * frames);
+  for (int i = 0; i < frames; ++i) {
+    buff [i] = (float) (((double) rand () / (double) RAND_MAX - 0.5) * 0.05);
+  }
+  period = 60.0 / bpm * (double) rate;
+  for (double t = 0.0; t < frames; t += period) {
+    int   start = (int) (t + 0.5);
+
+    for (int k = 0; k < rate / 50 && start + k < frames; ++k) {
+      buff [start + k] += (float) (0.8 *
+          sin (2.0 * M_PI * 1000.0 * k / rate) * exp (-k / (rate / 275.0)));
+    }
+  }
+  chkaudioSend (buff, frames, 1, chunk, cb, udata);
+  mdfree (buff);
+}
+
+/* internal routines */
+
+static void
+chkaudioSend (const float *buff, int frames, int channels, int chunk,
+    chkaudiocb_t cb, void *udata)
+{
+  for (int i = 0; i < frames; i += chunk) {
+    int   len = chunk;
+
+    if (frames - i < len) {
+      len = frames - i;
+    }
+    cb (udata, buff + i * channels, len);
+  }
+}
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_CHKAUDIO_H
+#define INC_CHKAUDIO_H
+
+/* synthesized audio for the audio analysis tests */
+
+/* samples : float, interleaved if there is more than one channel */
+/* count : the number of sample frames */
+typedef void (*chkaudiocb_t)(void *udata, const float *samples, int count);
+
+/* a sine tone, the same in all channels, an amplitude of zero is silence */
+typedef struct {
+  double  freq;
+  double  amp;
+  double  phase;
+  double  secs;
+} chkaudiotone_t;
+
+double  chkaudioAmplitude (double dbfs);
+void    chkaudioTones (const chkaudiotone_t *tones, int count, int rate, int channels, int chunk, chkaudiocb_t cb, void *udata);
+void    chkaudioClickTrack (double bpm, double secs, int rate, int chunk, chkaudiocb_t cb, void *udata);
+
+#endif /* INC_CHKAUDIO_H */
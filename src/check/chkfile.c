@@ -0,0 +1,25 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "chkfile.h"
+
+/* creates (or truncates) the file, and writes a single line of data */
+void
+chkfileCreate (const char *fn, const char *data)
+{
+  FILE    *fh;
+
+  fh = fopen (fn, "w");
+  if (fh == NULL) {
+    return;
+  }
+  fprintf (fh, "%s\n", data);
+  fclose (fh);
+}
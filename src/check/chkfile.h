@@ -0,0 +1,11 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_CHKFILE_H
+#define INC_CHKFILE_H
+
+/* file helpers for the tests */
+
+void    chkfileCreate (const char *fn, const char *data);
+
+#endif /* INC_CHKFILE_H */
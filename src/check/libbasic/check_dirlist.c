@@ -194,6 +194,49 @@ START_TEST(dirlist_recursive)
 }
 END_TEST
 
+START_TEST(dirlist_walk)
+{
+  slist_t     *slist;
+  dirwalk_t   *dwalk;
+  const char  *fn;
+  int         c;
+  int         flags [] = {
+      DIRLIST_DIRS, DIRLIST_DIRS | DIRLIST_LINKS,
+      DIRLIST_FILES, DIRLIST_FILES | DIRLIST_LINKS,
+  };
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- dirlist_walk");
+  mdebugSubTag ("dirlist_walk");
+
+  dwalk = dirlistWalkStart ("tmp/nosuchdir", DIRLIST_FILES);
+  ck_assert_ptr_null (dwalk);
+  ck_assert_ptr_null (dirlistWalkNext (dwalk));
+  dirlistWalkFree (dwalk);
+
+  /* the walk returns the same entries as the recursive list */
+  for (size_t i = 0; i < sizeof (flags) / sizeof (int); ++i) {
+    slist = dirlistRecursiveDirList ("tmp/abc", flags [i]);
+    dwalk = dirlistWalkStart ("tmp/abc", flags [i]);
+    ck_assert_ptr_nonnull (dwalk);
+    c = 0;
+    while ((fn = dirlistWalkNext (dwalk)) != NULL) {
+      ck_assert_ptr_nonnull (slistGetStr (slist, fn));
+      ++c;
+    }
+    ck_assert_int_eq (c, slistGetCount (slist));
+    ck_assert_int_eq (dirlistWalkCount (dwalk), c);
+    dirlistWalkFree (dwalk);
+    slistFree (slist);
+  }
+
+  /* stop part way through */
+  dwalk = dirlistWalkStart ("tmp/abc", DIRLIST_FILES);
+  fn = dirlistWalkNext (dwalk);
+  ck_assert_ptr_nonnull (fn);
+  dirlistWalkFree (dwalk);
+}
+END_TEST
+
 Suite *
 dirlist_suite (void)
 {
@@ -206,6 +249,7 @@ dirlist_suite (void)
   tcase_add_unchecked_fixture (tc, setup, teardown);
   tcase_add_test (tc, dirlist_basic);
   tcase_add_test (tc, dirlist_recursive);
+  tcase_add_test (tc, dirlist_walk);
   suite_add_tcase (s, tc);
   return s;
 }
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "chkfile.h"
+#include "dirop.h"
+#include "dirwatch.h"
+#include "filemanip.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "tmutil.h"
+
+#define DW_DIR    "tmp/dirwatch"
+#define DW_SUBDIR "tmp/dirwatch/sub"
+#define DW_FNA    "tmp/dirwatch/sub/a.txt"
+#define DW_FNB    "tmp/dirwatch/b.txt"
+#define DW_FNC    "tmp/dirwatch/c.txt"
+
+enum {
+  DW_DEBOUNCE = 100,
+};
+
+/* waits for the next debounced event */
+static dirwatchevent_t
+dwWait (dirwatch_t *dw, const char **path, const char **oldpath)
+{
+  dirwatchevent_t   ev = DIRWATCH_NONE;
+
+  for (int i = 0; i < 100; ++i) {
+    dirwatchProcess (dw);
+    ev = dirwatchNext (dw, path, oldpath);
+    if (ev != DIRWATCH_NONE) {
+      break;
+    }
+    mssleep (10);
+  }
+  return ev;
+}
+
+START_TEST(dirwatch_alloc)
+{
+  dirwatch_t    *dw;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- dirwatch_alloc");
+  mdebugSubTag ("dirwatch_alloc");
+
+  diropDeleteDir (DW_DIR, DIROP_ALL);
+  diropMakeDir (DW_SUBDIR);
+  dw = dirwatchAlloc (DW_DIR, DW_DEBOUNCE);
+  ck_assert_ptr_nonnull (dw);
+  dirwatchFree (dw);
+  diropDeleteDir (DW_DIR, DIROP_ALL);
+}
+END_TEST
+
+START_TEST(dirwatch_events)
+{
+  dirwatch_t      *dw;
+  dirwatchevent_t ev;
+  const char      *path;
+  const char      *oldpath;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- dirwatch_events");
+  mdebugSubTag ("dirwatch_events");
+
+  diropDeleteDir (DW_DIR, DIROP_ALL);
+  diropMakeDir (DW_SUBDIR);
+  dw = dirwatchAlloc (DW_DIR, DW_DEBOUNCE);
+
+  if (! dirwatchIsComplete (dw)) {
+    /* not supported on this platform */
+    dirwatchFree (dw);
+    diropDeleteDir (DW_DIR, DIROP_ALL);
+    return;
+  }
+
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_NONE);
+
+  /* multiple writes are a single event */
+  chkfileCreate (DW_FNA, "dirwatch");
+  chkfileCreate (DW_FNA, "dirwatch");
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_CHANGED);
+  ck_assert_str_eq (path, DW_FNA);
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_NONE);
+
+  filemanipMove (DW_FNA, DW_FNB);
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_RENAMED);
+  ck_assert_str_eq (path, DW_FNB);
+  ck_assert_str_eq (oldpath, DW_FNA);
+
+  /* a chain of renames is reported as one */
+  filemanipMove (DW_FNB, DW_FNC);
+  filemanipMove (DW_FNC, DW_FNA);
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_RENAMED);
+  ck_assert_str_eq (path, DW_FNA);
+  ck_assert_str_eq (oldpath, DW_FNB);
+
+  fileopDelete (DW_FNA);
+  ev = dwWait (dw, &path, &oldpath);
+  ck_assert_int_eq (ev, DIRWATCH_REMOVED);
+  ck_assert_str_eq (path, DW_FNA);
+
+  dirwatchFree (dw);
+  diropDeleteDir (DW_DIR, DIROP_ALL);
+}
+END_TEST
+
+Suite *
+dirwatch_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("dirwatch");
+  tc = tcase_create ("dirwatch");
+  tcase_set_tags (tc, "libbasic");
+  tcase_add_test (tc, dirwatch_alloc);
+  tcase_add_test (tc, dirwatch_events);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -37,6 +37,7 @@ check_libbasic (SRunner *sr)
    *  datafile    partial
    *  bdjopt      complete 2023-7-18
    *  dirlist     complete
+   *  dirwatch    complete
    *  procutil    partial
    *  lock        complete
    *  rafile      complete
@@ -69,6 +70,9 @@ check_libbasic (SRunner *sr)
   s = dirlist_suite();
   srunner_add_suite (sr, s);
 
+  s = dirwatch_suite();
+  srunner_add_suite (sr, s);
+
   s = procutil_suite();
   srunner_add_suite (sr, s);
 
@@ -0,0 +1,344 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "aafilter.h"
+#include "check_bdj.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "mp3hdr.h"
+#include "osprocess.h"
+#include "sysvars.h"
+
+#define AAF_IN_FN   "tmp/aaf-in.wav"
+#define AAF_OUT_FN  "tmp/aaf-out.wav"
+#define AAF_FFMPEG_FN  "tmp/aaf-ffmpeg.wav"
+#define AAF_MP3_FN  "tmp/aaf-out.mp3"
+#define AAF_FILTERS "afade=t=in:curve=tri:d=100ms, " \
+    "afade=t=out:curve=tri:st=1900ms:d=100ms, apad=pad_dur=500ms"
+
+enum {
+  AAF_RATE = 44100,
+  /* one second of silence, two seconds of tone, one second of silence */
+  AAF_SAMPLES = AAF_RATE * 4,
+};
+
+typedef struct {
+  float   *data;
+  int     count;
+  int     alloc;
+} aafsamples_t;
+
+static void
+aafWriteU32 (FILE *fh, uint32_t val)
+{
+  unsigned char   b [4];
+
+  b [0] = val & 0xff;
+  b [1] = (val >> 8) & 0xff;
+  b [2] = (val >> 16) & 0xff;
+  b [3] = (val >> 24) & 0xff;
+  fwrite (b, 4, 1, fh);
+}
+
+static void
+aafWriteU16 (FILE *fh, uint16_t val)
+{
+  unsigned char   b [2];
+
+  b [0] = val & 0xff;
+  b [1] = (val >> 8) & 0xff;
+  fwrite (b, 2, 1, fh);
+}
+
+/* mono, signed 16-bit */
+static void
+aafCreateWav (const char *fn)
+{
+  FILE      *fh;
+  uint32_t  datasz = AAF_SAMPLES * 2;
+
+  fh = fopen (fn, "wb");
+  fwrite ("RIFF", 4, 1, fh);
+  aafWriteU32 (fh, 36 + datasz);
+  fwrite ("WAVEfmt ", 8, 1, fh);
+  aafWriteU32 (fh, 16);
+  aafWriteU16 (fh, 1);
+  aafWriteU16 (fh, 1);
+  aafWriteU32 (fh, AAF_RATE);
+  aafWriteU32 (fh, AAF_RATE * 2);
+  aafWriteU16 (fh, 2);
+  aafWriteU16 (fh, 16);
+  fwrite ("data", 4, 1, fh);
+  aafWriteU32 (fh, datasz);
+  for (int i = 0; i < AAF_SAMPLES; ++i) {
+    int16_t   val = 0;
+
+    if (i >= AAF_RATE && i < AAF_RATE * 3) {
+      val = (int16_t) (16000.0 * sin (2.0 * M_PI * 440.0 * i / AAF_RATE));
+    }
+    aafWriteU16 (fh, (uint16_t) val);
+  }
+  fclose (fh);
+}
+
+static void
+setup (void)
+{
+  aafCreateWav (AAF_IN_FN);
+}
+
+static void
+teardown (void)
+{
+  fileopDelete (AAF_IN_FN);
+  fileopDelete (AAF_OUT_FN);
+  fileopDelete (AAF_FFMPEG_FN);
+  fileopDelete (AAF_MP3_FN);
+}
+
+static void
+aafSampleCallback (void *udata, const float *samples, int count)
+{
+  return;
+}
+
+static void
+aafSaveCallback (void *udata, const float *samples, int count)
+{
+  aafsamples_t  *aafs = udata;
+
+  if (aafs->count + count > aafs->alloc) {
+    aafs->alloc = aafs->count + count + AAF_RATE;
+    aafs->data = mdrealloc (aafs->data, sizeof (float) * aafs->alloc);
+  }
+  memcpy (aafs->data + aafs->count, samples, sizeof (float) * count);
+  aafs->count += count;
+}
+
+START_TEST(aafilter_alloc)
+{
+  aafilter_t  *aaf;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- aafilter_alloc");
+  mdebugSubTag ("aafilter_alloc");
+
+  aaf = aafilterAlloc ();
+  if (aafilterAvailable ()) {
+    ck_assert_ptr_nonnull (aaf);
+    ck_assert_int_eq (aafilterHaveFilter ("atempo"), true);
+    ck_assert_int_eq (aafilterHaveFilter ("no-such-filter"), false);
+  } else {
+    ck_assert_ptr_null (aaf);
+  }
+  ck_assert_int_eq (aafilterGetProgress (aaf), 0);
+  aafilterFree (aaf);
+}
+END_TEST
+
+START_TEST(aafilter_process)
+{
+  aafilter_t  *aaf;
+  ssize_t     sz;
+  int         rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- aafilter_process");
+  mdebugSubTag ("aafilter_process");
+
+  aaf = aafilterAlloc ();
+  /* trim to the tone, fade and add a half second of silence */
+  rc = aafilterProcess (aaf, AAF_IN_FN, AAF_OUT_FN, 1000, 2000,
+      "afade=t=in:curve=tri:d=100ms, afade=t=out:curve=tri:st=1900ms:d=100ms, "
+      "apad=pad_dur=500ms");
+  if (! aafilterAvailable ()) {
+    ck_assert_int_ne (rc, 0);
+    ck_assert_int_eq (fileopFileExists (AAF_OUT_FN), false);
+  } else {
+    ck_assert_int_eq (rc, 0);
+    ck_assert_int_eq (fileopFileExists (AAF_OUT_FN), true);
+    /* 2.5 seconds of audio plus the header */
+    sz = fileopSize (AAF_OUT_FN);
+    ck_assert_int_ge (sz, AAF_RATE * 5 - 2000);
+    ck_assert_int_le (sz, AAF_RATE * 5 + 2000);
+  }
+
+  /* a missing input file fails and does not leave an output file */
+  fileopDelete (AAF_OUT_FN);
+  rc = aafilterProcess (aaf, "tmp/aaf-none.wav", AAF_OUT_FN, 0, 0, "");
+  ck_assert_int_ne (rc, 0);
+  ck_assert_int_eq (fileopFileExists (AAF_OUT_FN), false);
+  aafilterFree (aaf);
+}
+END_TEST
+
+START_TEST(aafilter_cancel)
+{
+  aafilter_t  *aaf;
+  int         rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- aafilter_cancel");
+  mdebugSubTag ("aafilter_cancel");
+
+  aaf = aafilterAlloc ();
+  fileopDelete (AAF_OUT_FN);
+  aafilterCancel (aaf);
+  rc = aafilterProcess (aaf, AAF_IN_FN, AAF_OUT_FN, 0, 0, "");
+  if (! aafilterAvailable ()) {
+    ck_assert_int_ne (rc, 0);
+  } else {
+    ck_assert_int_eq (rc, AAFILTER_CANCELLED);
+  }
+  ck_assert_int_eq (fileopFileExists (AAF_OUT_FN), false);
+  aafilterFree (aaf);
+}
+END_TEST
+
+START_TEST(aafilter_mp3_duration)
+{
+  aafilter_t  *aaf;
+  int32_t     dur;
+  int         rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- aafilter_mp3_duration");
+  mdebugSubTag ("aafilter_mp3_duration");
+
+  if (! aafilterAvailable ()) {
+    return;
+  }
+
+  aaf = aafilterAlloc ();
+  rc = aafilterProcess (aaf, AAF_IN_FN, AAF_MP3_FN, 0, 0, "");
+  if (rc != 0) {
+    /* no mp3 encoder */
+    aafilterFree (aaf);
+    return;
+  }
+
+  /* the duration from the mp3 headers matches avformat's duration, */
+  /* other than the encoder delay and padding */
+  rc = aafilterSamples (aaf, AAF_MP3_FN, 0, 100, 8000, 1,
+      aafSampleCallback, NULL);
+  ck_assert_int_eq (rc, 0);
+  dur = mp3hdrDuration (AAF_MP3_FN);
+  ck_assert_int_ge (dur, aafilterGetDuration (aaf) - 100);
+  ck_assert_int_le (dur, aafilterGetDuration (aaf) + 100);
+  ck_assert_int_ge (dur, 3950);
+  ck_assert_int_le (dur, 4050);
+  aafilterFree (aaf);
+}
+END_TEST
+
+/* the in-process filter must produce the same audio as the */
+/* ffmpeg command line with the same filter chain */
+START_TEST(aafilter_ffmpeg)
+{
+  aafilter_t    *aaf;
+  const char    *targv [20];
+  int           targc = 0;
+  aafsamples_t  aafs;
+  aafsamples_t  ffs;
+  double        sumsq = 0.0;
+  int           count;
+  int           rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- aafilter_ffmpeg");
+  mdebugSubTag ("aafilter_ffmpeg");
+
+  if (! aafilterAvailable ()) {
+    return;
+  }
+  if (! *sysvarsGetStr (SV_PATH_FFMPEG) ||
+      ! fileopFileExists (sysvarsGetStr (SV_PATH_FFMPEG))) {
+    return;
+  }
+
+  aaf = aafilterAlloc ();
+  rc = aafilterProcess (aaf, AAF_IN_FN, AAF_OUT_FN, 1000, 2000, AAF_FILTERS);
+  ck_assert_int_eq (rc, 0);
+
+  /* the same arguments as the audio adjustment's ffmpeg command */
+  targv [targc++] = sysvarsGetStr (SV_PATH_FFMPEG);
+  targv [targc++] = "-hide_banner";
+  targv [targc++] = "-y";
+  targv [targc++] = "-ss";
+  targv [targc++] = "1000ms";
+  targv [targc++] = "-i";
+  targv [targc++] = AAF_IN_FN;
+  /* the duration includes the gap */
+  targv [targc++] = "-t";
+  targv [targc++] = "2500ms";
+  targv [targc++] = "-af";
+  targv [targc++] = AAF_FILTERS;
+  targv [targc++] = AAF_FFMPEG_FN;
+  targv [targc++] = NULL;
+  rc = osProcessPipe (targv, OS_PROC_WAIT | OS_PROC_DETACH, NULL, 0, NULL);
+  ck_assert_int_eq (rc, 0);
+  ck_assert_int_eq (fileopFileExists (AAF_FFMPEG_FN), true);
+
+  aafs.data = NULL;
+  aafs.count = 0;
+  aafs.alloc = 0;
+  ffs = aafs;
+  rc = aafilterSamples (aaf, AAF_OUT_FN, 0, 0, AAF_RATE, 1,
+      aafSaveCallback, &aafs);
+  ck_assert_int_eq (rc, 0);
+  rc = aafilterSamples (aaf, AAF_FFMPEG_FN, 0, 0, AAF_RATE, 1,
+      aafSaveCallback, &ffs);
+  ck_assert_int_eq (rc, 0);
+
+  /* the lengths may differ by a few milliseconds */
+  ck_assert_int_ge (aafs.count, AAF_RATE * 5 / 2 - AAF_RATE / 100);
+  ck_assert_int_le (abs (aafs.count - ffs.count), AAF_RATE / 100);
+
+  count = aafs.count < ffs.count ? aafs.count : ffs.count;
+  for (int i = 0; i < count; ++i) {
+    double    diff;
+
+    diff = aafs.data [i] - ffs.data [i];
+    sumsq += diff * diff;
+  }
+  ck_assert_double_le (sqrt (sumsq / count), 0.01);
+
+  dataFree (aafs.data);
+  dataFree (ffs.data);
+  aafilterFree (aaf);
+}
+END_TEST
+
+Suite *
+aafilter_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("aafilter");
+  tc = tcase_create ("aafilter");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_unchecked_fixture (tc, setup, teardown);
+  tcase_add_test (tc, aafilter_alloc);
+  tcase_add_test (tc, aafilter_process);
+  tcase_add_test (tc, aafilter_cancel);
+  tcase_add_test (tc, aafilter_mp3_duration);
+  tcase_add_test (tc, aafilter_ffmpeg);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "bpmdetect.h"
+#include "check_bdj.h"
+#include "chkaudio.h"
+#include "log.h"
+#include "mdebug.h"
+
+enum {
+  BPMD_SECONDS = 30,
+  BPMD_CHUNK = 1000,
+  BPMD_MIN_CONF = 50,
+};
+
+typedef struct {
+  double  bpm;
+  double  low;
+  double  high;
+  double  expect;
+} bpmdtest_t;
+
+static bpmdtest_t tests [] = {
+  { 120.0,  60.0, 200.0, 120.0 },
+  {  90.0,  60.0, 200.0,  90.0 },
+  { 128.0,  60.0, 200.0, 128.0 },
+  { 100.5,  60.0, 200.0, 100.5 },
+  {  60.0,  50.0, 220.0,  60.0 },
+  /* a waltz range (28-32 mpm), the clicks are at twice the tempo */
+  { 180.0,  84.0,  96.0,  90.0 },
+  /* a viennese waltz range (58-60 mpm) */
+  { 177.0, 168.0, 186.0, 177.0 },
+};
+enum {
+  BPMD_TEST_MAX = sizeof (tests) / sizeof (bpmdtest_t),
+};
+
+static void
+bpmdSamples (void *udata, const float *samples, int count)
+{
+  bpmdetectAddSamples (udata, samples, count);
+}
+
+START_TEST(bpmdetect_click)
+{
+  bpmdetect_t *bpmd;
+  double      bpm;
+  int         conf;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bpmdetect_click");
+  mdebugSubTag ("bpmdetect_click");
+
+  bpmd = bpmdetectAlloc ();
+  for (int i = 0; i < (int) BPMD_TEST_MAX; ++i) {
+    bpmdetectReset (bpmd);
+    chkaudioClickTrack (tests [i].bpm, BPMD_SECONDS, BPMDETECT_RATE,
+        BPMD_CHUNK, bpmdSamples, bpmd);
+    bpm = bpmdetectCalc (bpmd, tests [i].low, tests [i].high, &conf);
+    ck_assert_double_eq_tol (bpm, tests [i].expect, 0.5);
+    ck_assert_int_ge (conf, BPMD_MIN_CONF);
+    ck_assert_int_le (conf, 100);
+  }
+  bpmdetectFree (bpmd);
+}
+END_TEST
+
+START_TEST(bpmdetect_silence)
+{
+  bpmdetect_t *bpmd;
+  float       *buff;
+  int         count = BPMDETECT_RATE * BPMD_SECONDS;
+  double      bpm;
+  int         conf;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bpmdetect_silence");
+  mdebugSubTag ("bpmdetect_silence");
+
+  bpmd = bpmdetectAlloc ();
+  buff = mdmalloc (sizeof (float) * count);
+
+  /* no data */
+  bpm = bpmdetectCalc (bpmd, 60.0, 200.0, &conf);
+  ck_assert_double_eq (bpm, 0.0);
+  ck_assert_int_eq (conf, 0);
+
+  /* silence */
+  for (int i = 0; i < count; ++i) {
+    buff [i] = 0.0f;
+  }
+  bpmdetectAddSamples (bpmd, buff, count);
+  bpm = bpmdetectCalc (bpmd, 60.0, 200.0, &conf);
+  ck_assert_double_eq (bpm, 0.0);
+  ck_assert_int_eq (conf, 0);
+
+  /* noise has no tempo */
+  for (int i = 0; i < count; ++i) {
+    buff [i] = (float) (((double) rand () / (double) RAND_MAX - 0.5) * 0.3);
+  }
+  bpmdetectReset (bpmd);
+  bpmdetectAddSamples (bpmd, buff, count);
+  bpmdetectCalc (bpmd, 60.0, 200.0, &conf);
+  ck_assert_int_lt (conf, BPMD_MIN_CONF);
+
+  /* too short */
+  bpmdetectReset (bpmd);
+  bpmdetectAddSamples (bpmd, buff, BPMDETECT_RATE);
+  bpm = bpmdetectCalc (bpmd, 60.0, 200.0, &conf);
+  ck_assert_double_eq (bpm, 0.0);
+
+  mdfree (buff);
+  bpmdetectFree (bpmd);
+}
+END_TEST
+
+START_TEST(bpmdetect_file)
+{
+  bpmdetect_t *bpmd;
+  int         rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bpmdetect_file");
+  mdebugSubTag ("bpmdetect_file");
+
+  bpmd = bpmdetectAlloc ();
+  /* a missing file fails */
+  rc = bpmdetectFile (bpmd, NULL, "tmp/bpmd-none.wav", 0, 0);
+  ck_assert_int_ne (rc, 0);
+  bpmdetectFree (bpmd);
+}
+END_TEST
+
+Suite *
+bpmdetect_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("bpmdetect");
+  tc = tcase_create ("bpmdetect");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_test (tc, bpmdetect_click);
+  tcase_add_test (tc, bpmdetect_silence);
+  tcase_add_test (tc, bpmdetect_file);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
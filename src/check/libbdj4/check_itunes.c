@@ -0,0 +1,164 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "bdjopt.h"
+#include "bdjvarsdfload.h"
+#include "check_bdj.h"
+#include "itunes.h"
+#include "log.h"
+#include "mdebug.h"
+#include "nlist.h"
+#include "tagdef.h"
+#include "templateutil.h"
+
+#define IT_XML_FN     "test-templates/itunes-library.xml"
+#define IT_MEDIA_DIR  "test-templates"
+
+static void
+setup (void)
+{
+  templateFileCopy ("dancetypes.txt", "dancetypes.txt");
+  templateFileCopy ("dances.txt", "dances.txt");
+  templateFileCopy ("genres.txt", "genres.txt");
+  templateFileCopy ("levels.txt", "levels.txt");
+  templateFileCopy ("ratings.txt", "ratings.txt");
+  templateFileCopy ("itunes-fields.txt", "itunes-fields.txt");
+  templateFileCopy ("itunes-stars.txt", "itunes-stars.txt");
+  bdjoptInit ();
+  bdjoptSetStr (OPT_M_DIR_ITUNES_MEDIA, IT_MEDIA_DIR);
+  bdjoptSetStr (OPT_M_ITUNES_XML_FILE, IT_XML_FN);
+  bdjvarsdfloadInit ();
+}
+
+static void
+teardown (void)
+{
+  bdjvarsdfloadCleanup ();
+  bdjoptCleanup ();
+}
+
+START_TEST(itunes_alloc)
+{
+  itunes_t    *itunes;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- itunes_alloc");
+  mdebugSubTag ("itunes_alloc");
+
+  ck_assert_int_eq (itunesConfigured (), true);
+  itunes = itunesAlloc ();
+  ck_assert_ptr_nonnull (itunes);
+  /* nothing has been parsed yet */
+  ck_assert_ptr_null (itunesGetSongData (itunes, 100));
+  itunesFree (itunes);
+}
+END_TEST
+
+START_TEST(itunes_songs)
+{
+  itunes_t    *itunes;
+  nlist_t     *entry;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- itunes_songs");
+  mdebugSubTag ("itunes_songs");
+
+  itunes = itunesAlloc ();
+  ck_assert_int_eq (itunesParse (itunes), true);
+
+  entry = itunesGetSongData (itunes, 100);
+  ck_assert_ptr_nonnull (entry);
+  ck_assert_str_eq (nlistGetStr (entry, TAG_TITLE), "Tango One");
+  ck_assert_str_eq (nlistGetStr (entry, TAG_ARTIST), "Artist A");
+  ck_assert_str_eq (nlistGetStr (entry, TAG_ALBUM), "Album A");
+  ck_assert_str_eq (nlistGetStr (entry, TAG_URI), "/music/Tango One.mp3");
+  ck_assert_int_eq (nlistGetNum (entry, TAG_TRACKNUMBER), 3);
+  /* ballroom dance */
+  ck_assert_int_eq (nlistGetNum (entry, TAG_GENRE), 1);
+  /* 100 -> great */
+  ck_assert_int_eq (nlistGetNum (entry, TAG_DANCERATING), 3);
+  /* fields that are not in the itunes-fields list are not imported */
+  ck_assert_ptr_null (nlistGetStr (entry, TAG_COMMENT));
+  ck_assert_ptr_null (nlistGetStr (entry, TAG_GROUPING));
+
+  entry = itunesGetSongDataByName (itunes, "/music/Waltz Two.mp3");
+  ck_assert_ptr_nonnull (entry);
+  ck_assert_str_eq (nlistGetStr (entry, TAG_TITLE), "Waltz Two");
+  /* a computed rating is set to unrated */
+  ck_assert_int_eq (nlistGetNum (entry, TAG_DANCERATING), 0);
+
+  /* videos are skipped */
+  ck_assert_ptr_null (itunesGetSongData (itunes, 102));
+  ck_assert_ptr_null (itunesGetSongDataByName (itunes, "/music/Video Three.m4v"));
+
+  itunesFree (itunes);
+}
+END_TEST
+
+START_TEST(itunes_playlists)
+{
+  itunes_t    *itunes;
+  nlist_t     *ids;
+  const char  *skey;
+  int         count;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- itunes_playlists");
+  mdebugSubTag ("itunes_playlists");
+
+  itunes = itunesAlloc ();
+  ck_assert_int_eq (itunesParse (itunes), true);
+
+  /* the master and smart playlists are skipped */
+  count = 0;
+  itunesStartIteratePlaylists (itunes);
+  while ((skey = itunesIteratePlaylists (itunes)) != NULL) {
+    ck_assert_str_eq (skey, "Dance List");
+    ++count;
+  }
+  ck_assert_int_eq (count, 1);
+  ck_assert_ptr_null (itunesGetPlaylistData (itunes, "Library"));
+  ck_assert_ptr_null (itunesGetPlaylistData (itunes, "Smart List"));
+
+  /* the skipped video is not in the playlist */
+  ids = itunesGetPlaylistData (itunes, "Dance List");
+  ck_assert_ptr_nonnull (ids);
+  ck_assert_int_eq (nlistGetCount (ids), 1);
+  ck_assert_int_eq (nlistGetNum (ids, 100), 1);
+  ck_assert_int_eq (nlistGetNum (ids, 102), LIST_VALUE_INVALID);
+
+  itunesFree (itunes);
+}
+END_TEST
+
+Suite *
+itunes_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("itunes");
+  tc = tcase_create ("itunes");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_unchecked_fixture (tc, setup, teardown);
+  tcase_add_test (tc, itunes_alloc);
+  tcase_add_test (tc, itunes_songs);
+  tcase_add_test (tc, itunes_playlists);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
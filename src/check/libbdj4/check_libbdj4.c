@@ -58,8 +58,13 @@ check_libbdj4 (SRunner *sr)
    *  msgparse              complete 2022-12-27
    *  webclient             complete 2022-12-27
    *  audioadjust
+   *  aafilter              complete
+   *  bpmdetect             complete
+   *  loudness              complete
+   *  silencedet            complete
    *  templateutil          complete // needed by tests; needs localized tests
    *  aesencdec             --
+   *  tagcache              complete
    *  bdjvarsdfload         complete // needed by tests; uses templateutil
    *  musicq                complete
    *  orgopt                complete
@@ -69,11 +74,12 @@ check_libbdj4 (SRunner *sr)
    *  songlistutil
    *  xspf
    *  quickedit
-   *  itunes
+   *  itunes                complete
    *  instutil
    *  bdj4init
    *  mp3exp
    *  expimpbdj4
+   *  tagwriter             complete
    */
 
   logMsg (LOG_DBG, LOG_IMPORTANT, "==chk== libbdj4");
@@ -161,12 +167,27 @@ check_libbdj4 (SRunner *sr)
 
   /* audioadjust */
 
+  s = aafilter_suite();
+  srunner_add_suite (sr, s);
+
+  s = bpmdetect_suite();
+  srunner_add_suite (sr, s);
+
+  s = loudness_suite();
+  srunner_add_suite (sr, s);
+
+  s = silencedet_suite();
+  srunner_add_suite (sr, s);
+
   s = templateutil_suite();
   srunner_add_suite (sr, s);
 
   s = aesencdec_suite();
   srunner_add_suite (sr, s);
 
+  s = tagcache_suite();
+  srunner_add_suite (sr, s);
+
   s = bdjvarsdfload_suite();
   srunner_add_suite (sr, s);
 
@@ -189,7 +210,8 @@ check_libbdj4 (SRunner *sr)
 
   /* quickedit */
 
-  /* itunes */
+  s = itunes_suite();
+  srunner_add_suite (sr, s);
 
   /* instutil */
 
@@ -198,6 +220,9 @@ check_libbdj4 (SRunner *sr)
   /* mp3exp */
 
   /* expimpbdj4 */
+
+  s = tagwriter_suite();
+  srunner_add_suite (sr, s);
 }
 
 #pragma clang diagnostic pop
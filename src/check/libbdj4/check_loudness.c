@@ -0,0 +1,198 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "chkaudio.h"
+#include "log.h"
+#include "loudness.h"
+#include "mdebug.h"
+
+enum {
+  LOUD_CHUNK = 1000,
+};
+
+static void
+loudSamples (void *udata, const float *samples, int count)
+{
+  loudnessAddSamples (udata, samples, count);
+}
+
+START_TEST(loudness_tone)
+{
+  loudness_t      *loud;
+  chkaudiotone_t  tones [1];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- loudness_tone");
+  mdebugSubTag ("loudness_tone");
+
+  loud = loudnessAlloc ();
+  /* no data */
+  ck_assert_double_eq (loudnessIntegrated (loud), LOUDNESS_NONE);
+  ck_assert_double_eq (loudnessTruePeak (loud), LOUDNESS_NONE);
+
+  /* ebu tech 3341: a 1kHz stereo sine at -23 dBFS is -23 LUFS */
+  tones [0] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-23.0), 0.0, 20 };
+  chkaudioTones (tones, 1, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq_tol (loudnessIntegrated (loud), -23.0, 0.1);
+  ck_assert_double_eq_tol (loudnessTruePeak (loud), -23.0, 0.2);
+
+  loudnessReset (loud);
+  tones [0] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-33.0), 0.0, 20 };
+  chkaudioTones (tones, 1, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq_tol (loudnessIntegrated (loud), -33.0, 0.1);
+
+  /* the k-weighting reduces the low frequencies */
+  loudnessReset (loud);
+  tones [0] = (chkaudiotone_t) { 50.0, chkaudioAmplitude (-23.0), 0.0, 20 };
+  chkaudioTones (tones, 1, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_lt (loudnessIntegrated (loud), -24.0);
+
+  /* too quiet */
+  loudnessReset (loud);
+  tones [0] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-80.0), 0.0, 20 };
+  chkaudioTones (tones, 1, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq (loudnessIntegrated (loud), LOUDNESS_NONE);
+
+  loudnessFree (loud);
+}
+END_TEST
+
+START_TEST(loudness_gate)
+{
+  loudness_t      *loud;
+  chkaudiotone_t  tones [3];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- loudness_gate");
+  mdebugSubTag ("loudness_gate");
+
+  loud = loudnessAlloc ();
+
+  /* ebu tech 3341 case 3: the quiet sections are removed by the */
+  /* relative gate */
+  tones [0] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-36.0), 0.0, 10 };
+  tones [1] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-23.0), 0.0, 60 };
+  tones [2] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-36.0), 0.0, 10 };
+  chkaudioTones (tones, 3, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq_tol (loudnessIntegrated (loud), -23.0, 0.1);
+
+  /* silence is removed by the absolute gate */
+  loudnessReset (loud);
+  tones [0] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-100.0), 0.0, 20 };
+  tones [1] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-23.0), 0.0, 20 };
+  tones [2] = (chkaudiotone_t) { 1000.0, chkaudioAmplitude (-100.0), 0.0, 20 };
+  chkaudioTones (tones, 3, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq_tol (loudnessIntegrated (loud), -23.0, 0.1);
+
+  loudnessFree (loud);
+}
+END_TEST
+
+START_TEST(loudness_true_peak)
+{
+  loudness_t      *loud;
+  chkaudiotone_t  tones [1];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- loudness_true_peak");
+  mdebugSubTag ("loudness_true_peak");
+
+  loud = loudnessAlloc ();
+
+  /* a sine at a quarter of the sample rate, 45 degrees out of phase. */
+  /* the sample peak is 3 dB lower than the true peak */
+  tones [0] = (chkaudiotone_t) { LOUDNESS_RATE / 4.0,
+      chkaudioAmplitude (-6.0), M_PI / 4.0, 2 };
+  chkaudioTones (tones, 1, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      LOUD_CHUNK, loudSamples, loud);
+  ck_assert_double_eq_tol (loudnessTruePeak (loud), -6.0, 0.3);
+
+  loudnessFree (loud);
+}
+END_TEST
+
+START_TEST(loudness_vol_adjust)
+{
+  double    val;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- loudness_vol_adjust");
+  mdebugSubTag ("loudness_vol_adjust");
+
+  /* at the target */
+  val = loudnessVolumeAdjust (-18.0, -3.0, -18.0);
+  ck_assert_double_eq (val, 0.0);
+  /* too loud */
+  val = loudnessVolumeAdjust (-12.0, -0.5, -18.0);
+  ck_assert_double_lt (val, 0.0);
+  ck_assert_double_ge (val, - LOUDNESS_ADJ_MAX);
+  /* too quiet, limited by the true peak */
+  val = loudnessVolumeAdjust (-24.0, -3.0, -18.0);
+  ck_assert_double_gt (val, 0.0);
+  ck_assert_double_lt (val, loudnessVolumeAdjust (-24.0, -10.0, -18.0));
+  /* too quiet, no headroom */
+  val = loudnessVolumeAdjust (-24.0, -0.5, -18.0);
+  ck_assert_double_eq (val, 0.0);
+  /* limits */
+  val = loudnessVolumeAdjust (-5.0, 0.0, -40.0);
+  ck_assert_double_eq (val, - LOUDNESS_ADJ_MAX);
+  val = loudnessVolumeAdjust (LOUDNESS_NONE, LOUDNESS_NONE, -18.0);
+  ck_assert_double_eq (val, 0.0);
+}
+END_TEST
+
+START_TEST(loudness_file)
+{
+  loudness_t  *loud;
+  int         rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- loudness_file");
+  mdebugSubTag ("loudness_file");
+
+  loud = loudnessAlloc ();
+  /* a missing file fails */
+  rc = loudnessFile (loud, NULL, "tmp/loud-none.wav");
+  ck_assert_int_ne (rc, 0);
+  loudnessFree (loud);
+}
+END_TEST
+
+Suite *
+loudness_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("loudness");
+  tc = tcase_create ("loudness");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_test (tc, loudness_tone);
+  tcase_add_test (tc, loudness_gate);
+  tcase_add_test (tc, loudness_true_peak);
+  tcase_add_test (tc, loudness_vol_adjust);
+  tcase_add_test (tc, loudness_file);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -58,12 +58,15 @@ START_TEST(msgparse_mq_data)
   mp_musicqupditem_t  *mpmqitem = NULL;
   char                *p = tbuff;
   char                *end = tbuff + sizeof (tbuff);
+  int                 rc;
 
   logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- msgparse_mq_data");
   mdebugSubTag ("msgparse_mq_data");
 
-  snprintf (tbuff, sizeof (tbuff), "6%c2761800%c77%c",
-      MSG_ARGS_RS, MSG_ARGS_RS, MSG_ARGS_RS);
+  /* mqidx, seq, tottime, currdbidx, total, start */
+  snprintf (tbuff, sizeof (tbuff), "6%c1%c2761800%c77%c%d%c0%c",
+      MSG_ARGS_RS, MSG_ARGS_RS, MSG_ARGS_RS, MSG_ARGS_RS,
+      (int) titemsz, MSG_ARGS_RS, MSG_ARGS_RS);
   p = tbuff + strlen (tbuff);
   for (int i = 0; i < titemsz; ++i) {
     snprintf (tmp, sizeof (tmp), "%d%c%d%c%d%c%d%c",
@@ -71,9 +74,11 @@ START_TEST(msgparse_mq_data)
       mptestdata [i].dbidx, MSG_ARGS_RS, mptestdata [i].pind, MSG_ARGS_RS);
     p = stpecpy (p, end, tmp);
   }
-  mpmqu = msgparseMusicQueueData (tbuff);
+  rc = msgparseMusicQueueData (&mpmqu, tbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_OK);
   ck_assert_ptr_nonnull (mpmqu);
   ck_assert_int_eq (mpmqu->mqidx, 6);
+  ck_assert_int_eq (mpmqu->seq, 1);
   ck_assert_int_eq (mpmqu->tottime, 2761800);
   ck_assert_int_eq (mpmqu->currdbidx, 77);
   list = mpmqu->dispList;
@@ -89,6 +94,170 @@ START_TEST(msgparse_mq_data)
 }
 END_TEST
 
+START_TEST(msgparse_mq_data_parts)
+{
+  char                tbuff [80];
+  char                sbuff [80];
+  mp_musicqupdate_t   *mqu = NULL;
+  mp_musicqupdate_t   *mpmqu = NULL;
+  mp_musicqupdate_t   *pending = NULL;
+  mp_musicqupditem_t  *mpmqitem = NULL;
+  nlistidx_t          start;
+  int                 parts;
+  int                 rc;
+  bool                brc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- msgparse_mq_data_parts");
+  mdebugSubTag ("msgparse_mq_data_parts");
+
+  mqu = msgparseMusicQueueAlloc (3);
+  mqu->seq = 5;
+  mqu->tottime = 2761800;
+  mqu->currdbidx = 77;
+  for (int i = 0; i < titemsz; ++i) {
+    msgparseMusicQueueAppend (mqu, mptestdata [i].didx,
+        mptestdata [i].uidx, mptestdata [i].dbidx, mptestdata [i].pind);
+  }
+
+  /* the buffer only holds a few items, the data is sent in parts */
+  start = 0;
+  parts = 0;
+  rc = MSGPARSE_MQ_PARTIAL;
+  do {
+    brc = msgbuildMusicQueueData (tbuff, sizeof (tbuff), mqu, &start);
+    ++parts;
+    if (parts == 2) {
+      /* save the second part */
+      stpecpy (sbuff, sbuff + sizeof (sbuff), tbuff);
+    }
+    ck_assert_int_eq (rc, MSGPARSE_MQ_PARTIAL);
+    rc = msgparseMusicQueueData (&pending, tbuff);
+  } while (! brc);
+  ck_assert_int_gt (parts, 1);
+  ck_assert_int_eq (start, titemsz);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_OK);
+
+  mpmqu = pending;
+  pending = NULL;
+  ck_assert_ptr_nonnull (mpmqu);
+  ck_assert_int_eq (mpmqu->mqidx, 3);
+  ck_assert_int_eq (mpmqu->seq, 5);
+  ck_assert_int_eq (mpmqu->tottime, 2761800);
+  ck_assert_int_eq (mpmqu->currdbidx, 77);
+  ck_assert_int_eq (nlistGetCount (mpmqu->dispList), titemsz);
+  for (int i = 0; i < titemsz; ++i) {
+    mpmqitem = nlistGetData (mpmqu->dispList, i);
+    ck_assert_ptr_nonnull (mpmqitem);
+    ck_assert_int_eq (mpmqitem->dispidx, mptestdata [i].didx);
+    ck_assert_int_eq (mpmqitem->uniqueidx, mptestdata [i].uidx);
+    ck_assert_int_eq (mpmqitem->dbidx, mptestdata [i].dbidx);
+    ck_assert_int_eq (mpmqitem->pauseind, mptestdata [i].pind);
+  }
+
+  /* a part without the preceding parts requires the complete data */
+  rc = msgparseMusicQueueData (&pending, sbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_RESYNC);
+  ck_assert_ptr_null (pending);
+
+  msgparseMusicQueueDataFree (mpmqu);
+  msgparseMusicQueueDataFree (mqu);
+}
+END_TEST
+
+START_TEST(msgparse_mq_delta)
+{
+  char                tbuff [4000];
+  char                dbuff [4000];
+  mp_musicqupdate_t   *prev = NULL;
+  mp_musicqupdate_t   *curr = NULL;
+  mp_musicqupdate_t   *mpmqu = NULL;
+  mp_musicqupditem_t  *mpmqitem = NULL;
+  mp_musicqupditem_t  *curritem = NULL;
+  int                 dispidx;
+  int                 rc;
+  bool                brc;
+  nlistidx_t          start;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- msgparse_mq_delta");
+  mdebugSubTag ("msgparse_mq_delta");
+
+  prev = msgparseMusicQueueAlloc (2);
+  prev->seq = 1;
+  prev->tottime = 2761800;
+  prev->currdbidx = 77;
+  for (int i = 0; i < titemsz; ++i) {
+    msgparseMusicQueueAppend (prev, mptestdata [i].didx,
+        mptestdata [i].uidx, mptestdata [i].dbidx, mptestdata [i].pind);
+  }
+
+  /* the current song finished: the first item is removed, */
+  /* the last item is moved to the top, an item is inserted, */
+  /* and the pause indicator is changed on another */
+  curr = msgparseMusicQueueAlloc (2);
+  curr->seq = 2;
+  curr->tottime = 2540100;
+  curr->currdbidx = mptestdata [0].dbidx;
+  dispidx = 1;
+  msgparseMusicQueueAppend (curr, dispidx++, mptestdata [7].uidx,
+      mptestdata [7].dbidx, mptestdata [7].pind);
+  for (int i = 1; i < titemsz - 1; ++i) {
+    int   pind = mptestdata [i].pind;
+
+    if (i == 5) {
+      pind = 1;
+    }
+    if (i == 4) {
+      msgparseMusicQueueAppend (curr, dispidx++, 200, 42, 0);
+    }
+    msgparseMusicQueueAppend (curr, dispidx++, mptestdata [i].uidx,
+        mptestdata [i].dbidx, pind);
+  }
+
+  /* the receiver has the complete data for the previous queue */
+  start = 0;
+  brc = msgbuildMusicQueueData (tbuff, sizeof (tbuff), prev, &start);
+  ck_assert_int_eq (brc, true);
+  ck_assert_int_eq (start, titemsz);
+  rc = msgparseMusicQueueData (&mpmqu, tbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_OK);
+  ck_assert_ptr_nonnull (mpmqu);
+  ck_assert_int_eq (mpmqu->seq, 1);
+
+  brc = msgbuildMusicQueueDelta (dbuff, sizeof (dbuff), prev, curr);
+  ck_assert_int_eq (brc, true);
+  stpecpy (tbuff, tbuff + sizeof (tbuff), dbuff);
+
+  rc = msgparseMusicQueueDelta (mpmqu, dbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_OK);
+  ck_assert_int_eq (mpmqu->seq, curr->seq);
+  ck_assert_int_eq (mpmqu->tottime, curr->tottime);
+  ck_assert_int_eq (mpmqu->currdbidx, curr->currdbidx);
+  ck_assert_int_eq (nlistGetCount (mpmqu->dispList),
+      nlistGetCount (curr->dispList));
+  for (int i = 0; i < nlistGetCount (curr->dispList); ++i) {
+    mpmqitem = nlistGetData (mpmqu->dispList, i);
+    curritem = nlistGetData (curr->dispList, i);
+    ck_assert_ptr_nonnull (mpmqitem);
+    ck_assert_int_eq (mpmqitem->dispidx, curritem->dispidx);
+    ck_assert_int_eq (mpmqitem->uniqueidx, curritem->uniqueidx);
+    ck_assert_int_eq (mpmqitem->dbidx, curritem->dbidx);
+    ck_assert_int_eq (mpmqitem->pauseind, curritem->pauseind);
+  }
+
+  /* a repeated or missed delta requires the complete data */
+  rc = msgparseMusicQueueDelta (mpmqu, tbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_RESYNC);
+  ck_assert_int_eq (mpmqu->seq, curr->seq);
+
+  rc = msgparseMusicQueueDelta (NULL, tbuff);
+  ck_assert_int_eq (rc, MSGPARSE_MQ_RESYNC);
+
+  msgparseMusicQueueDataFree (mpmqu);
+  msgparseMusicQueueDataFree (prev);
+  msgparseMusicQueueDataFree (curr);
+}
+END_TEST
+
 START_TEST(msgparse_songsel_data)
 {
   char            tbuff [MAXPATHLEN];
@@ -113,6 +282,74 @@ START_TEST(msgparse_songsel_data)
 }
 END_TEST
 
+START_TEST(msgparse_player_status)
+{
+  char              tbuff [200];
+  mp_playerstatus_t ps;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- msgparse_player_status");
+  mdebugSubTag ("msgparse_player_status");
+
+  msgbuildPlayerStatus (tbuff, sizeof (tbuff), true, false,
+      60, 95, 40, 123456, 2761800);
+  ck_assert_int_eq (msgArgsIsTLV (tbuff), true);
+  msgparsePlayerStatus (&ps, tbuff);
+  ck_assert_int_eq (ps.repeat, true);
+  ck_assert_int_eq (ps.pauseatend, false);
+  ck_assert_int_eq (ps.currentVolume, 60);
+  ck_assert_int_eq (ps.currentSpeed, 95);
+  ck_assert_int_eq (ps.baseVolume, 40);
+  ck_assert_int_eq (ps.playedtime, 123456);
+  ck_assert_int_eq (ps.duration, 2761800);
+
+  /* the binary form is not modified by the parse */
+  msgparsePlayerStatus (&ps, tbuff);
+  ck_assert_int_eq (ps.duration, 2761800);
+
+  /* text form */
+  snprintf (tbuff, sizeof (tbuff), "0%c1%c70%c110%c30%c5000%c180000",
+      MSG_ARGS_RS, MSG_ARGS_RS, MSG_ARGS_RS, MSG_ARGS_RS,
+      MSG_ARGS_RS, MSG_ARGS_RS);
+  msgparsePlayerStatus (&ps, tbuff);
+  ck_assert_int_eq (ps.repeat, false);
+  ck_assert_int_eq (ps.pauseatend, true);
+  ck_assert_int_eq (ps.currentVolume, 70);
+  ck_assert_int_eq (ps.currentSpeed, 110);
+  ck_assert_int_eq (ps.baseVolume, 30);
+  ck_assert_int_eq (ps.playedtime, 5000);
+  ck_assert_int_eq (ps.duration, 180000);
+}
+END_TEST
+
+START_TEST(msgparse_musicq_status)
+{
+  char              tbuff [200];
+  mp_musicqstatus_t mqstatus;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- msgparse_musicq_status");
+  mdebugSubTag ("msgparse_musicq_status");
+
+  msgbuildMusicQStatus (tbuff, sizeof (tbuff), 12345, 77);
+  ck_assert_int_eq (msgArgsIsTLV (tbuff), true);
+  mqstatus.dbidx = -1;
+  mqstatus.uniqueidx = -1;
+  msgparseMusicQStatus (&mqstatus, tbuff);
+  ck_assert_int_eq (mqstatus.dbidx, 12345);
+  ck_assert_int_eq (mqstatus.uniqueidx, 77);
+
+  msgbuildMusicQStatus (tbuff, sizeof (tbuff), -1, 0);
+  msgparseMusicQStatus (&mqstatus, tbuff);
+  ck_assert_int_eq (mqstatus.dbidx, -1);
+  ck_assert_int_eq (mqstatus.uniqueidx, 0);
+
+  /* text form */
+  snprintf (tbuff, sizeof (tbuff), "%d%c%d", 400, MSG_ARGS_RS, 23);
+  msgparseMusicQStatus (&mqstatus, tbuff);
+  ck_assert_int_eq (mqstatus.dbidx, 400);
+  ck_assert_int_eq (mqstatus.uniqueidx, 23);
+}
+END_TEST
+
 Suite *
 msgparse_suite (void)
 {
@@ -123,7 +360,11 @@ msgparse_suite (void)
   tc = tcase_create ("msgparse");
   tcase_set_tags (tc, "libbdj4");
   tcase_add_test (tc, msgparse_mq_data);
+  tcase_add_test (tc, msgparse_mq_data_parts);
+  tcase_add_test (tc, msgparse_mq_delta);
   tcase_add_test (tc, msgparse_songsel_data);
+  tcase_add_test (tc, msgparse_player_status);
+  tcase_add_test (tc, msgparse_musicq_status);
   suite_add_tcase (s, tc);
 
   return s;
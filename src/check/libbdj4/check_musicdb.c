@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <sys/types.h>
 #include <time.h>
 
@@ -730,6 +731,103 @@ START_TEST(musicdb_rename)
 }
 END_TEST
 
+START_TEST(musicdb_change_list)
+{
+  musicdb_t *db;
+  musicdb_t *chgdb;
+  musicdb_t *loaddb;
+  song_t    *song;
+  song_t    *dbsong;
+  dbidx_t   count;
+  dbidx_t   dbidx;
+  dbidx_t   rdbidx;
+  char      tmp [200];
+  char      serial [40];
+  char      *ndata;
+  FILE      *fh;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- musicdb_change_list");
+  mdebugSubTag ("musicdb_change_list");
+
+  db = dbOpen (dbfn);
+  chgdb = dbOpen (dbfn);
+  count = dbCount (chgdb);
+
+  dbStartChangeList (db);
+
+  /* updated entry */
+  song = dbGetByName (db, "argentinetango06.mp3");
+  ck_assert_ptr_nonnull (song);
+  dbidx = songGetNum (song, TAG_DBIDX);
+  songSetStr (song, TAG_ARTIST, "chg-artist");
+  dbWriteSong (db, song);
+
+  /* new entry */
+  song = songAlloc ();
+  ndata = regexReplaceLiteral (songparsedata [0], "%d", "99");
+  songParse (song, ndata, 0);
+  songSetNum (song, TAG_RRN, MUSICDB_ENTRY_NEW);
+  mdfree (ndata);
+  snprintf (tmp, sizeof (tmp), "%s/%s", bdjoptGetStr (OPT_M_DIR_MUSIC),
+      songGetStr (song, TAG_URI));
+  fh = fileopOpen (tmp, "w");
+  mdextfclose (fh);
+  fclose (fh);
+  dbWriteSong (db, song);
+  songFree (song);
+
+  /* removed entry */
+  song = dbGetByName (db, "argentinetango07.mp3");
+  ck_assert_ptr_nonnull (song);
+  rdbidx = songGetNum (song, TAG_DBIDX);
+  dbWriteSong (db, song);
+  snprintf (tmp, sizeof (tmp), "%s/%s", bdjoptGetStr (OPT_M_DIR_MUSIC),
+      songGetStr (song, TAG_URI));
+  fileopDelete (tmp);
+
+  snprintf (serial, sizeof (serial), "%" PRId64, dbSaveChangeList (db));
+  ck_assert_int_eq (dbApplyChangeList (chgdb, "1"), false);
+  ck_assert_int_eq (dbApplyChangeList (chgdb, serial), true);
+
+  ck_assert_int_eq (dbCount (chgdb), count + 1);
+
+  dbsong = dbGetByName (chgdb, "argentinetango06.mp3");
+  ck_assert_ptr_nonnull (dbsong);
+  ck_assert_int_eq (songGetNum (dbsong, TAG_DBIDX), dbidx);
+  ck_assert_str_eq (songGetStr (dbsong, TAG_ARTIST), "chg-artist");
+
+  /* new entries are added after the existing entries */
+  dbsong = dbGetByName (chgdb, "argentinetango99.mp3");
+  ck_assert_ptr_nonnull (dbsong);
+  ck_assert_int_eq (songGetNum (dbsong, TAG_DBIDX), count);
+  ck_assert_str_eq (songGetStr (dbsong, TAG_ARTIST), "artist99");
+
+  dbsong = dbGetByName (chgdb, "argentinetango07.mp3");
+  ck_assert_ptr_null (dbsong);
+  dbsong = dbGetByIdx (chgdb, rdbidx);
+  ck_assert_ptr_null (dbsong);
+
+  /* a re-loaded database has the same database indexes */
+  loaddb = dbOpen (dbfn);
+  ck_assert_int_eq (dbCount (loaddb), dbCount (chgdb));
+  dbsong = dbGetByName (loaddb, "argentinetango06.mp3");
+  ck_assert_ptr_nonnull (dbsong);
+  ck_assert_int_eq (songGetNum (dbsong, TAG_DBIDX), dbidx);
+  dbsong = dbGetByName (loaddb, "argentinetango99.mp3");
+  ck_assert_ptr_nonnull (dbsong);
+  ck_assert_int_eq (songGetNum (dbsong, TAG_DBIDX), count);
+  dbsong = dbGetByIdx (loaddb, rdbidx);
+  ck_assert_ptr_null (dbsong);
+  dbClose (loaddb);
+
+  dbClose (chgdb);
+  dbClose (db);
+
+  snprintf (tmp, sizeof (tmp), "%s%s", dbfn, MUSICDB_CHG_EXT);
+  fileopDelete (tmp);
+}
+END_TEST
+
 START_TEST(musicdb_db)
 {
   musicdb_t *db;
@@ -832,6 +930,7 @@ musicdb_suite (void)
   tcase_add_test (tc, musicdb_temp);
   tcase_add_test (tc, musicdb_remove);
   tcase_add_test (tc, musicdb_rename);
+  tcase_add_test (tc, musicdb_change_list);
   tcase_add_test (tc, musicdb_cleanup);
   tcase_add_test (tc, musicdb_db);
   suite_add_tcase (s, tc);
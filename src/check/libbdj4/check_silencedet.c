@@ -0,0 +1,137 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "chkaudio.h"
+#include "log.h"
+#include "mdebug.h"
+#include "silencedet.h"
+
+enum {
+  /* not a multiple of the block size */
+  SD_CHUNK = 333,
+};
+
+static void
+sdSamples (void *udata, const float *samples, int count)
+{
+  silencedetAddSamples (udata, samples, count);
+}
+
+START_TEST(silencedet_detect)
+{
+  silencedet_t    *sd;
+  chkaudiotone_t  parts [3];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- silencedet_detect");
+  mdebugSubTag ("silencedet_detect");
+
+  sd = silencedetAlloc ();
+  /* no data */
+  ck_assert_double_eq (silencedetLength (sd), 0.0);
+  ck_assert_double_eq (silencedetLeading (sd), 0.0);
+  ck_assert_double_eq (silencedetTrailing (sd), 0.0);
+
+  /* one second of silence, two seconds of tone, one second of silence */
+  silencedetReset (sd, -50);
+  parts [0] = (chkaudiotone_t) { 440.0, 0.0, 0.0, 1.0 };
+  parts [1] = (chkaudiotone_t) { 440.0, 0.5, 0.0, 2.0 };
+  parts [2] = (chkaudiotone_t) { 440.0, 0.0, 0.0, 1.0 };
+  chkaudioTones (parts, 3, SILENCEDET_RATE, SILENCEDET_CHANNELS,
+      SD_CHUNK, sdSamples, sd);
+  ck_assert_double_eq_tol (silencedetLength (sd), 4.0, 0.001);
+  ck_assert_double_eq_tol (silencedetLeading (sd), 1.0, 0.02);
+  ck_assert_double_eq_tol (silencedetTrailing (sd), 3.0, 0.02);
+
+  /* noise below the noise level is silence */
+  silencedetReset (sd, -50);
+  parts [0] = (chkaudiotone_t) { 440.0, 0.001, 0.0, 1.5 };
+  parts [1] = (chkaudiotone_t) { 440.0, 0.5, 0.0, 2.0 };
+  parts [2] = (chkaudiotone_t) { 440.0, 0.001, 0.0, 0.5 };
+  chkaudioTones (parts, 3, SILENCEDET_RATE, SILENCEDET_CHANNELS,
+      SD_CHUNK, sdSamples, sd);
+  ck_assert_double_eq_tol (silencedetLeading (sd), 1.5, 0.02);
+  ck_assert_double_eq_tol (silencedetTrailing (sd), 3.5, 0.02);
+
+  /* the same audio with a lower noise level has no silence */
+  silencedetReset (sd, -70);
+  chkaudioTones (parts, 3, SILENCEDET_RATE, SILENCEDET_CHANNELS,
+      SD_CHUNK, sdSamples, sd);
+  ck_assert_double_eq (silencedetLeading (sd), 0.0);
+  ck_assert_double_eq_tol (silencedetTrailing (sd), silencedetLength (sd), 0.001);
+
+  /* silence in the middle is not reported */
+  silencedetReset (sd, -50);
+  parts [0] = (chkaudiotone_t) { 440.0, 0.5, 0.0, 1.0 };
+  parts [1] = (chkaudiotone_t) { 440.0, 0.0, 0.0, 1.0 };
+  parts [2] = (chkaudiotone_t) { 440.0, 0.5, 0.0, 1.0 };
+  chkaudioTones (parts, 3, SILENCEDET_RATE, SILENCEDET_CHANNELS,
+      SD_CHUNK, sdSamples, sd);
+  ck_assert_double_eq (silencedetLeading (sd), 0.0);
+  ck_assert_double_eq_tol (silencedetTrailing (sd), 3.0, 0.001);
+
+  /* all silence */
+  silencedetReset (sd, -50);
+  parts [0] = (chkaudiotone_t) { 440.0, 0.0, 0.0, 2.0 };
+  chkaudioTones (parts, 1, SILENCEDET_RATE, SILENCEDET_CHANNELS,
+      SD_CHUNK, sdSamples, sd);
+  ck_assert_double_eq_tol (silencedetLeading (sd), 2.0, 0.001);
+  ck_assert_double_eq (silencedetTrailing (sd), 0.0);
+
+  silencedetFree (sd);
+}
+END_TEST
+
+START_TEST(silencedet_file)
+{
+  silencedet_t  *sd;
+  double        sstart;
+  double        send;
+  int           rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- silencedet_file");
+  mdebugSubTag ("silencedet_file");
+
+  sd = silencedetAlloc ();
+  /* a missing file fails */
+  rc = silencedetFile (sd, NULL, "tmp/sd-none.wav", -50, 0.5, &sstart, &send);
+  ck_assert_int_ne (rc, 0);
+  ck_assert_double_eq (sstart, 0.0);
+  ck_assert_double_eq (send, 0.0);
+  silencedetFree (sd);
+}
+END_TEST
+
+Suite *
+silencedet_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("silencedet");
+  tc = tcase_create ("silencedet");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_test (tc, silencedet_detect);
+  tcase_add_test (tc, silencedet_file);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
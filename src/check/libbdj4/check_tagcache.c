@@ -0,0 +1,218 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "chkfile.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "slist.h"
+#include "tagcache.h"
+
+#define TC_FN     "tmp/tagcache.dat"
+#define TC_AFN    "tmp/tagcache-a.mp3"
+#define TC_BFN    "tmp/tagcache-b.mp3"
+
+static slist_t *
+tcTagData (void)
+{
+  slist_t   *tagdata;
+
+  tagdata = slistAlloc ("chk-tagcache", LIST_ORDERED, NULL);
+  slistSetStr (tagdata, "TITLE", "title\nwith a newline");
+  slistSetStr (tagdata, "ARTIST", "artist");
+  slistSetStr (tagdata, "DURATION", "123456");
+  return tagdata;
+}
+
+START_TEST(tagcache_empty)
+{
+  tagcache_t    *tc;
+  fileopstat_t  fst;
+  slist_t       *tagdata;
+  int           rewrite;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagcache_empty");
+  mdebugSubTag ("tagcache_empty");
+
+  fileopDelete (TC_FN);
+  chkfileCreate (TC_AFN, "tagcache");
+  fileopStat (TC_AFN, &fst);
+
+  tc = tagcacheLoad (TC_FN);
+  ck_assert_ptr_nonnull (tc);
+  tagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_null (tagdata);
+  /* no changes, nothing is saved */
+  tagcacheSave (tc, false);
+  ck_assert_int_eq (fileopFileExists (TC_FN), 0);
+  tagcacheFree (tc);
+
+  /* a damaged cache file is not used */
+  chkfileCreate (TC_FN, "tagcache");
+  tc = tagcacheLoad (TC_FN);
+  ck_assert_ptr_nonnull (tc);
+  tagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_null (tagdata);
+  tagcacheFree (tc);
+
+  fileopDelete (TC_FN);
+  fileopDelete (TC_AFN);
+}
+END_TEST
+
+START_TEST(tagcache_save_load)
+{
+  tagcache_t    *tc;
+  fileopstat_t  fst;
+  fileopstat_t  fstb;
+  slist_t       *tagdata;
+  slist_t       *ctagdata;
+  int           rewrite;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagcache_save_load");
+  mdebugSubTag ("tagcache_save_load");
+
+  fileopDelete (TC_FN);
+  chkfileCreate (TC_AFN, "tagcache");
+  chkfileCreate (TC_BFN, "tagcache");
+  fileopStat (TC_AFN, &fst);
+  fileopStat (TC_BFN, &fstb);
+
+  tagdata = tcTagData ();
+  tc = tagcacheLoad (TC_FN);
+  tagcacheSet (tc, TC_AFN, &fst, tagdata, 2);
+  tagcacheSet (tc, TC_BFN, &fstb, tagdata, 0);
+  tagcacheSave (tc, false);
+  tagcacheFree (tc);
+  ck_assert_int_eq (fileopFileExists (TC_FN), 1);
+
+  tc = tagcacheLoad (TC_FN);
+  rewrite = 0;
+  ctagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_nonnull (ctagdata);
+  ck_assert_int_eq (rewrite, 2);
+  ck_assert_int_eq (slistGetCount (ctagdata), slistGetCount (tagdata));
+  ck_assert_str_eq (slistGetStr (ctagdata, "TITLE"), "title\nwith a newline");
+  ck_assert_str_eq (slistGetStr (ctagdata, "ARTIST"), "artist");
+  ck_assert_str_eq (slistGetStr (ctagdata, "DURATION"), "123456");
+  slistFree (ctagdata);
+
+  /* the entries that were not used are removed */
+  tagcacheSave (tc, true);
+  tagcacheFree (tc);
+
+  tc = tagcacheLoad (TC_FN);
+  ctagdata = tagcacheGet (tc, TC_BFN, &fstb, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+  ctagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_nonnull (ctagdata);
+  slistFree (ctagdata);
+  tagcacheFree (tc);
+
+  slistFree (tagdata);
+  fileopDelete (TC_FN);
+  fileopDelete (TC_AFN);
+  fileopDelete (TC_BFN);
+}
+END_TEST
+
+START_TEST(tagcache_changed)
+{
+  tagcache_t    *tc;
+  fileopstat_t  fst;
+  fileopstat_t  tfst;
+  slist_t       *tagdata;
+  slist_t       *ctagdata;
+  int           rewrite;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagcache_changed");
+  mdebugSubTag ("tagcache_changed");
+
+  fileopDelete (TC_FN);
+  chkfileCreate (TC_AFN, "tagcache");
+  fileopStat (TC_AFN, &fst);
+
+  tagdata = tcTagData ();
+  tc = tagcacheLoad (TC_FN);
+  tagcacheSet (tc, TC_AFN, &fst, tagdata, 0);
+  tagcacheSave (tc, false);
+  tagcacheFree (tc);
+  tc = tagcacheLoad (TC_FN);
+
+  /* any change to the file information invalidates the entry */
+  tfst = fst;
+  tfst.size += 1;
+  ctagdata = tagcacheGet (tc, TC_AFN, &tfst, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+
+  tfst = fst;
+  tfst.mtime += 1;
+  ctagdata = tagcacheGet (tc, TC_AFN, &tfst, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+
+  tfst = fst;
+  tfst.ctime += 1;
+  ctagdata = tagcacheGet (tc, TC_AFN, &tfst, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+
+  tfst = fst;
+  tfst.inode += 1;
+  ctagdata = tagcacheGet (tc, TC_AFN, &tfst, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+
+  ctagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_nonnull (ctagdata);
+  slistFree (ctagdata);
+
+  /* a new entry replaces the old */
+  slistSetStr (tagdata, "ARTIST", "new-artist");
+  tfst = fst;
+  tfst.mtime += 1;
+  tagcacheSet (tc, TC_AFN, &tfst, tagdata, 0);
+  ctagdata = tagcacheGet (tc, TC_AFN, &fst, &rewrite);
+  ck_assert_ptr_null (ctagdata);
+  ctagdata = tagcacheGet (tc, TC_AFN, &tfst, &rewrite);
+  ck_assert_ptr_nonnull (ctagdata);
+  ck_assert_str_eq (slistGetStr (ctagdata, "ARTIST"), "new-artist");
+  slistFree (ctagdata);
+  tagcacheFree (tc);
+
+  slistFree (tagdata);
+  fileopDelete (TC_FN);
+  fileopDelete (TC_AFN);
+}
+END_TEST
+
+Suite *
+tagcache_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("tagcache");
+  tc = tcase_create ("tagcache");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_test (tc, tagcache_empty);
+  tcase_add_test (tc, tagcache_save_load);
+  tcase_add_test (tc, tagcache_changed);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
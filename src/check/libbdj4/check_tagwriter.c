@@ -0,0 +1,200 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "audiotag.h"
+#include "bdjopt.h"
+#include "check_bdj.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "slist.h"
+#include "tagwriter.h"
+
+#define TW_AFN    "tmp/tw-a.flac"
+#define TW_BFN    "tmp/tw-b.flac"
+#define TW_ATMP   "tmp/t-tw-a.flac"
+#define TW_NOFN   "tmp/tw-none.flac"
+
+enum {
+  TW_OLD_TIME = 100000,
+};
+
+/* a flac file with only the stream info block, and no audio frames */
+static void
+twCreateFlac (const char *fn)
+{
+  FILE            *fh;
+  unsigned char   hdr [] = {
+    'f', 'L', 'a', 'C',
+    /* last metadata block, stream info, length 34 */
+    0x80, 0x00, 0x00, 0x22,
+    /* min/max block size 4096 */
+    0x10, 0x00, 0x10, 0x00,
+    /* min/max frame size unknown */
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 44100 hz, 2 channels, 16 bits, no samples */
+    0x0a, 0xc4, 0x42, 0xf0, 0x00, 0x00, 0x00, 0x00,
+  };
+  unsigned char   md5 [16];
+
+  memset (md5, 0, sizeof (md5));
+  fh = fopen (fn, "wb");
+  fwrite (hdr, sizeof (hdr), 1, fh);
+  fwrite (md5, sizeof (md5), 1, fh);
+  fclose (fh);
+}
+
+static slist_t *
+twNewTags (const char *title)
+{
+  slist_t   *newtaglist;
+
+  newtaglist = slistAlloc ("chk-tw-new", LIST_ORDERED, NULL);
+  slistSetStr (newtaglist, "TITLE", title);
+  return newtaglist;
+}
+
+static void
+setup (void)
+{
+  bdjoptInit ();
+  bdjoptSetNum (OPT_G_WRITETAGS, WRITE_TAGS_ALL);
+  audiotagInit ();
+}
+
+static void
+teardown (void)
+{
+  audiotagCleanup ();
+  bdjoptCleanup ();
+}
+
+START_TEST(tagwriter_alloc)
+{
+  tagwriter_t   *tw;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagwriter_alloc");
+  mdebugSubTag ("tagwriter_alloc");
+
+  tw = tagwriterAlloc ();
+  ck_assert_ptr_nonnull (tw);
+  ck_assert_int_eq (tagwriterIsIdle (tw), true);
+  ck_assert_int_eq (tagwriterGetCount (tw), 0);
+  ck_assert_int_eq (tagwriterGetDeviceCount (tw), 0);
+  ck_assert_int_eq (slistGetCount (tagwriterGetErrors (tw)), 0);
+  ck_assert_int_eq (tagwriterProcess (tw), 0);
+  tagwriterFree (tw);
+}
+END_TEST
+
+START_TEST(tagwriter_write)
+{
+  tagwriter_t   *tw;
+  slist_t       *tagdata;
+  time_t        otm;
+  int           rewrite;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagwriter_write");
+  mdebugSubTag ("tagwriter_write");
+
+  twCreateFlac (TW_AFN);
+  twCreateFlac (TW_BFN);
+  otm = fileopModTime (TW_AFN) - TW_OLD_TIME;
+  fileopSetModTime (TW_AFN, otm);
+  fileopSetModTime (TW_BFN, otm);
+
+  tw = tagwriterAlloc ();
+  tagwriterAdd (tw, TW_AFN, NULL, twNewTags ("title-a"), 0, AT_KEEP_MOD_TIME);
+  tagwriterAdd (tw, TW_BFN, NULL, twNewTags ("title-b"), 0, AT_UPDATE_MOD_TIME);
+  /* both files are in the same directory, on the same device */
+  ck_assert_int_eq (tagwriterGetDeviceCount (tw), 1);
+  ck_assert_int_eq (tagwriterIsIdle (tw), false);
+
+  tagwriterWait (tw);
+  ck_assert_int_eq (tagwriterIsIdle (tw), true);
+  ck_assert_int_eq (tagwriterGetCount (tw), 0);
+  ck_assert_int_eq (slistGetCount (tagwriterGetErrors (tw)), 0);
+  tagwriterFree (tw);
+
+  /* the copy replaces the original */
+  ck_assert_int_eq (fileopFileExists (TW_ATMP), false);
+  ck_assert_int_eq (fileopModTime (TW_AFN), otm);
+  ck_assert_int_ne (fileopModTime (TW_BFN), otm);
+
+  tagdata = audiotagParseData (TW_AFN, &rewrite);
+  ck_assert_str_eq (slistGetStr (tagdata, "TITLE"), "title-a");
+  slistFree (tagdata);
+  tagdata = audiotagParseData (TW_BFN, &rewrite);
+  ck_assert_str_eq (slistGetStr (tagdata, "TITLE"), "title-b");
+  slistFree (tagdata);
+
+  fileopDelete (TW_AFN);
+  fileopDelete (TW_BFN);
+}
+END_TEST
+
+START_TEST(tagwriter_errors)
+{
+  tagwriter_t   *tw;
+  slist_t       *errors;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- tagwriter_errors");
+  mdebugSubTag ("tagwriter_errors");
+
+  fileopDelete (TW_NOFN);
+  twCreateFlac (TW_AFN);
+
+  tw = tagwriterAlloc ();
+  tagwriterAdd (tw, TW_NOFN, NULL, twNewTags ("title-none"), 0, AT_KEEP_MOD_TIME);
+  tagwriterAdd (tw, TW_AFN, NULL, twNewTags ("title-a"), 0, AT_KEEP_MOD_TIME);
+  tagwriterWait (tw);
+
+  /* only the missing file is reported */
+  errors = tagwriterGetErrors (tw);
+  ck_assert_int_eq (slistGetCount (errors), 1);
+  ck_assert_int_eq (slistGetNum (errors, TW_NOFN), AUDIOTAG_WRITE_FAILED);
+  ck_assert_int_eq (fileopFileExists (TW_NOFN), false);
+
+  tagwriterClearErrors (tw);
+  ck_assert_int_eq (slistGetCount (tagwriterGetErrors (tw)), 0);
+  tagwriterFree (tw);
+
+  fileopDelete (TW_AFN);
+}
+END_TEST
+
+Suite *
+tagwriter_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("tagwriter");
+  tc = tcase_create ("tagwriter");
+  tcase_set_tags (tc, "libbdj4");
+  tcase_add_unchecked_fixture (tc, setup, teardown);
+  tcase_add_test (tc, tagwriter_alloc);
+  tcase_add_test (tc, tagwriter_write);
+  tcase_add_test (tc, tagwriter_errors);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -22,10 +22,10 @@
 #include "check_bdj.h"
 #include "mdebug.h"
 #include "log.h"
+#include "tmutil.h"
 
 START_TEST(bdjmsg_encode)
 {
-  char    tmp [BDJMSG_MAX_PFX];
   char    buff [BDJMSG_MAX_PFX];
   size_t  len;
 
@@ -34,10 +34,10 @@ START_TEST(bdjmsg_encode)
 
   len = msgEncode (ROUTE_MAIN, ROUTE_STARTERUI, MSG_EXIT_REQUEST,
       buff, sizeof (buff));
-  ck_assert_int_eq (len, BDJMSG_MAX_PFX);
-  snprintf (tmp, sizeof (tmp), "%04d~%04d~%04d~",
-      ROUTE_MAIN, ROUTE_STARTERUI, MSG_EXIT_REQUEST);
-  ck_assert_str_eq (buff, tmp);
+  ck_assert_int_eq (len, BDJMSG_HDR_SZ + 1);
+  ck_assert_int_eq ((unsigned char) buff [0], BDJMSG_HDR_MAGIC);
+  ck_assert_int_eq (buff [1], BDJMSG_HDR_VERSION);
+  ck_assert_int_eq (buff [BDJMSG_HDR_SZ], '\0');
 }
 END_TEST
 
@@ -49,18 +49,90 @@ START_TEST(bdjmsg_decode)
   bdjmsgroute_t rt;
   bdjmsgmsg_t   msg;
   char    *args = NULL;
+  int64_t tmbeg;
+  int64_t tmsent;
 
   logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bdjmsg_decode");
   mdebugSubTag ("bdjmsg_decode");
 
+  tmbeg = ustime ();
   len = msgEncode (ROUTE_MAIN, ROUTE_STARTERUI, MSG_EXIT_REQUEST,
       buff, sizeof (buff));
-  ck_assert_int_eq (len, BDJMSG_MAX_PFX);
+  ck_assert_int_eq (len, BDJMSG_HDR_SZ + 1);
   msgDecode (buff, &rf, &rt, &msg, &args);
   ck_assert_int_eq (rf, ROUTE_MAIN);
   ck_assert_int_eq (rt, ROUTE_STARTERUI);
   ck_assert_int_eq (msg, MSG_EXIT_REQUEST);
   ck_assert_str_eq (args, "");
+  tmsent = msgTimeSent (buff);
+  ck_assert_int_ge (tmsent, tmbeg);
+  ck_assert_int_le (tmsent, ustime ());
+}
+END_TEST
+
+START_TEST(bdjmsg_decode_text)
+{
+  char    buff [BDJMSG_MAX_PFX + 20];
+  bdjmsgroute_t rf;
+  bdjmsgroute_t rt;
+  bdjmsgmsg_t   msg;
+  char    *args = NULL;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bdjmsg_decode_text");
+  mdebugSubTag ("bdjmsg_decode_text");
+
+  /* the older text prefix is still accepted */
+  snprintf (buff, sizeof (buff), "%04d~%04d~%04d~%s",
+      ROUTE_PLAYER, ROUTE_MAIN, MSG_PLAYER_STATE, "abc");
+  msgDecode (buff, &rf, &rt, &msg, &args);
+  ck_assert_int_eq (rf, ROUTE_PLAYER);
+  ck_assert_int_eq (rt, ROUTE_MAIN);
+  ck_assert_int_eq (msg, MSG_PLAYER_STATE);
+  ck_assert_str_eq (args, "abc");
+}
+END_TEST
+
+START_TEST(bdjmsg_tlv)
+{
+  char        buff [200];
+  size_t      offset;
+  const char  *p;
+  int         type;
+  int64_t     val;
+  int64_t     tvals [] = { 0, -1, 127, -300, 70000, -2147483648LL, 5000000000LL };
+  int         tvalsz = sizeof (tvals) / sizeof (int64_t);
+  int         count;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- bdjmsg_tlv");
+  mdebugSubTag ("bdjmsg_tlv");
+
+  ck_assert_int_eq (msgArgsIsTLV ("abc"), false);
+  ck_assert_int_eq (msgArgsLen ("abc"), 4);
+  ck_assert_int_eq (msgArgsLen (NULL), 0);
+
+  offset = msgTLVInit (buff, sizeof (buff));
+  for (int i = 0; i < tvalsz; ++i) {
+    offset = msgTLVAddInt (buff, sizeof (buff), offset, i + 1, tvals [i]);
+    ck_assert_int_ne (offset, 0);
+  }
+  msgTLVFinish (buff, offset);
+  ck_assert_int_eq (msgArgsIsTLV (buff), true);
+  ck_assert_int_eq (msgArgsLen (buff), offset + 1);
+  ck_assert_int_eq (buff [offset], '\0');
+
+  p = NULL;
+  count = 0;
+  while ((p = msgTLVNext (buff, p, &type, &val)) != NULL) {
+    ck_assert_int_eq (type, count + 1);
+    ck_assert_int_eq (val, tvals [count]);
+    ++count;
+  }
+  ck_assert_int_eq (count, tvalsz);
+
+  /* buffer too small */
+  offset = msgTLVInit (buff, 8);
+  offset = msgTLVAddInt (buff, 8, offset, 1, 5000000000LL);
+  ck_assert_int_eq (offset, 0);
 }
 END_TEST
 
@@ -75,6 +147,8 @@ bdjmsg_suite (void)
   tcase_set_tags (tc, "libcommon");
   tcase_add_test (tc, bdjmsg_encode);
   tcase_add_test (tc, bdjmsg_decode);
+  tcase_add_test (tc, bdjmsg_decode_text);
+  tcase_add_test (tc, bdjmsg_tlv);
   suite_add_tcase (s, tc);
   return s;
 }
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "bdjopt.h"
+#include "check_bdj.h"
+#include "fadecurve.h"
+#include "log.h"
+#include "mdebug.h"
+
+typedef struct {
+  int     fadetype;
+  double  findex;
+  double  gain;
+} tfade_t;
+
+static tfade_t tvals [] = {
+  { FADETYPE_TRIANGLE, 0.0, 0.0 },
+  { FADETYPE_TRIANGLE, 0.5, 0.5 },
+  { FADETYPE_TRIANGLE, 1.0, 1.0 },
+  { FADETYPE_QUADRATIC, 0.5, 0.25 },
+  { FADETYPE_QUADRATIC, 1.0, 1.0 },
+  { FADETYPE_INVERTED_PARABOLA, 0.5, 0.75 },
+  { FADETYPE_QUARTER_SINE, 0.0, 0.0 },
+  { FADETYPE_QUARTER_SINE, 1.0, 1.0 },
+  { FADETYPE_HALF_SINE, 0.0, 0.0 },
+  { FADETYPE_HALF_SINE, 0.5, 0.5 },
+  { FADETYPE_HALF_SINE, 1.0, 1.0 },
+  { FADETYPE_EXPONENTIAL_SINE, 0.0, 0.0 },
+  { FADETYPE_EXPONENTIAL_SINE, 1.0, 1.0 },
+  /* out of range */
+  { FADETYPE_TRIANGLE, -0.5, 0.0 },
+  { FADETYPE_TRIANGLE, 1.5, 1.0 },
+};
+enum {
+  TVALS_SZ = sizeof (tvals) / sizeof (tfade_t),
+};
+
+START_TEST(fadecurve_calc)
+{
+  double    gain;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- fadecurve_calc");
+  mdebugSubTag ("fadecurve_calc");
+
+  for (int i = 0; i < TVALS_SZ; ++i) {
+    gain = fadecurveCalc (tvals [i].fadetype, tvals [i].findex);
+    ck_assert_double_eq_tol (gain, tvals [i].gain, 0.0001);
+  }
+}
+END_TEST
+
+START_TEST(fadecurve_range)
+{
+  double    gain;
+  double    prior;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- fadecurve_range");
+  mdebugSubTag ("fadecurve_range");
+
+  /* every curve rises from silence to full volume */
+  for (int ft = 0; ft < FADETYPE_MAX; ++ft) {
+    prior = 0.0;
+    for (int i = 0; i <= 100; ++i) {
+      gain = fadecurveCalc (ft, (double) i / 100.0);
+      ck_assert_double_ge (gain, 0.0);
+      ck_assert_double_le (gain, 1.0);
+      ck_assert_double_ge (gain, prior);
+      prior = gain;
+    }
+  }
+}
+END_TEST
+
+Suite *
+fadecurve_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("fadecurve");
+  tc = tcase_create ("fadecurve");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, fadecurve_calc);
+  tcase_add_test (tc, fadecurve_range);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -8,6 +8,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -141,6 +142,105 @@ START_TEST(filemanip_copy)
 }
 END_TEST
 
+START_TEST(filemanip_copy_large)
+{
+  FILE      *fh;
+  int       rc;
+  time_t    otm;
+  char      *ofn = "tmp/filemanip-large.dat";
+  char      *nfn = "tmp/filemanip-large-new.dat";
+  char      obuff [1000];
+  char      nbuff [1000];
+  FILE      *ofh;
+  FILE      *nfh;
+  size_t    olen;
+  size_t    nlen;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- filemanip_copy_large");
+  mdebugSubTag ("filemanip_copy_large");
+
+  fileopDelete (ofn);
+  fileopDelete (nfn);
+
+  /* larger than the copy buffer */
+  fh = fileopOpen (ofn, "w");
+  ck_assert_ptr_nonnull (fh);
+  for (int i = 0; i < 40000; ++i) {
+    fprintf (fh, "%d\n", i);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+  otm = fileopModTime (ofn) - 100;
+  fileopSetModTime (ofn, otm);
+
+  rc = filemanipCopy (ofn, nfn);
+  ck_assert_int_eq (rc, 0);
+  ck_assert_int_eq (fileopSize (ofn), fileopSize (nfn));
+  /* the modification time is preserved */
+  ck_assert_int_eq (fileopModTime (nfn), otm);
+
+  ofh = fileopOpen (ofn, "r");
+  nfh = fileopOpen (nfn, "r");
+  do {
+    olen = fread (obuff, 1, sizeof (obuff), ofh);
+    nlen = fread (nbuff, 1, sizeof (nbuff), nfh);
+    ck_assert_int_eq (olen, nlen);
+    ck_assert_mem_eq (obuff, nbuff, olen);
+  } while (olen > 0);
+  mdextfclose (ofh);
+  fclose (ofh);
+  mdextfclose (nfh);
+  fclose (nfh);
+
+  /* an existing file is replaced */
+  fh = fileopOpen (ofn, "w");
+  fprintf (fh, "x\n");
+  mdextfclose (fh);
+  fclose (fh);
+  rc = filemanipCopy (ofn, nfn);
+  ck_assert_int_eq (rc, 0);
+  ck_assert_int_eq (fileopSize (nfn), 2);
+
+  fileopDelete (ofn);
+  fileopDelete (nfn);
+}
+END_TEST
+
+START_TEST(filemanip_copy_perm)
+{
+  FILE        *fh;
+  struct stat statbuf;
+  char        *ofn = "tmp/abc-perm.txt";
+  char        *nfn = "tmp/abc-perm.txt.new";
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- filemanip_copy_perm");
+  mdebugSubTag ("filemanip_copy_perm");
+
+  if (isWindows ()) {
+    return;
+  }
+
+  fileopDelete (ofn);
+  fileopDelete (nfn);
+
+  fh = fileopOpen (ofn, "w");
+  ck_assert_ptr_nonnull (fh);
+  fprintf (fh, "x\n");
+  mdextfclose (fh);
+  fclose (fh);
+  chmod (ofn, 0640);
+
+  filemanipCopy (ofn, nfn);
+  chmod (nfn, 0600);
+  filemanipCopyPermissions (ofn, nfn);
+  stat (nfn, &statbuf);
+  ck_assert_int_eq (statbuf.st_mode & 07777, 0640);
+
+  fileopDelete (ofn);
+  fileopDelete (nfn);
+}
+END_TEST
+
 START_TEST(filemanip_backup)
 {
   FILE      *fh;
@@ -501,6 +601,8 @@ filemanip_suite (void)
   tcase_set_tags (tc, "libcommon");
   tcase_add_test (tc, filemanip_move);
   tcase_add_test (tc, filemanip_copy);
+  tcase_add_test (tc, filemanip_copy_large);
+  tcase_add_test (tc, filemanip_copy_perm);
   tcase_add_test (tc, filemanip_backup);
   tcase_add_test (tc, filemanip_renameall);
   tcase_add_test (tc, filemanip_deleteall);
@@ -141,6 +141,52 @@ START_TEST(fileop_modtime_a)
 }
 END_TEST
 
+START_TEST(fileop_stat_a)
+{
+  FILE          *fh;
+  time_t        ctm;
+  fileopstat_t  fst;
+  fileopstat_t  fstb;
+  bool          rc;
+  char *fn = "tmp/abc.txt";
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- fileop_stat_a");
+  mdebugSubTag ("fileop_stat_a");
+
+  ctm = time (NULL);
+  fh = fileopOpen (fn, "w");
+  ck_assert_ptr_nonnull (fh);
+  fprintf (fh, "abcdef");
+  mdextfclose (fh);
+  fclose (fh);
+  rc = fileopStat (fn, &fst);
+  ck_assert_int_eq (rc, 1);
+  ck_assert_int_eq (fst.size, 6);
+  ck_assert_int_ge (fst.mtime, ctm);
+  ck_assert_int_eq (fst.mtime, fileopModTime (fn));
+  ck_assert_int_ge (fst.ctime, ctm);
+  ck_assert_int_eq (fst.nlink, 1);
+
+  /* the inode does not change when the file is re-written */
+  fh = fileopOpen (fn, "a");
+  fprintf (fh, "ghi");
+  mdextfclose (fh);
+  fclose (fh);
+  rc = fileopStat (fn, &fstb);
+  ck_assert_int_eq (rc, 1);
+  ck_assert_int_eq (fstb.size, 9);
+  ck_assert_int_eq (fstb.inode, fst.inode);
+  ck_assert_int_eq (fstb.dev, fst.dev);
+  unlink (fn);
+
+  rc = fileopStat ("tmp/def.txt", &fst);
+  ck_assert_int_eq (rc, 0);
+  ck_assert_int_eq (fst.size, -1);
+  ck_assert_int_eq (fst.mtime, 0);
+  ck_assert_int_eq (fst.ctime, 0);
+}
+END_TEST
+
 START_TEST(fileop_setmodtime_a)
 {
   FILE      *fh;
@@ -428,6 +474,7 @@ fileop_suite (void)
   tcase_add_test (tc, fileop_exists_symlink);
   tcase_add_test (tc, fileop_size_a);
   tcase_add_test (tc, fileop_modtime_a);
+  tcase_add_test (tc, fileop_stat_a);
   tcase_add_test (tc, fileop_setmodtime_a);
   tcase_add_test (tc, fileop_delete_a);
   tcase_add_test (tc, fileop_delete_symlink);
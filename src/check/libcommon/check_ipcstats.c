@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "bdjmsg.h"
+#include "check_bdj.h"
+#include "ipcstats.h"
+#include "log.h"
+#include "mdebug.h"
+#include "tmutil.h"
+
+START_TEST(ipcstats_report)
+{
+  char      *buff;
+  int64_t   t;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- ipcstats_report");
+  mdebugSubTag ("ipcstats_report");
+
+  buff = mdmalloc (IPCSTATS_REPORT_MAX);
+
+  ipcstatsReset ();
+  ipcstatsReport (buff, IPCSTATS_REPORT_MAX);
+  ck_assert_ptr_null (strstr (buff, "route"));
+  ck_assert_ptr_null (strstr (buff, "msg"));
+
+  t = ipcstatsStart ();
+  ipcstatsSent (ROUTE_MAIN, MSG_PLAYER_VOLUME, 20, t);
+  ipcstatsSuperseded (MSG_PLAYER_STATUS_DATA);
+  t = ipcstatsStart ();
+  ipcstatsRcvd (ROUTE_PLAYER, MSG_PLAYER_STATUS_DATA, 60, t, ustime ());
+  ipcstatsLost (ROUTE_MARQUEE);
+  ipcstatsSockWrite (24);
+  ipcstatsSockRead (64);
+  ipcstatsReport (buff, IPCSTATS_REPORT_MAX);
+
+  ck_assert_ptr_nonnull (strstr (buff, "sock write 1 24B read 1 64B"));
+  ck_assert_ptr_nonnull (strstr (buff, "route MAIN "));
+  ck_assert_ptr_nonnull (strstr (buff, "route PLAYER "));
+  ck_assert_ptr_nonnull (strstr (buff, "lost 1"));
+  ck_assert_ptr_nonnull (strstr (buff, "latency PLAYER "));
+  ck_assert_ptr_nonnull (strstr (buff, "superseded 1"));
+  ck_assert_ptr_nonnull (strstr (buff, msgDebugText (MSG_PLAYER_VOLUME)));
+  ck_assert_ptr_null (strstr (buff, "latency MAIN "));
+
+  ipcstatsReset ();
+  ipcstatsReport (buff, IPCSTATS_REPORT_MAX);
+  ck_assert_ptr_null (strstr (buff, "route"));
+
+  mdfree (buff);
+}
+END_TEST
+
+Suite *
+ipcstats_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("ipcstats");
+  tc = tcase_create ("ipcstats");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, ipcstats_report);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
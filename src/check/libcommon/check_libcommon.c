@@ -52,20 +52,25 @@ check_libcommon (SRunner *sr)
    *  pathinfo    complete
    *  log
    *  bdjmsg      complete
+   *  ipcstats    complete
    *  sock        partial                 // uses ossignal
+   *  shmring     complete
    *  bdjvars     complete
-   *  sockh
+   *  sockh       partial
    *  queue       complete 2022-11-1
    *  conn
    *  callback    complete 2023-3-4
    *  osrandom    complete
    *  bdjregex
    *  colorutils  complete
+   *  fadecurve   complete
    *  vsencdec    complete
    *  oslocale
    *  ossignal    complete
    *  bdj4arg
    *  roman       complete 2024-11-20
+   *  workpool    complete
+   *  mp3hdr      complete
    */
 
   logMsg (LOG_DBG, LOG_IMPORTANT, "==chk== libcommon");
@@ -134,13 +139,20 @@ check_libcommon (SRunner *sr)
   s = bdjmsg_suite();
   srunner_add_suite (sr, s);
 
+  s = ipcstats_suite();
+  srunner_add_suite (sr, s);
+
   s = sock_suite();
   srunner_add_suite (sr, s);
 
+  s = shmring_suite();
+  srunner_add_suite (sr, s);
+
   s = bdjvars_suite();
   srunner_add_suite (sr, s);
 
-  /* sockh */
+  s = sockh_suite();
+  srunner_add_suite (sr, s);
 
   s = queue_suite();
   srunner_add_suite (sr, s);
@@ -158,6 +170,9 @@ check_libcommon (SRunner *sr)
   s = colorutils_suite();
   srunner_add_suite (sr, s);
 
+  s = fadecurve_suite();
+  srunner_add_suite (sr, s);
+
   s = vsencdec_suite();
   srunner_add_suite (sr, s);
 
@@ -170,6 +185,12 @@ check_libcommon (SRunner *sr)
 
   s = roman_suite();
   srunner_add_suite (sr, s);
+
+  s = workpool_suite();
+  srunner_add_suite (sr, s);
+
+  s = mp3hdr_suite();
+  srunner_add_suite (sr, s);
 }
 
 #pragma clang diagnostic pop
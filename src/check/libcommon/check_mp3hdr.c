@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "mp3hdr.h"
+
+#define MP3_FN  "tmp/mp3hdr.mp3"
+
+enum {
+  MP3_ID3V2_SZ = 2000,
+  MP3_XING_OFFSET = 36,
+  MP3_VBRI_OFFSET = 36,
+};
+
+/* mpeg-1 layer 3, 128 kbit/s, 48000, stereo: 384 bytes, 24ms */
+static const unsigned char hdr48 [] = { 0xff, 0xfb, 0x94, 0x00 };
+/* mpeg-1 layer 3, 128 kbit/s, 44100, stereo: 417 bytes */
+static const unsigned char hdr44 [] = { 0xff, 0xfb, 0x90, 0x00 };
+/* mpeg-2 layer 3, 64 kbit/s, 24000, mono: 192 bytes, 24ms */
+static const unsigned char hdrm2 [] = { 0xff, 0xf3, 0x84, 0xc0 };
+
+/* the first frame may contain a vbr header */
+static void
+mp3Create (const unsigned char *hdr, int framelen, int frames,
+    const unsigned char *vbr, size_t vbrlen, size_t vbroffset,
+    bool id3)
+{
+  FILE            *fh;
+  unsigned char   *frame;
+
+  fh = fopen (MP3_FN, "wb");
+  if (id3) {
+    unsigned char   id3hdr [10] = { 'I', 'D', '3', 4, 0, 0, 0, 0, 0, 0 };
+
+    /* syncsafe */
+    id3hdr [8] = (MP3_ID3V2_SZ >> 7) & 0x7f;
+    id3hdr [9] = MP3_ID3V2_SZ & 0x7f;
+    fwrite (id3hdr, sizeof (id3hdr), 1, fh);
+    frame = mdmalloc (MP3_ID3V2_SZ);
+    memset (frame, 0, MP3_ID3V2_SZ);
+    fwrite (frame, MP3_ID3V2_SZ, 1, fh);
+    mdfree (frame);
+  }
+
+  frame = mdmalloc (framelen);
+  for (int i = 0; i < frames; ++i) {
+    memset (frame, 0, framelen);
+    memcpy (frame, hdr, 4);
+    if (i == 0 && vbr != NULL) {
+      memcpy (frame + vbroffset, vbr, vbrlen);
+    }
+    fwrite (frame, framelen, 1, fh);
+  }
+  mdfree (frame);
+
+  if (id3) {
+    unsigned char   id3v1 [128];
+
+    memset (id3v1, 0, sizeof (id3v1));
+    memcpy (id3v1, "TAG", 3);
+    fwrite (id3v1, sizeof (id3v1), 1, fh);
+  }
+  fclose (fh);
+}
+
+START_TEST(mp3hdr_none)
+{
+  FILE      *fh;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- mp3hdr_none");
+  mdebugSubTag ("mp3hdr_none");
+
+  ck_assert_int_eq (mp3hdrDuration ("tmp/mp3hdr-none.mp3"), -1);
+
+  /* not an mp3 file */
+  fh = fopen (MP3_FN, "w");
+  fprintf (fh, "not an mp3 file\n");
+  fclose (fh);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), -1);
+  fileopDelete (MP3_FN);
+}
+END_TEST
+
+START_TEST(mp3hdr_cbr)
+{
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- mp3hdr_cbr");
+  mdebugSubTag ("mp3hdr_cbr");
+
+  mp3Create (hdr48, 384, 500, NULL, 0, 0, false);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), 500 * 24);
+
+  /* the id3 tags are not included */
+  mp3Create (hdr48, 384, 500, NULL, 0, 0, true);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), 500 * 24);
+
+  mp3Create (hdrm2, 192, 250, NULL, 0, 0, true);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), 250 * 24);
+
+  fileopDelete (MP3_FN);
+}
+END_TEST
+
+START_TEST(mp3hdr_xing)
+{
+  unsigned char   xing [8 + 4 + 4 + 24];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- mp3hdr_xing");
+  mdebugSubTag ("mp3hdr_xing");
+
+  /* the number of frames in the header is used, not the file size */
+  memset (xing, 0, sizeof (xing));
+  memcpy (xing, "Xing", 4);
+  /* flags: frames, bytes */
+  xing [7] = 0x03;
+  /* 1000 frames */
+  xing [10] = 0x03;
+  xing [11] = 0xe8;
+  mp3Create (hdr44, 417, 20, xing, 16, MP3_XING_OFFSET, true);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), 1000 * 1152 * 1000 / 44100);
+
+  /* lame extension: delay 576, padding 1000 */
+  memcpy (xing + 16, "LAME3.100", 9);
+  xing [16 + 21] = 0x24;
+  xing [16 + 22] = 0x03;
+  xing [16 + 23] = 0xe8;
+  mp3Create (hdr44, 417, 20, xing, sizeof (xing), MP3_XING_OFFSET, true);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN),
+      (1000 * 1152 - 576 - 1000) * 1000 / 44100);
+
+  /* no frame count */
+  memset (xing, 0, sizeof (xing));
+  memcpy (xing, "Xing", 4);
+  mp3Create (hdr44, 417, 20, xing, 16, MP3_XING_OFFSET, true);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), -1);
+
+  fileopDelete (MP3_FN);
+}
+END_TEST
+
+START_TEST(mp3hdr_vbri)
+{
+  unsigned char   vbri [18];
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- mp3hdr_vbri");
+  mdebugSubTag ("mp3hdr_vbri");
+
+  memset (vbri, 0, sizeof (vbri));
+  memcpy (vbri, "VBRI", 4);
+  /* 500 frames */
+  vbri [16] = 0x01;
+  vbri [17] = 0xf4;
+  mp3Create (hdr44, 417, 20, vbri, sizeof (vbri), MP3_VBRI_OFFSET, false);
+  ck_assert_int_eq (mp3hdrDuration (MP3_FN), 500 * 1152 * 1000 / 44100);
+
+  fileopDelete (MP3_FN);
+}
+END_TEST
+
+Suite *
+mp3hdr_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("mp3hdr");
+  tc = tcase_create ("mp3hdr");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, mp3hdr_none);
+  tcase_add_test (tc, mp3hdr_cbr);
+  tcase_add_test (tc, mp3hdr_xing);
+  tcase_add_test (tc, mp3hdr_vbri);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "log.h"
+#include "mdebug.h"
+#include "shmring.h"
+
+enum {
+  SHMRING_TEST_PORT = 39130,
+};
+
+START_TEST(shmring_open_none)
+{
+  shmring_t   *ring;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- shmring_open_none");
+  mdebugSubTag ("shmring_open_none");
+
+  ring = shmringOpen (SHMRING_TEST_PORT);
+  ck_assert_ptr_null (ring);
+}
+END_TEST
+
+START_TEST(shmring_put_get)
+{
+  shmring_t   *cring;
+  shmring_t   *pring;
+  char        buff [SHMRING_SLOT_SZ];
+  char        tbuff [SHMRING_SLOT_SZ];
+  size_t      len;
+  bool        rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- shmring_put_get");
+  mdebugSubTag ("shmring_put_get");
+
+  if (! shmringAvailable ()) {
+    return;
+  }
+
+  cring = shmringCreate (SHMRING_TEST_PORT);
+  ck_assert_ptr_nonnull (cring);
+  pring = shmringOpen (SHMRING_TEST_PORT);
+  ck_assert_ptr_nonnull (pring);
+
+  rc = shmringGet (cring, buff, sizeof (buff), &len);
+  ck_assert_int_eq (rc, false);
+  ck_assert_int_eq (len, 0);
+
+  /* fill the ring */
+  for (int i = 0; i < SHMRING_SLOTS; ++i) {
+    snprintf (tbuff, sizeof (tbuff), "message %d", i);
+    rc = shmringPut (pring, tbuff, strlen (tbuff) + 1);
+    ck_assert_int_eq (rc, true);
+  }
+  rc = shmringPut (pring, "full", 5);
+  ck_assert_int_eq (rc, false);
+
+  /* messages are received in order */
+  for (int i = 0; i < SHMRING_SLOTS; ++i) {
+    snprintf (tbuff, sizeof (tbuff), "message %d", i);
+    rc = shmringGet (cring, buff, sizeof (buff), &len);
+    ck_assert_int_eq (rc, true);
+    ck_assert_int_eq (len, strlen (tbuff) + 1);
+    ck_assert_str_eq (buff, tbuff);
+  }
+  rc = shmringGet (cring, buff, sizeof (buff), &len);
+  ck_assert_int_eq (rc, false);
+
+  /* wraps around */
+  rc = shmringPut (pring, "after", 6);
+  ck_assert_int_eq (rc, true);
+  rc = shmringGet (cring, buff, sizeof (buff), &len);
+  ck_assert_int_eq (rc, true);
+  ck_assert_str_eq (buff, "after");
+
+  /* too large */
+  memset (tbuff, 'a', sizeof (tbuff));
+  rc = shmringPut (pring, tbuff, sizeof (tbuff));
+  ck_assert_int_eq (rc, false);
+
+  shmringClose (pring);
+  shmringClose (cring);
+}
+END_TEST
+
+START_TEST(shmring_close)
+{
+  shmring_t   *cring;
+  shmring_t   *pring;
+  bool        rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- shmring_close");
+  mdebugSubTag ("shmring_close");
+
+  if (! shmringAvailable ()) {
+    return;
+  }
+
+  cring = shmringCreate (SHMRING_TEST_PORT);
+  ck_assert_ptr_nonnull (cring);
+  pring = shmringOpen (SHMRING_TEST_PORT);
+  ck_assert_ptr_nonnull (pring);
+  ck_assert_int_eq (shmringIsClosed (pring), false);
+
+  /* the producer must notice that the consumer has gone away */
+  shmringClose (cring);
+  ck_assert_int_eq (shmringIsClosed (pring), true);
+  rc = shmringPut (pring, "closed", 7);
+  ck_assert_int_eq (rc, false);
+  shmringClose (pring);
+
+  pring = shmringOpen (SHMRING_TEST_PORT);
+  ck_assert_ptr_null (pring);
+}
+END_TEST
+
+Suite *
+shmring_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("shmring");
+  tc = tcase_create ("shmring");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, shmring_open_none);
+  tcase_add_test (tc, shmring_put_get);
+  tcase_add_test (tc, shmring_close);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
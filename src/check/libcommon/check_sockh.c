@@ -0,0 +1,177 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "bdjmsg.h"
+#include "check_bdj.h"
+#include "log.h"
+#include "mdebug.h"
+#include "sock.h"
+#include "sockh.h"
+#include "tmutil.h"
+
+enum {
+  SOCKH_TEST_PORT = 32720,
+};
+
+typedef struct {
+  bdjmsgmsg_t   msg;
+  const char    *args;
+} tsockhmsg_t;
+
+static tsockhmsg_t sendmsgs [] = {
+  { MSG_PLAYER_STATUS_DATA, "1" },
+  { MSG_HANDSHAKE, NULL },
+  { MSG_PLAYER_STATUS_DATA, "2" },
+  { MSG_PLAYER_VOLUME, "50" },
+  { MSG_PLAYER_STATUS_DATA, "3" },
+};
+enum {
+  SENDMSGS_SZ = sizeof (sendmsgs) / sizeof (tsockhmsg_t),
+};
+
+/* the older status messages are replaced */
+static tsockhmsg_t rcvmsgs [] = {
+  { MSG_HANDSHAKE, NULL },
+  { MSG_PLAYER_VOLUME, "50" },
+  { MSG_PLAYER_STATUS_DATA, "3" },
+};
+enum {
+  RCVMSGS_SZ = sizeof (rcvmsgs) / sizeof (tsockhmsg_t),
+};
+
+START_TEST(sockh_buff)
+{
+  sockhbuff_t   *sb;
+  Sock_t        l;
+  Sock_t        c = INVALID_SOCKET;
+  Sock_t        r;
+  int           err;
+  int           connerr;
+  int           count;
+  int           rc;
+  char          buff [BDJMSG_MAX];
+  char          *ndata;
+  size_t        len;
+  char          *args;
+  bdjmsgroute_t routefrom;
+  bdjmsgroute_t route;
+  bdjmsgmsg_t   msg;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- sockh_buff");
+  mdebugSubTag ("sockh_buff");
+
+  l = sockServer (SOCKH_TEST_PORT, &err);
+  ck_assert_int_eq (socketInvalid (l), 0);
+  c = sockConnect (SOCKH_TEST_PORT, &connerr, c);
+  count = 0;
+  while (connerr == SOCK_CONN_IN_PROGRESS && count < 100) {
+    mssleep (20);
+    c = sockConnect (SOCKH_TEST_PORT, &connerr, c);
+    ++count;
+  }
+  ck_assert_int_eq (socketInvalid (c), 0);
+  r = sockAccept (l, &err);
+  ck_assert_int_eq (socketInvalid (r), 0);
+
+  sb = sockhBuffAlloc ();
+  ck_assert_int_eq (sockhBuffIsEmpty (sb), true);
+  for (int i = 0; i < SENDMSGS_SZ; ++i) {
+    rc = sockhBuffMessage (sb, ROUTE_PLAYER, ROUTE_MAIN,
+        sendmsgs [i].msg, sendmsgs [i].args);
+    ck_assert_int_eq (rc, true);
+  }
+  ck_assert_int_eq (sockhBuffIsEmpty (sb), false);
+
+  rc = sockhBuffFlush (c, sb);
+  ck_assert_int_eq (rc, 0);
+  ck_assert_int_eq (sockhBuffIsEmpty (sb), true);
+
+  for (int i = 0; i < RCVMSGS_SZ; ++i) {
+    ndata = sockReadBuff (r, &len, buff, sizeof (buff));
+    ck_assert_ptr_nonnull (ndata);
+    msgDecode (buff, &routefrom, &route, &msg, &args);
+    ck_assert_int_eq (routefrom, ROUTE_PLAYER);
+    ck_assert_int_eq (route, ROUTE_MAIN);
+    ck_assert_int_eq (msg, rcvmsgs [i].msg);
+    if (rcvmsgs [i].args == NULL) {
+      ck_assert_int_eq (*args, '\0');
+    } else {
+      ck_assert_str_eq (args, rcvmsgs [i].args);
+    }
+  }
+
+  sockhBuffFree (sb);
+  sockClose (r);
+  sockClose (c);
+  sockClose (l);
+}
+END_TEST
+
+START_TEST(sockh_buff_large)
+{
+  sockhbuff_t   *sb;
+  char          *args;
+  bool          rc;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- sockh_buff_large");
+  mdebugSubTag ("sockh_buff_large");
+
+  sb = sockhBuffAlloc ();
+  args = mdmalloc (SOCKH_BUFF_MAX + 1);
+  memset (args, 'a', SOCKH_BUFF_MAX);
+  args [SOCKH_BUFF_MAX] = '\0';
+
+  /* too large to buffer */
+  rc = sockhBuffMessage (sb, ROUTE_MAIN, ROUTE_PLAYERUI,
+      MSG_MUSIC_QUEUE_DATA, args);
+  ck_assert_int_eq (rc, false);
+  ck_assert_int_eq (sockhBuffIsEmpty (sb), true);
+
+  args [SOCKH_BUFF_MAX / 2] = '\0';
+  rc = sockhBuffMessage (sb, ROUTE_MAIN, ROUTE_PLAYERUI,
+      MSG_MUSIC_QUEUE_DATA, args);
+  ck_assert_int_eq (rc, true);
+  /* the buffer is full */
+  rc = sockhBuffMessage (sb, ROUTE_MAIN, ROUTE_PLAYERUI,
+      MSG_MUSIC_QUEUE_DATA, args);
+  ck_assert_int_eq (rc, false);
+
+  mdfree (args);
+  sockhBuffFree (sb);
+}
+END_TEST
+
+Suite *
+sockh_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("sockh");
+  tc = tcase_create ("sockh-buff");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, sockh_buff);
+  tcase_add_test (tc, sockh_buff_large);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
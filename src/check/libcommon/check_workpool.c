@@ -0,0 +1,197 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#pragma clang diagnostic push
+#pragma GCC diagnostic push
+#pragma clang diagnostic ignored "-Wformat-extra-args"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+
+#include <check.h>
+
+#include "check_bdj.h"
+#include "log.h"
+#include "mdebug.h"
+#include "tmutil.h"
+#include "workpool.h"
+
+enum {
+  WP_JOB_COUNT = 20,
+  WP_THREADS = 4,
+};
+
+typedef struct {
+  int     num;
+  int     result;
+  int     thridx;
+} tjob_t;
+
+static void
+tworker (void *udata, void *job, int thridx)
+{
+  tjob_t  *tjob = job;
+  int     *mult = udata;
+
+  mssleep (5);
+  tjob->result = tjob->num * *mult;
+  tjob->thridx = thridx;
+}
+
+static int
+twait (workpool_t *wp, int *found, int *cancelcount)
+{
+  tjob_t    *tjob;
+  bool      cancelled;
+  int       count = 0;
+
+  while (count < 2000) {
+    tjob = workpoolProcess (wp, &cancelled);
+    if (tjob == NULL) {
+      if (workpoolIsIdle (wp)) {
+        break;
+      }
+      mssleep (1);
+      ++count;
+      continue;
+    }
+    if (cancelled) {
+      *cancelcount += 1;
+    } else {
+      ck_assert_int_eq (tjob->result, tjob->num * 3);
+      ck_assert_int_ge (tjob->thridx, 0);
+      ck_assert_int_lt (tjob->thridx, workpoolThreadCount (wp));
+      found [tjob->num] += 1;
+    }
+  }
+  return count;
+}
+
+START_TEST(workpool_alloc)
+{
+  workpool_t  *wp;
+  int         mult = 3;
+  int         count, tot;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- workpool_alloc");
+  mdebugSubTag ("workpool_alloc");
+
+  wp = workpoolAlloc ("chk-wp", WP_THREADS, tworker, &mult);
+  ck_assert_ptr_nonnull (wp);
+  ck_assert_int_ge (workpoolThreadCount (wp), 1);
+  ck_assert_int_le (workpoolThreadCount (wp), WP_THREADS);
+  ck_assert_int_eq (workpoolIsIdle (wp), true);
+  ck_assert_int_eq (workpoolIsCancelled (wp), false);
+  workpoolGetCount (wp, &count, &tot);
+  ck_assert_int_eq (count, 0);
+  ck_assert_int_eq (tot, 0);
+  workpoolFree (wp);
+}
+END_TEST
+
+START_TEST(workpool_process)
+{
+  workpool_t  *wp;
+  int         mult = 3;
+  int         count, tot;
+  tjob_t      jobs [WP_JOB_COUNT];
+  int         found [WP_JOB_COUNT];
+  int         cancelcount = 0;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- workpool_process");
+  mdebugSubTag ("workpool_process");
+
+  wp = workpoolAlloc ("chk-wp", WP_THREADS, tworker, &mult);
+  for (int i = 0; i < WP_JOB_COUNT; ++i) {
+    jobs [i].num = i;
+    jobs [i].result = -1;
+    jobs [i].thridx = -1;
+    found [i] = 0;
+    workpoolAdd (wp, &jobs [i]);
+  }
+  workpoolGetCount (wp, &count, &tot);
+  ck_assert_int_eq (tot, WP_JOB_COUNT);
+
+  twait (wp, found, &cancelcount);
+  ck_assert_int_eq (workpoolIsIdle (wp), true);
+  ck_assert_int_eq (cancelcount, 0);
+  for (int i = 0; i < WP_JOB_COUNT; ++i) {
+    ck_assert_int_eq (found [i], 1);
+  }
+  workpoolGetCount (wp, &count, &tot);
+  ck_assert_int_eq (count, WP_JOB_COUNT);
+  ck_assert_int_eq (tot, WP_JOB_COUNT);
+  workpoolFree (wp);
+}
+END_TEST
+
+START_TEST(workpool_cancel)
+{
+  workpool_t  *wp;
+  int         mult = 3;
+  int         count, tot;
+  tjob_t      jobs [WP_JOB_COUNT];
+  int         found [WP_JOB_COUNT];
+  int         cancelcount = 0;
+  int         foundcount = 0;
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "--chk-- workpool_cancel");
+  mdebugSubTag ("workpool_cancel");
+
+  wp = workpoolAlloc ("chk-wp", 2, tworker, &mult);
+  for (int i = 0; i < WP_JOB_COUNT; ++i) {
+    jobs [i].num = i;
+    jobs [i].result = -1;
+    jobs [i].thridx = -1;
+    found [i] = 0;
+    workpoolAdd (wp, &jobs [i]);
+  }
+  workpoolCancel (wp);
+  ck_assert_int_eq (workpoolIsCancelled (wp), true);
+
+  twait (wp, found, &cancelcount);
+  ck_assert_int_eq (workpoolIsIdle (wp), true);
+  for (int i = 0; i < WP_JOB_COUNT; ++i) {
+    ck_assert_int_le (found [i], 1);
+    foundcount += found [i];
+  }
+  /* every job is returned exactly once */
+  ck_assert_int_eq (foundcount + cancelcount, WP_JOB_COUNT);
+  ck_assert_int_gt (cancelcount, 0);
+  workpoolGetCount (wp, &count, &tot);
+  ck_assert_int_eq (count, foundcount);
+
+  /* jobs added after a cancel are returned as cancelled */
+  cancelcount = 0;
+  workpoolAdd (wp, &jobs [0]);
+  twait (wp, found, &cancelcount);
+  ck_assert_int_eq (cancelcount, 1);
+
+  workpoolFree (wp);
+}
+END_TEST
+
+Suite *
+workpool_suite (void)
+{
+  Suite     *s;
+  TCase     *tc;
+
+  s = suite_create ("workpool");
+  tc = tcase_create ("workpool");
+  tcase_set_tags (tc, "libcommon");
+  tcase_add_test (tc, workpool_alloc);
+  tcase_add_test (tc, workpool_process);
+  tcase_add_test (tc, workpool_cancel);
+  suite_add_tcase (s, tc);
+  return s;
+}
+
+#pragma clang diagnostic pop
+#pragma GCC diagnostic pop
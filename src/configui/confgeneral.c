@@ -96,6 +96,11 @@ confuiBuildUIGeneral (confuigui_t *gui)
   uiEntrySetValidate (gui->uiitem [CONFUI_ENTRY_CHOOSE_MUSIC_DIR].uiwidgetp,
       "", uiEntryValidateDir, NULL, UIENTRY_DELAYED);
 
+  /* CONTEXT: configuration: update the database when the music folder changes */
+  confuiMakeItemSwitch (gui, vbox, szgrp, _("Watch Music Folder"),
+      CONFUI_SWITCH_DB_WATCH, OPT_G_DB_WATCH,
+      bdjoptGetNum (OPT_G_DB_WATCH), NULL, 0);
+
   /* CONTEXT: configuration: the name of this profile */
   confuiMakeItemEntry (gui, vbox, szgrp, _("Profile Name"),
       CONFUI_ENTRY_PROFILE_NAME, OPT_P_PROFILENAME,
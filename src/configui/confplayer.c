@@ -127,6 +127,11 @@ confuiBuildUIPlayer (confuigui_t *gui)
       CONFUI_WIDGET_DEFAULT_VOL, OPT_P_DEFAULTVOLUME,
       1, 100, bdjoptGetNum (OPT_P_DEFAULTVOLUME), NULL);
 
+  /* CONTEXT: configuration: the loudness (LUFS) used to calculate the volume adjustment */
+  confuiMakeItemSpinboxNum (gui, vbox, szgrp, szgrpB, _("Target Loudness"),
+      CONFUI_WIDGET_LOUDNESS_TARGET, OPT_G_LOUDNESS_TARGET,
+      -31, -5, bdjoptGetNum (OPT_G_LOUDNESS_TARGET), NULL);
+
   /* CONTEXT: (noun) configuration: the number of items loaded into the music queue */
   confuiMakeItemSpinboxNum (gui, vbox, szgrp, szgrpB, _("Queue Length"),
       CONFUI_WIDGET_PL_QUEUE_LEN, OPT_G_PLAYERQLEN,
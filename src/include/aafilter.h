@@ -0,0 +1,40 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_AAFILTER_H
+#define INC_AAFILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+/* in-process audio processing: decode, filter and encode in one pass */
+
+typedef struct aafilter aafilter_t;
+
+/* samples : float, interleaved if there is more than one channel */
+/* count : the number of sample frames */
+typedef void (*aafiltersamplecb_t)(void *udata, const float *samples, int count);
+
+enum {
+  AAFILTER_CANCELLED = -2,
+};
+
+bool aafilterAvailable (void);
+aafilter_t * aafilterAlloc (void);
+void aafilterFree (aafilter_t *aaf);
+int aafilterProcess (aafilter_t *aaf, const char *infn, const char *outfn, int32_t startms, int32_t durms, const char *filters);
+int aafilterSamples (aafilter_t *aaf, const char *infn, int32_t startms, int32_t durms, int rate, int channels, aafiltersamplecb_t cb, void *udata);
+int aafilterGetProgress (aafilter_t *aaf);
+int32_t aafilterGetDuration (aafilter_t *aaf);
+void aafilterCancel (aafilter_t *aaf);
+bool aafilterHaveFilter (const char *name);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_AAFILTER_H */
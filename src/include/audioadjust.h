@@ -4,9 +4,12 @@
 #ifndef INC_AUDIOADJUST_H
 #define INC_AUDIOADJUST_H
 
+#include "aafilter.h"
+#include "callback.h"
 #include "musicdb.h"
 #include "nlist.h"
 #include "song.h"
+#include "tagwriter.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
 extern "C" {
@@ -18,12 +21,40 @@ enum {
   AA_NO_GAP = -1,
 };
 
+enum {
+  AA_NO_CHANGE = 1,
+};
+
+/* the song data and options used by aaAdjustFile() */
+typedef struct {
+  int32_t     songstart;
+  int32_t     songend;
+  int32_t     songdur;
+  int         speed;
+  int         fadetype;
+  long        dur;
+  int         fadein;
+  int         fadeout;
+  int         gap;
+} aaparam_t;
+
 typedef struct aa aa_t;
+typedef struct aabatch aabatch_t;
 
 aa_t * aaAlloc (void);
 void aaFree (aa_t *aa);
 bool aaApplyAdjustments (musicdb_t *musicdb, dbidx_t dbidx, int aaflags);
+aabatch_t *aaBatchAlloc (musicdb_t *musicdb, nlist_t *dbidxlist, int aaflags, callback_t *songcb);
+void aaBatchFree (aabatch_t *aab);
+void aaBatchSetTagWriter (aabatch_t *aab, tagwriter_t *tagwriter);
+bool aaBatchProcess (aabatch_t *aab);
+void aaBatchCancel (aabatch_t *aab);
+void aaBatchGetCount (aabatch_t *aab, int *count, int *tot);
+int aaBatchGetProgress (aabatch_t *aab);
 void aaAdjust (musicdb_t *musicdb, song_t *song, const char *infn, const char *outfn, long dur, int fadein, int fadeout, int gap);
+void aaGetParams (song_t *song, aaparam_t *aap, long dur, int fadein, int fadeout, int gap);
+int aaAdjustFile (aafilter_t *aaf, const aaparam_t *aap, const char *infn, const char *outfn);
+void aaSetDuration (song_t *song, const char *ffn);
 int aaSilenceDetect (const char *infn, double *sstart, double *send);
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -28,6 +28,7 @@ void    audiotagInit (void);
 void    audiotagCleanup (void);
 slist_t * audiotagParseData (const char *ffn, int *rewrite);
 int     audiotagWriteTags (const char *ffn, slist_t *tagdata, slist_t *newtaglist, int rewrite, int modTimeFlag);
+int     audiotagWriteTagsReplace (const char *ffn, slist_t *tagdata, slist_t *newtaglist, int rewrite, int modTimeFlag);
 void    *audiotagSaveTags (const char *ffn);
 void    audiotagFreeSavedTags (const char *ffn, void *sdata);
 int     audiotagRestoreTags (const char *ffn, void *sdata);
@@ -107,6 +107,7 @@ enum {
 #define ALT_IDX_FN          "altidx"
 #define BASE_PORT_FN        "baseport"
 #define INST_PATH_FN        "installdir"
+#define IPC_LOCAL_FN        "ipclocal"
 #define NEWINST_FN          "newinstall"
 #define READONLY_FN         "readonly"
 /* installation */
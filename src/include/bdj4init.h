@@ -41,6 +41,10 @@ enum {
   BDJ4_ARG_UPD_NEW              = (1 << 24),
   BDJ4_ARG_UPD_CONVERT          = (1 << 25),
   BDJ4_INIT_NO_LOG              = (1 << 26),
+  BDJ4_ARG_DB_BPM_DETECT        = (1 << 27),
+  BDJ4_ARG_DB_LOUDNESS          = (1 << 28),
+  BDJ4_ARG_DB_UPD_CHANGED       = (1 << 29),
+  BDJ4_ARG_DB_WATCH             = (1 << 30),
 };
 
 void bdj4initArgInit (void);
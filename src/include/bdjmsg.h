@@ -4,7 +4,9 @@
 #ifndef INC_BDJMSG_H
 #define INC_BDJMSG_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <stddef.h>
 
 #if defined (__cplusplus) || defined (c_plusplus)
 extern "C" {
@@ -21,6 +23,7 @@ typedef enum {
   ROUTE_BPM_COUNTER,
   ROUTE_CONFIGUI,
   ROUTE_DBUPDATE,   // the main db update process
+  ROUTE_DBWATCH,    // the music folder watcher
   ROUTE_HELPERUI,
   ROUTE_MAIN,
   ROUTE_MANAGEUI,
@@ -41,6 +44,7 @@ typedef enum {
   MSG_SOCKET_CLOSE,
   MSG_DATABASE_UPDATE,      // send by manageui to starterui,
                             // then sent by starterui to playerui, main.
+                            // args: change list serial (optional)
   MSG_DB_ENTRY_UPDATE,      // args: dbidx
   MSG_DB_ENTRY_REMOVE,      // args: dbidx
   MSG_DB_ENTRY_UNREMOVE,    // args: dbidx
@@ -100,12 +104,20 @@ typedef enum {
   MSG_SONG_PREP,            // args: song fname, duration, song-start
                             //    song-end, volume-adjustment-perc, ann-flag
   MSG_SONG_CLEAR_PREP,      // args: song fname
+  MSG_SONG_PREROLL,         // args: unique-idx, song fname
+                            //    the song after the current song,
+                            //    response to playback-preroll.
   MSG_SET_PLAYBACK_GAP,     // args: gap
   MSG_SET_PLAYBACK_FADEIN,  // args: fade-in
   MSG_SET_PLAYBACK_FADEOUT, // args: fade-out
+  MSG_SET_PLAYBACK_XFADE,   // args: crossfade
   MSG_MAIN_READY,           // the main process is ready to receive msgs
   MSG_MUSICQ_DATA_SUSPEND,  // args: queue number
   MSG_MUSICQ_DATA_RESUME,   // args: queue number
+  MSG_MUSICQ_DATA_RESYNC,   // args: queue number
+                            //    a music queue delta could not be applied,
+                            //    or a part of the data is missing,
+                            //    request the complete queue data.
 
   /* from player */
   MSG_PLAY_PAUSEATEND_STATE,// args: 0/1
@@ -116,12 +128,15 @@ typedef enum {
                             //    stop playing, do not continue
   MSG_PLAYBACK_FINISH,      // to main: player has finished playing song
                             //    args: song fname
+  MSG_PLAYBACK_PREROLL,     // to main: the player can pre-roll the next
+                            //    song for a crossfade.
   MSG_PLAYER_STATE,         // args: player state
   MSG_PLAYER_STATUS_DATA,   // response to get_status; to main
   MSG_PLAYER_ANN_FINISHED,  // announcement is finished
 
   /* to/from manageui/playerui */
-  MSG_MUSIC_QUEUE_DATA,
+  MSG_MUSIC_QUEUE_DATA,     // may be sent in several parts
+  MSG_MUSIC_QUEUE_DELTA,    // changes since the last music queue data
   MSG_QUEUE_SWITCH,         // args: queue number
   MSG_SONG_SELECT,          // args: queue number, position
   MSG_FINISHED,             // no more songs, also sent to marquee
@@ -168,7 +183,7 @@ typedef enum {
   MSG_DB_STOP_REQ,
   MSG_DB_PROGRESS,          // args: % complete
   MSG_DB_STATUS_MSG,        // args: status message
-  MSG_DB_FINISH,            //
+  MSG_DB_FINISH,            // args: change list serial (optional)
   MSG_DB_WAIT,              // display 'please wait'
   MSG_DB_WAIT_FINISH,       // clear status
   /* to/from bpm counter */
@@ -194,6 +209,12 @@ typedef enum {
 
   MSG_CHK_CLEAR_PREP_Q,
 
+  /* debugging */
+  /* the ipc statistics request is answered by sockh in every process */
+  /* on the same socket. */
+  MSG_DEBUG_IPC_STATS,
+  MSG_DEBUG_IPC_STATS_DATA, // args: statistics report
+
   /* when a new message is added, update: */
   /* bdjmsg.c: debugging information for the msg */
   MSG_MAX,
@@ -204,13 +225,26 @@ enum {
   PREP_ANNOUNCE,
 };
 
+/* the message prefix is binary: */
+/*   magic, version, route-from (2), route (2), msg (2), */
+/*   time-sent (8, microseconds) */
+/* the values are in network byte order. */
+/* the older text prefix (3 4-char numerics with separators) */
+/* is still accepted by msgDecode() */
+enum {
+  BDJMSG_HDR_MAGIC = 0xBD,
+  BDJMSG_HDR_VERSION = 2,
+  BDJMSG_HDR_TIME_OFFSET = 8,
+  BDJMSG_HDR_SZ = 16,
+};
+
 /* make the message size large enough to handle a */
 /* 1000 (the max player queue length) long playlist message */
 enum {
   BDJMSG_MAX_ARGS = 20000,
-  /* the prefix consists of 3 4-char numerics with separators */
-  /* and a null byte */
-  BDJMSG_MAX_PFX = (sizeof (uint32_t) + 1) * 3 + 1,
+  /* the prefix is large enough for either the binary header or */
+  /* the text prefix, and a null byte */
+  BDJMSG_MAX_PFX = BDJMSG_HDR_SZ + 1,
   BDJMSG_MAX = BDJMSG_MAX_PFX + BDJMSG_MAX_ARGS,
 };
 
@@ -219,12 +253,29 @@ enum {
 #define MSG_ARGS_EMPTY      0x03      // ETX
 #define MSG_ARGS_EMPTY_STR  "\x03"
 
+/* binary (type-length-value) arguments: */
+/*   marker, total length (2), then for each field: type, length, value, */
+/*   and a terminating null byte */
+/* integer values are big-endian, as short as possible, sign-extended */
+#define MSG_ARGS_TLV        0x02      // STX
+enum {
+  MSG_TLV_HDR_SZ = 3,
+  MSG_TLV_MAX = 0xFFFF,
+};
+
 /* exposed for use in testing */
 extern const char *bdjmsgroutetxt [ROUTE_MAX];
 extern const char *bdjmsgtxt [MSG_MAX];
 
 size_t    msgEncode (bdjmsgroute_t routefrom, bdjmsgroute_t route, bdjmsgmsg_t msg, char *msgbuff, size_t mlen);
 void      msgDecode (char *msgbuff, bdjmsgroute_t *routefrom, bdjmsgroute_t *route, bdjmsgmsg_t *msg, char **args);
+int64_t   msgTimeSent (const char *msgbuff);
+size_t    msgArgsLen (const char *args);
+bool      msgArgsIsTLV (const char *args);
+size_t    msgTLVInit (char *buff, size_t sz);
+size_t    msgTLVAddInt (char *buff, size_t sz, size_t offset, int type, int64_t val);
+void      msgTLVFinish (char *buff, size_t offset);
+const char *msgTLVNext (const char *args, const char *p, int *type, int64_t *val);
 const char *msgDebugText (bdjmsgmsg_t msg);
 const char *msgRouteDebugText (bdjmsgroute_t route);
 
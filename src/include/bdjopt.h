@@ -82,8 +82,10 @@ typedef enum {
   OPT_G_BPM,
   OPT_G_CLOCK_DISP,
   OPT_G_DANCESEL_METHOD,
+  OPT_G_DB_WATCH,
   OPT_G_DEBUGLVL,
   OPT_G_LOADDANCEFROMGENRE,
+  OPT_G_LOUDNESS_TARGET,
   OPT_G_OLDORGPATH,
   OPT_G_ORGPATH,
   OPT_G_PLAYERQLEN,
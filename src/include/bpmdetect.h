@@ -0,0 +1,33 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_BPMDETECT_H
+#define INC_BPMDETECT_H
+
+#include <stdint.h>
+
+#include "aafilter.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+enum {
+  /* the audio is analyzed at this sample rate */
+  BPMDETECT_RATE = 11025,
+};
+
+typedef struct bpmdetect bpmdetect_t;
+
+bpmdetect_t *bpmdetectAlloc (void);
+void bpmdetectFree (bpmdetect_t *bpmd);
+void bpmdetectReset (bpmdetect_t *bpmd);
+void bpmdetectAddSamples (bpmdetect_t *bpmd, const float *samples, int count);
+int bpmdetectFile (bpmdetect_t *bpmd, aafilter_t *aaf, const char *fn, int32_t startms, int32_t durms);
+double bpmdetectCalc (bpmdetect_t *bpmd, double lowbpm, double highbpm, int *confidence);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_BPMDETECT_H */
@@ -114,6 +114,7 @@ enum {
   CONFUI_WIDGET_BEGIN,
   CONFUI_SWITCH_AUTO_ORGANIZE,
   CONFUI_SWITCH_DB_LOAD_FROM_GENRE,
+  CONFUI_SWITCH_DB_WATCH,
   CONFUI_SWITCH_ENABLE_ITUNES,
   CONFUI_SWITCH_MOBILE_MQ,
   CONFUI_SWITCH_MQ_SHOW_SONG_INFO,
@@ -215,6 +216,7 @@ enum {
   CONFUI_WIDGET_ITUNES_FIELD_32,
   CONFUI_WIDGET_ITUNES_FIELD_33,
   CONFUI_WIDGET_ITUNES_FIELD_34,
+  CONFUI_WIDGET_LOUDNESS_TARGET,
   CONFUI_WIDGET_MOBMQ_PORT,
   CONFUI_WIDGET_MOBMQ_QR_CODE,
   CONFUI_WIDGET_MQ_BG_COLOR,
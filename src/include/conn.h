@@ -85,6 +85,9 @@ void      connProcessUnconnected (conn_t *conn);
 
 /**
  * Send a message.
+ * The message is held in the outbound buffer for the route and is
+ * sent by connFlush().  An older status message for the same route
+ * that has not been sent yet is replaced.
  *
  * @param[in] conn The connection.
  * @param[in] route The route to send the message to.
@@ -94,6 +97,14 @@ void      connProcessUnconnected (conn_t *conn);
 void      connSendMessage (conn_t *conn, bdjmsgroute_t route,
               bdjmsgmsg_t msg, const char *args);
 
+/**
+ * Send all held outbound messages.
+ * This is called at the end of each pass of the main loop.
+ *
+ * @param[in] conn The connection.
+ */
+void      connFlush (conn_t *conn);
+
 /**
  * Check and see if a connection is active.
  *
@@ -4,6 +4,8 @@
 #ifndef INC_DIRLIST_H
 #define INC_DIRLIST_H
 
+#include <stdint.h>
+
 #include "slist.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -18,9 +20,15 @@ enum {
   DIRLIST_LINKS = 0x04,
 };
 
+typedef struct dirwalk dirwalk_t;
+
 /* dirlist.c */
 slist_t * dirlistBasicDirList (const char *dir, const char *extension);
 slist_t * dirlistRecursiveDirList (const char *dir, int flags);
+dirwalk_t * dirlistWalkStart (const char *dir, int flags);
+void dirlistWalkFree (dirwalk_t *dwalk);
+int32_t dirlistWalkCount (dirwalk_t *dwalk);
+const char * dirlistWalkNext (dirwalk_t *dwalk);
 
 #if defined (__cplusplus) || defined (c_plusplus)
 } /* extern C */
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_DIRWATCH_H
+#define INC_DIRWATCH_H
+
+#include <stdbool.h>
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+typedef struct dirwatch dirwatch_t;
+
+typedef enum {
+  DIRWATCH_NONE,
+  /* a file was created, modified or moved into the directory */
+  DIRWATCH_CHANGED,
+  DIRWATCH_REMOVED,
+  /* path is the new name, oldpath is the old name */
+  DIRWATCH_RENAMED,
+  DIRWATCH_DIR_REMOVED,
+  DIRWATCH_DIR_RENAMED,
+  /* events were lost, the entire directory must be scanned */
+  DIRWATCH_RESCAN,
+} dirwatchevent_t;
+
+dirwatch_t      *dirwatchAlloc (const char *topdir, int debouncems);
+void            dirwatchFree (dirwatch_t *dw);
+bool            dirwatchIsComplete (dirwatch_t *dw);
+void            dirwatchProcess (dirwatch_t *dw);
+dirwatchevent_t dirwatchNext (dirwatch_t *dw, const char **path, const char **oldpath);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_DIRWATCH_H */
@@ -0,0 +1,17 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_FADECURVE_H
+#define INC_FADECURVE_H
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+double  fadecurveCalc (int fadeType, double findex);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_FADECURVE_H */
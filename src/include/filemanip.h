@@ -13,6 +13,7 @@ extern "C" {
 int     filemanipCopy (const char *from, const char *to);
 int     filemanipLinkCopy (const char *from, const char *to);
 int     filemanipMove (const char *from, const char *to);
+void    filemanipCopyPermissions (const char *from, const char *to);
 void    filemanipBackup (const char *fname, int count);
 void    filemanipRenameAll (const char *ofname, const char *nfname);
 void    filemanipDeleteAll (const char *name);
@@ -6,15 +6,30 @@
 
 #include "config.h"
 #include <stdio.h>
+#include <stdint.h>
 #include <time.h>
 
 #if defined (__cplusplus) || defined (c_plusplus)
 extern "C" {
 #endif
 
+/* the inode is always zero on windows */
+/* nlink is always one on windows */
+/* ctime is the status change time, the creation time on windows */
+/* dev is the drive number on windows */
+typedef struct {
+  ssize_t   size;
+  time_t    mtime;
+  time_t    ctime;
+  uint64_t  inode;
+  uint64_t  dev;
+  uint32_t  nlink;
+} fileopstat_t;
+
 bool    fileopFileExists (const char *fname);
 ssize_t fileopSize (const char *fname);
 time_t  fileopModTime (const char *fname);
+bool    fileopStat (const char *fname, fileopstat_t *fst);
 void    fileopSetModTime (const char *fname, time_t tm);
 time_t  fileopCreateTime (const char *fname);
 bool    fileopIsDirectory (const char *fname);
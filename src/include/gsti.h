@@ -24,6 +24,8 @@ void gstiPlay (gsti_t *gsti);
 void gstiStop (gsti_t *gsti);
 bool gstiSetPosition (gsti_t *gsti, int64_t pos);
 bool gstiSetRate (gsti_t *gsti, double rate);
+bool gstiHaveFade (gsti_t *gsti);
+void gstiFade (gsti_t *gsti, plifade_t fadedir, int fadeType, int64_t fadestart, int64_t fadelen);
 int gstiGetVolume (gsti_t *gsti);
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_IPCSTATS_H
+#define INC_IPCSTATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bdjmsg.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+/* per-process statistics for the messages sent between processes */
+
+enum {
+  IPCSTATS_REPORT_MAX = 60000,
+};
+
+int64_t ipcstatsStart (void);
+void    ipcstatsSent (bdjmsgroute_t route, bdjmsgmsg_t msg, size_t bytes, int64_t start);
+void    ipcstatsSuperseded (bdjmsgmsg_t msg);
+void    ipcstatsRcvd (bdjmsgroute_t routefrom, bdjmsgmsg_t msg, size_t bytes, int64_t start, int64_t timesent);
+void    ipcstatsLost (bdjmsgroute_t route);
+void    ipcstatsSockWrite (size_t bytes);
+void    ipcstatsSockRead (size_t bytes);
+void    ipcstatsReset (void);
+size_t  ipcstatsReport (char *buff, size_t sz);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_IPCSTATS_H */
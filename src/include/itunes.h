@@ -4,6 +4,7 @@
 #ifndef INC_ITUNES_H
 #define INC_ITUNES_H
 
+#include "callback.h"
 #include "nlist.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -37,6 +38,7 @@ void  itunesSetField (itunes_t *itunes, int idx, int value);
 void  itunesSaveFields (itunes_t *itunes);
 void  itunesStartIterateAvailFields (itunes_t *itunes);
 const char * itunesIterateAvailFields (itunes_t *itunes, int *val);
+void  itunesSetProgressCallback (itunes_t *itunes, callback_t *cb);
 bool  itunesParse (itunes_t *itunes);
 nlist_t * itunesGetSongData (itunes_t *itunes, nlistidx_t idx);
 nlist_t * itunesGetSongDataByName (itunes_t *itunes, const char *skey);
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_LOUDNESS_H
+#define INC_LOUDNESS_H
+
+#include <stdint.h>
+
+#include "aafilter.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+enum {
+  /* the audio is analyzed at this sample rate, stereo */
+  LOUDNESS_RATE = 48000,
+  LOUDNESS_CHANNELS = 2,
+};
+
+/* returned when there is no audio above the absolute gate */
+#define LOUDNESS_NONE -70.0
+/* a volume increase is limited so that the true peak stays below this */
+#define LOUDNESS_MAX_TRUE_PEAK -1.0
+/* the same limits as the song editor volume adjustment */
+#define LOUDNESS_ADJ_MAX 50.0
+
+typedef struct loudness loudness_t;
+
+loudness_t *loudnessAlloc (void);
+void loudnessFree (loudness_t *loud);
+void loudnessReset (loudness_t *loud);
+void loudnessAddSamples (loudness_t *loud, const float *samples, int count);
+int loudnessFile (loudness_t *loud, aafilter_t *aaf, const char *fn);
+double loudnessIntegrated (loudness_t *loud);
+double loudnessTruePeak (loudness_t *loud);
+double loudnessVolumeAdjust (double lufs, double truepeak, double target);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_LOUDNESS_H */
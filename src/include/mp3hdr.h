@@ -0,0 +1,19 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_MP3HDR_H
+#define INC_MP3HDR_H
+
+#include <stdint.h>
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+int32_t mp3hdrDuration (const char *fn);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_MP3HDR_H */
@@ -22,11 +22,24 @@ typedef struct {
 
 typedef struct {
   musicqidx_t     mqidx;
+  int32_t         seq;
   int32_t         tottime;
   dbidx_t         currdbidx;
   nlist_t         *dispList;
 } mp_musicqupdate_t;
 
+/* music queue delta operations */
+#define MP_MQ_DELTA_INSERT  'I'   // pos, uniqueidx, dbidx, pause-ind
+#define MP_MQ_DELTA_REMOVE  'R'   // pos
+#define MP_MQ_DELTA_MOVE    'M'   // from-pos, to-pos
+#define MP_MQ_DELTA_FLAG    'F'   // pos, pause-ind
+
+enum {
+  MSGPARSE_MQ_OK,
+  MSGPARSE_MQ_PARTIAL,
+  MSGPARSE_MQ_RESYNC,
+};
+
 typedef struct {
   int             mqidx;
   int32_t         loc;
@@ -52,15 +65,19 @@ typedef struct {
   int32_t   uniqueidx;
 } mp_musicqstatus_t;
 
-mp_musicqupdate_t *msgparseMusicQueueData (char * data);
+mp_musicqupdate_t *msgparseMusicQueueAlloc (musicqidx_t mqidx);
+void  msgparseMusicQueueAppend (mp_musicqupdate_t *musicqupdate, int dispidx, int32_t uniqueidx, dbidx_t dbidx, int pauseind);
+bool  msgbuildMusicQueueData (char *buff, size_t sz, mp_musicqupdate_t *musicqupdate, nlistidx_t *start);
+bool  msgbuildMusicQueueDelta (char *buff, size_t sz, mp_musicqupdate_t *prev, mp_musicqupdate_t *curr);
+int   msgparseMusicQueueData (mp_musicqupdate_t **pending, char *data);
+int   msgparseMusicQueueDelta (mp_musicqupdate_t *musicqupdate, char *data);
 void  msgparseMusicQueueDataFree (mp_musicqupdate_t *musicqupdate);
 
 mp_songselect_t *msgparseSongSelect (char * data);
 void msgparseSongSelectFree (mp_songselect_t *songselect);
 
 void msgbuildPlayerStatus (char *buff, size_t sz, bool repeat, bool pauseatend, int currvol, int currspeed, int basevol, uint32_t tm, int32_t dur);
-mp_playerstatus_t *msgparsePlayerStatusData (char * data);
-void msgparsePlayerStatusFree (mp_playerstatus_t *playerstatus);
+void msgparsePlayerStatus (mp_playerstatus_t *ps, char *data);
 
 void msgbuildPlayerState (char *buff, size_t sz, int playerState, bool newsong);
 mp_playerstate_t *msgparsePlayerStateData (char * data);
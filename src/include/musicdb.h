@@ -4,6 +4,7 @@
 #ifndef INC_MUSICDB_H
 #define INC_MUSICDB_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "rafile.h"
@@ -34,6 +35,7 @@ enum {
 #define MUSICDB_TMP_FNAME "musicdb-tmp"
 #define MUSICDB_EXT       ".dat"
 #define MUSICDB_ENTRY_NEW RAFILE_NEW
+#define MUSICDB_CHG_EXT   ".chg"
 
 musicdb_t *dbOpen (const char *);
 void      dbClose (musicdb_t *db);
@@ -55,6 +57,9 @@ void      dbStartIterator (musicdb_t *db, slistidx_t *iteridx);
 song_t    *dbIterate (musicdb_t *db, dbidx_t *dbidx, slistidx_t *iteridx);
 void      dbBackup (void);
 dbidx_t   dbAddTemporarySong (musicdb_t *db, song_t *song);
+void      dbStartChangeList (musicdb_t *musicdb);
+int64_t   dbSaveChangeList (musicdb_t *musicdb);
+bool      dbApplyChangeList (musicdb_t *musicdb, const char *serial);
 /* void      dbDumpSongList (musicdb_t *db); */ // for debugging
 
 #if defined (__cplusplus) || defined (c_plusplus)
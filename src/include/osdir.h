@@ -12,8 +12,17 @@ extern "C" {
 
 typedef struct dirhandle dirhandle_t;
 
+/* the type of the directory entry, if known without a stat() */
+enum {
+  OSDIR_TYPE_UNKNOWN,
+  OSDIR_TYPE_FILE,
+  OSDIR_TYPE_DIR,
+  OSDIR_TYPE_LINK,
+};
+
 dirhandle_t   * osDirOpen (const char *dir);
 char          * osDirIterate (dirhandle_t *dirh);
+char          * osDirIterateType (dirhandle_t *dirh, int *type);
 void          osDirClose (dirhandle_t *dirh);
 
 #if defined (__cplusplus) || defined (c_plusplus)
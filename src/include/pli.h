@@ -37,8 +37,16 @@ enum {
   PLI_SUPPORT_SPEED   = (1 << 1),
   PLI_SUPPORT_DEVLIST = (1 << 2),
   PLI_SUPPORT_XFADE   = (1 << 3),
+  PLI_SUPPORT_FADE    = (1 << 4),
 };
 
+/* the fades are applied within the player interface's audio pipeline */
+typedef enum {
+  PLI_FADE_NONE,
+  PLI_FADE_IN,
+  PLI_FADE_OUT,
+} plifade_t;
+
 enum {
   PLI_DEFAULT_DEV,
   PLI_SELECTED_DEV,
@@ -73,6 +81,7 @@ plistate_t    pliState (pli_t *pli);
 int           pliSetAudioDevice (pli_t *pli, const char *dev, int plidevtype);
 int           pliAudioDeviceList (pli_t *pli, volsinklist_t *sinklist);
 int           pliSupported (pli_t *pli);
+void          pliFade (pli_t *pli, plifade_t fadedir, int fadeType, ssize_t fadestart, ssize_t fadelen);
 
 int           pliGetVolume (pli_t *pli);      // for debugging
 const char    *pliStateText (pli_t *pli);
@@ -95,6 +104,7 @@ plistate_t    pliiState (plidata_t *pliData);
 int           pliiSetAudioDevice (plidata_t *pliData, const char *dev, int plidevtype);
 int           pliiAudioDeviceList (plidata_t *pliData, volsinklist_t *);
 int           pliiSupported (plidata_t *pliData);
+void          pliiFade (plidata_t *pliData, plifade_t fadedir, int fadeType, ssize_t fadestart, ssize_t fadelen);
 void          pliiDesc (const char **ret, int max);
 int           pliiGetVolume (plidata_t *pliData);
 
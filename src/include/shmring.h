@@ -0,0 +1,37 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_SHMRING_H
+#define INC_SHMRING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+/* single-producer, single-consumer ring buffer in shared memory */
+/* the consumer (the listening process) creates and owns the ring */
+
+enum {
+  SHMRING_SLOT_SZ = 256,
+  SHMRING_SLOTS = 16,
+};
+
+typedef struct shmring shmring_t;
+
+bool      shmringAvailable (void);
+shmring_t *shmringCreate (uint16_t port);
+shmring_t *shmringOpen (uint16_t port);
+void      shmringClose (shmring_t *ring);
+bool      shmringIsClosed (shmring_t *ring);
+bool      shmringPut (shmring_t *ring, const char *data, size_t len);
+bool      shmringGet (shmring_t *ring, char *buff, size_t sz, size_t *len);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_SHMRING_H */
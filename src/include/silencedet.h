@@ -0,0 +1,36 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_SILENCEDET_H
+#define INC_SILENCEDET_H
+
+#include <stdint.h>
+
+#include "aafilter.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+enum {
+  /* the audio is analyzed at this sample rate, stereo */
+  SILENCEDET_RATE = 24000,
+  SILENCEDET_CHANNELS = 2,
+};
+
+typedef struct silencedet silencedet_t;
+
+silencedet_t *silencedetAlloc (void);
+void silencedetFree (silencedet_t *sd);
+void silencedetReset (silencedet_t *sd, int noisedb);
+void silencedetAddSamples (silencedet_t *sd, const float *samples, int count);
+double silencedetLength (silencedet_t *sd);
+double silencedetLeading (silencedet_t *sd);
+double silencedetTrailing (silencedet_t *sd);
+int silencedetFile (silencedet_t *sd, aafilter_t *aaf, const char *fn, int noisedb, double mindur, double *sstart, double *send);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_SILENCEDET_H */
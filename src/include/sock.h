@@ -55,6 +55,14 @@ enum {
 # define INVALID_SOCKET -1
 #endif
 
+/* the transport is set for the entire process */
+typedef enum {
+  SOCK_TRANS_TCP,       // localhost
+  SOCK_TRANS_LOCAL,     // unix domain socket
+} socktransport_t;
+
+void          sockSetTransport (socktransport_t transport);
+socktransport_t sockGetTransport (void);
 Sock_t        sockServer (uint16_t port, int *err);
 void          sockClose (Sock_t);
 sockinfo_t *  sockAddCheck (sockinfo_t *, Sock_t);
@@ -67,6 +75,7 @@ Sock_t        sockAccept (Sock_t, int *);
 Sock_t        sockConnect (uint16_t port, int *connerr, Sock_t clsock);
 char *        sockReadBuff (Sock_t, size_t *, char *data, size_t dlen);
 int           sockWriteBinary (Sock_t, const char *data, size_t dlen, const char *args, size_t alen);
+int           sockWriteBuff (Sock_t, const char *data, size_t dlen);
 bool          socketInvalid (Sock_t sock);
 bool          sockWaitClosed (sockinfo_t *sockinfo);
 
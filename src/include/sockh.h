@@ -8,6 +8,8 @@
 
 #include "sock.h"
 #include "bdjmsg.h"
+#include "callback.h"
+#include "shmring.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
 extern "C" {
@@ -20,16 +22,29 @@ typedef int (*sockhProcessFunc_t)(void *);
 typedef struct {
   sockinfo_t      *si;
   Sock_t          listenSock;
+  shmring_t       *ring;
 } sockserver_t;
 
+typedef struct sockhbuff sockhbuff_t;
+
 enum {
   SOCKH_CONTINUE = false,
   SOCKH_STOP = true,
   SOCKH_MAINLOOP_TIMEOUT = 5,
+  /* messages larger than this are not buffered */
+  SOCKH_BUFF_MAX = 65536,
 };
 
 void  sockhMainLoop (uint16_t listenPort, sockhProcessMsg_t msgFunc, sockhProcessFunc_t processFunc, void *userData);
 int   sockhSendMessage (Sock_t sock, bdjmsgroute_t routefrom, bdjmsgroute_t route, bdjmsgmsg_t msg, const char *args);
+void  sockhSetFlushCallback (callback_t *cb);
+sockhbuff_t *sockhBuffAlloc (void);
+void  sockhBuffFree (sockhbuff_t *sb);
+bool  sockhBuffMessage (sockhbuff_t *sb, bdjmsgroute_t routefrom, bdjmsgroute_t route, bdjmsgmsg_t msg, const char *args);
+bool  sockhBuffIsEmpty (sockhbuff_t *sb);
+int   sockhBuffFlush (Sock_t sock, sockhbuff_t *sb);
+bool  sockhStatusRingPort (uint16_t port);
+int   sockhRingSendMessage (shmring_t *ring, bdjmsgroute_t routefrom, bdjmsgroute_t route, bdjmsgmsg_t msg, const char *args);
 
 #if defined (__cplusplus) || defined (c_plusplus)
 } /* extern C */
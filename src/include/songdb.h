@@ -6,6 +6,7 @@
 
 #include "musicdb.h"
 #include "song.h"
+#include "tagwriter.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
 extern "C" {
@@ -36,6 +37,7 @@ size_t songdbWriteDBSong (songdb_t *songdb, song_t *song, int *flags, dbidx_t rr
 songdb_t *songdbAlloc (musicdb_t *musicdb);
 void  songdbFree (songdb_t *songdb);
 void  songdbSetMusicDB (songdb_t *songdb, musicdb_t *musicdb);
+void  songdbSetTagWriter (songdb_t *songdb, tagwriter_t *tagwriter);
 
 #if defined (__cplusplus) || defined (c_plusplus)
 } /* extern C */
@@ -85,6 +85,7 @@ typedef enum {
   SVL_PROFILE_IDX,
   SVL_HOME_SZ,
   SVL_INITIAL_PORT,
+  SVL_IPC_LOCAL,
   SVL_IS_LINUX,
   SVL_IS_MACOS,
   SVL_IS_MSYS,
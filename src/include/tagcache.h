@@ -0,0 +1,31 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_TAGCACHE_H
+#define INC_TAGCACHE_H
+
+#include <stdbool.h>
+
+#include "fileop.h"
+#include "slist.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+#define TAGCACHE_FNAME  "tagcache"
+#define TAGCACHE_EXT    ".dat"
+
+typedef struct tagcache tagcache_t;
+
+tagcache_t  *tagcacheLoad (const char *fname);
+void        tagcacheFree (tagcache_t *tc);
+void        tagcacheSave (tagcache_t *tc, bool prune);
+slist_t     *tagcacheGet (tagcache_t *tc, const char *ffn, fileopstat_t *fst, int *rewrite);
+void        tagcacheSet (tagcache_t *tc, const char *ffn, fileopstat_t *fst, slist_t *tagdata, int rewrite);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_TAGCACHE_H */
@@ -91,9 +91,14 @@ typedef enum {
   TAG_DISCTOTAL,              //
   TAG_DURATION,               // not saved to af
   TAG_FAVORITE,               //
+  TAG_FILE_INODE,             // only in the database
+  TAG_FILE_MISSING,           // only in the database
+  TAG_FILE_MTIME,             // only in the database
+  TAG_FILE_SIZE,              // only in the database
   TAG_GENRE,                  //
   TAG_GROUPING,               //
   TAG_KEYWORD,                //
+  TAG_LOUDNESS,               // only in the database
   TAG_MOVEMENTNAME,           //
   TAG_MOVEMENTNUM,            //
   TAG_MOVEMENTCOUNT,          //
@@ -119,6 +124,7 @@ typedef enum {
   TAG_TRACK_ID,               // musicbrainz_releasetrackid
   TAG_TRACKNUMBER,            //
   TAG_TRACKTOTAL,             //
+  TAG_TRUE_PEAK,              // only in the database
   TAG_LAST_UPDATED,           //  internal
   TAG_URI,                    //
   TAG_VOLUMEADJUSTPERC,       //  bdj4
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_TAGWRITER_H
+#define INC_TAGWRITER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "slist.h"
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+typedef struct tagwriter tagwriter_t;
+
+tagwriter_t *tagwriterAlloc (void);
+void    tagwriterFree (tagwriter_t *tw);
+void    tagwriterAdd (tagwriter_t *tw, const char *ffn, slist_t *tagdata, slist_t *newtaglist, int rewrite, int modTimeFlag);
+int32_t tagwriterProcess (tagwriter_t *tw);
+void    tagwriterWait (tagwriter_t *tw);
+bool    tagwriterIsIdle (tagwriter_t *tw);
+int32_t tagwriterGetCount (tagwriter_t *tw);
+int     tagwriterGetDeviceCount (tagwriter_t *tw);
+slist_t *tagwriterGetErrors (tagwriter_t *tw);
+void    tagwriterClearErrors (tagwriter_t *tw);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_TAGWRITER_H */
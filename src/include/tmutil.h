@@ -5,6 +5,7 @@
 #define INC_TMUTIL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -39,6 +40,7 @@ typedef struct {
 
 void      mssleep (time_t);
 time_t    mstime (void);
+int64_t   ustime (void);
 time_t    mstimestartofday (void);
 void      mstimestart (mstime_t *tm);
 time_t    mstimeend (mstime_t *tm);
@@ -18,6 +18,7 @@ enum {
   RESPONSE_CLOSE,
   RESPONSE_APPLY,
   RESPONSE_RESET,
+  RESPONSE_CANCEL,
 };
 
 #include "callback.h"
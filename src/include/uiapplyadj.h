@@ -18,7 +18,9 @@ typedef struct uiaa uiaa_t;
 uiaa_t  *uiaaInit (uiwcont_t *windowp, nlist_t *opts);
 void    uiaaFree (uiaa_t *uiaa);
 void    uiaaSetResponseCallback (uiaa_t *uiaa, callback_t *uicb);
-bool    uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig);
+void    uiaaSetCancelCallback (uiaa_t *uiaa, callback_t *uicb);
+bool    uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig, int selcount);
+bool    uiaaApplyAll (uiaa_t *uiaa);
 void    uiaaDialogClear (uiaa_t *uiaa);
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -5,6 +5,7 @@
 #define INC_UICOPYTAGS_H
 
 #include "nlist.h"
+#include "tagwriter.h"
 #include "uiwcont.h"
 
 #if defined (__cplusplus) || defined (c_plusplus)
@@ -15,6 +16,7 @@ typedef struct uict uict_t;
 
 uict_t  *uicopytagsInit (uiwcont_t *windowp, nlist_t *opts);
 void    uicopytagsFree (uict_t *uict);
+void    uicopytagsSetTagWriter (uict_t *uict, tagwriter_t *tagwriter);
 bool    uicopytagsDialog (uict_t *uict);
 void    uicopytagsProcess (uict_t *uict);
 int     uicopytagsState (uict_t *uict);
@@ -83,6 +83,7 @@ void  uisongselUIInit (uisongsel_t *uisongsel);
 void  uisongselUIFree (uisongsel_t *uisongsel);
 uiwcont_t   * uisongselBuildUI (uisongsel_t *uisongsel, uiwcont_t *parentwin);
 void  uisongselPopulateData (uisongsel_t *uisongsel);
+void  uisongselPopulateMarks (uisongsel_t *uisongsel);
 bool  uisongselSelectCallback (void *udata);
 bool  uisongselNextSelection (void *udata);
 bool  uisongselPreviousSelection (void *udata);
@@ -33,6 +33,8 @@ vlcdata_t *       vlcInit (int vlcargc, char *vlcargv [], char *vlcopt []);
 void              vlcClose (vlcdata_t *vlcdata);
 void              vlcRelease (vlcdata_t *vlcdata);
 int               vlcSetAudioDev (vlcdata_t *vlcdata, const char *dev, int plidevtype);
+bool              vlcHaveFade (vlcdata_t *vlcdata);
+void              vlcFade (vlcdata_t *vlcdata, plifade_t fadedir, int fadeType, ssize_t fadestart, ssize_t fadelen);
 bool              vlcVersionLinkCheck (void);
 bool              vlcVersionCheck (void);
 int               vlcGetVolume (vlcdata_t *vlcdata);
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#ifndef INC_WORKPOOL_H
+#define INC_WORKPOOL_H
+
+#include <stdbool.h>
+
+#if defined (__cplusplus) || defined (c_plusplus)
+extern "C" {
+#endif
+
+/* a bounded pool of worker threads */
+/* the callback is run in a worker thread, and must not use any data */
+/* that is shared with the main thread */
+
+typedef struct workpool workpool_t;
+
+typedef void (*workpoolcb_t)(void *udata, void *job, int thridx);
+
+workpool_t *workpoolAlloc (const char *tag, int numthreads, workpoolcb_t cb, void *udata);
+void workpoolFree (workpool_t *wp);
+int  workpoolThreadCount (workpool_t *wp);
+void workpoolAdd (workpool_t *wp, void *job);
+void *workpoolProcess (workpool_t *wp, bool *cancelled);
+void workpoolCancel (workpool_t *wp);
+bool workpoolIsCancelled (workpool_t *wp);
+bool workpoolIsIdle (workpool_t *wp);
+void workpoolGetCount (workpool_t *wp, int *count, int *tot);
+
+#if defined (__cplusplus) || defined (c_plusplus)
+} /* extern C */
+#endif
+
+#endif /* INC_WORKPOOL_H */
@@ -24,6 +24,7 @@
 #include "localeutil.h"
 #include "log.h"
 #include "mdebug.h"
+#include "mp3hdr.h"
 #include "slist.h"
 #include "tagdef.h"
 
@@ -98,10 +99,20 @@ atiiParseTags (atidata_t *atidata, slist_t *tagdata, const char *ffn,
     atibdj4ParseFlacTags (atidata, tagdata, ffn, tagtype, rewrite);
   }
   if (tagtype == TAG_TYPE_ID3) {
-    /* mp3 duration is complicated, let the ffmpeg library do this */
     logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "tag-type: mp3");
     atibdj4ParseMP3Tags (atidata, tagdata, ffn, tagtype, rewrite);
   }
+  if (filetype == AFILE_TYPE_MP3) {
+    /* the mp3 headers are used if possible, as avformat must */
+    /* read and parse frames to get the duration */
+    duration = mp3hdrDuration (ffn);
+    if (duration >= 0) {
+      needduration = false;
+      snprintf (pbuff, sizeof (pbuff), "%" PRId32, duration);
+      logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "duration: mp3 headers: %s", pbuff);
+      slistSetStr (tagdata, atidata->tagName (TAG_DURATION), pbuff);
+    }
+  }
   if (filetype == AFILE_TYPE_MP4) {
     needduration = false;
     logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "tag-type: mp4");
@@ -293,6 +293,7 @@ atibdj4WriteMP3Tags (atidata_t *atidata, const char *ffn,
   slistidx_t          iteridx;
   const char          *key;
   const char          *tagname;
+  int                 rc = 0;
 
   id3file = id3_file_open (ffn, ID3_FILE_MODE_READWRITE);
   if (id3file == NULL) {
@@ -330,10 +331,11 @@ atibdj4WriteMP3Tags (atidata_t *atidata, const char *ffn,
 
   if (id3_file_update (id3file) != 0) {
     logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "  file update failed %s", ffn);
+    rc = -1;
   }
   id3_file_close (id3file);
 
-  return -1;
+  return rc;
 }
 
 atisaved_t *
@@ -544,6 +544,7 @@ cleanup_label:
 
   if (state == VC_DONE_SUCCESS) {
     atiReplaceFile (ffn, outfn);
+    rc = 0;
   } else {
     fileopDelete (outfn);
   }
@@ -28,8 +28,7 @@
 
 typedef struct asiterdata {
   const char      *dir;
-  slist_t         *filelist;
-  slistidx_t      fliter;
+  dirwalk_t       *dwalk;
 } asiterdata_t;
 
 typedef struct asdata {
@@ -356,8 +355,8 @@ asiStartIterator (asdata_t *asdata, const char *dir)
   asidata = mdmalloc (sizeof (asiterdata_t));
   asidata->dir = dir;
 
-  asidata->filelist = dirlistRecursiveDirList (dir, DIRLIST_FILES);
-  slistStartIterator (asidata->filelist, &asidata->fliter);
+  /* the files are returned as the directories are read */
+  asidata->dwalk = dirlistWalkStart (dir, DIRLIST_FILES);
 
   return asidata;
 }
@@ -369,12 +368,11 @@ asiCleanIterator (asdata_t *asdata, asiterdata_t *asidata)
     return;
   }
 
-  if (asidata->filelist != NULL) {
-    slistFree (asidata->filelist);
-  }
+  dirlistWalkFree (asidata->dwalk);
   mdfree (asidata);
 }
 
+/* the number of files returned so far */
 int32_t
 asiIterCount (asdata_t *asdata, asiterdata_t *asidata)
 {
@@ -384,7 +382,7 @@ asiIterCount (asdata_t *asdata, asiterdata_t *asidata)
     return c;
   }
 
-  c = slistGetCount (asidata->filelist);
+  c = dirlistWalkCount (asidata->dwalk);
   return c;
 }
 
@@ -397,7 +395,7 @@ asiIterate (asdata_t *asdata, asiterdata_t *asidata)
     return NULL;
   }
 
-  rval = slistIterateKey (asidata->filelist, &asidata->fliter);
+  rval = dirlistWalkNext (asidata->dwalk);
   return rval;
 }
 
@@ -63,8 +63,10 @@ static datafilekey_t bdjoptglobaldfkeys [] = {
   { "BPM",                  OPT_G_BPM,                VALUE_NUM, bdjoptConvBPM, DF_NORM },
   { "CLOCKDISP",            OPT_G_CLOCK_DISP,         VALUE_NUM, bdjoptConvClock, DF_NORM },
   { "DANCESELMETHOD",       OPT_G_DANCESEL_METHOD,    VALUE_NUM, bdjoptConvDanceselMethod, DF_NORM },
+  { "DBWATCH",              OPT_G_DB_WATCH,           VALUE_NUM, convBoolean, DF_NORM },
   { "DEBUGLVL",             OPT_G_DEBUGLVL,           VALUE_NUM, NULL, DF_NORM },
   { "LOADDANCEFROMGENRE",   OPT_G_LOADDANCEFROMGENRE, VALUE_NUM, convBoolean, DF_NORM },
+  { "LOUDNESSTARGET",       OPT_G_LOUDNESS_TARGET,    VALUE_NUM, NULL, DF_NORM },
   { "OLDORGPATH",           OPT_G_OLDORGPATH,         VALUE_STR, NULL, DF_NORM },
   { "ORGPATH",              OPT_G_ORGPATH,            VALUE_STR, NULL, DF_NORM },
   { "PLAYERQLEN",           OPT_G_PLAYERQLEN,         VALUE_NUM, NULL, DF_NORM },
@@ -446,6 +448,16 @@ bdjoptInit (void)
   if (nlistGetNum (bdjopt->bdjoptList, OPT_G_USE_WORK_MOVEMENT) < 0) {
     nlistSetNum (bdjopt->bdjoptList, OPT_G_USE_WORK_MOVEMENT, false);
   }
+
+  /* added 4.12.8, loudness-target (LUFS) */
+  if (nlistGetNum (bdjopt->bdjoptList, OPT_G_LOUDNESS_TARGET) == LIST_VALUE_INVALID) {
+    nlistSetNum (bdjopt->bdjoptList, OPT_G_LOUDNESS_TARGET, -18);
+  }
+
+  /* added 4.12.8, watch the music folder for changes */
+  if (nlistGetNum (bdjopt->bdjoptList, OPT_G_DB_WATCH) < 0) {
+    nlistSetNum (bdjopt->bdjoptList, OPT_G_DB_WATCH, false);
+  }
 }
 
 void
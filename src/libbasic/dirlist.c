@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 #include <string.h>
@@ -26,6 +27,44 @@
 #include "osutils.h"
 #include "pathinfo.h"
 #include "queue.h"
+#include "tmutil.h"
+#include "workpool.h"
+
+enum {
+  /* reading directories is mostly waiting on i/o, */
+  /* especially on network drives */
+  DIRWALK_THREADS = 4,
+  DIRWALK_JOBS_PER_THREAD = 2,
+};
+
+typedef struct {
+  char      *path;
+  int       type;
+} dirwalkentry_t;
+
+typedef struct {
+  char            *dir;
+  int             flags;
+  /* set by the worker thread */
+  dirwalkentry_t  *entries;
+  int             count;
+  int             alloc;
+} dirwalkjob_t;
+
+typedef struct dirwalk {
+  workpool_t    *wp;
+  queue_t       *dirq;
+  dirwalkjob_t  *curr;
+  int           curridx;
+  int           flags;
+  int           active;
+  int           maxactive;
+  int32_t       count;
+} dirwalk_t;
+
+static int  dirlistGetType (const char *path, int type, int flags);
+static void dirlistWalkWorker (void *udata, void *tjob, int thridx);
+static void dirlistWalkJobFree (dirwalkjob_t *job);
 
 slist_t *
 dirlistBasicDirList (const char *dirname, const char *extension)
@@ -95,6 +134,7 @@ dirlistRecursiveDirList (const char *dirname, int flags)
 {
   dirhandle_t   *dh;
   char          *fname;
+  int           type;
   slist_t       *fileList;
   queue_t       *dirQueue;
   char          temp [MAXPATHLEN];
@@ -119,7 +159,7 @@ dirlistRecursiveDirList (const char *dirname, int flags)
     dir = queuePop (dirQueue);
 
     dh = osDirOpen (dir);
-    while ((fname = osDirIterate (dh)) != NULL) {
+    while ((fname = osDirIterateType (dh, &type)) != NULL) {
       if (strcmp (fname, ".") == 0 ||
           strcmp (fname, "..") == 0) {
         mdfree (fname);
@@ -131,19 +171,19 @@ dirlistRecursiveDirList (const char *dirname, int flags)
       mdextalloc (cvtname);
       if (cvtname != NULL) {
         snprintf (temp, sizeof (temp), "%s/%s", dir, cvtname);
-        if ((flags & DIRLIST_LINKS) == DIRLIST_LINKS &&
-            osIsLink (temp)) {
+        type = dirlistGetType (temp, type, flags);
+        if (type == OSDIR_TYPE_LINK) {
           if ((flags & DIRLIST_FILES) == DIRLIST_FILES) {
             p = temp + dirnamelen + 1;
             slistSetStr (fileList, temp, p);
           }
-        } else if (fileopIsDirectory (temp)) {
+        } else if (type == OSDIR_TYPE_DIR) {
           queuePush (dirQueue, mdstrdup (temp));
           if ((flags & DIRLIST_DIRS) == DIRLIST_DIRS) {
             p = temp + dirnamelen + 1;
             slistSetStr (fileList, temp, p);
           }
-        } else if (fileopFileExists (temp)) {
+        } else if (type == OSDIR_TYPE_FILE) {
           if ((flags & DIRLIST_FILES) == DIRLIST_FILES) {
             p = temp + dirnamelen + 1;
             slistSetStr (fileList, temp, p);
@@ -164,3 +204,228 @@ dirlistRecursiveDirList (const char *dirname, int flags)
   return fileList;
 }
 
+
+/* a streaming version of dirlistRecursiveDirList() */
+/* the directories are read by worker threads, and the entries are */
+/* returned as they are found.  the entries are not sorted. */
+dirwalk_t *
+dirlistWalkStart (const char *dirname, int flags)
+{
+  dirwalk_t   *dwalk;
+
+  if (! fileopIsDirectory (dirname)) {
+    return NULL;
+  }
+
+  dwalk = mdmalloc (sizeof (dirwalk_t));
+  dwalk->wp = workpoolAlloc ("dirwalk", DIRWALK_THREADS,
+      dirlistWalkWorker, NULL);
+  dwalk->dirq = queueAlloc ("dirwalk-q", NULL);
+  dwalk->curr = NULL;
+  dwalk->curridx = 0;
+  dwalk->flags = flags;
+  dwalk->active = 0;
+  dwalk->maxactive =
+      workpoolThreadCount (dwalk->wp) * DIRWALK_JOBS_PER_THREAD;
+  dwalk->count = 0;
+
+  queuePush (dwalk->dirq, mdstrdup (dirname));
+  return dwalk;
+}
+
+void
+dirlistWalkFree (dirwalk_t *dwalk)
+{
+  dirwalkjob_t  *job;
+  char          *dir;
+  bool          cancelled;
+
+  if (dwalk == NULL) {
+    return;
+  }
+
+  workpoolCancel (dwalk->wp);
+  while (! workpoolIsIdle (dwalk->wp)) {
+    while ((job = workpoolProcess (dwalk->wp, &cancelled)) != NULL) {
+      dirlistWalkJobFree (job);
+    }
+    mssleep (1);
+  }
+  while ((job = workpoolProcess (dwalk->wp, &cancelled)) != NULL) {
+    dirlistWalkJobFree (job);
+  }
+  workpoolFree (dwalk->wp);
+  while ((dir = queuePop (dwalk->dirq)) != NULL) {
+    mdfree (dir);
+  }
+  queueFree (dwalk->dirq);
+  dirlistWalkJobFree (dwalk->curr);
+  mdfree (dwalk);
+}
+
+/* the number of entries returned so far */
+int32_t
+dirlistWalkCount (dirwalk_t *dwalk)
+{
+  if (dwalk == NULL) {
+    return 0;
+  }
+  return dwalk->count;
+}
+
+/* returns the next full path, waiting for a directory to be read */
+/* if necessary.  the path is valid until the next call. */
+const char *
+dirlistWalkNext (dirwalk_t *dwalk)
+{
+  if (dwalk == NULL) {
+    return NULL;
+  }
+
+  while (true) {
+    dirwalkjob_t  *job;
+    bool          cancelled;
+
+    if (dwalk->curr != NULL) {
+      while (dwalk->curridx < dwalk->curr->count) {
+        dirwalkentry_t  *entry;
+
+        entry = &dwalk->curr->entries [dwalk->curridx];
+        ++dwalk->curridx;
+        if (entry->type == OSDIR_TYPE_DIR) {
+          queuePush (dwalk->dirq, mdstrdup (entry->path));
+          if ((dwalk->flags & DIRLIST_DIRS) != DIRLIST_DIRS) {
+            continue;
+          }
+        } else if ((dwalk->flags & DIRLIST_FILES) != DIRLIST_FILES) {
+          continue;
+        }
+        ++dwalk->count;
+        return entry->path;
+      }
+      dirlistWalkJobFree (dwalk->curr);
+      dwalk->curr = NULL;
+    }
+
+    /* the number of directories being read is limited, */
+    /* so that the memory used is bounded */
+    while (dwalk->active < dwalk->maxactive &&
+        queueGetCount (dwalk->dirq) > 0) {
+      job = mdmalloc (sizeof (dirwalkjob_t));
+      job->dir = queuePop (dwalk->dirq);
+      job->flags = dwalk->flags;
+      job->entries = NULL;
+      job->count = 0;
+      job->alloc = 0;
+      workpoolAdd (dwalk->wp, job);
+      ++dwalk->active;
+    }
+
+    if (dwalk->active == 0) {
+      break;
+    }
+
+    job = workpoolProcess (dwalk->wp, &cancelled);
+    if (job == NULL) {
+      mssleep (1);
+      continue;
+    }
+    --dwalk->active;
+    dwalk->curr = job;
+    dwalk->curridx = 0;
+  }
+
+  return NULL;
+}
+
+/* internal routines */
+
+/* a stat() is only done if the directory entry type is not known */
+static int
+dirlistGetType (const char *path, int type, int flags)
+{
+  if (type == OSDIR_TYPE_FILE || type == OSDIR_TYPE_DIR) {
+    return type;
+  }
+  if (type == OSDIR_TYPE_LINK &&
+      (flags & DIRLIST_LINKS) == DIRLIST_LINKS) {
+    return type;
+  }
+
+  if ((flags & DIRLIST_LINKS) == DIRLIST_LINKS && osIsLink (path)) {
+    return OSDIR_TYPE_LINK;
+  }
+  if (fileopIsDirectory (path)) {
+    return OSDIR_TYPE_DIR;
+  }
+  if (fileopFileExists (path)) {
+    return OSDIR_TYPE_FILE;
+  }
+  return OSDIR_TYPE_UNKNOWN;
+}
+
+static void
+dirlistWalkWorker (void *udata, void *tjob, int thridx)
+{
+  dirwalkjob_t  *job = tjob;
+  dirhandle_t   *dh;
+  char          *fname;
+  char          *cvtname;
+  char          temp [MAXPATHLEN];
+  int           type;
+  gsize         bread, bwrite;
+
+  dh = osDirOpen (job->dir);
+  while ((fname = osDirIterateType (dh, &type)) != NULL) {
+    if (strcmp (fname, ".") == 0 ||
+        strcmp (fname, "..") == 0) {
+      mdfree (fname);
+      continue;
+    }
+
+    cvtname = g_filename_to_utf8 (fname, strlen (fname),
+        &bread, &bwrite, NULL);
+    mdextalloc (cvtname);
+    mdfree (fname);
+    if (cvtname == NULL) {
+      continue;
+    }
+
+    snprintf (temp, sizeof (temp), "%s/%s", job->dir, cvtname);
+    mdfree (cvtname);     // allocated by glib
+    type = dirlistGetType (temp, type, job->flags);
+    if (type == OSDIR_TYPE_UNKNOWN) {
+      continue;
+    }
+    /* the directories are always needed to continue the traversal */
+    if (type != OSDIR_TYPE_DIR &&
+        (job->flags & DIRLIST_FILES) != DIRLIST_FILES) {
+      continue;
+    }
+
+    if (job->count >= job->alloc) {
+      job->alloc += 50;
+      job->entries = mdrealloc (job->entries,
+          sizeof (dirwalkentry_t) * job->alloc);
+    }
+    job->entries [job->count].path = mdstrdup (temp);
+    job->entries [job->count].type = type;
+    ++job->count;
+  }
+  osDirClose (dh);
+}
+
+static void
+dirlistWalkJobFree (dirwalkjob_t *job)
+{
+  if (job == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < job->count; ++i) {
+    mdfree (job->entries [i].path);
+  }
+  dataFree (job->entries);
+  dataFree (job->dir);
+  mdfree (job);
+}
@@ -0,0 +1,532 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * watches a directory tree for changes to the files within it.
+ * on linux, inotify is used.  on other platforms, and if the watch
+ * limit is reached, dirwatchIsComplete() returns false and the caller
+ * must fall back to scanning the directory.
+ * the events are debounced; an event for a path is only returned once
+ * no further events for that path have been seen for debouncems.
+ * renames within the directory tree are paired up, and are returned
+ * as a single rename event.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#if _hdr_unistd
+# include <unistd.h>
+#endif
+
+#if _sys_inotify
+# include <sys/inotify.h>
+#endif
+
+#include "bdj4.h"
+#include "dirlist.h"
+#include "dirwatch.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "nlist.h"
+#include "slist.h"
+#include "tmutil.h"
+
+enum {
+  DW_READ_SZ = 16384,
+  /* the time to wait for the second half of a rename */
+  DW_MOVE_WAIT = 200,
+};
+
+typedef struct {
+  dirwatchevent_t event;
+  char            *oldpath;
+  mstime_t        tm;
+} dwpending_t;
+
+typedef struct {
+  char            *path;
+  bool            isdir;
+  mstime_t        tm;
+} dwmove_t;
+
+typedef struct dirwatch {
+  int             fd;
+  int             debouncems;
+  char            *topdir;
+  nlist_t         *wdlist;
+  nlist_t         *movelist;
+  slist_t         *pending;
+  mstime_t        rescantm;
+  dirwatchevent_t currevent;
+  char            *currpath;
+  char            *curroldpath;
+  bool            complete;
+  bool            rescan;
+} dirwatch_t;
+
+#if _sys_inotify && _lib_inotify_init1
+static void dirwatchEvent (dirwatch_t *dw, const struct inotify_event *ev);
+static void dirwatchAddDir (dirwatch_t *dw, const char *dir, bool scan);
+static void dirwatchAddWatch (dirwatch_t *dw, const char *dir);
+static void dirwatchRenameDir (dirwatch_t *dw, const char *olddir, const char *newdir);
+static void dirwatchRemoveDir (dirwatch_t *dw, const char *dir);
+static void dirwatchMoveFinish (dirwatch_t *dw);
+static void dirwatchSetPending (dirwatch_t *dw, const char *path, dirwatchevent_t event, const char *oldpath);
+#endif
+static void dirwatchPendingFree (void *data);
+static void dirwatchMoveFree (void *data);
+
+dirwatch_t *
+dirwatchAlloc (const char *topdir, int debouncems)
+{
+  dirwatch_t    *dw;
+
+  dw = mdmalloc (sizeof (dirwatch_t));
+  dw->fd = -1;
+  dw->debouncems = debouncems;
+  dw->topdir = mdstrdup (topdir);
+  dw->wdlist = nlistAlloc ("dirwatch-wd", LIST_ORDERED, NULL);
+  dw->movelist = nlistAlloc ("dirwatch-move", LIST_ORDERED, dirwatchMoveFree);
+  dw->pending = slistAlloc ("dirwatch-pending", LIST_ORDERED, dirwatchPendingFree);
+  mstimeset (&dw->rescantm, 0);
+  dw->currevent = DIRWATCH_NONE;
+  dw->currpath = NULL;
+  dw->curroldpath = NULL;
+  dw->complete = false;
+  dw->rescan = false;
+
+#if _sys_inotify && _lib_inotify_init1
+  dw->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+  if (dw->fd < 0) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "dirwatch: inotify-init failed %d", errno);
+    return dw;
+  }
+
+  dw->complete = true;
+  dirwatchAddDir (dw, topdir, false);
+  logMsg (LOG_DBG, LOG_INFO, "dirwatch: %s: %" PRId32 " dirs complete:%d",
+      topdir, nlistGetCount (dw->wdlist), dw->complete);
+#endif
+
+  return dw;
+}
+
+void
+dirwatchFree (dirwatch_t *dw)
+{
+  if (dw == NULL) {
+    return;
+  }
+
+#if _sys_inotify && _lib_inotify_init1
+  if (dw->fd >= 0) {
+    close (dw->fd);
+  }
+#endif
+  nlistFree (dw->wdlist);
+  nlistFree (dw->movelist);
+  slistFree (dw->pending);
+  dataFree (dw->topdir);
+  dataFree (dw->currpath);
+  dataFree (dw->curroldpath);
+  mdfree (dw);
+}
+
+/* if false, some or all of the directories are not being watched, */
+/* and the directory must be scanned periodically */
+bool
+dirwatchIsComplete (dirwatch_t *dw)
+{
+  if (dw == NULL) {
+    return false;
+  }
+  return dw->complete;
+}
+
+/* reads any events that are available, does not block */
+void
+dirwatchProcess (dirwatch_t *dw)
+{
+#if _sys_inotify && _lib_inotify_init1
+  char      buff [DW_READ_SZ]
+      __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+  ssize_t   len;
+
+  if (dw == NULL || dw->fd < 0) {
+    return;
+  }
+
+  while ((len = read (dw->fd, buff, sizeof (buff))) > 0) {
+    const struct inotify_event  *ev;
+
+    for (char *p = buff; p < buff + len;
+        p += sizeof (struct inotify_event) + ev->len) {
+      ev = (const struct inotify_event *) p;
+      dirwatchEvent (dw, ev);
+    }
+  }
+
+  dirwatchMoveFinish (dw);
+#endif
+}
+
+/* returns the next event that has been quiet for the debounce time */
+/* the returned paths are valid until the next call */
+dirwatchevent_t
+dirwatchNext (dirwatch_t *dw, const char **path, const char **oldpath)
+{
+  slistidx_t    iteridx;
+  const char    *key;
+
+  *path = NULL;
+  *oldpath = NULL;
+
+  if (dw == NULL) {
+    return DIRWATCH_NONE;
+  }
+
+  dataFree (dw->currpath);
+  dw->currpath = NULL;
+  dataFree (dw->curroldpath);
+  dw->curroldpath = NULL;
+  dw->currevent = DIRWATCH_NONE;
+
+  if (dw->rescan && mstimeCheck (&dw->rescantm)) {
+    /* everything will be scanned, any pending events are not needed */
+    dw->rescan = false;
+    slistFree (dw->pending);
+    dw->pending = slistAlloc ("dirwatch-pending", LIST_ORDERED, dirwatchPendingFree);
+    *path = dw->topdir;
+    return DIRWATCH_RESCAN;
+  }
+
+  slistStartIterator (dw->pending, &iteridx);
+  while ((key = slistIterateKey (dw->pending, &iteridx)) != NULL) {
+    dwpending_t   *pend;
+
+    pend = slistGetData (dw->pending, key);
+    if (! mstimeCheck (&pend->tm)) {
+      continue;
+    }
+
+    dw->currevent = pend->event;
+    dw->currpath = mdstrdup (key);
+    if (pend->oldpath != NULL) {
+      dw->curroldpath = mdstrdup (pend->oldpath);
+    }
+    slistDelete (dw->pending, key);
+    break;
+  }
+
+  *path = dw->currpath;
+  *oldpath = dw->curroldpath;
+  return dw->currevent;
+}
+
+/* internal routines */
+
+#if _sys_inotify && _lib_inotify_init1
+
+enum {
+  DW_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+      IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR,
+};
+
+static void
+dirwatchEvent (dirwatch_t *dw, const struct inotify_event *ev)
+{
+  const char    *dir;
+  char          path [MAXPATHLEN];
+  bool          isdir;
+
+  if ((ev->mask & IN_Q_OVERFLOW) == IN_Q_OVERFLOW) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "dirwatch: queue overflow");
+    dw->rescan = true;
+    mstimeset (&dw->rescantm, dw->debouncems);
+    return;
+  }
+
+  dir = nlistGetStr (dw->wdlist, ev->wd);
+  if (dir == NULL || ! *dir) {
+    return;
+  }
+  if ((ev->mask & IN_IGNORED) == IN_IGNORED) {
+    /* the watch was removed */
+    nlistSetStr (dw->wdlist, ev->wd, "");
+    return;
+  }
+  if (ev->len == 0) {
+    return;
+  }
+
+  snprintf (path, sizeof (path), "%s/%s", dir, ev->name);
+  isdir = (ev->mask & IN_ISDIR) == IN_ISDIR;
+
+  if ((ev->mask & IN_CLOSE_WRITE) == IN_CLOSE_WRITE) {
+    dirwatchSetPending (dw, path, DIRWATCH_CHANGED, NULL);
+  }
+  if ((ev->mask & IN_CREATE) == IN_CREATE && isdir) {
+    /* the files may have been created before the watch was added */
+    dirwatchAddDir (dw, path, true);
+  }
+  if ((ev->mask & IN_DELETE) == IN_DELETE) {
+    dirwatchSetPending (dw, path,
+        isdir ? DIRWATCH_DIR_REMOVED : DIRWATCH_REMOVED, NULL);
+  }
+  if ((ev->mask & IN_MOVED_FROM) == IN_MOVED_FROM) {
+    dwmove_t    *mv;
+
+    mv = mdmalloc (sizeof (dwmove_t));
+    mv->path = mdstrdup (path);
+    mv->isdir = isdir;
+    mstimeset (&mv->tm, DW_MOVE_WAIT);
+    nlistSetData (dw->movelist, ev->cookie, mv);
+  }
+  if ((ev->mask & IN_MOVED_TO) == IN_MOVED_TO) {
+    dwmove_t    *mv;
+
+    mv = nlistGetData (dw->movelist, ev->cookie);
+    if (mv != NULL && mv->path != NULL) {
+      if (isdir) {
+        dirwatchRenameDir (dw, mv->path, path);
+        dirwatchSetPending (dw, path, DIRWATCH_DIR_RENAMED, mv->path);
+      } else {
+        dirwatchSetPending (dw, path, DIRWATCH_RENAMED, mv->path);
+      }
+      dataFree (mv->path);
+      mv->path = NULL;
+    } else {
+      /* moved in from outside the directory tree */
+      if (isdir) {
+        dirwatchAddDir (dw, path, true);
+      } else {
+        dirwatchSetPending (dw, path, DIRWATCH_CHANGED, NULL);
+      }
+    }
+  }
+}
+
+static void
+dirwatchAddDir (dirwatch_t *dw, const char *dir, bool scan)
+{
+  slist_t     *dlist;
+  slistidx_t  iteridx;
+  const char  *key;
+  int         flags;
+
+  dirwatchAddWatch (dw, dir);
+
+  flags = DIRLIST_DIRS;
+  if (scan) {
+    flags |= DIRLIST_FILES;
+  }
+  dlist = dirlistRecursiveDirList (dir, flags);
+  slistStartIterator (dlist, &iteridx);
+  while ((key = slistIterateKey (dlist, &iteridx)) != NULL) {
+    if (scan && ! fileopIsDirectory (key)) {
+      dirwatchSetPending (dw, key, DIRWATCH_CHANGED, NULL);
+      continue;
+    }
+    dirwatchAddWatch (dw, key);
+  }
+  slistFree (dlist);
+}
+
+static void
+dirwatchAddWatch (dirwatch_t *dw, const char *dir)
+{
+  int     wd;
+
+  wd = inotify_add_watch (dw->fd, dir, DW_MASK);
+  if (wd < 0) {
+    if (dw->complete) {
+      logMsg (LOG_DBG, LOG_IMPORTANT, "dirwatch: unable to watch %s %d",
+          dir, errno);
+    }
+    /* ENOSPC: the watch limit has been reached */
+    dw->complete = false;
+    return;
+  }
+  nlistSetStr (dw->wdlist, wd, dir);
+}
+
+/* the watches stay in place, but the paths must be updated */
+static void
+dirwatchRenameDir (dirwatch_t *dw, const char *olddir, const char *newdir)
+{
+  nlistidx_t  iteridx;
+  nlistidx_t  wd;
+  size_t      len;
+
+  len = strlen (olddir);
+  nlistStartIterator (dw->wdlist, &iteridx);
+  while ((wd = nlistIterateKey (dw->wdlist, &iteridx)) >= 0) {
+    const char  *dir;
+    char        tbuff [MAXPATHLEN];
+
+    dir = nlistGetStr (dw->wdlist, wd);
+    if (strncmp (dir, olddir, len) != 0 ||
+        (dir [len] != '/' && dir [len] != '\0')) {
+      continue;
+    }
+    snprintf (tbuff, sizeof (tbuff), "%s%s", newdir, dir + len);
+    nlistSetStr (dw->wdlist, wd, tbuff);
+  }
+}
+
+/* the directory was moved out of the directory tree */
+static void
+dirwatchRemoveDir (dirwatch_t *dw, const char *dir)
+{
+  nlistidx_t  iteridx;
+  nlistidx_t  wd;
+  size_t      len;
+
+  len = strlen (dir);
+  nlistStartIterator (dw->wdlist, &iteridx);
+  while ((wd = nlistIterateKey (dw->wdlist, &iteridx)) >= 0) {
+    const char  *wdir;
+
+    wdir = nlistGetStr (dw->wdlist, wd);
+    if (strncmp (wdir, dir, len) != 0 ||
+        (wdir [len] != '/' && wdir [len] != '\0')) {
+      continue;
+    }
+    inotify_rm_watch (dw->fd, wd);
+    nlistSetStr (dw->wdlist, wd, "");
+  }
+}
+
+/* a move-from without a matching move-to is a removal */
+static void
+dirwatchMoveFinish (dirwatch_t *dw)
+{
+  nlistidx_t  iteridx;
+  dwmove_t    *mv;
+  bool        active = false;
+
+  nlistStartIterator (dw->movelist, &iteridx);
+  while ((mv = nlistIterateValueData (dw->movelist, &iteridx)) != NULL) {
+    if (mv->path == NULL) {
+      continue;
+    }
+    if (! mstimeCheck (&mv->tm)) {
+      active = true;
+      continue;
+    }
+
+    if (mv->isdir) {
+      dirwatchRemoveDir (dw, mv->path);
+      dirwatchSetPending (dw, mv->path, DIRWATCH_DIR_REMOVED, NULL);
+    } else {
+      dirwatchSetPending (dw, mv->path, DIRWATCH_REMOVED, NULL);
+    }
+    dataFree (mv->path);
+    mv->path = NULL;
+  }
+
+  if (! active && nlistGetCount (dw->movelist) > 0) {
+    nlistFree (dw->movelist);
+    dw->movelist = nlistAlloc ("dirwatch-move", LIST_ORDERED, dirwatchMoveFree);
+  }
+}
+
+static void
+dirwatchSetPending (dirwatch_t *dw, const char *path,
+    dirwatchevent_t event, const char *oldpath)
+{
+  dwpending_t   *pend;
+  char          *chainpath = NULL;
+
+  if (event == DIRWATCH_RENAMED || event == DIRWATCH_DIR_RENAMED) {
+    /* a rename of a file that is still pending */
+    pend = slistGetData (dw->pending, oldpath);
+    if (pend != NULL) {
+      char    *tkey;
+
+      tkey = mdstrdup (oldpath);
+      if (pend->event == DIRWATCH_RENAMED ||
+          pend->event == DIRWATCH_DIR_RENAMED) {
+        chainpath = mdstrdup (pend->oldpath);
+        oldpath = chainpath;
+      } else if (pend->event == DIRWATCH_CHANGED) {
+        /* a new file that was renamed is still a new file */
+        event = DIRWATCH_CHANGED;
+        oldpath = NULL;
+      }
+      slistDelete (dw->pending, tkey);
+      mdfree (tkey);
+    }
+  }
+
+  pend = slistGetData (dw->pending, path);
+  if (pend != NULL && event == DIRWATCH_REMOVED &&
+      pend->event == DIRWATCH_RENAMED) {
+    /* renamed and then removed, the original file is gone */
+    char    *tpath;
+
+    tpath = mdstrdup (pend->oldpath);
+    slistDelete (dw->pending, path);
+    dirwatchSetPending (dw, tpath, DIRWATCH_REMOVED, NULL);
+    mdfree (tpath);
+    dataFree (chainpath);
+    return;
+  }
+
+  if (pend != NULL && event == DIRWATCH_CHANGED &&
+      (pend->event == DIRWATCH_RENAMED ||
+      pend->event == DIRWATCH_DIR_RENAMED)) {
+    /* the receiver checks the renamed file for changes */
+    mstimeset (&pend->tm, dw->debouncems);
+    dataFree (chainpath);
+    return;
+  }
+
+  if (pend == NULL) {
+    pend = mdmalloc (sizeof (dwpending_t));
+    pend->oldpath = NULL;
+    slistSetData (dw->pending, path, pend);
+  }
+  pend->event = event;
+  dataFree (pend->oldpath);
+  pend->oldpath = NULL;
+  if (oldpath != NULL) {
+    pend->oldpath = mdstrdup (oldpath);
+  }
+  mstimeset (&pend->tm, dw->debouncems);
+  dataFree (chainpath);
+}
+
+#endif /* _sys_inotify && _lib_inotify_init1 */
+
+static void
+dirwatchPendingFree (void *data)
+{
+  dwpending_t   *pend = data;
+
+  if (pend == NULL) {
+    return;
+  }
+  dataFree (pend->oldpath);
+  mdfree (pend);
+}
+
+static void
+dirwatchMoveFree (void *data)
+{
+  dwmove_t    *mv = data;
+
+  if (mv == NULL) {
+    return;
+  }
+  dataFree (mv->path);
+  mdfree (mv);
+}
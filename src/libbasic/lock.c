@@ -31,6 +31,7 @@ static char *locknames [ROUTE_MAX] = {
   [ROUTE_BPM_COUNTER] = "bpmcounter",
   [ROUTE_CONFIGUI] = "configui",
   [ROUTE_DBUPDATE] = "dbupdate",
+  [ROUTE_DBWATCH] = "dbwatch",
   [ROUTE_HELPERUI] = "helperui",
   [ROUTE_MAIN] = "main",
   [ROUTE_MANAGEUI] = "manageui",
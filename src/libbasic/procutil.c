@@ -283,6 +283,9 @@ procutilStopProcess (procutil_t *process, conn_t *conn,
       return;
     }
     connSendMessage (conn, route, MSG_EXIT_REQUEST, NULL);
+    /* the caller may wait for the process to exit, or stop it, */
+    /* before the main loop sends the held messages */
+    connFlush (conn);
     process->started = false;
   }
   if (force == PROCUTIL_FORCE_TERM) {
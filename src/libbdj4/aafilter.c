@@ -0,0 +1,793 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * in-process audio adjustments using libavfilter.
+ * the input is decoded, passed through a filter graph and encoded
+ * in a single pass.  the same filter descriptions as ffmpeg's -af
+ * option are used.
+ * an aafilter_t may be re-used for many songs, but may only be used
+ * by one thread at a time.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if _hdr_libavfilter_avfilter
+# include <libavcodec/avcodec.h>
+# include <libavfilter/avfilter.h>
+# include <libavfilter/buffersink.h>
+# include <libavfilter/buffersrc.h>
+# include <libavformat/avformat.h>
+# include <libavutil/channel_layout.h>
+# include <libavutil/error.h>
+# include <libavutil/opt.h>
+#endif
+
+#include "aafilter.h"
+#include "bdjstring.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+
+#if _hdr_libavfilter_avfilter
+
+enum {
+  AAF_FILTER_SZ = 1024,
+};
+
+typedef struct aafilter {
+  AVPacket          *pkt;
+  AVPacket          *encpkt;
+  AVFrame           *frame;
+  AVFrame           *filtframe;
+  AVFormatContext   *ictx;
+  AVCodecContext    *dec;
+  AVFormatContext   *octx;
+  AVCodecContext    *enc;
+  AVStream          *ost;
+  AVFilterGraph     *graph;
+  AVFilterContext   *srcctx;
+  AVFilterContext   *sinkctx;
+  int               sidx;
+  int64_t           nextpts;
+  int64_t           startms;
+  int64_t           totalms;
+  int64_t           curms;
+  int64_t           durationms;
+  /* sample output */
+  aafiltersamplecb_t samplecb;
+  void              *sampleudata;
+  /* set by another thread */
+  volatile bool     cancelled;
+} aafilter_t;
+
+static int  aafilterOpenInput (aafilter_t *aaf, const char *infn);
+static int  aafilterOpenOutput (aafilter_t *aaf, const char *outfn);
+static int  aafilterOpenGraph (aafilter_t *aaf, int32_t startms, int32_t durms, const char *filters);
+static int  aafilterRun (aafilter_t *aaf);
+static int  aafilterDecode (aafilter_t *aaf, AVPacket *pkt);
+static int  aafilterDrain (aafilter_t *aaf);
+static int  aafilterEncode (aafilter_t *aaf, AVFrame *frame);
+static void aafilterClose (aafilter_t *aaf);
+static void aafilterLogError (const char *tag, const char *fn, int rc);
+
+bool
+aafilterAvailable (void)
+{
+  return true;
+}
+
+aafilter_t *
+aafilterAlloc (void)
+{
+  aafilter_t  *aaf;
+
+  aaf = mdmalloc (sizeof (aafilter_t));
+  aaf->pkt = av_packet_alloc ();
+  aaf->encpkt = av_packet_alloc ();
+  aaf->frame = av_frame_alloc ();
+  aaf->filtframe = av_frame_alloc ();
+  aaf->ictx = NULL;
+  aaf->dec = NULL;
+  aaf->octx = NULL;
+  aaf->enc = NULL;
+  aaf->ost = NULL;
+  aaf->graph = NULL;
+  aaf->srcctx = NULL;
+  aaf->sinkctx = NULL;
+  aaf->sidx = -1;
+  aaf->nextpts = 0;
+  aaf->startms = 0;
+  aaf->totalms = 0;
+  aaf->curms = 0;
+  aaf->durationms = 0;
+  aaf->samplecb = NULL;
+  aaf->sampleudata = NULL;
+  aaf->cancelled = false;
+  return aaf;
+}
+
+void
+aafilterFree (aafilter_t *aaf)
+{
+  if (aaf == NULL) {
+    return;
+  }
+
+  aafilterClose (aaf);
+  av_packet_free (&aaf->pkt);
+  av_packet_free (&aaf->encpkt);
+  av_frame_free (&aaf->frame);
+  av_frame_free (&aaf->filtframe);
+  mdfree (aaf);
+}
+
+/* startms : seek position, as with ffmpeg's -ss option */
+/* durms : the duration to process, as with ffmpeg's -t option, */
+/*   0 processes to the end of the input */
+/* filters : a filter description, as with ffmpeg's -af option */
+/* outfn : if null, nothing is written, the input is only analyzed */
+int
+aafilterProcess (aafilter_t *aaf, const char *infn, const char *outfn,
+    int32_t startms, int32_t durms, const char *filters)
+{
+  int     rc;
+
+  if (aaf == NULL || infn == NULL) {
+    return -1;
+  }
+
+  aaf->nextpts = 0;
+  aaf->startms = startms;
+  aaf->curms = 0;
+
+  rc = aafilterOpenInput (aaf, infn);
+  if (rc == 0 && outfn != NULL) {
+    rc = aafilterOpenOutput (aaf, outfn);
+  }
+  if (rc == 0) {
+    rc = aafilterOpenGraph (aaf, startms, durms, filters);
+  }
+  if (rc == 0) {
+    rc = aafilterRun (aaf);
+  }
+  if (rc == 0 && aaf->octx != NULL) {
+    rc = av_write_trailer (aaf->octx);
+    if (rc < 0) {
+      aafilterLogError ("write-trailer", outfn, rc);
+    }
+  }
+
+  aafilterClose (aaf);
+
+  if (rc < 0) {
+    if (outfn != NULL) {
+      /* the caller checks for the existence of the output file */
+      fileopDelete (outfn);
+    }
+    if (rc == AVERROR_EXIT) {
+      return AAFILTER_CANCELLED;
+    }
+    return -1;
+  }
+
+  aaf->curms = aaf->totalms;
+  return 0;
+}
+
+/* the audio is decoded, mixed to mono or stereo and re-sampled to rate, */
+/* and passed to the callback as interleaved float samples */
+int
+aafilterSamples (aafilter_t *aaf, const char *infn, int32_t startms,
+    int32_t durms, int rate, int channels, aafiltersamplecb_t cb, void *udata)
+{
+  char    filters [200];
+  int     rc;
+
+  if (aaf == NULL) {
+    return -1;
+  }
+
+  snprintf (filters, sizeof (filters),
+      "aformat=sample_fmts=flt:channel_layouts=%s:sample_rates=%d",
+      channels == 2 ? "stereo" : "mono", rate);
+  aaf->samplecb = cb;
+  aaf->sampleudata = udata;
+  rc = aafilterProcess (aaf, infn, NULL, startms, durms, filters);
+  aaf->samplecb = NULL;
+  aaf->sampleudata = NULL;
+  return rc;
+}
+
+/* returns a percentage */
+/* may be called from another thread, the value is approximate */
+int
+aafilterGetProgress (aafilter_t *aaf)
+{
+  int64_t   pct;
+
+  if (aaf == NULL || aaf->totalms <= 0) {
+    return 0;
+  }
+
+  pct = aaf->curms * 100 / aaf->totalms;
+  if (pct < 0) {
+    pct = 0;
+  }
+  if (pct > 100) {
+    pct = 100;
+  }
+  return (int) pct;
+}
+
+/* the duration of the last input file, as reported by the container */
+int32_t
+aafilterGetDuration (aafilter_t *aaf)
+{
+  if (aaf == NULL) {
+    return 0;
+  }
+  return (int32_t) aaf->durationms;
+}
+
+/* may be called from another thread */
+/* the current process is stopped, and any further processing fails */
+void
+aafilterCancel (aafilter_t *aaf)
+{
+  if (aaf == NULL) {
+    return;
+  }
+  aaf->cancelled = true;
+}
+
+bool
+aafilterHaveFilter (const char *name)
+{
+  return avfilter_get_by_name (name) != NULL;
+}
+
+/* internal routines */
+
+static int
+aafilterOpenInput (aafilter_t *aaf, const char *infn)
+{
+  const AVCodec *codec = NULL;
+  AVStream      *st;
+  int           rc;
+
+  rc = avformat_open_input (&aaf->ictx, infn, NULL, NULL);
+  if (rc < 0) {
+    aafilterLogError ("open-input", infn, rc);
+    return rc;
+  }
+  rc = avformat_find_stream_info (aaf->ictx, NULL);
+  if (rc < 0) {
+    aafilterLogError ("stream-info", infn, rc);
+    return rc;
+  }
+
+  rc = av_find_best_stream (aaf->ictx, AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+  if (rc < 0) {
+    aafilterLogError ("find-stream", infn, rc);
+    return rc;
+  }
+  aaf->sidx = rc;
+  st = aaf->ictx->streams [aaf->sidx];
+
+  aaf->dec = avcodec_alloc_context3 (codec);
+  if (aaf->dec == NULL) {
+    return AVERROR (ENOMEM);
+  }
+  rc = avcodec_parameters_to_context (aaf->dec, st->codecpar);
+  if (rc < 0) {
+    return rc;
+  }
+  aaf->dec->pkt_timebase = st->time_base;
+  rc = avcodec_open2 (aaf->dec, codec, NULL);
+  if (rc < 0) {
+    aafilterLogError ("open-decoder", infn, rc);
+    return rc;
+  }
+
+  aaf->totalms = 0;
+  if (aaf->ictx->duration != AV_NOPTS_VALUE) {
+    aaf->totalms = aaf->ictx->duration / 1000;
+  }
+  aaf->durationms = aaf->totalms;
+  return 0;
+}
+
+/* the output format and codec are determined by the output */
+/* file name, as ffmpeg does */
+static int
+aafilterOpenOutput (aafilter_t *aaf, const char *outfn)
+{
+  const AVCodec             *codec;
+  enum AVCodecID            codecid;
+  const enum AVSampleFormat *fmts = NULL;
+  const int                 *rates = NULL;
+  int                       rc;
+
+  rc = avformat_alloc_output_context2 (&aaf->octx, NULL, NULL, outfn);
+  if (rc < 0 || aaf->octx == NULL) {
+    aafilterLogError ("output-format", outfn, rc);
+    return rc < 0 ? rc : AVERROR_MUXER_NOT_FOUND;
+  }
+
+  codecid = av_guess_codec (aaf->octx->oformat, NULL, outfn, NULL,
+      AVMEDIA_TYPE_AUDIO);
+  codec = avcodec_find_encoder (codecid);
+  if (codec == NULL) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "aafilter: no encoder: %s", outfn);
+    return AVERROR_ENCODER_NOT_FOUND;
+  }
+
+  aaf->enc = avcodec_alloc_context3 (codec);
+  if (aaf->enc == NULL) {
+    return AVERROR (ENOMEM);
+  }
+
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(61,13,100)
+  avcodec_get_supported_config (aaf->enc, codec,
+      AV_CODEC_CONFIG_SAMPLE_FORMAT, 0, (const void **) &fmts, NULL);
+  avcodec_get_supported_config (aaf->enc, codec,
+      AV_CODEC_CONFIG_SAMPLE_RATE, 0, (const void **) &rates, NULL);
+#else
+  fmts = codec->sample_fmts;
+  rates = codec->supported_samplerates;
+#endif
+
+  aaf->enc->sample_fmt = aaf->dec->sample_fmt;
+  if (fmts != NULL) {
+    aaf->enc->sample_fmt = fmts [0];
+    for (int i = 0; fmts [i] != AV_SAMPLE_FMT_NONE; ++i) {
+      if (fmts [i] == aaf->dec->sample_fmt) {
+        aaf->enc->sample_fmt = fmts [i];
+        break;
+      }
+    }
+  }
+  aaf->enc->sample_rate = aaf->dec->sample_rate;
+  if (rates != NULL) {
+    aaf->enc->sample_rate = rates [0];
+    for (int i = 0; rates [i] != 0; ++i) {
+      if (rates [i] == aaf->dec->sample_rate) {
+        aaf->enc->sample_rate = rates [i];
+        break;
+      }
+    }
+  }
+  if (aaf->dec->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+    av_channel_layout_default (&aaf->enc->ch_layout,
+        aaf->dec->ch_layout.nb_channels);
+  } else {
+    av_channel_layout_copy (&aaf->enc->ch_layout, &aaf->dec->ch_layout);
+  }
+  aaf->enc->time_base = (AVRational) { 1, aaf->enc->sample_rate };
+  /* -q:a 0 */
+  aaf->enc->flags |= AV_CODEC_FLAG_QSCALE;
+  aaf->enc->global_quality = 0;
+  if ((aaf->octx->oformat->flags & AVFMT_GLOBALHEADER) == AVFMT_GLOBALHEADER) {
+    aaf->enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  }
+
+  rc = avcodec_open2 (aaf->enc, codec, NULL);
+  if (rc < 0) {
+    aafilterLogError ("open-encoder", outfn, rc);
+    return rc;
+  }
+
+  aaf->ost = avformat_new_stream (aaf->octx, NULL);
+  if (aaf->ost == NULL) {
+    return AVERROR (ENOMEM);
+  }
+  rc = avcodec_parameters_from_context (aaf->ost->codecpar, aaf->enc);
+  if (rc < 0) {
+    return rc;
+  }
+  aaf->ost->time_base = aaf->enc->time_base;
+
+  /* the tags are restored by the caller, but copy them as ffmpeg does */
+  av_dict_copy (&aaf->octx->metadata, aaf->ictx->metadata, 0);
+
+  if ((aaf->octx->oformat->flags & AVFMT_NOFILE) != AVFMT_NOFILE) {
+    rc = avio_open (&aaf->octx->pb, outfn, AVIO_FLAG_WRITE);
+    if (rc < 0) {
+      aafilterLogError ("open-output", outfn, rc);
+      return rc;
+    }
+  }
+
+  rc = avformat_write_header (aaf->octx, NULL);
+  if (rc < 0) {
+    aafilterLogError ("write-header", outfn, rc);
+    return rc;
+  }
+  return 0;
+}
+
+static int
+aafilterOpenGraph (aafilter_t *aaf, int32_t startms, int32_t durms,
+    const char *filters)
+{
+  const AVFilter  *abuffer;
+  const AVFilter  *abuffersink;
+  AVFilterInOut   *outputs = NULL;
+  AVFilterInOut   *inputs = NULL;
+  AVStream        *st;
+  char            args [512];
+  char            layout [100];
+  char            desc [AAF_FILTER_SZ];
+  char            tmp [300];
+  char            *dp = desc;
+  char            *dend = desc + sizeof (desc);
+  const char      *pfx = "";
+  double          startts;
+  int             rc;
+
+  st = aaf->ictx->streams [aaf->sidx];
+
+  aaf->graph = avfilter_graph_alloc ();
+  abuffer = avfilter_get_by_name ("abuffer");
+  abuffersink = avfilter_get_by_name ("abuffersink");
+  if (aaf->graph == NULL || abuffer == NULL || abuffersink == NULL) {
+    return AVERROR (ENOMEM);
+  }
+  /* the caller may run several of these concurrently */
+  aaf->graph->nb_threads = 1;
+
+  av_channel_layout_describe (&aaf->dec->ch_layout, layout, sizeof (layout));
+  snprintf (args, sizeof (args),
+      "time_base=%d/%d:sample_rate=%d:sample_fmt=%s:channel_layout=%s",
+      st->time_base.num, st->time_base.den, aaf->dec->sample_rate,
+      av_get_sample_fmt_name (aaf->dec->sample_fmt), layout);
+  rc = avfilter_graph_create_filter (&aaf->srcctx, abuffer, "in",
+      args, NULL, aaf->graph);
+  if (rc < 0) {
+    return rc;
+  }
+  rc = avfilter_graph_create_filter (&aaf->sinkctx, abuffersink, "out",
+      NULL, NULL, aaf->graph);
+  if (rc < 0) {
+    return rc;
+  }
+
+  *desc = '\0';
+  if (startms > 0 || durms > 0) {
+    /* the trim is relative to the start of the stream, as ffmpeg's -ss */
+    startts = (double) startms / 1000.0;
+    if (aaf->ictx->start_time != AV_NOPTS_VALUE) {
+      startts += (double) aaf->ictx->start_time / (double) AV_TIME_BASE;
+    }
+    if (durms > 0) {
+      snprintf (tmp, sizeof (tmp), "atrim=start=%.6f:duration=%.6f",
+          startts, (double) durms / 1000.0);
+    } else {
+      snprintf (tmp, sizeof (tmp), "atrim=start=%.6f", startts);
+    }
+    dp = stpecpy (dp, dend, tmp);
+    dp = stpecpy (dp, dend, ", asetpts=PTS-STARTPTS");
+    pfx = ", ";
+  }
+  if (filters != NULL && *filters) {
+    dp = stpecpy (dp, dend, pfx);
+    dp = stpecpy (dp, dend, filters);
+    pfx = ", ";
+  }
+  if (aaf->enc != NULL) {
+    av_channel_layout_describe (&aaf->enc->ch_layout, layout, sizeof (layout));
+    snprintf (tmp, sizeof (tmp),
+        "%saformat=sample_fmts=%s:sample_rates=%d:channel_layouts=%s",
+        pfx, av_get_sample_fmt_name (aaf->enc->sample_fmt),
+        aaf->enc->sample_rate, layout);
+    dp = stpecpy (dp, dend, tmp);
+  }
+  if (*desc == '\0') {
+    stpecpy (desc, dend, "anull");
+  }
+
+  outputs = avfilter_inout_alloc ();
+  inputs = avfilter_inout_alloc ();
+  if (outputs == NULL || inputs == NULL) {
+    avfilter_inout_free (&outputs);
+    avfilter_inout_free (&inputs);
+    return AVERROR (ENOMEM);
+  }
+  outputs->name = av_strdup ("in");
+  outputs->filter_ctx = aaf->srcctx;
+  outputs->pad_idx = 0;
+  outputs->next = NULL;
+  inputs->name = av_strdup ("out");
+  inputs->filter_ctx = aaf->sinkctx;
+  inputs->pad_idx = 0;
+  inputs->next = NULL;
+
+  logMsg (LOG_DBG, LOG_AUDIO_ADJUST, "aafilter: graph: %s", desc);
+  rc = avfilter_graph_parse_ptr (aaf->graph, desc, &inputs, &outputs, NULL);
+  avfilter_inout_free (&outputs);
+  avfilter_inout_free (&inputs);
+  if (rc < 0) {
+    aafilterLogError ("graph-parse", desc, rc);
+    return rc;
+  }
+  rc = avfilter_graph_config (aaf->graph, NULL);
+  if (rc < 0) {
+    aafilterLogError ("graph-config", desc, rc);
+    return rc;
+  }
+
+  if (aaf->enc != NULL &&
+      (aaf->enc->codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE) == 0 &&
+      aaf->enc->frame_size > 0) {
+    av_buffersink_set_frame_size (aaf->sinkctx, aaf->enc->frame_size);
+  }
+
+  if (durms > 0) {
+    aaf->totalms = durms;
+  } else if (aaf->totalms > startms) {
+    aaf->totalms -= startms;
+  }
+
+  if (startms > 0) {
+    int64_t   seekts;
+
+    /* seek before the start, the trim filter is accurate */
+    seekts = (int64_t) startms * 1000;
+    if (aaf->ictx->start_time != AV_NOPTS_VALUE) {
+      seekts += aaf->ictx->start_time;
+    }
+    if (av_seek_frame (aaf->ictx, -1, seekts, AVSEEK_FLAG_BACKWARD) >= 0) {
+      avcodec_flush_buffers (aaf->dec);
+    }
+  }
+
+  return 0;
+}
+
+static int
+aafilterRun (aafilter_t *aaf)
+{
+  int     rc = 0;
+
+  while (rc >= 0) {
+    if (aaf->cancelled) {
+      rc = AVERROR_EXIT;
+      break;
+    }
+    rc = av_read_frame (aaf->ictx, aaf->pkt);
+    if (rc < 0) {
+      break;
+    }
+    if (aaf->pkt->stream_index == aaf->sidx) {
+      rc = aafilterDecode (aaf, aaf->pkt);
+    }
+    av_packet_unref (aaf->pkt);
+  }
+
+  if (rc == AVERROR_EOF || rc == 0) {
+    /* end of input, or the trim has finished */
+    aafilterDecode (aaf, NULL);
+    av_buffersrc_add_frame_flags (aaf->srcctx, NULL, 0);
+    rc = aafilterDrain (aaf);
+    if (rc == AVERROR_EOF || rc == AVERROR (EAGAIN)) {
+      rc = 0;
+    }
+    if (rc == 0 && aaf->enc != NULL) {
+      rc = aafilterEncode (aaf, NULL);
+    }
+  } else if (rc < 0 && rc != AVERROR_EXIT) {
+    aafilterLogError ("process", "", rc);
+  }
+
+  return rc;
+}
+
+/* a null packet flushes the decoder */
+/* returns AVERROR_EOF when the filter graph is finished */
+static int
+aafilterDecode (aafilter_t *aaf, AVPacket *pkt)
+{
+  int     rc;
+
+  rc = avcodec_send_packet (aaf->dec, pkt);
+  if (rc < 0 && rc != AVERROR_EOF) {
+    /* a damaged packet is skipped, as ffmpeg does */
+    return 0;
+  }
+
+  while (true) {
+    AVStream  *st;
+
+    rc = avcodec_receive_frame (aaf->dec, aaf->frame);
+    if (rc == AVERROR (EAGAIN) || rc == AVERROR_EOF) {
+      rc = 0;
+      break;
+    }
+    if (rc < 0) {
+      break;
+    }
+
+    st = aaf->ictx->streams [aaf->sidx];
+    aaf->frame->pts = aaf->frame->best_effort_timestamp;
+    if (aaf->frame->pts != AV_NOPTS_VALUE) {
+      aaf->curms = av_rescale_q (aaf->frame->pts, st->time_base,
+          (AVRational) { 1, 1000 }) - aaf->startms;
+    }
+
+    rc = av_buffersrc_add_frame_flags (aaf->srcctx, aaf->frame, 0);
+    av_frame_unref (aaf->frame);
+    if (rc < 0) {
+      break;
+    }
+    rc = aafilterDrain (aaf);
+    if (rc == AVERROR (EAGAIN)) {
+      rc = 0;
+    }
+    if (rc < 0) {
+      break;
+    }
+  }
+
+  return rc;
+}
+
+static int
+aafilterDrain (aafilter_t *aaf)
+{
+  int     rc;
+
+  while (true) {
+    rc = av_buffersink_get_frame (aaf->sinkctx, aaf->filtframe);
+    if (rc < 0) {
+      break;
+    }
+
+    if (aaf->samplecb != NULL) {
+      aaf->samplecb (aaf->sampleudata,
+          (const float *) aaf->filtframe->data [0],
+          aaf->filtframe->nb_samples);
+    }
+    if (aaf->enc != NULL) {
+      aaf->filtframe->pts = aaf->nextpts;
+      aaf->nextpts += aaf->filtframe->nb_samples;
+      rc = aafilterEncode (aaf, aaf->filtframe);
+    }
+    av_frame_unref (aaf->filtframe);
+    if (rc < 0) {
+      break;
+    }
+  }
+
+  return rc;
+}
+
+/* a null frame flushes the encoder */
+static int
+aafilterEncode (aafilter_t *aaf, AVFrame *frame)
+{
+  int     rc;
+
+  rc = avcodec_send_frame (aaf->enc, frame);
+  if (rc < 0) {
+    return rc;
+  }
+
+  while (true) {
+    rc = avcodec_receive_packet (aaf->enc, aaf->encpkt);
+    if (rc == AVERROR (EAGAIN) || rc == AVERROR_EOF) {
+      rc = 0;
+      break;
+    }
+    if (rc < 0) {
+      break;
+    }
+    av_packet_rescale_ts (aaf->encpkt, aaf->enc->time_base, aaf->ost->time_base);
+    aaf->encpkt->stream_index = aaf->ost->index;
+    rc = av_interleaved_write_frame (aaf->octx, aaf->encpkt);
+    if (rc < 0) {
+      break;
+    }
+  }
+
+  return rc;
+}
+
+static void
+aafilterClose (aafilter_t *aaf)
+{
+  avfilter_graph_free (&aaf->graph);
+  aaf->srcctx = NULL;
+  aaf->sinkctx = NULL;
+  avcodec_free_context (&aaf->enc);
+  if (aaf->octx != NULL) {
+    if ((aaf->octx->oformat->flags & AVFMT_NOFILE) != AVFMT_NOFILE) {
+      avio_closep (&aaf->octx->pb);
+    }
+    avformat_free_context (aaf->octx);
+    aaf->octx = NULL;
+  }
+  aaf->ost = NULL;
+  avcodec_free_context (&aaf->dec);
+  avformat_close_input (&aaf->ictx);
+  aaf->sidx = -1;
+}
+
+static void
+aafilterLogError (const char *tag, const char *fn, int rc)
+{
+  char    tbuff [200];
+
+  av_strerror (rc, tbuff, sizeof (tbuff));
+  logMsg (LOG_DBG, LOG_IMPORTANT, "aafilter: %s: %s: %s", tag, tbuff, fn);
+}
+
+#else /* _hdr_libavfilter_avfilter */
+
+typedef struct aafilter {
+  int     unused;
+} aafilter_t;
+
+bool
+aafilterAvailable (void)
+{
+  return false;
+}
+
+aafilter_t *
+aafilterAlloc (void)
+{
+  return NULL;
+}
+
+void
+aafilterFree (aafilter_t *aaf)
+{
+  return;
+}
+
+int
+aafilterProcess (aafilter_t *aaf, const char *infn, const char *outfn,
+    int32_t startms, int32_t durms, const char *filters)
+{
+  return -1;
+}
+
+int
+aafilterSamples (aafilter_t *aaf, const char *infn, int32_t startms,
+    int32_t durms, int rate, int channels, aafiltersamplecb_t cb, void *udata)
+{
+  return -1;
+}
+
+int
+aafilterGetProgress (aafilter_t *aaf)
+{
+  return 0;
+}
+
+int32_t
+aafilterGetDuration (aafilter_t *aaf)
+{
+  return 0;
+}
+
+void
+aafilterCancel (aafilter_t *aaf)
+{
+  return;
+}
+
+bool
+aafilterHaveFilter (const char *name)
+{
+  return false;
+}
+
+#endif /* _hdr_libavfilter_avfilter */
@@ -10,6 +10,7 @@
 #include <string.h>
 #include <inttypes.h>
 
+#include "aafilter.h"
 #include "audioadjust.h"
 #include "audiofile.h"
 #include "audiosrc.h"
@@ -19,6 +20,7 @@
 #include "bdjstring.h"
 #include "bdjvars.h"
 #include "bdjvarsdf.h"
+#include "callback.h"
 #include "datafile.h"
 #include "fileop.h"
 #include "filemanip.h"
@@ -29,12 +31,15 @@
 #include "osprocess.h"
 #include "pathbld.h"
 #include "pathinfo.h"
+#include "silencedet.h"
 #include "song.h"
 #include "songdb.h"
 #include "songutil.h"
 #include "sysvars.h"
 #include "tagdef.h"
+#include "tagwriter.h"
 #include "tmutil.h"
+#include "workpool.h"
 
 enum {
   AA_NONE,
@@ -47,11 +52,47 @@ enum {
   AA_RESP_BUFF_SZ = 300000,
 };
 
+enum {
+  /* the number of songs prepared per worker thread */
+  AA_QUEUE_PER_THREAD = 2,
+};
+
 typedef struct aa {
   datafile_t      *df;
   nlist_t         *values;
+  aafilter_t      *aaf;
 } aa_t;
 
+/* a song being adjusted */
+typedef struct {
+  dbidx_t         dbidx;
+  char            songfn [MAXPATHLEN];
+  char            fullfn [MAXPATHLEN];
+  char            origfn [MAXPATHLEN];
+  char            outfn [MAXPATHLEN];
+  void            *savedtags;
+  aaparam_t       aap;
+  int             rc;
+} aajob_t;
+
+typedef struct aabatch {
+  musicdb_t       *musicdb;
+  nlist_t         *dbidxlist;
+  nlistidx_t      iteridx;
+  int             aaflags;
+  callback_t      *songcb;
+  tagwriter_t     *tagwriter;
+  workpool_t      *wp;
+  aafilter_t      **aaf;
+  /* set by the worker threads */
+  volatile bool   *active;
+  int             numthreads;
+  int             queued;
+  int             count;
+  int             tot;
+  bool            more;
+} aabatch_t;
+
 enum {
   AA_TRIMSILENCE_NOISE,
   AA_TRIMSILENCE_DURATION,
@@ -69,9 +110,13 @@ static const char * const SILENCE_DUR_STR = { "silence_duration:" };
 #define SILENCE_DUR_LEN (strlen (SILENCE_DUR_STR))
 
 
-static void aaApplySpeed (song_t *song, const char *infn, const char *outfn, int speed, int gap);
+static int  aaAdjustFilter (aafilter_t *aaf, const char *infn, const char *outfn, int32_t songstart, int32_t calcdur, int32_t songdur, int fadein, int fadeout, const char *ftstr, int speed, int gap);
+static void aaApplySpeed (const char *infn, const char *outfn, int speed, int gap);
+static aajob_t *aaApplyPrepare (musicdb_t *musicdb, tagwriter_t *tagwriter, dbidx_t dbidx, int aaflags, bool *changed);
+static bool aaApplyFinish (musicdb_t *musicdb, tagwriter_t *tagwriter, aajob_t *job);
+static void aaApplyDiscard (aajob_t *job);
+static void aaBatchWorker (void *udata, void *tjob, int thridx);
 static void aaRestoreTags (musicdb_t *musicdb, song_t *song, dbidx_t dbidx, const char *infn, const char *songfn);
-static void aaSetDuration (musicdb_t *musicdb, song_t *song, const char *ffn);
 static int  aaProcess (const char *tag, const char *targv [], int targc, char *resp);
 
 aa_t *
@@ -91,6 +136,8 @@ aaAlloc (void)
   aa->df = datafileAllocParse ("audioadjust", DFTYPE_KEY_VAL, fname,
       aadfkeys, AA_KEY_MAX, DF_NO_OFFSET, NULL);
   aa->values = datafileGetList (aa->df);
+  /* null if libavfilter is not available */
+  aa->aaf = aafilterAlloc ();
 
   return aa;
 }
@@ -100,6 +147,7 @@ aaFree (aa_t *aa)
 {
   if (aa != NULL) {
     datafileFree (aa->df);
+    aafilterFree (aa->aaf);
     mdfree (aa);
   }
 }
@@ -107,134 +155,262 @@ aaFree (aa_t *aa)
 bool
 aaApplyAdjustments (musicdb_t *musicdb, dbidx_t dbidx, int aaflags)
 {
-  song_t      *song;
-  pathinfo_t  *pi;
-  char        songfn [MAXPATHLEN];
-  char        *infn;
-  char        origfn [MAXPATHLEN];
-  char        fullfn [MAXPATHLEN];
-  char        outfn [MAXPATHLEN];
+  aa_t        *aa;
+  aafilter_t  *aaf = NULL;
+  aajob_t     *job;
   bool        changed = false;
-  void        *savedtags = NULL;
 
-  song = dbGetByIdx (musicdb, dbidx);
-  if (song == NULL) {
+  job = aaApplyPrepare (musicdb, NULL, dbidx, aaflags, &changed);
+  if (job == NULL) {
     return changed;
   }
 
-  stpecpy (songfn, songfn + sizeof (songfn), songGetStr (song, TAG_URI));
-  if (audiosrcGetType (songfn) != AUDIOSRC_TYPE_FILE) {
-    return changed;
+  aa = bdjvarsdfGet (BDJVDF_AUDIO_ADJUST);
+  if (aa != NULL) {
+    aaf = aa->aaf;
   }
+  job->rc = aaAdjustFile (aaf, &job->aap, job->origfn, job->outfn);
+  changed = aaApplyFinish (musicdb, NULL, job);
+  mdfree (job);
 
-  audiosrcFullPath (songfn, fullfn, sizeof (fullfn), NULL, 0);
-  infn = fullfn;
-  snprintf (origfn, sizeof (origfn), "%s%s",
-      infn, bdjvarsGetStr (BDJV_ORIGINAL_EXT));
+  return changed;
+}
 
-  /* check for a non-localized .original file, and if there, rename it */
-  if (strcmp (BDJ4_GENERIC_ORIG_EXT, bdjvarsGetStr (BDJV_ORIGINAL_EXT)) != 0 &&
-      ! fileopFileExists (origfn)) {
-    /* use outfn as a temporary area */
-    snprintf (outfn, sizeof (outfn), "%s%s", infn, BDJ4_GENERIC_ORIG_EXT);
-    if (fileopFileExists (outfn)) {
-      filemanipMove (outfn, origfn);
-    }
+/* the adjustments are applied to each song in dbidxlist (keyed by dbidx) */
+/* by a pool of worker threads.  the batch takes ownership of dbidxlist. */
+/* songcb is called with the dbidx and changed flag as each song finishes. */
+aabatch_t *
+aaBatchAlloc (musicdb_t *musicdb, nlist_t *dbidxlist, int aaflags,
+    callback_t *songcb)
+{
+  aabatch_t   *aab;
+
+  aab = mdmalloc (sizeof (aabatch_t));
+  aab->musicdb = musicdb;
+  aab->dbidxlist = dbidxlist;
+  nlistStartIterator (aab->dbidxlist, &aab->iteridx);
+  aab->aaflags = aaflags;
+  aab->songcb = songcb;
+  aab->tagwriter = NULL;
+  aab->queued = 0;
+  aab->count = 0;
+  aab->tot = nlistGetCount (dbidxlist);
+  aab->more = true;
+
+  aab->wp = workpoolAlloc ("aa-batch", 0, aaBatchWorker, aab);
+  aab->numthreads = workpoolThreadCount (aab->wp);
+  aab->aaf = mdmalloc (sizeof (aafilter_t *) * aab->numthreads);
+  aab->active = mdmalloc (sizeof (bool) * aab->numthreads);
+  for (int i = 0; i < aab->numthreads; ++i) {
+    aab->aaf [i] = aafilterAlloc ();
+    aab->active [i] = false;
   }
 
-  if (aaflags == SONG_ADJUST_RESTORE) {
-    if (fileopFileExists (origfn)) {
-      filemanipMove (origfn, fullfn);
-      aaRestoreTags (musicdb, song, dbidx, fullfn, songfn);
-      changed = true;
-    }
-    return changed;
-  }
+  return aab;
+}
 
-  if (aaflags != SONG_ADJUST_NONE &&
-      ! fileopFileExists (origfn)) {
-    int     value;
-    slist_t *taglist;
+void
+aaBatchFree (aabatch_t *aab)
+{
+  if (aab == NULL) {
+    return;
+  }
 
-    value = bdjoptGetNum (OPT_G_WRITETAGS);
-    if (value == WRITE_TAGS_NONE) {
-      bdjoptSetNum (OPT_G_WRITETAGS, WRITE_TAGS_BDJ_ONLY);
+  if (! workpoolIsIdle (aab->wp)) {
+    aaBatchCancel (aab);
+    while (! aaBatchProcess (aab)) {
+      mssleep (10);
     }
-    taglist = songTagList (song);
-    audiotagWriteTags (fullfn, taglist, taglist, AF_FORCE_WRITE_BDJ, AT_KEEP_MOD_TIME);
-    bdjoptSetNum (OPT_G_WRITETAGS, value);
-    slistFree (taglist);
-    filemanipCopy (fullfn, origfn);
+  }
+  workpoolFree (aab->wp);
+  for (int i = 0; i < aab->numthreads; ++i) {
+    aafilterFree (aab->aaf [i]);
+  }
+  mdfree (aab->aaf);
+  mdfree ((void *) aab->active);
+  nlistFree (aab->dbidxlist);
+  mdfree (aab);
+}
+
+/* if set, any pending background tag writes are completed before */
+/* a song file is replaced */
+void
+aaBatchSetTagWriter (aabatch_t *aab, tagwriter_t *tagwriter)
+{
+  if (aab == NULL) {
+    return;
   }
 
-  pi = pathInfo (fullfn);
-  snprintf (outfn, sizeof (outfn), "%.*s/n-%.*s",
-      (int) pi->dlen, pi->dirname,
-      (int) pi->flen, pi->filename);
-  pathInfoFree (pi);
+  aab->tagwriter = tagwriter;
+}
 
-  /* ffmpeg (et.al.) does not handle all tags properly. */
-  /* save all the original tags */
-  savedtags = audiotagSaveTags (fullfn);
+/* called from the main loop, returns true when the batch is finished */
+/* the database batch (and its lock) is only held while a single song */
+/* is updated, so that the other processes are not blocked, and the */
+/* song is written out before the song callback is executed */
+bool
+aaBatchProcess (aabatch_t *aab)
+{
+  aajob_t   *job;
+  bool      cancelled;
+  bool      changed;
 
-  /* start with the input as the original filename */
-  infn = origfn;
+  if (aab == NULL) {
+    return true;
+  }
 
-  /* the adjust flags must be reset, as the user may have selected */
-  /* different settings */
-  songSetNum (song, TAG_ADJUSTFLAGS, SONG_ADJUST_NONE);
+  /* prepare only enough songs to keep the workers busy */
+  while (aab->more &&
+      aab->queued < aab->numthreads * AA_QUEUE_PER_THREAD) {
+    dbidx_t   dbidx;
+
+    dbidx = nlistIterateKey (aab->dbidxlist, &aab->iteridx);
+    if (dbidx < 0) {
+      aab->more = false;
+      break;
+    }
 
-  /* any adjustments to the song are made */
-  if ((aaflags & SONG_ADJUST_ADJUST) == SONG_ADJUST_ADJUST) {
-    aaAdjust (musicdb, song, infn, outfn, 0, 0, 0, 0);
-    if (fileopFileExists (outfn)) {
-      long    adjflags;
-      int     obpm, nbpm;
-      int     ospeed;
-
-      filemanipMove (outfn, fullfn);
-      infn = fullfn;
-      ospeed = songGetNum (song, TAG_SPEEDADJUSTMENT);
-      songSetNum (song, TAG_SPEEDADJUSTMENT, 0);
-      songSetNum (song, TAG_SONGSTART, 0);
-      songSetNum (song, TAG_SONGEND, 0);
-      obpm = songGetNum (song, TAG_BPM);
-      nbpm = 0;
-      if (obpm > 0 && ospeed > 0 && ospeed != 100) {
-        nbpm = songutilAdjustBPM (obpm, ospeed);
-        songSetNum (song, TAG_BPM, nbpm);
+    changed = false;
+    dbStartBatch (aab->musicdb);
+    job = aaApplyPrepare (aab->musicdb, aab->tagwriter, dbidx,
+        aab->aaflags, &changed);
+    dbEndBatch (aab->musicdb);
+    if (job == NULL) {
+      /* restored, or there is nothing to do */
+      ++aab->count;
+      if (aab->songcb != NULL) {
+        callbackHandlerII (aab->songcb, dbidx, changed);
       }
-      adjflags = songGetNum (song, TAG_ADJUSTFLAGS);
-      adjflags |= SONG_ADJUST_ADJUST;
-      songSetNum (song, TAG_ADJUSTFLAGS, adjflags);
-      changed = true;
-    } else {
-      fileopDelete (outfn);
+      continue;
     }
+    ++aab->queued;
+    workpoolAdd (aab->wp, job);
   }
 
-  if (changed) {
-    songdb_t    *songdb;
+  while ((job = workpoolProcess (aab->wp, &cancelled)) != NULL) {
+    --aab->queued;
+    if (cancelled) {
+      aaApplyDiscard (job);
+      mdfree (job);
+      continue;
+    }
 
-    /* ffmpeg (et.al.) does not handle all tags properly. */
-    /* restore all the original tags */
-    audiotagRestoreTags (fullfn, savedtags);
-    audiotagFreeSavedTags (fullfn, savedtags);
-    savedtags = NULL;
+    dbStartBatch (aab->musicdb);
+    changed = aaApplyFinish (aab->musicdb, aab->tagwriter, job);
+    dbEndBatch (aab->musicdb);
+    ++aab->count;
+    if (aab->songcb != NULL) {
+      callbackHandlerII (aab->songcb, job->dbidx, changed);
+    }
+    mdfree (job);
+  }
 
-    songdb = songdbAlloc (musicdb);
-    songdbWriteDB (songdb, dbidx);
-    songdbFree (songdb);
+  if (! aab->more && workpoolIsIdle (aab->wp)) {
+    return true;
   }
-  dataFree (savedtags);
 
-  return changed;
+  return false;
+}
+
+/* the songs not yet started are skipped, and the songs */
+/* being processed are stopped (if possible) */
+void
+aaBatchCancel (aabatch_t *aab)
+{
+  if (aab == NULL) {
+    return;
+  }
+
+  aab->more = false;
+  workpoolCancel (aab->wp);
+  for (int i = 0; i < aab->numthreads; ++i) {
+    aafilterCancel (aab->aaf [i]);
+  }
+}
+
+/* count : the number of songs finished */
+void
+aaBatchGetCount (aabatch_t *aab, int *count, int *tot)
+{
+  *count = 0;
+  *tot = 0;
+  if (aab == NULL) {
+    return;
+  }
+  *count = aab->count;
+  *tot = aab->tot;
+}
+
+/* a percentage, including the songs in progress */
+int
+aaBatchGetProgress (aabatch_t *aab)
+{
+  int64_t   pct;
+
+  if (aab == NULL || aab->tot <= 0) {
+    return 0;
+  }
+
+  pct = (int64_t) aab->count * 100;
+  for (int i = 0; i < aab->numthreads; ++i) {
+    if (aab->active [i]) {
+      pct += aafilterGetProgress (aab->aaf [i]);
+    }
+  }
+  pct /= aab->tot;
+  if (pct > 100) {
+    pct = 100;
+  }
+  return (int) pct;
 }
 
 void
 aaAdjust (musicdb_t *musicdb, song_t *song,
     const char *infn, const char *outfn,
     long dur, int fadein, int fadeout, int gap)
+{
+  aa_t        *aa;
+  aafilter_t  *aaf = NULL;
+  aaparam_t   aap;
+  int         rc;
+
+  aaGetParams (song, &aap, dur, fadein, fadeout, gap);
+  aa = bdjvarsdfGet (BDJVDF_AUDIO_ADJUST);
+  if (aa != NULL) {
+    aaf = aa->aaf;
+  }
+  rc = aaAdjustFile (aaf, &aap, infn, outfn);
+  if (rc == 0) {
+    aaSetDuration (song, outfn);
+  }
+}
+
+/* gathers the song and option data needed by aaAdjustFile() */
+void
+aaGetParams (song_t *song, aaparam_t *aap,
+    long dur, int fadein, int fadeout, int gap)
+{
+  aap->songstart = songGetNum (song, TAG_SONGSTART);
+  aap->songend = songGetNum (song, TAG_SONGEND);
+  aap->songdur = songGetNum (song, TAG_DURATION);
+  aap->speed = songGetNum (song, TAG_SPEEDADJUSTMENT);
+  if (aap->speed < 0) {
+    aap->speed = 100;
+  }
+  aap->fadetype = bdjoptGetNum (OPT_P_FADETYPE);
+  aap->dur = dur;
+  aap->fadein = fadein;
+  aap->fadeout = fadeout;
+  aap->gap = gap;
+}
+
+/* no shared data is used, this may be run in a worker thread, */
+/* each thread must use its own aafilter (which may be null) */
+/* returns 0 if the output file was created, AA_NO_CHANGE if there */
+/* are no adjustments to make */
+int
+aaAdjustFile (aafilter_t *aaf, const aaparam_t *aap,
+    const char *infn, const char *outfn)
 {
   const char  *targv [40];
   int         targc = 0;
@@ -248,7 +424,10 @@ aaAdjust (musicdb_t *musicdb, song_t *song,
   int32_t     songdur;
   int32_t     calcdur;
   int         speed;
-  int         fadetype;
+  long        dur;
+  int         fadein;
+  int         fadeout;
+  int         gap;
   const char  *afprefix = "";
   const char  *ftstr = "tri";
   mstime_t    etm;
@@ -259,19 +438,19 @@ aaAdjust (musicdb_t *musicdb, song_t *song,
   mstimestart (&etm);
   *aftext = '\0';
 
-  songstart = songGetNum (song, TAG_SONGSTART);
-  songend = songGetNum (song, TAG_SONGEND);
-  songdur = songGetNum (song, TAG_DURATION);
-  speed = songGetNum (song, TAG_SPEEDADJUSTMENT);
-  if (speed < 0) {
-    speed = 100;
-  }
-  fadetype = bdjoptGetNum (OPT_P_FADETYPE);
+  songstart = aap->songstart;
+  songend = aap->songend;
+  songdur = aap->songdur;
+  speed = aap->speed;
+  dur = aap->dur;
+  fadein = aap->fadein;
+  fadeout = aap->fadeout;
+  gap = aap->gap;
 
   if (songstart <= 0 && songend <= 0 && speed == 100 && dur == 0 &&
       fadein == 0 && fadeout == 0 && gap == 0) {
     /* no adjustments need to be made */
-    return;
+    return AA_NO_CHANGE;
   }
 
   calcdur = dur;
@@ -286,7 +465,7 @@ aaAdjust (musicdb_t *musicdb, song_t *song,
   }
 
   /* translate to ffmpeg names */
-  switch (fadetype) {
+  switch (aap->fadetype) {
     case FADETYPE_EXPONENTIAL_SINE: { ftstr = "esin"; break; }
     case FADETYPE_HALF_SINE: { ftstr = "hsin"; break; }
     case FADETYPE_INVERTED_PARABOLA: { ftstr = "ipar"; break; }
@@ -295,6 +474,18 @@ aaAdjust (musicdb_t *musicdb, song_t *song,
     case FADETYPE_TRIANGLE: { ftstr = "tri"; break; }
   }
 
+  rc = aaAdjustFilter (aaf, infn, outfn, songstart, calcdur, songdur,
+      fadein, fadeout, ftstr, speed, gap);
+  if (rc == 0) {
+    logMsg (LOG_DBG, LOG_INFO, "aa: adjust-filter: elapsed: %" PRIu64,
+        (uint64_t) mstimeend (&etm));
+    return rc;
+  }
+  if (rc == AAFILTER_CANCELLED) {
+    return rc;
+  }
+
+  /* the in-process filter is not available or failed, run ffmpeg */
   targv [targc++] = sysvarsGetStr (SV_PATH_FFMPEG);
   targv [targc++] = "-hide_banner";
   targv [targc++] = "-y";
@@ -370,18 +561,14 @@ aaAdjust (musicdb_t *musicdb, song_t *song,
 
     snprintf (tmpfn, sizeof (tmpfn), "%s.tmp", outfn);
     filemanipMove (outfn, tmpfn);
-    aaApplySpeed (song, tmpfn, outfn, speed, gap);
+    aaApplySpeed (tmpfn, outfn, speed, gap);
     fileopDelete (tmpfn);
     logMsg (LOG_DBG, LOG_INFO, "aa: adjust-with-speed: elapsed: %ld",
         (long) mstimeend (&etm));
   }
 
-  if (rc == 0) {
-    aaSetDuration (musicdb, song, outfn);
-  }
-
   dataFree (resp);
-  return;
+  return rc;
 }
 
 int
@@ -410,6 +597,30 @@ aaSilenceDetect (const char *infn, double *sstart, double *send)
 
   aa = bdjvarsdfGet (BDJVDF_AUDIO_ADJUST);
 
+  snprintf (ffargs, sizeof (ffargs),
+      "silencedetect=noise=%ddB:duration=%.2f",
+      (int) nlistGetNum (aa->values, AA_TRIMSILENCE_NOISE),
+      nlistGetDouble (aa->values, AA_TRIMSILENCE_DURATION));
+
+  /* only the beginning and end of the song are decoded */
+  if (aa->aaf != NULL) {
+    silencedet_t  *sd;
+
+    sd = silencedetAlloc ();
+    rc = silencedetFile (sd, aa->aaf, infn,
+        (int) nlistGetNum (aa->values, AA_TRIMSILENCE_NOISE),
+        nlistGetDouble (aa->values, AA_TRIMSILENCE_DURATION),
+        sstart, send);
+    silencedetFree (sd);
+    if (rc == 0) {
+      logMsg (LOG_DBG, LOG_INFO, "aa-silence-detect: native: elapsed: %ld",
+          (long) mstimeend (&etm));
+      logMsg (LOG_DBG, LOG_INFO, "aa-silence-detect: start: %.2f end: %.2f",
+          *sstart, *send);
+      return 0;
+    }
+  }
+
   targv [targc++] = sysvarsGetStr (SV_PATH_FFMPEG);
   targv [targc++] = "-hide_banner";
   targv [targc++] = "-y";
@@ -420,10 +631,6 @@ aaSilenceDetect (const char *infn, double *sstart, double *send)
   targv [targc++] = "-i";
   targv [targc++] = infn;
 
-  snprintf (ffargs, sizeof (ffargs),
-      "silencedetect=noise=%ddB:duration=%.2f",
-      (int) nlistGetNum (aa->values, AA_TRIMSILENCE_NOISE),
-      nlistGetDouble (aa->values, AA_TRIMSILENCE_DURATION));
   targv [targc++] = "-af";
   targv [targc++] = ffargs;
 
@@ -504,10 +711,284 @@ aaSilenceDetect (const char *infn, double *sstart, double *send)
   return rc;
 }
 
+/* updates the song duration from the adjusted file */
+void
+aaSetDuration (song_t *song, const char *ffn)
+{
+  slist_t     *tagdata;
+  int         rewrite;
+  int32_t     dur;
+
+  if (! fileopFileExists (ffn)) {
+    return;
+  }
+
+  tagdata = audiotagParseData (ffn, &rewrite);
+  dur = atol (slistGetStr (tagdata, tagdefs [TAG_DURATION].tag));
+  songSetNum (song, TAG_DURATION, dur);
+  slistFree (tagdata);
+}
+
 /* internal routines */
 
+/* runs in the main thread */
+/* returns null if there is no conversion to be done */
+static aajob_t *
+aaApplyPrepare (musicdb_t *musicdb, tagwriter_t *tagwriter, dbidx_t dbidx,
+    int aaflags, bool *changed)
+{
+  song_t      *song;
+  pathinfo_t  *pi;
+  aajob_t     *job;
+  char        tbuff [MAXPATHLEN];
+
+  *changed = false;
+  song = dbGetByIdx (musicdb, dbidx);
+  if (song == NULL) {
+    return NULL;
+  }
+
+  job = mdmalloc (sizeof (aajob_t));
+  job->dbidx = dbidx;
+  job->savedtags = NULL;
+  job->rc = -1;
+  *job->outfn = '\0';
+
+  stpecpy (job->songfn, job->songfn + sizeof (job->songfn),
+      songGetStr (song, TAG_URI));
+  if (audiosrcGetType (job->songfn) != AUDIOSRC_TYPE_FILE) {
+    mdfree (job);
+    return NULL;
+  }
+
+  /* the background tag writer replaces the song file when it is done, */
+  /* any pending tag writes must be completed before the files are moved */
+  tagwriterWait (tagwriter);
+
+  audiosrcFullPath (job->songfn, job->fullfn, sizeof (job->fullfn), NULL, 0);
+  snprintf (job->origfn, sizeof (job->origfn), "%s%s",
+      job->fullfn, bdjvarsGetStr (BDJV_ORIGINAL_EXT));
+
+  /* check for a non-localized .original file, and if there, rename it */
+  if (strcmp (BDJ4_GENERIC_ORIG_EXT, bdjvarsGetStr (BDJV_ORIGINAL_EXT)) != 0 &&
+      ! fileopFileExists (job->origfn)) {
+    snprintf (tbuff, sizeof (tbuff), "%s%s", job->fullfn, BDJ4_GENERIC_ORIG_EXT);
+    if (fileopFileExists (tbuff)) {
+      filemanipMove (tbuff, job->origfn);
+    }
+  }
+
+  if (aaflags == SONG_ADJUST_RESTORE) {
+    if (fileopFileExists (job->origfn)) {
+      filemanipMove (job->origfn, job->fullfn);
+      aaRestoreTags (musicdb, song, dbidx, job->fullfn, job->songfn);
+      *changed = true;
+    }
+    mdfree (job);
+    return NULL;
+  }
+
+  if (aaflags != SONG_ADJUST_NONE &&
+      ! fileopFileExists (job->origfn)) {
+    int     value;
+    slist_t *taglist;
+
+    value = bdjoptGetNum (OPT_G_WRITETAGS);
+    if (value == WRITE_TAGS_NONE) {
+      bdjoptSetNum (OPT_G_WRITETAGS, WRITE_TAGS_BDJ_ONLY);
+    }
+    taglist = songTagList (song);
+    audiotagWriteTags (job->fullfn, taglist, taglist, AF_FORCE_WRITE_BDJ, AT_KEEP_MOD_TIME);
+    bdjoptSetNum (OPT_G_WRITETAGS, value);
+    slistFree (taglist);
+    filemanipCopy (job->fullfn, job->origfn);
+  }
+
+  if ((aaflags & SONG_ADJUST_ADJUST) != SONG_ADJUST_ADJUST) {
+    /* the adjust flags must be reset, as the user may have selected */
+    /* different settings */
+    songSetNum (song, TAG_ADJUSTFLAGS, SONG_ADJUST_NONE);
+    mdfree (job);
+    return NULL;
+  }
+
+  pi = pathInfo (job->fullfn);
+  snprintf (job->outfn, sizeof (job->outfn), "%.*s/n-%.*s",
+      (int) pi->dlen, pi->dirname,
+      (int) pi->flen, pi->filename);
+  pathInfoFree (pi);
+
+  /* ffmpeg (et.al.) does not handle all tags properly. */
+  /* save all the original tags */
+  job->savedtags = audiotagSaveTags (job->fullfn);
+
+  /* the input is the original file */
+  aaGetParams (song, &job->aap, 0, 0, 0, 0);
+
+  return job;
+}
+
+/* runs in the main thread */
+/* the job itself is not freed, the caller must free it */
+static bool
+aaApplyFinish (musicdb_t *musicdb, tagwriter_t *tagwriter, aajob_t *job)
+{
+  song_t      *song;
+  bool        changed = false;
+
+  song = dbGetByIdx (musicdb, job->dbidx);
+  if (song == NULL) {
+    aaApplyDiscard (job);
+    return changed;
+  }
+
+  /* the adjust flags must be reset, as the user may have selected */
+  /* different settings */
+  songSetNum (song, TAG_ADJUSTFLAGS, SONG_ADJUST_NONE);
+
+  if (job->rc == 0 && fileopFileExists (job->outfn)) {
+    long    adjflags;
+    int     obpm, nbpm;
+    int     ospeed;
+
+    aaSetDuration (song, job->outfn);
+    /* a tag write may have been queued while the song was processed */
+    tagwriterWait (tagwriter);
+    filemanipMove (job->outfn, job->fullfn);
+    ospeed = songGetNum (song, TAG_SPEEDADJUSTMENT);
+    songSetNum (song, TAG_SPEEDADJUSTMENT, 0);
+    songSetNum (song, TAG_SONGSTART, 0);
+    songSetNum (song, TAG_SONGEND, 0);
+    obpm = songGetNum (song, TAG_BPM);
+    nbpm = 0;
+    if (obpm > 0 && ospeed > 0 && ospeed != 100) {
+      nbpm = songutilAdjustBPM (obpm, ospeed);
+      songSetNum (song, TAG_BPM, nbpm);
+    }
+    adjflags = songGetNum (song, TAG_ADJUSTFLAGS);
+    adjflags |= SONG_ADJUST_ADJUST;
+    songSetNum (song, TAG_ADJUSTFLAGS, adjflags);
+    changed = true;
+  } else {
+    fileopDelete (job->outfn);
+  }
+
+  if (changed) {
+    songdb_t    *songdb;
+
+    /* ffmpeg (et.al.) does not handle all tags properly. */
+    /* restore all the original tags */
+    audiotagRestoreTags (job->fullfn, job->savedtags);
+    audiotagFreeSavedTags (job->fullfn, job->savedtags);
+    job->savedtags = NULL;
+
+    songdb = songdbAlloc (musicdb);
+    songdbWriteDB (songdb, job->dbidx);
+    songdbFree (songdb);
+  }
+  dataFree (job->savedtags);
+  job->savedtags = NULL;
+
+  return changed;
+}
+
+/* a cancelled song, the song file has not been changed */
+/* only the job's contents are cleaned up, the caller frees the job */
 static void
-aaApplySpeed (song_t *song, const char *infn, const char *outfn,
+aaApplyDiscard (aajob_t *job)
+{
+  if (*job->outfn) {
+    fileopDelete (job->outfn);
+    *job->outfn = '\0';
+  }
+  dataFree (job->savedtags);
+  job->savedtags = NULL;
+}
+
+/* runs in a worker thread */
+static void
+aaBatchWorker (void *udata, void *tjob, int thridx)
+{
+  aabatch_t   *aab = udata;
+  aajob_t     *job = tjob;
+
+  aab->active [thridx] = true;
+  job->rc = aaAdjustFile (aab->aaf [thridx], &job->aap,
+      job->origfn, job->outfn);
+  aab->active [thridx] = false;
+}
+
+/* the trim, fades, speed change and gap are all applied in one pass */
+static int
+aaAdjustFilter (aafilter_t *aaf, const char *infn, const char *outfn,
+    int32_t songstart, int32_t calcdur, int32_t songdur,
+    int fadein, int fadeout, const char *ftstr, int speed, int gap)
+{
+  char        aftext [500];
+  char        tmp [80];
+  const char  *afprefix = "";
+  char        *afp = aftext;
+  char        *afend = aftext + sizeof (aftext);
+  int32_t     durms = 0;
+  int         rc;
+
+  if (aaf == NULL) {
+    return -1;
+  }
+
+  *aftext = '\0';
+
+  if (calcdur > 0 && calcdur < songdur) {
+    /* the trim is done before the filters, so the gap is not included */
+    durms = calcdur;
+  }
+
+  if (fadein > 0) {
+    snprintf (tmp, sizeof (tmp),
+        "%safade=t=in:curve=tri:d=%dms",
+        afprefix, fadein);
+    afp = stpecpy (afp, afend, tmp);
+    afprefix = ", ";
+  }
+
+  if (fadeout > 0) {
+    snprintf (tmp, sizeof (tmp),
+        "%safade=t=out:curve=%s:st=%" PRId32 "ms:d=%dms",
+        afprefix, ftstr, calcdur - fadeout, fadeout);
+    afp = stpecpy (afp, afend, tmp);
+    afprefix = ", ";
+  }
+
+  if (speed > 0 && speed != 100) {
+    /* atempo is always present, rubberband is better quality */
+    snprintf (tmp, sizeof (tmp), "%s%s=tempo=%.2f",
+        afprefix,
+        aafilterHaveFilter ("rubberband") ? "rubberband" : "atempo",
+        (double) speed / 100.0);
+    afp = stpecpy (afp, afend, tmp);
+    afprefix = ", ";
+  }
+
+  if (gap > 0) {
+    snprintf (tmp, sizeof (tmp), "%sapad=pad_dur=%dms", afprefix, gap);
+    afp = stpecpy (afp, afend, tmp);
+    afprefix = ", ";
+  }
+
+  if (songstart < 0) {
+    songstart = 0;
+  }
+  rc = aafilterProcess (aaf, infn, outfn, songstart, durms, aftext);
+  if (rc != 0 || logCheck (LOG_DBG, LOG_AUDIO_ADJUST)) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "aa-adjust-filter: %s", aftext);
+    logMsg (LOG_DBG, LOG_IMPORTANT, "aa-adjust-filter: rc: %d", rc);
+  }
+
+  return rc;
+}
+
+static void
+aaApplySpeed (const char *infn, const char *outfn,
     int speed, int gap)
 {
   const char  *targv [30];
@@ -598,23 +1079,6 @@ aaRestoreTags (musicdb_t *musicdb, song_t *song, dbidx_t dbidx,
 }
 
 
-static void
-aaSetDuration (musicdb_t *musicdb, song_t *song, const char *ffn)
-{
-  slist_t     *tagdata;
-  int         rewrite;
-  int32_t     dur;
-
-  if (! fileopFileExists (ffn)) {
-    return;
-  }
-
-  tagdata = audiotagParseData (ffn, &rewrite);
-  dur = atol (slistGetStr (tagdata, tagdefs [TAG_DURATION].tag));
-  songSetNum (song, TAG_DURATION, dur);
-  slistFree (tagdata);
-}
-
 static int
 aaProcess (const char *tag, const char *targv [], int targc, char *resp)
 {
@@ -10,6 +10,10 @@
 #include <string.h>
 #include <inttypes.h>
 
+#if _lib_pthread_create
+# include <pthread.h>
+#endif
+
 #include "ati.h"
 #include "audiofile.h"
 #include "audiotag.h"
@@ -17,6 +21,7 @@
 #include "bdj4intl.h"
 #include "bdjopt.h"
 #include "bdjstring.h"
+#include "filemanip.h"
 #include "fileop.h"
 #include "log.h"
 #include "mdebug.h"
@@ -27,8 +32,16 @@
 #include "tmutil.h"
 
 typedef struct audiotag {
-  ati_t     *ati;
-  slist_t   *tagTypeLookup [TAG_TYPE_MAX];
+  ati_t           *ati;
+  slist_t         *tagTypeLookup [TAG_TYPE_MAX];
+  /* tagdefLookup() is not used, as it is also used by the main thread */
+  slist_t         *tagKeyLookup;
+#if _lib_pthread_create
+  /* audiotagParseData() may be called from multiple threads. */
+  /* the lookup lists are shared, and a list lookup updates */
+  /* the list's cache */
+  pthread_mutex_t lookuplock;
+#endif
 } audiotag_t;
 
 typedef struct {
@@ -62,6 +75,7 @@ enum {
 
 static audiotag_t *at = NULL;
 
+static int  audiotagWrite (const char *ffn, const char *tmpfn, slist_t *tagdata, slist_t *newtaglist, int rewrite, int modTimeFlag);
 static void audiotagParseTags (slist_t *tagdata, const char *ffn, int filetype, int tagtype, int *rewrite);
 static void audiotagCreateLookupTable (int tagtype);
 static int  audiotagTagCheck (int writetags, int tagtype, const char *tag, int rewrite);
@@ -70,6 +84,8 @@ static const char * audiotagTagLookup (int tagtype, const char *val);
 static const char * audiotagTagName (int tagkey);
 static const tagaudiotag_t *audiotagRawLookup (int tagkey, int tagtype);
 static int  audiotagCompareExt (const void *ta, const void *tb);
+static void audiotagLookupLock (void);
+static void audiotagLookupUnlock (void);
 
 void
 audiotagInit (void)
@@ -89,6 +105,10 @@ audiotagInit (void)
   for (int i = 0; i < TAG_TYPE_MAX; ++i) {
     at->tagTypeLookup [i] = NULL;
   }
+  at->tagKeyLookup = NULL;
+#if _lib_pthread_create
+  pthread_mutex_init (&at->lookuplock, NULL);
+#endif
 }
 
 void
@@ -104,7 +124,11 @@ audiotagCleanup (void)
       at->tagTypeLookup [i] = NULL;
     }
   }
+  slistFree (at->tagKeyLookup);
   atiFree (at->ati);
+#if _lib_pthread_create
+  pthread_mutex_destroy (&at->lookuplock);
+#endif
   mdfree (at);
   at = NULL;
 }
@@ -119,7 +143,9 @@ audiotagParseData (const char *ffn, int *rewrite)
   *rewrite = 0;
   tagdata = slistAlloc ("atag", LIST_ORDERED, NULL);
   audiotagDetermineTagType (ffn, &tagtype, &filetype);
+  audiotagLookupLock ();
   audiotagCreateLookupTable (tagtype);
+  audiotagLookupUnlock ();
   audiotagParseTags (tagdata, ffn, filetype, tagtype, rewrite);
   return tagdata;
 }
@@ -127,6 +153,38 @@ audiotagParseData (const char *ffn, int *rewrite)
 int
 audiotagWriteTags (const char *ffn, slist_t *tagdata, slist_t *newtaglist,
     int rewrite, int modTimeFlag)
+{
+  return audiotagWrite (ffn, NULL, tagdata, newtaglist, rewrite, modTimeFlag);
+}
+
+/* the tags are written to a copy of the file, and the copy then */
+/* replaces the original.  the original is never left partially written. */
+/* a file with more than one link is written in place, otherwise the */
+/* replacement would break the links */
+int
+audiotagWriteTagsReplace (const char *ffn, slist_t *tagdata,
+    slist_t *newtaglist, int rewrite, int modTimeFlag)
+{
+  pathinfo_t    *pi;
+  char          tmpfn [MAXPATHLEN];
+  fileopstat_t  fst;
+
+  if (fileopStat (ffn, &fst) && fst.nlink > 1) {
+    return audiotagWrite (ffn, NULL, tagdata, newtaglist, rewrite, modTimeFlag);
+  }
+
+  pi = pathInfo (ffn);
+  snprintf (tmpfn, sizeof (tmpfn), "%.*s/t-%.*s",
+      (int) pi->dlen, pi->dirname,
+      (int) pi->flen, pi->filename);
+  pathInfoFree (pi);
+
+  return audiotagWrite (ffn, tmpfn, tagdata, newtaglist, rewrite, modTimeFlag);
+}
+
+static int
+audiotagWrite (const char *ffn, const char *tmpfn, slist_t *tagdata,
+    slist_t *newtaglist, int rewrite, int modTimeFlag)
 {
   int         tagtype;
   int         filetype;
@@ -264,17 +322,49 @@ audiotagWriteTags (const char *ffn, slist_t *tagdata, slist_t *newtaglist,
 
   if (slistGetCount (updatelist) > 0 ||
       slistGetCount (dellist) > 0) {
-    time_t    origtm;
+    time_t      origtm;
+    const char  *wfn = ffn;
 
     logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "writing tags");
     logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "  %s", ffn);
     origtm = fileopModTime (ffn);
 
-    atiWriteTags (at->ati, ffn, updatelist, dellist, datalist,
-        tagtype, filetype);
+    if (tmpfn != NULL) {
+      wfn = tmpfn;
+      if (filemanipCopy (ffn, tmpfn) != 0) {
+        logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: unable to copy %s", ffn);
+        fileopDelete (tmpfn);
+        rc = AUDIOTAG_WRITE_FAILED;
+      }
+      if (rc == AUDIOTAG_WRITE_OK) {
+        /* the copy is created with the default permissions */
+        filemanipCopyPermissions (ffn, tmpfn);
+      }
+    }
 
-    if (modTimeFlag == AT_KEEP_MOD_TIME) {
-      fileopSetModTime (ffn, origtm);
+    if (rc == AUDIOTAG_WRITE_OK) {
+      if (atiWriteTags (at->ati, wfn, updatelist, dellist, datalist,
+          tagtype, filetype) != 0) {
+        logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: unable to write tags %s", ffn);
+        /* the original file is left as is */
+        if (tmpfn != NULL) {
+          fileopDelete (tmpfn);
+        }
+        rc = AUDIOTAG_WRITE_FAILED;
+      }
+    }
+
+    if (rc == AUDIOTAG_WRITE_OK &&
+        modTimeFlag == AT_KEEP_MOD_TIME) {
+      fileopSetModTime (wfn, origtm);
+    }
+
+    if (rc == AUDIOTAG_WRITE_OK && tmpfn != NULL) {
+      if (filemanipMove (tmpfn, ffn) != 0) {
+        logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: unable to replace %s", ffn);
+        fileopDelete (tmpfn);
+        rc = AUDIOTAG_WRITE_FAILED;
+      }
     }
   }
 
@@ -494,7 +584,17 @@ audiotagTagCheck (int writetags, int tagtype, const char *tag, int rewrite)
 {
   int tagkey = -1;
 
-  tagkey = tagdefLookup (tag);
+  audiotagLookupLock ();
+  if (at->tagKeyLookup == NULL) {
+    at->tagKeyLookup = slistAlloc ("tag-key", LIST_UNORDERED, NULL);
+    slistSetSize (at->tagKeyLookup, TAG_KEY_MAX);
+    for (int i = 0; i < TAG_KEY_MAX; ++i) {
+      slistSetNum (at->tagKeyLookup, tagdefs [i].tag, i);
+    }
+    slistSort (at->tagKeyLookup);
+  }
+  tagkey = slistGetNum (at->tagKeyLookup, tag);
+  audiotagLookupUnlock ();
   if (tagkey < 0 || tagkey >= TAG_KEY_MAX) {
     /* unknown tag  */
     // logMsg (LOG_DBG, LOG_DBUPDATE | LOG_AUDIO_TAG, "unknown-tag: %s", tag);
@@ -547,8 +647,10 @@ audiotagTagLookup (int tagtype, const char *val)
 {
   const char  *tagname;
 
+  audiotagLookupLock ();
   audiotagCreateLookupTable (tagtype);
   tagname = slistGetStr (at->tagTypeLookup [tagtype], val);
+  audiotagLookupUnlock ();
   return tagname;
 }
 
@@ -583,3 +685,19 @@ audiotagCompareExt (const void *ta, const void *tb)
 
   return strcmp (a->ext, b->ext);
 }
+
+static void
+audiotagLookupLock (void)
+{
+#if _lib_pthread_create
+  pthread_mutex_lock (&at->lookuplock);
+#endif
+}
+
+static void
+audiotagLookupUnlock (void)
+{
+#if _lib_pthread_create
+  pthread_mutex_unlock (&at->lookuplock);
+#endif
+}
@@ -99,6 +99,10 @@ bdj4startup (int argc, char *argv[], musicdb_t **musicdb,
     { "rebuild",        no_argument,        NULL,   'R' },
     { "checknew",       no_argument,        NULL,   'C' },
     { "compact",        no_argument,        NULL,   127 },
+    { "bpmdetect",      no_argument,        NULL,   126 },
+    { "loudness",       no_argument,        NULL,   125 },
+    { "updchanged",     no_argument,        NULL,   124 },
+    { "watch",          no_argument,        NULL,   123 },
     { "musicdir",       required_argument,  NULL,   'D' },
     { "reorganize",     no_argument,        NULL,   'O' },
     { "updfromtags",    no_argument,        NULL,   'u' },
@@ -192,6 +196,22 @@ bdj4startup (int argc, char *argv[], musicdb_t **musicdb,
         *flags |= BDJ4_ARG_DB_COMPACT;
         break;
       }
+      case 126: {
+        *flags |= BDJ4_ARG_DB_BPM_DETECT;
+        break;
+      }
+      case 125: {
+        *flags |= BDJ4_ARG_DB_LOUDNESS;
+        break;
+      }
+      case 124: {
+        *flags |= BDJ4_ARG_DB_UPD_CHANGED;
+        break;
+      }
+      case 123: {
+        *flags |= BDJ4_ARG_DB_WATCH;
+        break;
+      }
       case 'P': {
         *flags |= BDJ4_ARG_PROGRESS;
         break;
@@ -0,0 +1,484 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * tempo detection.
+ * the audio (mono, BPMDETECT_RATE) is reduced to an onset strength
+ * envelope using the spectral flux, and the tempo is estimated from
+ * the autocorrelation of the envelope, constrained to a tempo range.
+ * a bpmdetect_t may be re-used for many songs, but may only be used
+ * by one thread at a time.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "aafilter.h"
+#include "bpmdetect.h"
+#include "mdebug.h"
+
+enum {
+  BPMD_FFT_SZ = 1024,
+  BPMD_BINS = BPMD_FFT_SZ / 2,
+  BPMD_HOP = 128,
+  /* the envelope is allocated in chunks of this size */
+  BPMD_ENV_CHUNK = 4096,
+  /* the tempo is refined using this multiple of the beat period */
+  BPMD_REFINE_MULT = 4,
+};
+
+/* onset envelope frames per second */
+#define BPMD_FPS ((double) BPMDETECT_RATE / (double) BPMD_HOP)
+/* at least this many seconds of audio are needed */
+#define BPMD_MIN_SEC 4.0
+/* the tempo prior, in octaves */
+#define BPMD_PRIOR_WIDTH 1.0
+
+typedef struct bpmdetect {
+  float     *window;
+  float     *cosv;
+  float     *sinv;
+  int       *bitrev;
+  float     *re;
+  float     *im;
+  float     *mag;
+  float     *prevmag;
+  float     *frame;
+  int       framefill;
+  float     *env;
+  size_t    envlen;
+  size_t    envalloc;
+  bool      havemag;
+} bpmdetect_t;
+
+static void bpmdetectSampleCallback (void *udata, const float *samples, int count);
+static void bpmdetectFrame (bpmdetect_t *bpmd);
+static void bpmdetectFFT (bpmdetect_t *bpmd);
+static float bpmdetectFlux (const float *mag, const float *prevmag, int count);
+static double bpmdetectACF (const float *od, size_t count, size_t lag);
+static double bpmdetectPeak (const float *od, size_t count, size_t lag, size_t range, double *peakval);
+
+bpmdetect_t *
+bpmdetectAlloc (void)
+{
+  bpmdetect_t *bpmd;
+  int         bits = 0;
+
+  bpmd = mdmalloc (sizeof (bpmdetect_t));
+  bpmd->window = mdmalloc (sizeof (float) * BPMD_FFT_SZ);
+  bpmd->cosv = mdmalloc (sizeof (float) * BPMD_BINS);
+  bpmd->sinv = mdmalloc (sizeof (float) * BPMD_BINS);
+  bpmd->bitrev = mdmalloc (sizeof (int) * BPMD_FFT_SZ);
+  bpmd->re = mdmalloc (sizeof (float) * BPMD_FFT_SZ);
+  bpmd->im = mdmalloc (sizeof (float) * BPMD_FFT_SZ);
+  bpmd->mag = mdmalloc (sizeof (float) * BPMD_BINS);
+  bpmd->prevmag = mdmalloc (sizeof (float) * BPMD_BINS);
+  bpmd->frame = mdmalloc (sizeof (float) * BPMD_FFT_SZ);
+  bpmd->env = NULL;
+  bpmd->envalloc = 0;
+
+  for (int i = 0; i < BPMD_FFT_SZ; ++i) {
+    bpmd->window [i] = (float) (0.5 - 0.5 * cos (2.0 * M_PI * i / BPMD_FFT_SZ));
+  }
+  for (int i = 0; i < BPMD_BINS; ++i) {
+    bpmd->cosv [i] = (float) cos (2.0 * M_PI * i / BPMD_FFT_SZ);
+    bpmd->sinv [i] = (float) sin (2.0 * M_PI * i / BPMD_FFT_SZ);
+  }
+  while ((1 << bits) < BPMD_FFT_SZ) {
+    ++bits;
+  }
+  for (int i = 0; i < BPMD_FFT_SZ; ++i) {
+    int   r = 0;
+
+    for (int j = 0; j < bits; ++j) {
+      if ((i & (1 << j)) != 0) {
+        r |= 1 << (bits - 1 - j);
+      }
+    }
+    bpmd->bitrev [i] = r;
+  }
+
+  bpmdetectReset (bpmd);
+  return bpmd;
+}
+
+void
+bpmdetectFree (bpmdetect_t *bpmd)
+{
+  if (bpmd == NULL) {
+    return;
+  }
+
+  dataFree (bpmd->window);
+  dataFree (bpmd->cosv);
+  dataFree (bpmd->sinv);
+  dataFree (bpmd->bitrev);
+  dataFree (bpmd->re);
+  dataFree (bpmd->im);
+  dataFree (bpmd->mag);
+  dataFree (bpmd->prevmag);
+  dataFree (bpmd->frame);
+  dataFree (bpmd->env);
+  mdfree (bpmd);
+}
+
+void
+bpmdetectReset (bpmdetect_t *bpmd)
+{
+  if (bpmd == NULL) {
+    return;
+  }
+
+  bpmd->framefill = 0;
+  bpmd->envlen = 0;
+  bpmd->havemag = false;
+}
+
+/* samples : mono, at BPMDETECT_RATE */
+void
+bpmdetectAddSamples (bpmdetect_t *bpmd, const float *samples, int count)
+{
+  if (bpmd == NULL || samples == NULL) {
+    return;
+  }
+
+  while (count > 0) {
+    int     len;
+
+    len = BPMD_FFT_SZ - bpmd->framefill;
+    if (len > count) {
+      len = count;
+    }
+    memcpy (bpmd->frame + bpmd->framefill, samples, sizeof (float) * len);
+    bpmd->framefill += len;
+    samples += len;
+    count -= len;
+
+    if (bpmd->framefill == BPMD_FFT_SZ) {
+      bpmdetectFrame (bpmd);
+      memmove (bpmd->frame, bpmd->frame + BPMD_HOP,
+          sizeof (float) * (BPMD_FFT_SZ - BPMD_HOP));
+      bpmd->framefill -= BPMD_HOP;
+    }
+  }
+}
+
+/* the audio file is decoded and analyzed */
+/* startms, durms : the portion of the song to analyze, 0 for all */
+int
+bpmdetectFile (bpmdetect_t *bpmd, aafilter_t *aaf, const char *fn,
+    int32_t startms, int32_t durms)
+{
+  if (bpmd == NULL) {
+    return -1;
+  }
+
+  bpmdetectReset (bpmd);
+  return aafilterSamples (aaf, fn, startms, durms, BPMDETECT_RATE, 1,
+      bpmdetectSampleCallback, bpmd);
+}
+
+/* returns the tempo in beats per minute, or 0.0 if it cannot be */
+/* determined. */
+/* lowbpm, highbpm : the tempo range to search */
+/* confidence : 0 to 100 */
+double
+bpmdetectCalc (bpmdetect_t *bpmd, double lowbpm, double highbpm,
+    int *confidence)
+{
+  float     *od;
+  double    *sum;
+  size_t    n;
+  size_t    minlag;
+  size_t    maxlag;
+  size_t    bestlag = 0;
+  size_t    radius;
+  double    bestscore = 0.0;
+  double    bestval = 0.0;
+  double    center;
+  double    r0;
+  double    meanr = 0.0;
+  double    lag;
+  double    bpm = 0.0;
+  int       mult;
+
+  *confidence = 0;
+  if (bpmd == NULL || lowbpm <= 0.0 || highbpm < lowbpm) {
+    return bpm;
+  }
+
+  n = bpmd->envlen;
+  if ((double) n < BPMD_FPS * BPMD_MIN_SEC) {
+    return bpm;
+  }
+
+  minlag = (size_t) floor (60.0 * BPMD_FPS / highbpm);
+  maxlag = (size_t) ceil (60.0 * BPMD_FPS / lowbpm);
+  if (minlag < 2) {
+    minlag = 2;
+  }
+  if (maxlag * 2 >= n) {
+    maxlag = n / 2 - 1;
+  }
+  if (maxlag <= minlag) {
+    return bpm;
+  }
+
+  /* remove the local mean and half-wave rectify, so that only the */
+  /* onsets remain */
+  od = mdmalloc (sizeof (float) * n);
+  sum = mdmalloc (sizeof (double) * (n + 1));
+  sum [0] = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    sum [i + 1] = sum [i] + bpmd->env [i];
+  }
+  radius = (size_t) (BPMD_FPS * 0.25);
+  for (size_t i = 0; i < n; ++i) {
+    size_t  lo, hi;
+    double  mean;
+
+    lo = i > radius ? i - radius : 0;
+    hi = i + radius + 1 < n ? i + radius + 1 : n;
+    mean = (sum [hi] - sum [lo]) / (double) (hi - lo);
+    od [i] = (float) fmax (bpmd->env [i] - mean, 0.0);
+  }
+  mdfree (sum);
+
+  r0 = bpmdetectACF (od, n, 0);
+  if (r0 <= 0.0) {
+    mdfree (od);
+    return bpm;
+  }
+
+  /* a log-normal prior centered in the range favors the correct */
+  /* octave when both the tempo and a multiple are within the range */
+  center = sqrt (lowbpm * highbpm);
+  for (size_t l = minlag; l <= maxlag; ++l) {
+    double  r;
+    double  tbpm;
+    double  oct;
+    double  score;
+
+    r = bpmdetectACF (od, n, l);
+    meanr += r;
+    tbpm = 60.0 * BPMD_FPS / (double) l;
+    if (tbpm < lowbpm * 0.98 || tbpm > highbpm * 1.02) {
+      continue;
+    }
+    oct = log2 (tbpm / center) / BPMD_PRIOR_WIDTH;
+    score = r * exp (-0.5 * oct * oct);
+    if (score > bestscore) {
+      bestscore = score;
+      bestlag = l;
+    }
+  }
+  meanr /= (double) (maxlag - minlag + 1);
+
+  if (bestlag == 0) {
+    mdfree (od);
+    return bpm;
+  }
+
+  lag = bpmdetectPeak (od, n, bestlag, 1, &bestval);
+
+  /* the peak at a multiple of the period gives a more precise value */
+  mult = BPMD_REFINE_MULT;
+  while (mult > 1 && (size_t) (lag * mult) + mult + 1 >= n / 2) {
+    --mult;
+  }
+  if (mult > 1) {
+    double  tval;
+    double  tlag;
+
+    tlag = bpmdetectPeak (od, n, (size_t) (lag * mult + 0.5), mult, &tval);
+    if (tval > bestval * 0.5) {
+      lag = tlag / (double) mult;
+    }
+  }
+
+  bpm = 60.0 * BPMD_FPS / lag;
+  if (r0 > meanr) {
+    double  conf;
+
+    conf = 100.0 * (bestval - meanr) / (r0 - meanr);
+    if (conf < 0.0) {
+      conf = 0.0;
+    }
+    if (conf > 100.0) {
+      conf = 100.0;
+    }
+    *confidence = (int) conf;
+  }
+
+  mdfree (od);
+  return bpm;
+}
+
+/* internal routines */
+
+static void
+bpmdetectSampleCallback (void *udata, const float *samples, int count)
+{
+  bpmdetect_t   *bpmd = udata;
+
+  bpmdetectAddSamples (bpmd, samples, count);
+}
+
+static void
+bpmdetectFrame (bpmdetect_t *bpmd)
+{
+  float   *tmp;
+  float   flux = 0.0f;
+
+  for (int i = 0; i < BPMD_FFT_SZ; ++i) {
+    int   j = bpmd->bitrev [i];
+
+    bpmd->re [j] = bpmd->frame [i] * bpmd->window [i];
+    bpmd->im [j] = 0.0f;
+  }
+  bpmdetectFFT (bpmd);
+
+  /* log compressed magnitude */
+  for (int i = 0; i < BPMD_BINS; ++i) {
+    float   m;
+
+    m = sqrtf (bpmd->re [i] * bpmd->re [i] + bpmd->im [i] * bpmd->im [i]);
+    bpmd->mag [i] = log1pf (100.0f * m);
+  }
+
+  if (bpmd->havemag) {
+    flux = bpmdetectFlux (bpmd->mag, bpmd->prevmag, BPMD_BINS);
+  }
+  tmp = bpmd->prevmag;
+  bpmd->prevmag = bpmd->mag;
+  bpmd->mag = tmp;
+  bpmd->havemag = true;
+
+  if (bpmd->envlen >= bpmd->envalloc) {
+    bpmd->envalloc += BPMD_ENV_CHUNK;
+    bpmd->env = mdrealloc (bpmd->env, sizeof (float) * bpmd->envalloc);
+  }
+  bpmd->env [bpmd->envlen] = flux;
+  ++bpmd->envlen;
+}
+
+/* in-place radix-2 fft, the input is in bit-reversed order */
+static void
+bpmdetectFFT (bpmdetect_t *bpmd)
+{
+  float   *re = bpmd->re;
+  float   *im = bpmd->im;
+
+  for (int len = 2; len <= BPMD_FFT_SZ; len <<= 1) {
+    int   half = len / 2;
+    int   step = BPMD_FFT_SZ / len;
+
+    for (int i = 0; i < BPMD_FFT_SZ; i += len) {
+      for (int j = 0; j < half; ++j) {
+        float   wr, wi;
+        float   xr, xi;
+        int     a, b;
+
+        wr = bpmd->cosv [j * step];
+        wi = - bpmd->sinv [j * step];
+        a = i + j;
+        b = a + half;
+        xr = re [b] * wr - im [b] * wi;
+        xi = re [b] * wi + im [b] * wr;
+        re [b] = re [a] - xr;
+        im [b] = im [a] - xi;
+        re [a] += xr;
+        im [a] += xi;
+      }
+    }
+  }
+}
+
+/* the sum of the increases in magnitude */
+/* there are no branches, and separate partial sums are used so that */
+/* the compiler is able to vectorize the loop */
+static float
+bpmdetectFlux (const float *mag, const float *prevmag, int count)
+{
+  float   sums [4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  int     i;
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    for (int j = 0; j < 4; ++j) {
+      float   d;
+
+      d = mag [i + j] - prevmag [i + j];
+      sums [j] += (d + fabsf (d)) * 0.5f;
+    }
+  }
+  for ( ; i < count; ++i) {
+    float   d;
+
+    d = mag [i] - prevmag [i];
+    sums [0] += (d + fabsf (d)) * 0.5f;
+  }
+
+  return sums [0] + sums [1] + sums [2] + sums [3];
+}
+
+static double
+bpmdetectACF (const float *od, size_t count, size_t lag)
+{
+  double  sum = 0.0;
+
+  if (lag >= count) {
+    return 0.0;
+  }
+
+  for (size_t i = 0; i + lag < count; ++i) {
+    sum += (double) od [i] * (double) od [i + lag];
+  }
+  return sum / (double) (count - lag);
+}
+
+/* finds the autocorrelation peak within range of lag, */
+/* and interpolates its position */
+static double
+bpmdetectPeak (const float *od, size_t count, size_t lag, size_t range,
+    double *peakval)
+{
+  size_t  lo;
+  size_t  best;
+  double  bestval;
+  double  rprev, rnext;
+  double  denom;
+  double  pos;
+
+  lo = lag > range ? lag - range : 1;
+  best = lo;
+  bestval = bpmdetectACF (od, count, lo);
+  for (size_t l = lo + 1; l <= lag + range; ++l) {
+    double  r;
+
+    r = bpmdetectACF (od, count, l);
+    if (r > bestval) {
+      bestval = r;
+      best = l;
+    }
+  }
+
+  *peakval = bestval;
+  pos = (double) best;
+  rprev = bpmdetectACF (od, count, best - 1);
+  rnext = bpmdetectACF (od, count, best + 1);
+  denom = rprev - 2.0 * bestval + rnext;
+  if (denom < 0.0) {
+    double  delta;
+
+    delta = 0.5 * (rprev - rnext) / denom;
+    if (delta > -1.0 && delta < 1.0) {
+      pos += delta;
+    }
+  }
+  return pos;
+}
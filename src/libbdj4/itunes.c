@@ -15,12 +15,12 @@
 
 #include <libxml/tree.h>
 #include <libxml/parser.h>
-#include <libxml/xpath.h>
-#include <libxml/xpathInternals.h>
+#include <libxml/xmlreader.h>
 
 #include "audiosrc.h"
 #include "bdj4.h"
 #include "bdjopt.h"
+#include "callback.h"
 #include "datafile.h"
 #include "fileop.h"
 #include "genre.h"
@@ -36,23 +36,26 @@
 #include "tagdef.h"
 #include "tmutil.h"
 
-static const xmlChar * datamainxpath = (const xmlChar *)
-      "/plist/dict/dict/key";
-static const xmlChar * dataxpath = (const xmlChar *)
-      "/plist/dict/dict/dict/key|"
-      "/plist/dict/dict/dict/integer|"
-      "/plist/dict/dict/dict/string|"
-      "/plist/dict/dict/dict/date|"
-      "/plist/dict/dict/dict/true|"
-      "/plist/dict/dict/dict/false";
-static const xmlChar * plmainxpath = (const xmlChar *)
-      "/plist/dict/array/dict/key";
-static const xmlChar * plxpath = (const xmlChar *)
-      "/plist/dict/array/dict/key|"
-      "/plist/dict/array/dict/integer|"
-      "/plist/dict/array/dict/string|"
-      "/plist/dict/array/dict/array/dict/key|"
-      "/plist/dict/array/dict/array/dict/integer";
+/* the itunes xml file is read with a streaming reader, as it may be */
+/* very large.  the elements that are processed are: */
+/*    track data: /plist/dict/dict/dict/{key,integer,string,date,true} */
+/*    playlists:  /plist/dict/array/dict/{key,integer,string} */
+/*                /plist/dict/array/dict/array/dict/{key,integer} */
+enum {
+  ITUNES_EL_OTHER,
+  ITUNES_EL_PLIST,
+  ITUNES_EL_DICT,
+  ITUNES_EL_ARRAY,
+  ITUNES_EL_KEY,
+  ITUNES_EL_INTEGER,
+  ITUNES_EL_STRING,
+  ITUNES_EL_DATE,
+  ITUNES_EL_TRUE,
+  ITUNES_MAX_DEPTH = 8,
+  /* how often the progress is checked */
+  ITUNES_PROGRESS_COUNT = 5000,
+};
+
 static const char *ITUNES_LOCALHOST = "file://localhost";
 static const char *ITUNES_LOCAL = "file://";
 
@@ -69,8 +72,36 @@ typedef struct itunes {
   slistidx_t    availiteridx;
   slistidx_t    songiteridx;
   slistidx_t    pliteridx;
+  callback_t    *progresscb;
 } itunes_t;
 
+/* converts the itunes key/value element pairs to key/value strings */
+typedef struct {
+  char          lastkey [50];
+  bool          valset;
+  bool          wantval;
+} itunesraw_t;
+
+typedef struct {
+  itunes_t      *itunes;
+  nlist_t       *songbyidx;
+  slist_t       *songbyname;
+  slist_t       *playlists;
+  itunesraw_t   dataraw;
+  itunesraw_t   plraw;
+  /* track data */
+  nlist_t       *entry;
+  nlistidx_t    lastval;
+  bool          ratingset;
+  bool          skip;
+  bool          datadone;
+  /* playlists */
+  char          keepname [1000];
+  nlist_t       *ids;
+  bool          plskip;
+  bool          ismaster;
+} itunesparse_t;
+
 /* must be sorted in ascii order */
 static datafilekey_t starsdfkeys [ITUNES_STARS_MAX] = {
   { "10",   ITUNES_STARS_10,      VALUE_NUM,  ratingConv, DF_NORM },
@@ -85,9 +116,13 @@ static datafilekey_t starsdfkeys [ITUNES_STARS_MAX] = {
   { "90",   ITUNES_STARS_90,      VALUE_NUM,  ratingConv, DF_NORM },
 };
 
-static bool itunesParseData (itunes_t *itunes, xmlXPathContextPtr xpathCtx, const xmlChar *xpathExpr);
-static bool itunesParsePlaylists (itunes_t *itunes, xmlXPathContextPtr xpathCtx, const xmlChar *xpathExpr);
-static bool itunesParseXPath (xmlXPathContextPtr xpathCtx, const xmlChar *xpathExpr, slist_t *rawdata, const xmlChar *mainxpath);
+static int  itunesElementType (const char *name);
+static void itunesParseElement (itunesparse_t *ps, xmlTextReaderPtr reader, int eltype, bool isdata);
+static bool itunesParseWantData (itunesparse_t *ps, const char *key);
+static void itunesParseDataPair (itunesparse_t *ps, const char *key, const char *val);
+static void itunesParseDataFinish (itunesparse_t *ps);
+static void itunesParsePlaylistPair (itunesparse_t *ps, const char *key, const char *val);
+static void itunesParsePlaylistFinish (itunesparse_t *ps);
 
 bool
 itunesConfigured (void)
@@ -152,6 +187,7 @@ itunesAlloc (void)
   itunes->songbyidx = NULL;
   itunes->songbyname = NULL;
   itunes->playlists = NULL;
+  itunes->progresscb = NULL;
 
 #if 0
   /* for debugging */
@@ -300,13 +336,28 @@ itunesIterateAvailFields (itunes_t *itunes, int *val)
   return skey;
 }
 
+/* the callback is called with the fraction of the file that */
+/* has been read */
+void
+itunesSetProgressCallback (itunes_t *itunes, callback_t *cb)
+{
+  if (itunes == NULL) {
+    return;
+  }
+  itunes->progresscb = cb;
+}
+
 bool
 itunesParse (itunes_t *itunes)
 {
-  xmlDocPtr           doc;
-  xmlXPathContextPtr  xpathCtx;
+  xmlTextReaderPtr    reader;
+  itunesparse_t       ps;
   const char          *fn;
   time_t              xmlts;
+  ssize_t             fsize;
+  int                 elstack [ITUNES_MAX_DEPTH];
+  int                 rc;
+  int32_t             count = 0;
 
   if (! itunesConfigured ()) {
     logMsg (LOG_DBG, LOG_INFO, "itunesParse: itunes not configured");
@@ -318,51 +369,117 @@ itunesParse (itunes_t *itunes)
   if (xmlts <= itunes->lastparse) {
     return true;
   }
+  fsize = fileopSize (fn);
 
   xmlInitParser ();
 
-  doc = xmlParseFile (fn);
-  mdextalloc (doc);
-  if (doc == NULL)  {
-    logMsg (LOG_DBG, LOG_INFO, "itunesParse: unable to parse %s", fn);
+  reader = xmlReaderForFile (fn, NULL, 0);
+  mdextalloc (reader);
+  if (reader == NULL)  {
+    logMsg (LOG_DBG, LOG_INFO, "itunesParse: unable to open %s", fn);
     xmlCleanupParser ();
     return false;
   }
 
-  xpathCtx = xmlXPathNewContext (doc);
-  mdextalloc (xpathCtx);
-  if (xpathCtx == NULL)  {
-    logMsg (LOG_DBG, LOG_INFO, "itunesParse: unable to create xpath context");
-    mdextfree (doc);
-    xmlFreeDoc (doc);
-    xmlCleanupParser ();
-    return false;
+  ps.itunes = itunes;
+  ps.songbyidx = nlistAlloc ("itunes-songs-by-idx", LIST_ORDERED, NULL);
+  ps.songbyname = slistAlloc ("itunes-song-by-name", LIST_ORDERED, NULL);
+  ps.playlists = slistAlloc ("itunes-playlists", LIST_ORDERED, NULL);
+  ps.dataraw.valset = true;
+  ps.dataraw.wantval = false;
+  ps.plraw.valset = true;
+  ps.plraw.wantval = false;
+  ps.entry = NULL;
+  ps.lastval = -1;
+  ps.ratingset = false;
+  ps.skip = false;
+  ps.datadone = false;
+  *ps.keepname = '\0';
+  ps.ids = NULL;
+  ps.plskip = false;
+  ps.ismaster = false;
+
+  for (int i = 0; i < ITUNES_MAX_DEPTH; ++i) {
+    elstack [i] = ITUNES_EL_OTHER;
   }
 
-  if (! itunesParseData (itunes, xpathCtx, dataxpath)) {
-    mdextfree (xpathCtx);
-    xmlXPathFreeContext (xpathCtx);
-    mdextfree (doc);
-    xmlFreeDoc (doc);
-    xmlCleanupParser ();
-    return false;
+  while ((rc = xmlTextReaderRead (reader)) == 1) {
+    int     depth;
+    int     eltype;
+
+    if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT) {
+      continue;
+    }
+
+    ++count;
+    if (count % ITUNES_PROGRESS_COUNT == 0 && fsize > 0) {
+      callbackHandlerD (itunes->progresscb,
+          (double) xmlTextReaderByteConsumed (reader) / (double) fsize);
+    }
+
+    depth = xmlTextReaderDepth (reader);
+    if (depth < 0 || depth >= ITUNES_MAX_DEPTH) {
+      continue;
+    }
+    eltype = itunesElementType ((const char *) xmlTextReaderConstName (reader));
+    elstack [depth] = eltype;
+
+    if (depth < 4 ||
+        elstack [0] != ITUNES_EL_PLIST ||
+        elstack [1] != ITUNES_EL_DICT) {
+      continue;
+    }
+
+    /* itunes just dumps everything into a dict structure. */
+    /* poor use of xml */
+    if (depth == 4 &&
+        elstack [2] == ITUNES_EL_DICT &&
+        elstack [3] == ITUNES_EL_DICT) {
+      itunesParseElement (&ps, reader, eltype, true);
+    }
+    if (elstack [2] == ITUNES_EL_ARRAY &&
+        elstack [3] == ITUNES_EL_DICT) {
+      if (depth == 4 ||
+          (depth == 6 &&
+          elstack [4] == ITUNES_EL_ARRAY &&
+          elstack [5] == ITUNES_EL_DICT &&
+          (eltype == ITUNES_EL_KEY || eltype == ITUNES_EL_INTEGER))) {
+        /* the track data must be complete before the playlists */
+        /* are processed */
+        itunesParseDataFinish (&ps);
+        itunesParseElement (&ps, reader, eltype, false);
+      }
+    }
   }
-  if (! itunesParsePlaylists (itunes, xpathCtx, plxpath)) {
-    mdextfree (xpathCtx);
-    xmlXPathFreeContext (xpathCtx);
-    mdextfree (doc);
-    xmlFreeDoc (doc);
-    xmlCleanupParser ();
+
+  mdextfree (reader);
+  xmlFreeTextReader (reader);
+  xmlCleanupParser ();
+
+  if (rc != 0) {
+    logMsg (LOG_DBG, LOG_INFO, "itunesParse: unable to parse %s", fn);
+    nlistFree (ps.entry);
+    nlistFree (ps.ids);
+    nlistFree (ps.songbyidx);
+    slistFree (ps.songbyname);
+    slistFree (ps.playlists);
     return false;
   }
 
-  mdextfree (xpathCtx);
-  xmlXPathFreeContext (xpathCtx);
-  mdextfree (doc);
-  xmlFreeDoc (doc);
-  xmlCleanupParser ();
+  itunesParseDataFinish (&ps);
+  itunesParsePlaylistFinish (&ps);
+
+  nlistFree (itunes->songbyidx);
+  slistFree (itunes->songbyname);
+  slistFree (itunes->playlists);
+  itunes->songbyidx = ps.songbyidx;
+  itunes->songbyname = ps.songbyname;
+  itunes->playlists = ps.playlists;
+
+  callbackHandlerD (itunes->progresscb, 1.0);
   itunes->lastparse = xmlts;
-  // xmlMemoryDump ();
+  logMsg (LOG_DBG, LOG_INFO, "itunesParse: songs: %" PRId32 " playlists: %" PRId32,
+      nlistGetCount (itunes->songbyidx), slistGetCount (itunes->playlists));
   return true;
 }
 
@@ -430,345 +547,379 @@ itunesIteratePlaylists (itunes_t *itunes)
 
 /* internal routines */
 
-static bool
-itunesParseData (itunes_t *itunes, xmlXPathContextPtr xpathCtx,
-    const xmlChar *xpathExpr)
+
+static int
+itunesElementType (const char *name)
 {
-  slist_t     *rawdata;
-  slistidx_t  iteridx;
-  const char  *key;
-  const char  *val;
-  nlistidx_t  lastval = -1;
-  nlist_t     *entry = NULL;
-  bool        ratingset = false;
-  bool        skip = false;
-
-  rawdata = slistAlloc ("itunes-data-raw", LIST_UNORDERED, NULL);
-  if (! itunesParseXPath (xpathCtx, xpathExpr, rawdata, datamainxpath)) {
-    slistFree (rawdata);
-    return false;
+  int     eltype = ITUNES_EL_OTHER;
+
+  if (strcmp (name, "key") == 0) {
+    eltype = ITUNES_EL_KEY;
+  } else if (strcmp (name, "integer") == 0) {
+    eltype = ITUNES_EL_INTEGER;
+  } else if (strcmp (name, "string") == 0) {
+    eltype = ITUNES_EL_STRING;
+  } else if (strcmp (name, "date") == 0) {
+    eltype = ITUNES_EL_DATE;
+  } else if (strcmp (name, "true") == 0) {
+    eltype = ITUNES_EL_TRUE;
+  } else if (strcmp (name, "dict") == 0) {
+    eltype = ITUNES_EL_DICT;
+  } else if (strcmp (name, "array") == 0) {
+    eltype = ITUNES_EL_ARRAY;
+  } else if (strcmp (name, "plist") == 0) {
+    eltype = ITUNES_EL_PLIST;
   }
+  return eltype;
+}
 
-  slistFree (itunes->songbyidx);
-  slistFree (itunes->songbyname);
-  itunes->songbyidx = nlistAlloc ("itunes-songs-by-idx", LIST_ORDERED, NULL);
-  itunes->songbyname = slistAlloc ("itunes-song-by-name", LIST_ORDERED, NULL);
+/* a key with no value (false, or an element that is not processed) */
+/* is set to "0" when the next key is found */
+static void
+itunesParseElement (itunesparse_t *ps, xmlTextReaderPtr reader,
+    int eltype, bool isdata)
+{
+  itunesraw_t *raw;
+  xmlNodePtr  node;
+  xmlChar     *val = NULL;
+  const char  *tval = "";
+
+  raw = &ps->plraw;
+  if (isdata) {
+    raw = &ps->dataraw;
+  }
 
-  slistStartIterator (rawdata, &iteridx);
-  while ((key = slistIterateKey (rawdata, &iteridx)) != NULL) {
-    val = slistGetStr (rawdata, key);
-    if (val == NULL) {
-      continue;
-    }
+  if (eltype != ITUNES_EL_KEY &&
+      eltype != ITUNES_EL_INTEGER &&
+      eltype != ITUNES_EL_STRING &&
+      eltype != ITUNES_EL_DATE &&
+      eltype != ITUNES_EL_TRUE) {
+    return;
+  }
+  if (! isdata &&
+      (eltype == ITUNES_EL_DATE || eltype == ITUNES_EL_TRUE)) {
+    return;
+  }
 
-    if (strcmp (key, "") == 0) {
-    } else if (strcmp (key, "Track ID") == 0) {
-      if (skip) {
-        nlistFree (entry);
-      }
-      if (! skip && lastval >= 0) {
-        const char  *tval;
+  /* the content of a value is only retrieved if it will be used */
+  if (eltype == ITUNES_EL_KEY ||
+      (eltype != ITUNES_EL_TRUE && raw->wantval)) {
+    node = xmlTextReaderExpand (reader);
+    if (node != NULL) {
+      val = xmlNodeGetContent (node);
+      mdextalloc (val);
+    }
+    if (val != NULL) {
+      tval = (const char *) val;
+    }
+  }
 
-        tval = nlistGetStr (entry, TAG_URI);
-        if (tval != NULL) {
-          nlistSetList (itunes->songbyidx, lastval, entry);
-          slistSetNum (itunes->songbyname, tval, lastval);
-        } else {
-          nlistFree (entry);
-        }
+  if (eltype == ITUNES_EL_KEY) {
+    if (! raw->valset && raw->wantval) {
+      if (isdata) {
+        itunesParseDataPair (ps, raw->lastkey, "0");
+      } else {
+        itunesParsePlaylistPair (ps, raw->lastkey, "0");
       }
-      entry = nlistAlloc ("itunes-entry", LIST_ORDERED, NULL);
-      lastval = atol (val);
-      ratingset = false;
-      skip = false;
-      continue;
     }
-    if (skip) {
-      continue;
+    stpecpy (raw->lastkey, raw->lastkey + sizeof (raw->lastkey), tval);
+    raw->valset = false;
+    raw->wantval = true;
+    if (isdata) {
+      raw->wantval = itunesParseWantData (ps, raw->lastkey);
     }
-
-    if (strcmp (key, "Movie") == 0 ||
-        strcmp (key, "Has Video") == 0) {
-      skip = true;
-      logMsg (LOG_DBG, LOG_ITUNES, "song: skip-video");
-      continue;
+  } else {
+    if (eltype == ITUNES_EL_TRUE) {
+      tval = "1";
     }
-
-    if (strcmp (key, "Rating Computed") == 0) {
-      if (atoi (val) == 1) {
-        /* set the dance rating to unrated */
-        nlistSetNum (entry, TAG_DANCERATING, 0);
-        logMsg (LOG_DBG, LOG_ITUNES, "song: unrated");
-        ratingset = true;
-      }
-    } else if (strcmp (key, "Loved") == 0 ||
-        strcmp (key, "Disliked") == 0) {
-      if (atoi (val) == 1) {
-        datafileconv_t  conv;
-
-        conv.invt = VALUE_STR;
-        if (strcmp (key, "Loved") == 0) {
-          conv.str = "pinkheart";
-        }
-        if (strcmp (key, "Disliked") == 0) {
-          conv.str = "brokenheart";
-        }
-        songFavoriteConv (&conv);
-        nlistSetNum (entry, TAG_FAVORITE, conv.num);
-        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId64 "",
-            tagdefs [TAG_FAVORITE].tag, conv.num);
+    if (raw->wantval) {
+      logMsg (LOG_DBG, LOG_ITUNES, "xml: raw: %s %s", raw->lastkey, tval);
+      if (isdata) {
+        itunesParseDataPair (ps, raw->lastkey, tval);
+      } else {
+        itunesParsePlaylistPair (ps, raw->lastkey, tval);
       }
-    } else {
-      int   tagidx;
+    }
+    raw->valset = true;
+  }
 
-      /* if the key is in the list and has an associated tag */
-      tagidx = slistGetNum (itunes->itunesAvailFields, key);
-      if (tagidx < 0) {
-        continue;
-      }
+  if (val != NULL) {
+    mdextfree (val);
+    xmlFree (val);
+  }
+}
 
-      if (tagidx == TAG_URI) {
-        bool    ok = false;
-        int     offset = 0;
+/* the track data that is not imported is skipped */
+static bool
+itunesParseWantData (itunesparse_t *ps, const char *key)
+{
+  int     tagidx;
 
-        if (strncmp (val, ITUNES_LOCALHOST, strlen (ITUNES_LOCALHOST)) == 0) {
-          offset = strlen (ITUNES_LOCALHOST);
-          ok = true;
-        } else if (strncmp (val, ITUNES_LOCAL, strlen (ITUNES_LOCAL)) == 0) {
-          offset = strlen (ITUNES_LOCAL);
-          ok = true;
-        } else {
-          skip = true;
-        }
+  if (strcmp (key, "Track ID") == 0 ||
+      strcmp (key, "Movie") == 0 ||
+      strcmp (key, "Has Video") == 0 ||
+      strcmp (key, "Rating Computed") == 0) {
+    return true;
+  }
+  if (strcmp (key, "Loved") == 0 ||
+      strcmp (key, "Disliked") == 0) {
+    return itunesGetField (ps->itunes, TAG_FAVORITE) > 0;
+  }
 
-        if (ok) {
-          char        *nstr;
+  tagidx = slistGetNum (ps->itunes->itunesAvailFields, key);
+  if (tagidx < 0) {
+    return false;
+  }
+  /* the uri is always needed */
+  /* work and movement are used to create the title */
+  if (tagidx == TAG_URI ||
+      tagidx == TAG_WORK ||
+      tagidx == TAG_MOVEMENTNAME ||
+      tagidx == TAG_MOVEMENTNUM) {
+    return true;
+  }
+  return itunesGetField (ps->itunes, tagidx) > 0;
+}
 
-          val += offset;
-          /* not sure that the string is decomposed */
-          nstr = g_uri_unescape_string (val, NULL);
-          mdextalloc (nstr);
+static void
+itunesParseDataPair (itunesparse_t *ps, const char *key, const char *val)
+{
+  itunes_t    *itunes = ps->itunes;
 
-          val = audiosrcRelativePath (nstr, 0);
-          nlistSetStr (entry, tagidx, val);
-          logMsg (LOG_DBG, LOG_ITUNES, "song: %s %s", tagdefs [tagidx].tag, val);
-          mdfree (nstr);    // allocated by glib
-        }
-      } else if (tagidx == TAG_DBADDDATE) {
-        time_t    tmval;
-
-        /* 2023-01-03T18:34:58Z */
-        tmval = tmutilStringToUTC (val, "%FT%TZ");
-        nlistSetNum (entry, tagidx, tmval);
-        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRIu64, tagdefs [tagidx].tag, (uint64_t) tmval);
-      } else if (tagidx == TAG_DANCERATING) {
-        int   ratingidx;
-        int   tval;
-
-        if (ratingset) {
-          continue;
-        }
+  if (val == NULL) {
+    return;
+  }
 
-        tval = atoi (val);
-        tval = tval / 10 - 1;
-        ratingidx = nlistGetNum (itunes->stars, tval);
-        nlistSetNum (entry, tagidx, ratingidx);
-        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId32, tagdefs [tagidx].tag, ratingidx);
-      } else if (tagidx == TAG_GENRE) {
-        datafileconv_t  conv;
-
-        conv.invt = VALUE_STR;
-        conv.str = val;
-        genreConv (&conv);
-        nlistSetNum (entry, tagidx, conv.num);
-        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId64, tagdefs [tagidx].tag, conv.num);
+  if (strcmp (key, "") == 0) {
+  } else if (strcmp (key, "Track ID") == 0) {
+    if (ps->skip) {
+      nlistFree (ps->entry);
+    }
+    if (! ps->skip && ps->lastval >= 0) {
+      const char  *tval;
+
+      tval = nlistGetStr (ps->entry, TAG_URI);
+      if (tval != NULL) {
+        nlistSetList (ps->songbyidx, ps->lastval, ps->entry);
+        slistSetNum (ps->songbyname, tval, ps->lastval);
       } else {
-        /* start time and stop time are already in the correct format (ms) */
-        if (tagdefs [tagidx].valueType == VALUE_NUM) {
-          nlistSetNum (entry, tagidx, atol (val));
-        }
-        if (tagdefs [tagidx].valueType == VALUE_STR) {
-          nlistSetStr (entry, tagidx, val);
-        }
-        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %s", tagdefs [tagidx].tag, val);
+        nlistFree (ps->entry);
       }
     }
+    ps->entry = nlistAlloc ("itunes-entry", LIST_ORDERED, NULL);
+    ps->lastval = atol (val);
+    ps->ratingset = false;
+    ps->skip = false;
+    return;
   }
-
-  if (skip) {
-    nlistFree (entry);
+  if (ps->skip) {
+    return;
   }
 
-  if (! skip) {
-    const char  *tval;
+  if (strcmp (key, "Movie") == 0 ||
+      strcmp (key, "Has Video") == 0) {
+    ps->skip = true;
+    logMsg (LOG_DBG, LOG_ITUNES, "song: skip-video");
+    return;
+  }
 
-    tval = nlistGetStr (entry, TAG_URI);
-    if (tval != NULL) {
-      nlistSetList (itunes->songbyidx, lastval, entry);
-      slistSetNum (itunes->songbyname, tval, lastval);
-    } else {
-      nlistFree (entry);
+  if (strcmp (key, "Rating Computed") == 0) {
+    if (atoi (val) == 1) {
+      /* set the dance rating to unrated */
+      nlistSetNum (ps->entry, TAG_DANCERATING, 0);
+      logMsg (LOG_DBG, LOG_ITUNES, "song: unrated");
+      ps->ratingset = true;
+    }
+  } else if (strcmp (key, "Loved") == 0 ||
+      strcmp (key, "Disliked") == 0) {
+    if (atoi (val) == 1) {
+      datafileconv_t  conv;
+
+      conv.invt = VALUE_STR;
+      if (strcmp (key, "Loved") == 0) {
+        conv.str = "pinkheart";
+      }
+      if (strcmp (key, "Disliked") == 0) {
+        conv.str = "brokenheart";
+      }
+      songFavoriteConv (&conv);
+      nlistSetNum (ps->entry, TAG_FAVORITE, conv.num);
+      logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId64 "",
+          tagdefs [TAG_FAVORITE].tag, conv.num);
     }
+  } else {
+    int   tagidx;
 
-    /* the itunes xml file does not appear to save the show-movement flag */
-    /* use our own setting to determine whether to use work/movement */
-    songutilTitleFromWorkMovement (entry);
-  }
+    /* if the key is in the list and has an associated tag */
+    tagidx = slistGetNum (itunes->itunesAvailFields, key);
+    if (tagidx < 0) {
+      return;
+    }
 
-  slistFree (rawdata);
-  return true;
-}
+    if (tagidx == TAG_URI) {
+      bool    ok = false;
+      int     offset = 0;
 
-static bool
-itunesParsePlaylists (itunes_t *itunes, xmlXPathContextPtr xpathCtx,
-    const xmlChar *xpathExpr)
-{
-  slist_t     *rawdata = NULL;
-  slistidx_t  iteridx;
-  const char  *key;
-  const char  *val;
-  char        keepname [1000];
-  nlist_t     *ids = NULL;
-  bool        skip = false;
-  bool        ismaster = false;
-
-  rawdata = slistAlloc ("itunes-pl-raw", LIST_UNORDERED, NULL);
-  if (! itunesParseXPath (xpathCtx, xpathExpr, rawdata, plmainxpath)) {
-    slistFree (rawdata);
-    return false;
-  }
+      if (strncmp (val, ITUNES_LOCALHOST, strlen (ITUNES_LOCALHOST)) == 0) {
+        offset = strlen (ITUNES_LOCALHOST);
+        ok = true;
+      } else if (strncmp (val, ITUNES_LOCAL, strlen (ITUNES_LOCAL)) == 0) {
+        offset = strlen (ITUNES_LOCAL);
+        ok = true;
+      } else {
+        ps->skip = true;
+      }
 
-  *keepname = '\0';
-  slistFree (itunes->playlists);
-  itunes->playlists = slistAlloc ("itunes-playlists", LIST_ORDERED, NULL);
+      if (ok) {
+        char        *nstr;
 
-  slistStartIterator (rawdata, &iteridx);
-  while ((key = slistIterateKey (rawdata, &iteridx)) != NULL) {
-    val = slistGetStr (rawdata, key);
+        val += offset;
+        /* not sure that the string is decomposed */
+        nstr = g_uri_unescape_string (val, NULL);
+        mdextalloc (nstr);
 
-    if (strcmp (key, "Master") == 0) {
-      ismaster = true;
-      continue;
-    }
-    if (strcmp (key, "Playlist ID") == 0) {
-      if (! skip && ids != NULL && nlistGetCount (ids) == 0) {
-        slistFree (ids);
-        ids = NULL;
-      }
-      if (skip == false && *keepname && ids != NULL) {
-        slistSetList (itunes->playlists, keepname, ids);
-        /* it is possible for a playlist to not have an item list */
-        ids = NULL;
-      }
-      skip = false;
-      if (ismaster) {
-        skip = true;
-        ismaster = false;
+        val = audiosrcRelativePath (nstr, 0);
+        nlistSetStr (ps->entry, tagidx, val);
+        logMsg (LOG_DBG, LOG_ITUNES, "song: %s %s", tagdefs [tagidx].tag, val);
+        mdfree (nstr);    // allocated by glib
       }
-      continue;
-    }
-    if (strcmp (key, "Playlist Items") == 0) {
-      ids = NULL;
-      if (! skip) {
-        ids = nlistAlloc ("itunes-pl-ids", LIST_UNORDERED, NULL);
-        skip = false;
+    } else if (tagidx == TAG_DBADDDATE) {
+      time_t    tmval;
+
+      /* 2023-01-03T18:34:58Z */
+      tmval = tmutilStringToUTC (val, "%FT%TZ");
+      nlistSetNum (ps->entry, tagidx, tmval);
+      logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRIu64, tagdefs [tagidx].tag, (uint64_t) tmval);
+    } else if (tagidx == TAG_DANCERATING) {
+      int   ratingidx;
+      int   tval;
+
+      if (ps->ratingset) {
+        return;
       }
-      continue;
-    }
-    if (skip) {
-      continue;
-    }
 
-    if (strcmp (key, "Distinguished Kind") == 0 ||
-        strcmp (key, "Smart Info") == 0) {
-      logMsg (LOG_DBG, LOG_ITUNES, "pl: skip");
-      skip = true;
-    } else if (strcmp (key, "Name") == 0) {
-      stpecpy (keepname, keepname + sizeof (keepname), val);
-      logMsg (LOG_DBG, LOG_ITUNES, "pl-name: %s", keepname);
-    } else if (strcmp (key, "Track ID") == 0) {
-      slist_t   *entry;
-      long      tval;
-
-      tval = atol (val);
-      entry = nlistGetList (itunes->songbyidx, tval);
-      if (entry != NULL) {
-        nlistSetNum (ids, tval, 1);
-        logMsg (LOG_DBG, LOG_ITUNES, "pl: %s %ld", keepname, tval);
+      tval = atoi (val);
+      tval = tval / 10 - 1;
+      ratingidx = nlistGetNum (itunes->stars, tval);
+      nlistSetNum (ps->entry, tagidx, ratingidx);
+      logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId32, tagdefs [tagidx].tag, ratingidx);
+    } else if (tagidx == TAG_GENRE) {
+      datafileconv_t  conv;
+
+      conv.invt = VALUE_STR;
+      conv.str = val;
+      genreConv (&conv);
+      nlistSetNum (ps->entry, tagidx, conv.num);
+      logMsg (LOG_DBG, LOG_ITUNES, "song: %s %" PRId64, tagdefs [tagidx].tag, conv.num);
+    } else {
+      /* start time and stop time are already in the correct format (ms) */
+      if (tagdefs [tagidx].valueType == VALUE_NUM) {
+        nlistSetNum (ps->entry, tagidx, atol (val));
+      }
+      if (tagdefs [tagidx].valueType == VALUE_STR) {
+        nlistSetStr (ps->entry, tagidx, val);
       }
+      logMsg (LOG_DBG, LOG_ITUNES, "song: %s %s", tagdefs [tagidx].tag, val);
     }
   }
+}
 
-  if (! skip && ids != NULL && nlistGetCount (ids) == 0) {
-    slistFree (ids);
-    ids = NULL;
+static void
+itunesParseDataFinish (itunesparse_t *ps)
+{
+  if (ps->datadone) {
+    return;
   }
-  if (skip == false && *keepname && ids != NULL) {
-    slistSetList (itunes->playlists, keepname, ids);
+  ps->datadone = true;
+
+  if (ps->skip) {
+    nlistFree (ps->entry);
   }
 
-  slistFree (rawdata);
-  return true;
+  if (! ps->skip) {
+    const char  *tval;
+
+    tval = nlistGetStr (ps->entry, TAG_URI);
+    if (tval != NULL) {
+      nlistSetList (ps->songbyidx, ps->lastval, ps->entry);
+      slistSetNum (ps->songbyname, tval, ps->lastval);
+      /* the itunes xml file does not appear to save the show-movement flag */
+      /* use our own setting to determine whether to use work/movement */
+      songutilTitleFromWorkMovement (ps->entry);
+    } else {
+      nlistFree (ps->entry);
+    }
+  }
+  ps->entry = NULL;
 }
 
-static bool
-itunesParseXPath (xmlXPathContextPtr xpathCtx, const xmlChar *xpathExpr,
-    slist_t *rawdata, const xmlChar *mainxpath)
+static void
+itunesParsePlaylistPair (itunesparse_t *ps, const char *key, const char *val)
 {
-  xmlXPathObjectPtr   xpathObj;
-  xmlNodeSetPtr       nodes;
-  xmlNodePtr          cur;
-  int                 size;
-  xmlChar             *val = NULL;
-  char                lastkey [50];
-  bool                valset = true;
-
-  xpathObj = xmlXPathEvalExpression (xpathExpr, xpathCtx);
-  mdextalloc (xpathObj);
-  if (xpathObj == NULL)  {
-    logMsg (LOG_DBG, LOG_IMPORTANT, "itunesParse: bad xpath expression");
-    return false;
+  if (strcmp (key, "Master") == 0) {
+    ps->ismaster = true;
+    return;
+  }
+  if (strcmp (key, "Playlist ID") == 0) {
+    if (! ps->plskip && ps->ids != NULL && nlistGetCount (ps->ids) == 0) {
+      nlistFree (ps->ids);
+      ps->ids = NULL;
+    }
+    if (ps->plskip == false && *ps->keepname && ps->ids != NULL) {
+      slistSetList (ps->playlists, ps->keepname, ps->ids);
+      /* it is possible for a playlist to not have an item list */
+      ps->ids = NULL;
+    }
+    ps->plskip = false;
+    if (ps->ismaster) {
+      ps->plskip = true;
+      ps->ismaster = false;
+    }
+    return;
+  }
+  if (strcmp (key, "Playlist Items") == 0) {
+    nlistFree (ps->ids);
+    ps->ids = NULL;
+    if (! ps->plskip) {
+      ps->ids = nlistAlloc ("itunes-pl-ids", LIST_UNORDERED, NULL);
+    }
+    return;
+  }
+  if (ps->plskip) {
+    return;
   }
 
-  nodes = xpathObj->nodesetval;
-  size = (nodes) ? nodes->nodeNr : 0;
-
-  /* itunes just dumps everything into a dict structure. */
-  /* poor use of xml */
-  for (int i = 0; i < size; ++i)  {
-    if (nodes->nodeTab [i]->type == XML_ELEMENT_NODE)  {
-      cur = nodes->nodeTab [i];
-      val = xmlNodeGetContent (cur);
-      mdextalloc (val);
-
-      logMsg (LOG_DBG, LOG_ITUNES, "xml: raw: %s %s", cur->name, val);
-      // fprintf (stderr, "i: %s %s\n", cur->name, val);
-      if (strcmp ((const char *) cur->name, "key") == 0) {
-        if (! valset) {
-          slistSetStr (rawdata, lastkey, "0");
-          // fprintf (stderr, "  0: %s 0\n", lastkey);
-        }
-        stpecpy (lastkey, lastkey + sizeof (lastkey), (const char *) val);
-        valset = false;
-      }
-      if (strcmp ((const char *) cur->name, "integer") == 0 ||
-          strcmp ((const char *) cur->name, "string") == 0 ||
-          strcmp ((const char *) cur->name, "date") == 0) {
-        slistSetStr (rawdata, lastkey, (const char *) val);
-        // fprintf (stderr, "  s: %s\n", val);
-        valset = true;
-      }
-      if (strcmp ((const char *) cur->name, "true") == 0) {
-        slistSetStr (rawdata, lastkey, (const char *) "1");
-        // fprintf (stderr, "  b: %s\n", "1");
-        valset = true;
-      }
-      mdextfree (val);
-      xmlFree (val);
+  if (strcmp (key, "Distinguished Kind") == 0 ||
+      strcmp (key, "Smart Info") == 0) {
+    logMsg (LOG_DBG, LOG_ITUNES, "pl: skip");
+    ps->plskip = true;
+  } else if (strcmp (key, "Name") == 0) {
+    stpecpy (ps->keepname, ps->keepname + sizeof (ps->keepname), val);
+    logMsg (LOG_DBG, LOG_ITUNES, "pl-name: %s", ps->keepname);
+  } else if (strcmp (key, "Track ID") == 0) {
+    nlist_t   *entry;
+    long      tval;
+
+    tval = atol (val);
+    entry = nlistGetList (ps->songbyidx, tval);
+    if (entry != NULL) {
+      nlistSetNum (ps->ids, tval, 1);
+      logMsg (LOG_DBG, LOG_ITUNES, "pl: %s %ld", ps->keepname, tval);
     }
   }
+}
 
-  mdextfree (xpathObj);
-  xmlXPathFreeObject (xpathObj);
-  return true;
+static void
+itunesParsePlaylistFinish (itunesparse_t *ps)
+{
+  if (! ps->plskip && ps->ids != NULL && nlistGetCount (ps->ids) == 0) {
+    nlistFree (ps->ids);
+    ps->ids = NULL;
+  }
+  if (ps->plskip == false && *ps->keepname && ps->ids != NULL) {
+    slistSetList (ps->playlists, ps->keepname, ps->ids);
+    ps->ids = NULL;
+  }
+  nlistFree (ps->ids);
+  ps->ids = NULL;
 }
@@ -0,0 +1,372 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * loudness measurement (EBU R128 / ITU-R BS.1770).
+ * the audio (stereo, LOUDNESS_RATE) is passed through the k-weighting
+ * filters, and the mean square is measured in 400ms blocks with a 75%
+ * overlap.  the integrated loudness uses the absolute (-70 LUFS) and
+ * relative (-10 LU) gates.
+ * the true peak is measured using 4x oversampling.
+ * a loudness_t may be re-used for many songs, but may only be used
+ * by one thread at a time.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "aafilter.h"
+#include "loudness.h"
+#include "mdebug.h"
+
+enum {
+  /* 100ms sub-blocks, four sub-blocks per gating block */
+  LOUD_SUB_LEN = LOUDNESS_RATE / 10,
+  LOUD_SUB_COUNT = 4,
+  /* the block list is allocated in chunks of this size */
+  LOUD_BLOCK_CHUNK = 1024,
+  /* true peak interpolation */
+  LOUD_TP_PHASES = 4,
+  LOUD_TP_TAPS = 12,
+  LOUD_BIQUAD_MAX = 2,
+};
+
+#define LOUD_ABS_GATE -70.0
+#define LOUD_REL_GATE -10.0
+
+typedef struct {
+  double    b0, b1, b2;
+  double    a1, a2;
+} loudbiquad_t;
+
+typedef struct loudness {
+  loudbiquad_t  kw [LOUD_BIQUAD_MAX];
+  double        z [LOUDNESS_CHANNELS][LOUD_BIQUAD_MAX][2];
+  double        subsum;
+  int           subfill;
+  double        sub [LOUD_SUB_COUNT];
+  int           subcount;
+  double        *blocks;
+  size_t        blockcount;
+  size_t        blockalloc;
+  /* the history is stored twice so that it may be read contiguously */
+  float         tpcoef [LOUD_TP_PHASES][LOUD_TP_TAPS];
+  float         tphist [LOUDNESS_CHANNELS][LOUD_TP_TAPS * 2];
+  int           tpidx;
+  double        peak;
+} loudness_t;
+
+static void loudnessSampleCallback (void *udata, const float *samples, int count);
+static double loudnessLUFS (double energy);
+static double loudnessEnergy (double lufs);
+
+loudness_t *
+loudnessAlloc (void)
+{
+  loudness_t  *loud;
+  double      k, q, vh, vb, a0;
+  double      f0;
+
+  loud = mdmalloc (sizeof (loudness_t));
+  loud->blocks = NULL;
+  loud->blockalloc = 0;
+
+  /* the k-weighting filters, calculated for the sample rate */
+  /* stage one: high shelf */
+  f0 = 1681.974450955533;
+  q = 0.7071752369554196;
+  k = tan (M_PI * f0 / (double) LOUDNESS_RATE);
+  vh = pow (10.0, 3.999843853973347 / 20.0);
+  vb = pow (vh, 0.4996667741545416);
+  a0 = 1.0 + k / q + k * k;
+  loud->kw [0].b0 = (vh + vb * k / q + k * k) / a0;
+  loud->kw [0].b1 = 2.0 * (k * k - vh) / a0;
+  loud->kw [0].b2 = (vh - vb * k / q + k * k) / a0;
+  loud->kw [0].a1 = 2.0 * (k * k - 1.0) / a0;
+  loud->kw [0].a2 = (1.0 - k / q + k * k) / a0;
+
+  /* stage two: high pass */
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = tan (M_PI * f0 / (double) LOUDNESS_RATE);
+  a0 = 1.0 + k / q + k * k;
+  loud->kw [1].b0 = 1.0;
+  loud->kw [1].b1 = -2.0;
+  loud->kw [1].b2 = 1.0;
+  loud->kw [1].a1 = 2.0 * (k * k - 1.0) / a0;
+  loud->kw [1].a2 = (1.0 - k / q + k * k) / a0;
+
+  /* the true peak interpolation filter: a windowed sinc, one set */
+  /* of coefficients per phase.  phase zero is the sample itself. */
+  for (int p = 0; p < LOUD_TP_PHASES; ++p) {
+    double  sum = 0.0;
+    double  c [LOUD_TP_TAPS];
+
+    for (int i = 0; i < LOUD_TP_TAPS; ++i) {
+      double  x;
+
+      x = (double) (LOUD_TP_TAPS / 2 - i) -
+          (double) p / (double) LOUD_TP_PHASES;
+      c [i] = 1.0;
+      if (x != 0.0) {
+        c [i] = sin (M_PI * x) / (M_PI * x);
+      }
+      c [i] *= 0.5 + 0.5 * cos (M_PI * x / (double) (LOUD_TP_TAPS / 2 + 1));
+      sum += c [i];
+    }
+    for (int i = 0; i < LOUD_TP_TAPS; ++i) {
+      loud->tpcoef [p][i] = (float) (c [i] / sum);
+    }
+  }
+
+  loudnessReset (loud);
+  return loud;
+}
+
+void
+loudnessFree (loudness_t *loud)
+{
+  if (loud == NULL) {
+    return;
+  }
+
+  dataFree (loud->blocks);
+  mdfree (loud);
+}
+
+void
+loudnessReset (loudness_t *loud)
+{
+  if (loud == NULL) {
+    return;
+  }
+
+  for (int ch = 0; ch < LOUDNESS_CHANNELS; ++ch) {
+    for (int i = 0; i < LOUD_BIQUAD_MAX; ++i) {
+      loud->z [ch][i][0] = 0.0;
+      loud->z [ch][i][1] = 0.0;
+    }
+    for (int i = 0; i < LOUD_TP_TAPS * 2; ++i) {
+      loud->tphist [ch][i] = 0.0f;
+    }
+  }
+  loud->subsum = 0.0;
+  loud->subfill = 0;
+  loud->subcount = 0;
+  loud->blockcount = 0;
+  loud->tpidx = 0;
+  loud->peak = 0.0;
+}
+
+/* samples : stereo, interleaved, at LOUDNESS_RATE */
+/* count : the number of sample frames */
+void
+loudnessAddSamples (loudness_t *loud, const float *samples, int count)
+{
+  if (loud == NULL || samples == NULL) {
+    return;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    int     hidx;
+
+    hidx = loud->tpidx;
+    for (int ch = 0; ch < LOUDNESS_CHANNELS; ++ch) {
+      double  y;
+      float   *hist;
+
+      y = samples [ch];
+      for (int j = 0; j < LOUD_BIQUAD_MAX; ++j) {
+        loudbiquad_t  *bq = &loud->kw [j];
+        double        *z = loud->z [ch][j];
+        double        out;
+
+        /* transposed direct form II */
+        out = bq->b0 * y + z [0];
+        z [0] = bq->b1 * y - bq->a1 * out + z [1];
+        z [1] = bq->b2 * y - bq->a2 * out;
+        y = out;
+      }
+      loud->subsum += y * y;
+
+      hist = loud->tphist [ch];
+      hist [hidx] = samples [ch];
+      hist [hidx + LOUD_TP_TAPS] = samples [ch];
+      /* hist [hidx + 1] is the oldest sample, */
+      /* hist [hidx + LOUD_TP_TAPS] is the newest */
+      for (int p = 0; p < LOUD_TP_PHASES; ++p) {
+        const float *coef = loud->tpcoef [p];
+        const float *h = hist + hidx + 1;
+        float       v = 0.0f;
+
+        for (int k = 0; k < LOUD_TP_TAPS; ++k) {
+          v += coef [LOUD_TP_TAPS - 1 - k] * h [k];
+        }
+        v = fabsf (v);
+        if (v > loud->peak) {
+          loud->peak = v;
+        }
+      }
+    }
+    loud->tpidx = (loud->tpidx + 1) % LOUD_TP_TAPS;
+    samples += LOUDNESS_CHANNELS;
+
+    ++loud->subfill;
+    if (loud->subfill < LOUD_SUB_LEN) {
+      continue;
+    }
+
+    /* a sub-block is complete */
+    memmove (loud->sub, loud->sub + 1, sizeof (double) * (LOUD_SUB_COUNT - 1));
+    loud->sub [LOUD_SUB_COUNT - 1] = loud->subsum;
+    loud->subsum = 0.0;
+    loud->subfill = 0;
+    if (loud->subcount < LOUD_SUB_COUNT) {
+      ++loud->subcount;
+    }
+    if (loud->subcount < LOUD_SUB_COUNT) {
+      continue;
+    }
+
+    if (loud->blockcount >= loud->blockalloc) {
+      loud->blockalloc += LOUD_BLOCK_CHUNK;
+      loud->blocks = mdrealloc (loud->blocks,
+          sizeof (double) * loud->blockalloc);
+    }
+    loud->blocks [loud->blockcount] =
+        (loud->sub [0] + loud->sub [1] + loud->sub [2] + loud->sub [3]) /
+        (double) (LOUD_SUB_LEN * LOUD_SUB_COUNT);
+    ++loud->blockcount;
+  }
+}
+
+/* the audio file is decoded and analyzed */
+int
+loudnessFile (loudness_t *loud, aafilter_t *aaf, const char *fn)
+{
+  if (loud == NULL) {
+    return -1;
+  }
+
+  loudnessReset (loud);
+  return aafilterSamples (aaf, fn, 0, 0, LOUDNESS_RATE, LOUDNESS_CHANNELS,
+      loudnessSampleCallback, loud);
+}
+
+/* returns the integrated loudness in LUFS */
+/* returns LOUDNESS_NONE if no block is above the absolute gate */
+double
+loudnessIntegrated (loudness_t *loud)
+{
+  double    absgate;
+  double    relgate;
+  double    sum = 0.0;
+  size_t    count = 0;
+
+  if (loud == NULL) {
+    return LOUDNESS_NONE;
+  }
+
+  absgate = loudnessEnergy (LOUD_ABS_GATE);
+  for (size_t i = 0; i < loud->blockcount; ++i) {
+    if (loud->blocks [i] > absgate) {
+      sum += loud->blocks [i];
+      ++count;
+    }
+  }
+  if (count == 0) {
+    return LOUDNESS_NONE;
+  }
+
+  relgate = loudnessEnergy (loudnessLUFS (sum / (double) count) + LOUD_REL_GATE);
+  if (relgate < absgate) {
+    relgate = absgate;
+  }
+  sum = 0.0;
+  count = 0;
+  for (size_t i = 0; i < loud->blockcount; ++i) {
+    if (loud->blocks [i] > relgate) {
+      sum += loud->blocks [i];
+      ++count;
+    }
+  }
+  if (count == 0) {
+    return LOUDNESS_NONE;
+  }
+
+  return loudnessLUFS (sum / (double) count);
+}
+
+/* returns the true peak in dBTP */
+double
+loudnessTruePeak (loudness_t *loud)
+{
+  double    val;
+
+  if (loud == NULL || loud->peak <= 0.0) {
+    return LOUDNESS_NONE;
+  }
+
+  val = 20.0 * log10 (loud->peak);
+  if (val < LOUDNESS_NONE) {
+    val = LOUDNESS_NONE;
+  }
+  return val;
+}
+
+/* returns the volume adjustment percentage that will move the */
+/* song's loudness to the target. */
+/* the system volume controls use a cubic scale (pulseaudio, pipewire), */
+/* for other systems this is an approximation. */
+double
+loudnessVolumeAdjust (double lufs, double truepeak, double target)
+{
+  double    gain;
+  double    perc;
+
+  if (lufs <= LOUDNESS_NONE) {
+    return 0.0;
+  }
+
+  gain = target - lufs;
+  if (gain > 0.0 && truepeak + gain > LOUDNESS_MAX_TRUE_PEAK) {
+    gain = LOUDNESS_MAX_TRUE_PEAK - truepeak;
+    if (gain < 0.0) {
+      gain = 0.0;
+    }
+  }
+
+  perc = (cbrt (pow (10.0, gain / 20.0)) - 1.0) * 100.0;
+  if (perc > LOUDNESS_ADJ_MAX) {
+    perc = LOUDNESS_ADJ_MAX;
+  }
+  if (perc < - LOUDNESS_ADJ_MAX) {
+    perc = - LOUDNESS_ADJ_MAX;
+  }
+  return round (perc * 10.0) / 10.0;
+}
+
+/* internal routines */
+
+static void
+loudnessSampleCallback (void *udata, const float *samples, int count)
+{
+  loudnessAddSamples (udata, samples, count);
+}
+
+static double
+loudnessLUFS (double energy)
+{
+  return -0.691 + 10.0 * log10 (energy);
+}
+
+static double
+loudnessEnergy (double lufs)
+{
+  return pow (10.0, (lufs + 0.691) / 10.0);
+}
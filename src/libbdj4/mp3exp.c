@@ -10,6 +10,7 @@
 #include <string.h>
 #include <inttypes.h>
 
+#include "aafilter.h"
 #include "audioadjust.h"
 #include "audiofile.h"
 #include "audiosrc.h"
@@ -28,21 +29,44 @@
 #include "song.h"
 #include "tagdef.h"
 #include "tmutil.h"
+#include "workpool.h"
+
+enum {
+  /* the number of songs queued per worker thread */
+  MP3EXP_QUEUE_PER_THREAD = 2,
+};
+
+typedef struct {
+  dbidx_t     dbidx;
+  char        infn [MAXPATHLEN];
+  char        outfn [MAXPATHLEN];
+  aaparam_t   aap;
+  int         rc;
+} mp3job_t;
 
 typedef struct mp3exp {
-  char      *msgdata;
-  musicdb_t *musicdb;
-  char      *dirname;
-  int       mqidx;
-  nlist_t   *savelist;
-  int       counter;
-  int       totcount;
-  char      *tokstr;
-  int       state;
-  int       fadein;
-  int       fadeout;
+  char        *msgdata;
+  musicdb_t   *musicdb;
+  char        *dirname;
+  int         mqidx;
+  nlist_t     *savelist;
+  int         counter;
+  int         donecount;
+  int         totcount;
+  int         queued;
+  char        *tokstr;
+  int         state;
+  int         fadein;
+  int         fadeout;
+  workpool_t  *wp;
+  aafilter_t  **aaf;
+  int         numthreads;
 } mp3exp_t;
 
+static bool mp3ExportQueueSong (mp3exp_t *mp3exp);
+static void mp3ExportWorker (void *udata, void *job, int thridx);
+static void mp3ExportFinishSong (mp3exp_t *mp3exp, mp3job_t *job);
+
 mp3exp_t *
 mp3ExportInit (char *msgdata, musicdb_t *musicdb,
     const char *dirname, int mqidx)
@@ -56,11 +80,16 @@ mp3ExportInit (char *msgdata, musicdb_t *musicdb,
   mp3exp->mqidx = mqidx;
   mp3exp->savelist = NULL;
   mp3exp->counter = 0;
+  mp3exp->donecount = 0;
   mp3exp->totcount = 0;
+  mp3exp->queued = 0;
   mp3exp->tokstr = NULL;
   mp3exp->fadein = bdjoptGetNumPerQueue (OPT_Q_FADEINTIME, mqidx);
   mp3exp->fadeout = bdjoptGetNumPerQueue (OPT_Q_FADEOUTTIME, mqidx);
   mp3exp->state = BDJ4_STATE_START;
+  mp3exp->wp = NULL;
+  mp3exp->aaf = NULL;
+  mp3exp->numthreads = 0;
 
   return mp3exp;
 }
@@ -69,6 +98,28 @@ void
 mp3ExportFree (mp3exp_t *mp3exp)
 {
   if (mp3exp != NULL) {
+    if (mp3exp->wp != NULL) {
+      mp3job_t  *job;
+      bool      cancelled;
+
+      /* wait for any running songs to finish */
+      workpoolCancel (mp3exp->wp);
+      while (! workpoolIsIdle (mp3exp->wp)) {
+        job = workpoolProcess (mp3exp->wp, &cancelled);
+        if (job == NULL) {
+          mssleep (10);
+          continue;
+        }
+        mdfree (job);
+      }
+      workpoolFree (mp3exp->wp);
+    }
+    if (mp3exp->aaf != NULL) {
+      for (int i = 0; i < mp3exp->numthreads; ++i) {
+        aafilterFree (mp3exp->aaf [i]);
+      }
+      mdfree (mp3exp->aaf);
+    }
     dataFree (mp3exp->dirname);
     dataFree (mp3exp->msgdata);
     nlistFree (mp3exp->savelist);
@@ -76,13 +127,20 @@ mp3ExportFree (mp3exp_t *mp3exp)
   }
 }
 
+/* count is the song currently being processed */
 void
 mp3ExportGetCount (mp3exp_t *mp3exp, int *count, int *tot)
 {
-  *count = mp3exp->counter;
+  *count = mp3exp->donecount + 1;
+  if (*count > mp3exp->totcount) {
+    *count = mp3exp->totcount;
+  }
   *tot = mp3exp->totcount;
 }
 
+/* the songs are converted by a pool of worker threads */
+/* the tags are written by the main thread as each song finishes */
+/* returns true when the export is complete */
 bool
 mp3ExportQueue (mp3exp_t *mp3exp)
 {
@@ -99,77 +157,41 @@ mp3ExportQueue (mp3exp_t *mp3exp)
       return true;
     }
     mp3exp->totcount = atoi (p);
+
+    mp3exp->wp = workpoolAlloc ("mp3-export", 0, mp3ExportWorker, mp3exp);
+    mp3exp->numthreads = workpoolThreadCount (mp3exp->wp);
+    /* each thread has its own audio filter */
+    mp3exp->aaf = mdmalloc (sizeof (aafilter_t *) * mp3exp->numthreads);
+    for (int i = 0; i < mp3exp->numthreads; ++i) {
+      mp3exp->aaf [i] = aafilterAlloc ();
+    }
+
     mp3exp->state = BDJ4_STATE_PROCESS;
     return false;
   }
 
   if (mp3exp->state == BDJ4_STATE_PROCESS) {
-    char    outfn [MAXPATHLEN];
-    char    ffn [MAXPATHLEN];
-
-    p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
-    if (p != NULL) {
-      dbidx_t dbidx;
-      long    dur;
-      int     gap;
-      song_t  *song;
-      void    *savedtags = NULL;
-      slist_t *taglist;
-      int     owrite;
-      int     intagtype, outtagtype;
-      int     infiletype, outfiletype;
-
-      dbidx = atol (p);
-      p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
-      if (p == NULL) {
-        return false;
-      }
-      dur = atol (p);
-      p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
-      if (p == NULL) {
-        return false;
-      }
-      gap = atol (p);
+    mp3job_t  *job;
+    bool      cancelled;
+    bool      more = true;
 
-      song = dbGetByIdx (mp3exp->musicdb, dbidx);
-      if (song == NULL) {
-        return false;
-      }
-      audiosrcFullPath (songGetStr (song, TAG_URI), ffn, sizeof (ffn), NULL, 0);
-      pi = pathInfo (ffn);
-
-      snprintf (outfn, sizeof (outfn), "%s/%03d-%.*s.mp3",
-          mp3exp->dirname, mp3exp->counter, (int) pi->blen, pi->basename);
-
-      nlistSetStr (mp3exp->savelist, dbidx, outfn);
+    /* keep the workers busy, but do not parse the entire list at once */
+    while (more &&
+        mp3exp->queued < mp3exp->numthreads * MP3EXP_QUEUE_PER_THREAD) {
+      more = mp3ExportQueueSong (mp3exp);
+    }
 
-      audiotagDetermineTagType (ffn, &intagtype, &infiletype);
-      audiotagDetermineTagType (outfn, &outtagtype, &outfiletype);
-      if (intagtype == outtagtype && infiletype == outfiletype) {
-        savedtags = audiotagSaveTags (ffn);
-      }
-      aaAdjust (mp3exp->musicdb, song, ffn, outfn,
-          dur, mp3exp->fadein, mp3exp->fadeout, gap);
-      if (intagtype == outtagtype && infiletype == outfiletype) {
-        audiotagRestoreTags (outfn, savedtags);
-        audiotagFreeSavedTags (outfn, savedtags);
-        savedtags = NULL;
+    /* write the tags for the songs that have finished */
+    while ((job = workpoolProcess (mp3exp->wp, &cancelled)) != NULL) {
+      if (! cancelled) {
+        mp3ExportFinishSong (mp3exp, job);
       }
-
-      /* always write the tags, they may have been updated by aaAdjust() */
-      taglist = songTagList (song);
-      owrite = bdjoptGetNum (OPT_G_WRITETAGS);
-      bdjoptSetNum (OPT_G_WRITETAGS, WRITE_TAGS_ALL);
-      audiotagWriteTags (outfn, NULL, taglist, AF_REWRITE_NONE, AT_KEEP_MOD_TIME);
-      bdjoptSetNum (OPT_G_WRITETAGS, owrite);
-      slistFree (taglist);
-
-      pathInfoFree (pi);
-
-      ++mp3exp->counter;
+      --mp3exp->queued;
+      ++mp3exp->donecount;
+      mdfree (job);
     }
 
-    if (p == NULL) {
+    if (! more && workpoolIsIdle (mp3exp->wp)) {
       mp3exp->state = BDJ4_STATE_FINISH;
     }
     return false;
@@ -194,3 +216,110 @@ mp3ExportQueue (mp3exp_t *mp3exp)
   /* off */
   return true;
 }
+
+/* internal routines */
+
+/* returns false when there are no more songs */
+static bool
+mp3ExportQueueSong (mp3exp_t *mp3exp)
+{
+  pathinfo_t  *pi = NULL;
+  char        *p = NULL;
+  mp3job_t    *job;
+  dbidx_t     dbidx;
+  long        dur;
+  int         gap;
+  song_t      *song;
+
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
+  if (p == NULL) {
+    return false;
+  }
+  dbidx = atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
+  if (p == NULL) {
+    return false;
+  }
+  dur = atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &mp3exp->tokstr);
+  if (p == NULL) {
+    return false;
+  }
+  gap = atol (p);
+
+  song = dbGetByIdx (mp3exp->musicdb, dbidx);
+  if (song == NULL) {
+    return true;
+  }
+
+  job = mdmalloc (sizeof (mp3job_t));
+  job->dbidx = dbidx;
+  job->rc = -1;
+  audiosrcFullPath (songGetStr (song, TAG_URI), job->infn,
+      sizeof (job->infn), NULL, 0);
+  pi = pathInfo (job->infn);
+  /* the output file names are numbered in the order of the queue */
+  snprintf (job->outfn, sizeof (job->outfn), "%s/%03d-%.*s.mp3",
+      mp3exp->dirname, mp3exp->counter, (int) pi->blen, pi->basename);
+  pathInfoFree (pi);
+
+  nlistSetStr (mp3exp->savelist, dbidx, job->outfn);
+
+  /* the song data is gathered here, the worker may not access the */
+  /* database or the options */
+  aaGetParams (song, &job->aap, dur, mp3exp->fadein, mp3exp->fadeout, gap);
+
+  ++mp3exp->counter;
+  ++mp3exp->queued;
+  workpoolAdd (mp3exp->wp, job);
+  return true;
+}
+
+/* runs in a worker thread */
+static void
+mp3ExportWorker (void *udata, void *tjob, int thridx)
+{
+  mp3exp_t  *mp3exp = udata;
+  mp3job_t  *job = tjob;
+
+  job->rc = aaAdjustFile (mp3exp->aaf [thridx], &job->aap,
+      job->infn, job->outfn);
+}
+
+static void
+mp3ExportFinishSong (mp3exp_t *mp3exp, mp3job_t *job)
+{
+  song_t  *song;
+  void    *savedtags = NULL;
+  slist_t *taglist;
+  int     owrite;
+  int     intagtype, outtagtype;
+  int     infiletype, outfiletype;
+
+  song = dbGetByIdx (mp3exp->musicdb, job->dbidx);
+  if (song == NULL) {
+    return;
+  }
+
+  audiotagDetermineTagType (job->infn, &intagtype, &infiletype);
+  audiotagDetermineTagType (job->outfn, &outtagtype, &outfiletype);
+  if (intagtype == outtagtype && infiletype == outfiletype) {
+    savedtags = audiotagSaveTags (job->infn);
+    audiotagRestoreTags (job->outfn, savedtags);
+    audiotagFreeSavedTags (job->outfn, savedtags);
+    savedtags = NULL;
+  }
+
+  /* the duration is also used by the m3u export */
+  if (job->rc == 0) {
+    aaSetDuration (song, job->outfn);
+  }
+
+  /* always write the tags, they may have been updated */
+  taglist = songTagList (song);
+  owrite = bdjoptGetNum (OPT_G_WRITETAGS);
+  bdjoptSetNum (OPT_G_WRITETAGS, WRITE_TAGS_ALL);
+  audiotagWriteTags (job->outfn, NULL, taglist, AF_REWRITE_NONE, AT_KEEP_MOD_TIME);
+  bdjoptSetNum (OPT_G_WRITETAGS, owrite);
+  slistFree (taglist);
+}
@@ -19,74 +19,447 @@
 #include "msgparse.h"
 #include "nlist.h"
 
+enum {
+  /* a delta is not sent if there are too many operations */
+  MP_MQ_DELTA_MIN_OPS = 10,
+  MP_MQ_DISPIDX_NEW = -1,
+};
+
+/* binary field types */
+enum {
+  MP_TLV_PS_REPEAT = 1,
+  MP_TLV_PS_PAUSEATEND,
+  MP_TLV_PS_CURRVOL,
+  MP_TLV_PS_CURRSPEED,
+  MP_TLV_PS_BASEVOL,
+  MP_TLV_PS_PLAYEDTIME,
+  MP_TLV_PS_DURATION,
+};
+
+enum {
+  MP_TLV_MQS_DBIDX = 1,
+  MP_TLV_MQS_UNIQUEIDX,
+};
+
 static void msgparseMusicQueueDispFree (void *data);
+static int  msgparseMusicQueueDeltaApply (mp_musicqupdate_t *musicqupdate, char *tokstr, int dispbase);
+static mp_musicqupditem_t ** msgparseMusicQueueWorkGrow (mp_musicqupditem_t **work, nlistidx_t *walloc, nlistidx_t wcount);
 
 mp_musicqupdate_t *
-msgparseMusicQueueData (char *data)
+msgparseMusicQueueAlloc (musicqidx_t mqidx)
 {
-  int               mqidx = 0;
-  char              *p;
-  char              *tokstr;
-  int               idx;
-  mp_musicqupditem_t   *musicqupditem;
   mp_musicqupdate_t    *musicqupdate;
 
-
   musicqupdate = mdmalloc (sizeof (mp_musicqupdate_t));
-  musicqupdate->mqidx = 0;
+  musicqupdate->mqidx = mqidx;
+  musicqupdate->seq = 0;
   musicqupdate->tottime = 0;
   musicqupdate->currdbidx = -1;
-
-  /* first, build ourselves a list to work with */
-  musicqupdate->dispList = nlistAlloc ("temp-musicq-disp", LIST_UNORDERED,
+  /* the items are always appended in order */
+  musicqupdate->dispList = nlistAlloc ("musicq-disp", LIST_ORDERED,
       msgparseMusicQueueDispFree);
+  return musicqupdate;
+}
 
-  p = strtok_r (data, MSG_ARGS_RS_STR, &tokstr);
-  if (p != NULL) {
-    mqidx = atoi (p);
-    musicqupdate->mqidx = mqidx;
+void
+msgparseMusicQueueAppend (mp_musicqupdate_t *musicqupdate, int dispidx,
+    int32_t uniqueidx, dbidx_t dbidx, int pauseind)
+{
+  mp_musicqupditem_t   *musicqupditem;
+
+  if (musicqupdate == NULL) {
+    return;
   }
 
-  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
-  if (p != NULL) {
-    /* queue duration */
-    musicqupdate->tottime = atol (p);
+  musicqupditem = mdmalloc (sizeof (mp_musicqupditem_t));
+  musicqupditem->dispidx = dispidx;
+  musicqupditem->uniqueidx = uniqueidx;
+  musicqupditem->dbidx = dbidx;
+  musicqupditem->pauseind = pauseind;
+  nlistSetData (musicqupdate->dispList,
+      nlistGetCount (musicqupdate->dispList), musicqupditem);
+}
+
+/*
+ * The complete music queue data is sent in parts if it does not fit
+ * in one message.  Each part has the total number of items and the
+ * position of its first item.
+ * 'start' is the position of the first item to add, and is updated to
+ * the position of the next item.
+ * Returns true when the last part has been built.
+ */
+bool
+msgbuildMusicQueueData (char *buff, size_t sz,
+    mp_musicqupdate_t *musicqupdate, nlistidx_t *start)
+{
+  char                tbuff [200];
+  char                *p;
+  char                *end;
+  nlistidx_t          count;
+  nlistidx_t          idx;
+  mp_musicqupditem_t  *musicqupditem;
+
+  count = nlistGetCount (musicqupdate->dispList);
+  snprintf (buff, sz, "%d%c%" PRId32 "%c%" PRId32 "%c%" PRId32 "%c%" PRId32 "%c%" PRId32 "%c",
+      musicqupdate->mqidx, MSG_ARGS_RS, musicqupdate->seq, MSG_ARGS_RS,
+      musicqupdate->tottime, MSG_ARGS_RS,
+      musicqupdate->currdbidx, MSG_ARGS_RS,
+      count, MSG_ARGS_RS, *start, MSG_ARGS_RS);
+  p = buff + strlen (buff);
+  end = buff + sz;
+
+  for (idx = *start; idx < count; ++idx) {
+    musicqupditem = nlistGetDataByIdx (musicqupdate->dispList, idx);
+    snprintf (tbuff, sizeof (tbuff),
+        "%d%c%" PRId32 "%c%" PRId32 "%c%d%c",
+        musicqupditem->dispidx, MSG_ARGS_RS,
+        musicqupditem->uniqueidx, MSG_ARGS_RS,
+        musicqupditem->dbidx, MSG_ARGS_RS,
+        musicqupditem->pauseind, MSG_ARGS_RS);
+    /* do not send a partial item */
+    if ((size_t) (end - p) <= strlen (tbuff)) {
+      break;
+    }
+    p = stpecpy (p, end, tbuff);
+  }
+
+  if (idx == *start && idx < count) {
+    /* not even one item fits, do not loop forever */
+    logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: music queue %d data: buffer too small",
+        musicqupdate->mqidx);
+    idx = count;
   }
+  *start = idx;
+
+  return idx >= count;
+}
 
+/*
+ * Builds the list of operations that changes the queue display list in
+ * 'prev' into the display list in 'curr'.
+ * Returns false if a delta cannot be used, and the complete music
+ * queue data must be sent instead.
+ */
+bool
+msgbuildMusicQueueDelta (char *buff, size_t sz,
+    mp_musicqupdate_t *prev, mp_musicqupdate_t *curr)
+{
+  char                tbuff [200];
+  char                *p;
+  char                *end;
+  nlistidx_t          pcount;
+  nlistidx_t          ccount;
+  nlistidx_t          wcount;
+  nlist_t             *prevset = NULL;
+  nlist_t             *currset = NULL;
+  mp_musicqupditem_t  **work = NULL;
+  mp_musicqupditem_t  *musicqupditem;
+  int                 dispbase = 0;
+  int                 opcount = 0;
+  bool                rc = true;
+
+  if (prev == NULL || curr == NULL || prev->mqidx != curr->mqidx) {
+    return false;
+  }
+
+  pcount = nlistGetCount (prev->dispList);
+  ccount = nlistGetCount (curr->dispList);
+
+  /* the receiver re-numbers the display indexes, */
+  /* which only works if they are sequential */
+  if (ccount > 0) {
+    musicqupditem = nlistGetDataByIdx (curr->dispList, 0);
+    dispbase = musicqupditem->dispidx;
+    for (nlistidx_t i = 1; i < ccount; ++i) {
+      musicqupditem = nlistGetDataByIdx (curr->dispList, i);
+      if (musicqupditem->dispidx != dispbase + i) {
+        return false;
+      }
+    }
+  }
+
+  prevset = nlistAlloc ("mq-delta-prev", LIST_UNORDERED, NULL);
+  nlistSetSize (prevset, pcount);
+  work = mdmalloc (sizeof (mp_musicqupditem_t *) * (size_t) (pcount + ccount + 1));
+  wcount = 0;
+  for (nlistidx_t i = 0; i < pcount; ++i) {
+    musicqupditem = nlistGetDataByIdx (prev->dispList, i);
+    nlistSetNum (prevset, musicqupditem->uniqueidx, i);
+    work [wcount++] = musicqupditem;
+  }
+  nlistSort (prevset);
+
+  currset = nlistAlloc ("mq-delta-curr", LIST_UNORDERED, NULL);
+  nlistSetSize (currset, ccount);
+  for (nlistidx_t i = 0; i < ccount; ++i) {
+    musicqupditem = nlistGetDataByIdx (curr->dispList, i);
+    nlistSetNum (currset, musicqupditem->uniqueidx, i);
+  }
+  nlistSort (currset);
+
+  snprintf (buff, sz, "%d%c%" PRId32 "%c%" PRId32 "%c%" PRId32 "%c%d%c",
+      curr->mqidx, MSG_ARGS_RS, curr->seq, MSG_ARGS_RS,
+      curr->tottime, MSG_ARGS_RS, curr->currdbidx, MSG_ARGS_RS,
+      dispbase, MSG_ARGS_RS);
+  p = buff + strlen (buff);
+  end = buff + sz;
+
+  /* removals are processed first, from the end of the list, */
+  /* so that the positions stay valid */
+  for (nlistidx_t i = wcount - 1; i >= 0; --i) {
+    if (nlistGetNum (currset, work [i]->uniqueidx) != LIST_VALUE_INVALID) {
+      continue;
+    }
+    snprintf (tbuff, sizeof (tbuff), "%c%c%" PRId32 "%c",
+        MP_MQ_DELTA_REMOVE, MSG_ARGS_RS, i, MSG_ARGS_RS);
+    p = stpecpy (p, end, tbuff);
+    memmove (&work [i], &work [i + 1],
+        sizeof (mp_musicqupditem_t *) * (size_t) (wcount - i - 1));
+    --wcount;
+    ++opcount;
+  }
+
+  for (nlistidx_t i = 0; i < ccount; ++i) {
+    mp_musicqupditem_t  *citem;
+    nlistidx_t          j;
+
+    citem = nlistGetDataByIdx (curr->dispList, i);
+
+    if (i < wcount && work [i]->uniqueidx == citem->uniqueidx) {
+      /* a change of the database index is a change of the entry itself */
+      if (work [i]->dbidx != citem->dbidx) {
+        rc = false;
+        break;
+      }
+    } else if (nlistGetNum (prevset, citem->uniqueidx) != LIST_VALUE_INVALID) {
+      /* the entry is still in the working list, past this position */
+      for (j = i + 1; j < wcount; ++j) {
+        if (work [j]->uniqueidx == citem->uniqueidx) {
+          break;
+        }
+      }
+      if (j >= wcount || work [j]->dbidx != citem->dbidx) {
+        rc = false;
+        break;
+      }
+      snprintf (tbuff, sizeof (tbuff), "%c%c%" PRId32 "%c%" PRId32 "%c",
+          MP_MQ_DELTA_MOVE, MSG_ARGS_RS, j, MSG_ARGS_RS, i, MSG_ARGS_RS);
+      p = stpecpy (p, end, tbuff);
+      musicqupditem = work [j];
+      memmove (&work [i + 1], &work [i],
+          sizeof (mp_musicqupditem_t *) * (size_t) (j - i));
+      work [i] = musicqupditem;
+      ++opcount;
+    } else {
+      snprintf (tbuff, sizeof (tbuff),
+          "%c%c%" PRId32 "%c%" PRId32 "%c%" PRId32 "%c%d%c",
+          MP_MQ_DELTA_INSERT, MSG_ARGS_RS, i, MSG_ARGS_RS,
+          citem->uniqueidx, MSG_ARGS_RS, citem->dbidx, MSG_ARGS_RS,
+          citem->pauseind, MSG_ARGS_RS);
+      p = stpecpy (p, end, tbuff);
+      memmove (&work [i + 1], &work [i],
+          sizeof (mp_musicqupditem_t *) * (size_t) (wcount - i));
+      work [i] = citem;
+      ++wcount;
+      ++opcount;
+    }
+
+    if (work [i]->pauseind != citem->pauseind) {
+      snprintf (tbuff, sizeof (tbuff), "%c%c%" PRId32 "%c%d%c",
+          MP_MQ_DELTA_FLAG, MSG_ARGS_RS, i, MSG_ARGS_RS,
+          citem->pauseind, MSG_ARGS_RS);
+      p = stpecpy (p, end, tbuff);
+      ++opcount;
+    }
+    work [i] = citem;
+
+    if (opcount > ccount / 2 + MP_MQ_DELTA_MIN_OPS) {
+      rc = false;
+      break;
+    }
+  }
+
+  if (wcount != ccount) {
+    rc = false;
+  }
+  /* stpecpy returns 'end' if the buffer is too small */
+  if (p == end) {
+    rc = false;
+  }
+
+  dataFree (work);
+  nlistFree (prevset);
+  nlistFree (currset);
+  return rc;
+}
+
+/*
+ * Parses one part of the complete music queue data.
+ * The parts are collected in 'pending'.  Once all of the parts have been
+ * received, MSGPARSE_MQ_OK is returned, and the caller takes ownership of
+ * 'pending'.  MSGPARSE_MQ_PARTIAL is returned if more parts are expected.
+ * If a part is missing, 'pending' is freed and MSGPARSE_MQ_RESYNC is
+ * returned.  The caller must then request the complete music queue data.
+ */
+int
+msgparseMusicQueueData (mp_musicqupdate_t **pending, char *data)
+{
+  char                *p;
+  char                *tokstr;
+  mp_musicqupdate_t   *musicqupdate;
+  int                 mqidx;
+  int32_t             seq;
+  int32_t             tottime;
+  dbidx_t             currdbidx;
+  nlistidx_t          total;
+  nlistidx_t          start;
+  int                 dispidx;
+  int32_t             uniqueidx;
+  dbidx_t             dbidx;
+  int                 pauseind;
+
+  if (pending == NULL || data == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+
+  p = strtok_r (data, MSG_ARGS_RS_STR, &tokstr);
+  mqidx = p == NULL ? 0 : atoi (p);
   p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
-  if (p != NULL) {
-    /* currently playing dbidx (music queue index 0) */
-    musicqupdate->currdbidx = atol (p);
+  /* sequence number */
+  seq = p == NULL ? 0 : atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  /* queue duration */
+  tottime = p == NULL ? 0 : atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  /* currently playing dbidx (music queue index 0) */
+  currdbidx = p == NULL ? -1 : atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  /* total number of items in all of the parts */
+  total = p == NULL ? 0 : atol (p);
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  /* position of the first item in this part */
+  start = p == NULL ? -1 : atol (p);
+
+  if (start == 0) {
+    msgparseMusicQueueDataFree (*pending);
+    *pending = msgparseMusicQueueAlloc (mqidx);
+    (*pending)->seq = seq;
+    (*pending)->tottime = tottime;
+    (*pending)->currdbidx = currdbidx;
+  }
+
+  musicqupdate = *pending;
+  if (musicqupdate == NULL ||
+      (int) musicqupdate->mqidx != mqidx ||
+      musicqupdate->seq != seq ||
+      nlistGetCount (musicqupdate->dispList) != start) {
+    logMsg (LOG_DBG, LOG_MSGS, "music queue %d data: missing part %" PRId32,
+        mqidx, start);
+    msgparseMusicQueueDataFree (*pending);
+    *pending = NULL;
+    return MSGPARSE_MQ_RESYNC;
   }
 
   p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
-  idx = 0;
   while (p != NULL) {
-    musicqupditem = mdmalloc (sizeof (mp_musicqupditem_t));
-    musicqupditem->dispidx = atoi (p);
+    dispidx = atoi (p);
+    uniqueidx = -1;
+    dbidx = -1;
+    pauseind = false;
 
     p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
     if (p != NULL) {
-      musicqupditem->uniqueidx = atol (p);
+      uniqueidx = atol (p);
     }
-
     p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
     if (p != NULL) {
-      musicqupditem->dbidx = atol (p);
+      dbidx = atol (p);
     }
     p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
     if (p != NULL) {
-      musicqupditem->pauseind = atoi (p);
+      pauseind = atoi (p);
     }
 
-    nlistSetData (musicqupdate->dispList, idx, musicqupditem);
-
+    msgparseMusicQueueAppend (musicqupdate, dispidx, uniqueidx, dbidx, pauseind);
     p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
-    ++idx;
   }
-  nlistSort (musicqupdate->dispList);
 
-  return musicqupdate;
+  if (nlistGetCount (musicqupdate->dispList) < total) {
+    return MSGPARSE_MQ_PARTIAL;
+  }
+  if (nlistGetCount (musicqupdate->dispList) > total) {
+    msgparseMusicQueueDataFree (*pending);
+    *pending = NULL;
+    return MSGPARSE_MQ_RESYNC;
+  }
+
+  return MSGPARSE_MQ_OK;
+}
+
+/*
+ * Applies a music queue delta to the music queue data in place.
+ * If the sequence number does not follow the sequence number of the
+ * current data, or the delta cannot be applied, the current data is left
+ * as is, and MSGPARSE_MQ_RESYNC is returned.  The caller must then
+ * request the complete music queue data.
+ */
+int
+msgparseMusicQueueDelta (mp_musicqupdate_t *musicqupdate, char *data)
+{
+  char      *p;
+  char      *tokstr;
+  int32_t   seq;
+  int32_t   tottime;
+  dbidx_t   currdbidx;
+  int       dispbase;
+  int       rc;
+
+  if (musicqupdate == NULL || data == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+
+  p = strtok_r (data, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL || atoi (p) != (int) musicqupdate->mqidx) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+  seq = atol (p);
+  if (seq != musicqupdate->seq + 1) {
+    logMsg (LOG_DBG, LOG_MSGS, "music queue %d delta: seq gap %" PRId32 "/%" PRId32,
+        musicqupdate->mqidx, musicqupdate->seq, seq);
+    return MSGPARSE_MQ_RESYNC;
+  }
+
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+  tottime = atol (p);
+
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+  currdbidx = atol (p);
+
+  p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL) {
+    return MSGPARSE_MQ_RESYNC;
+  }
+  dispbase = atoi (p);
+
+  rc = msgparseMusicQueueDeltaApply (musicqupdate, tokstr, dispbase);
+  if (rc == MSGPARSE_MQ_OK) {
+    musicqupdate->seq = seq;
+    musicqupdate->tottime = tottime;
+    musicqupdate->currdbidx = currdbidx;
+  }
+
+  return rc;
 }
 
 void
@@ -142,25 +515,30 @@ msgbuildPlayerStatus (char *buff, size_t sz,
     int currvol, int currspeed, int basevol,
     uint32_t tm, int32_t dur)
 {
-  snprintf (buff, sz, "%d%c%d%c%d%c%d%c%d%c%" PRIu32 "%c%" PRId32,
-      repeat, MSG_ARGS_RS,
-      pauseatend, MSG_ARGS_RS,
-      currvol, MSG_ARGS_RS,
-      currspeed, MSG_ARGS_RS,
-      basevol, MSG_ARGS_RS,
-      tm, MSG_ARGS_RS,
-      dur);
+  size_t    offset;
+
+  offset = msgTLVInit (buff, sz);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_REPEAT, repeat);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_PAUSEATEND, pauseatend);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_CURRVOL, currvol);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_CURRSPEED, currspeed);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_BASEVOL, basevol);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_PLAYEDTIME, tm);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_PS_DURATION, dur);
+  msgTLVFinish (buff, offset);
 }
 
-
-mp_playerstatus_t *
-msgparsePlayerStatusData (char * data)
+/* the binary form is decoded in place, the text form is modified */
+void
+msgparsePlayerStatus (mp_playerstatus_t *ps, char *data)
 {
-  mp_playerstatus_t *ps = NULL;
   char              *p;
   char              *tokstr;
 
-  ps = mdmalloc (sizeof (mp_playerstatus_t));
+  if (ps == NULL) {
+    return;
+  }
+
   ps->repeat = false;
   ps->pauseatend = false;
   ps->currentVolume = 0;
@@ -169,6 +547,54 @@ msgparsePlayerStatusData (char * data)
   ps->playedtime = 0;
   ps->duration = 0;
 
+  if (data == NULL) {
+    return;
+  }
+
+  if (msgArgsIsTLV (data)) {
+    const char  *tp = NULL;
+    int         type;
+    int64_t     val;
+
+    while ((tp = msgTLVNext (data, tp, &type, &val)) != NULL) {
+      switch (type) {
+        case MP_TLV_PS_REPEAT: {
+          ps->repeat = val;
+          break;
+        }
+        case MP_TLV_PS_PAUSEATEND: {
+          ps->pauseatend = val;
+          break;
+        }
+        case MP_TLV_PS_CURRVOL: {
+          ps->currentVolume = (int) val;
+          break;
+        }
+        case MP_TLV_PS_CURRSPEED: {
+          ps->currentSpeed = (int) val;
+          break;
+        }
+        case MP_TLV_PS_BASEVOL: {
+          ps->baseVolume = (int) val;
+          break;
+        }
+        case MP_TLV_PS_PLAYEDTIME: {
+          ps->playedtime = (uint32_t) val;
+          break;
+        }
+        case MP_TLV_PS_DURATION: {
+          ps->duration = (int32_t) val;
+          break;
+        }
+        default: {
+          /* unknown fields are skipped */
+          break;
+        }
+      }
+    }
+    return;
+  }
+
   p = strtok_r (data, MSG_ARGS_RS_STR, &tokstr);
   if (p != NULL) {
     ps->repeat = atoi (p);
@@ -203,18 +629,6 @@ msgparsePlayerStatusData (char * data)
   if (p != NULL) {
     ps->duration = atol (p);
   }
-
-  return ps;
-}
-
-void
-msgparsePlayerStatusFree (mp_playerstatus_t *playerstatus)
-{
-  if (playerstatus == NULL) {
-    return;
-  }
-
-  mdfree (playerstatus);
 }
 
 void
@@ -269,7 +683,12 @@ msgbuildQueuePlaylist (char *buff, size_t sz, int mqidx,
 void
 msgbuildMusicQStatus (char *buff, size_t sz, dbidx_t dbidx, int32_t uniqueidx)
 {
-  snprintf (buff, sz, "%" PRId32 "%c%" PRId32, dbidx, MSG_ARGS_RS, uniqueidx);
+  size_t    offset;
+
+  offset = msgTLVInit (buff, sz);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_MQS_DBIDX, dbidx);
+  offset = msgTLVAddInt (buff, sz, offset, MP_TLV_MQS_UNIQUEIDX, uniqueidx);
+  msgTLVFinish (buff, offset);
 }
 
 void
@@ -282,6 +701,30 @@ msgparseMusicQStatus (mp_musicqstatus_t *mqstatus, char *data)
     return;
   }
 
+  if (msgArgsIsTLV (data)) {
+    const char  *tp = NULL;
+    int         type;
+    int64_t     val;
+
+    while ((tp = msgTLVNext (data, tp, &type, &val)) != NULL) {
+      switch (type) {
+        case MP_TLV_MQS_DBIDX: {
+          mqstatus->dbidx = (dbidx_t) val;
+          break;
+        }
+        case MP_TLV_MQS_UNIQUEIDX: {
+          mqstatus->uniqueidx = (int32_t) val;
+          break;
+        }
+        default: {
+          /* unknown fields are skipped */
+          break;
+        }
+      }
+    }
+    return;
+  }
+
   p = strtok_r (data, MSG_ARGS_RS_STR, &tokstr);
   if (p != NULL) {
     mqstatus->dbidx = atol (p);
@@ -295,6 +738,189 @@ msgparseMusicQStatus (mp_musicqstatus_t *mqstatus, char *data)
 
 /* internal routines */
 
+static int
+msgparseMusicQueueDeltaApply (mp_musicqupdate_t *musicqupdate,
+    char *tokstr, int dispbase)
+{
+  char                *p;
+  nlistidx_t          count;
+  nlistidx_t          wcount;
+  nlistidx_t          walloc;
+  nlistidx_t          rcount = 0;
+  nlistidx_t          acount = 0;
+  mp_musicqupditem_t  **work = NULL;
+  mp_musicqupditem_t  **removed = NULL;
+  mp_musicqupditem_t  **added = NULL;
+  mp_musicqupditem_t  *musicqupditem;
+  nlist_t             *ndisplist;
+  int                 rc = MSGPARSE_MQ_OK;
+
+  count = nlistGetCount (musicqupdate->dispList);
+  walloc = count + 1;
+  work = mdmalloc (sizeof (mp_musicqupditem_t *) * (size_t) walloc);
+  wcount = 0;
+  for (nlistidx_t i = 0; i < count; ++i) {
+    work [wcount++] = nlistGetDataByIdx (musicqupdate->dispList, i);
+  }
+
+  /* the current display list is not touched until the entire */
+  /* delta has been validated */
+  while (rc == MSGPARSE_MQ_OK &&
+      (p = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr)) != NULL) {
+    int           op;
+    nlistidx_t    pos;
+    nlistidx_t    topos;
+    char          *pa;
+
+    op = *p;
+    pa = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+    if (pa == NULL) {
+      rc = MSGPARSE_MQ_RESYNC;
+      break;
+    }
+    pos = atol (pa);
+    if (pos < 0 || pos > wcount ||
+        (op != MP_MQ_DELTA_INSERT && pos == wcount)) {
+      rc = MSGPARSE_MQ_RESYNC;
+      break;
+    }
+
+    switch (op) {
+      case MP_MQ_DELTA_REMOVE: {
+        removed = mdrealloc (removed,
+            sizeof (mp_musicqupditem_t *) * (size_t) (rcount + 1));
+        removed [rcount++] = work [pos];
+        memmove (&work [pos], &work [pos + 1],
+            sizeof (mp_musicqupditem_t *) * (size_t) (wcount - pos - 1));
+        --wcount;
+        break;
+      }
+      case MP_MQ_DELTA_INSERT: {
+        char    *pu;
+        char    *pd;
+        char    *pp;
+
+        pu = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+        pd = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+        pp = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+        if (pu == NULL || pd == NULL || pp == NULL) {
+          rc = MSGPARSE_MQ_RESYNC;
+          break;
+        }
+        musicqupditem = mdmalloc (sizeof (mp_musicqupditem_t));
+        /* the display index is set once the delta has been applied */
+        musicqupditem->dispidx = MP_MQ_DISPIDX_NEW;
+        musicqupditem->uniqueidx = atol (pu);
+        musicqupditem->dbidx = atol (pd);
+        musicqupditem->pauseind = atoi (pp);
+        added = mdrealloc (added,
+            sizeof (mp_musicqupditem_t *) * (size_t) (acount + 1));
+        added [acount++] = musicqupditem;
+
+        work = msgparseMusicQueueWorkGrow (work, &walloc, wcount);
+        memmove (&work [pos + 1], &work [pos],
+            sizeof (mp_musicqupditem_t *) * (size_t) (wcount - pos));
+        work [pos] = musicqupditem;
+        ++wcount;
+        break;
+      }
+      case MP_MQ_DELTA_MOVE: {
+        pa = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+        if (pa == NULL) {
+          rc = MSGPARSE_MQ_RESYNC;
+          break;
+        }
+        topos = atol (pa);
+        if (topos < 0 || topos >= wcount) {
+          rc = MSGPARSE_MQ_RESYNC;
+          break;
+        }
+        musicqupditem = work [pos];
+        if (topos < pos) {
+          memmove (&work [topos + 1], &work [topos],
+              sizeof (mp_musicqupditem_t *) * (size_t) (pos - topos));
+        } else {
+          memmove (&work [pos], &work [pos + 1],
+              sizeof (mp_musicqupditem_t *) * (size_t) (topos - pos));
+        }
+        work [topos] = musicqupditem;
+        break;
+      }
+      case MP_MQ_DELTA_FLAG: {
+        pa = strtok_r (NULL, MSG_ARGS_RS_STR, &tokstr);
+        if (pa == NULL) {
+          rc = MSGPARSE_MQ_RESYNC;
+          break;
+        }
+        musicqupditem = work [pos];
+        if (musicqupditem->dispidx != MP_MQ_DISPIDX_NEW) {
+          /* not one of the added items, copy it so that the current */
+          /* data is not modified */
+          musicqupditem = mdmalloc (sizeof (mp_musicqupditem_t));
+          memcpy (musicqupditem, work [pos], sizeof (mp_musicqupditem_t));
+          musicqupditem->dispidx = MP_MQ_DISPIDX_NEW;
+          removed = mdrealloc (removed,
+              sizeof (mp_musicqupditem_t *) * (size_t) (rcount + 1));
+          removed [rcount++] = work [pos];
+          added = mdrealloc (added,
+              sizeof (mp_musicqupditem_t *) * (size_t) (acount + 1));
+          added [acount++] = musicqupditem;
+          work [pos] = musicqupditem;
+        }
+        musicqupditem->pauseind = atoi (pa);
+        break;
+      }
+      default: {
+        rc = MSGPARSE_MQ_RESYNC;
+        break;
+      }
+    }
+  }
+
+  if (rc != MSGPARSE_MQ_OK) {
+    /* the added items are not yet owned by any list */
+    for (nlistidx_t i = 0; i < acount; ++i) {
+      mdfree (added [i]);
+    }
+    dataFree (added);
+    dataFree (removed);
+    dataFree (work);
+    return rc;
+  }
+
+  ndisplist = nlistAlloc ("musicq-disp", LIST_ORDERED,
+      msgparseMusicQueueDispFree);
+  nlistSetSize (ndisplist, wcount);
+  for (nlistidx_t i = 0; i < wcount; ++i) {
+    work [i]->dispidx = dispbase + i;
+    nlistSetData (ndisplist, i, work [i]);
+  }
+
+  /* the items that were carried over are now owned by the new list */
+  nlistSetFreeHook (musicqupdate->dispList, NULL);
+  nlistFree (musicqupdate->dispList);
+  musicqupdate->dispList = ndisplist;
+  for (nlistidx_t i = 0; i < rcount; ++i) {
+    mdfree (removed [i]);
+  }
+
+  dataFree (added);
+  dataFree (removed);
+  dataFree (work);
+  return rc;
+}
+
+static mp_musicqupditem_t **
+msgparseMusicQueueWorkGrow (mp_musicqupditem_t **work, nlistidx_t *walloc,
+    nlistidx_t wcount)
+{
+  if (wcount + 1 >= *walloc) {
+    *walloc += 20;
+    work = mdrealloc (work, sizeof (mp_musicqupditem_t *) * (size_t) *walloc);
+  }
+  return work;
+}
+
 static void
 msgparseMusicQueueDispFree (void *data)
 {
@@ -3,6 +3,7 @@
  */
 #include "config.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -29,6 +30,7 @@
 #include "song.h"
 #include "songutil.h"
 #include "tagdef.h"
+#include "tmutil.h"
 
 enum {
   MUSICDB_IDENT = 0xcc0062646973756d,
@@ -45,12 +47,14 @@ typedef struct musicdb {
   rafile_t      *radb;
   char          *fn;
   nlist_t       *tempSongs;
+  nlist_t       *changes;
   bool          inbatch;
   bool          updatelast;
 } musicdb_t;
 
 static size_t dbWriteInternalSong (musicdb_t *musicdb, const char *fn, song_t *song, dbidx_t rrn);
 static song_t *dbReadEntry (musicdb_t *musicdb, rafileidx_t rrn);
+static void   dbSetRemovedEntry (musicdb_t *musicdb, rafileidx_t rrn);
 static void   dbRebuildDanceCounts (musicdb_t *musicdb);
 
 musicdb_t *
@@ -78,6 +82,7 @@ dbOpen (const char *fn)
   musicdb->fn = mdstrdup (fn);
   /* tempsongs is ordered by dbidx */
   musicdb->tempSongs = nlistAlloc ("db-temp-songs", LIST_ORDERED, songFree);
+  musicdb->changes = NULL;
   dbLoad (musicdb);
 
   return musicdb;
@@ -101,6 +106,7 @@ dbClose (musicdb_t *musicdb)
   nlistFree (musicdb->danceCounts);
   dataFree (musicdb->fn);
   nlistFree (musicdb->tempSongs);
+  nlistFree (musicdb->changes);
   musicdb->ident = BDJ4_IDENT_FREE;
   mdfree (musicdb);
 }
@@ -118,14 +124,15 @@ dbCount (musicdb_t *musicdb)
   return tcount;
 }
 
+/* the database index is the record number less one. */
+/* a record whose audio file is missing is kept as a removed entry, */
+/* so that the database index is always the same, whether the database */
+/* was loaded or a change list was applied (see dbApplyChangeList) */
 int
 dbLoad (musicdb_t *musicdb)
 {
   song_t      *song;
-  slist_t     *templist;
   nlistidx_t  iteridx;
-  slistidx_t  dbidx;
-  slistidx_t  siteridx;
   rafileidx_t racount;
 
   if (musicdb == NULL || musicdb->ident != MUSICDB_IDENT) {
@@ -134,10 +141,6 @@ dbLoad (musicdb_t *musicdb)
 
   musicdb->radb = raOpen (musicdb->fn, MUSICDB_VERSION);
   racount = raGetCount (musicdb->radb);
-  /* the songs loaded into the templist will be re-assigned to */
-  /* the songbyidx list, and should not be freed */
-  templist = slistAlloc ("db-temp", LIST_UNORDERED, NULL);
-  slistSetSize (templist, racount);
   slistSetSize (musicdb->songbyname, racount);
   nlistSetSize (musicdb->songbyidx, racount);
   logMsg (LOG_DBG, LOG_DB, "db-load: %s %" PRId32 "\n", musicdb->fn, racount);
@@ -146,40 +149,32 @@ dbLoad (musicdb_t *musicdb)
 
   /* the random access file is indexed starting at 1 */
   for (rafileidx_t i = 1; i <= racount; ++i) {
-    song = dbReadEntry (musicdb, i);
-
-    if (song != NULL) {
-      const char  *uri = NULL;
-      nlistidx_t  dkey;
+    dbidx_t     dbidx;
+    nlistidx_t  dkey;
 
-      dkey = songGetNum (song, TAG_DANCE);
-      if (dkey >= 0) {
-        nlistIncrement (musicdb->danceCounts, dkey);
-      }
-      songSetNum (song, TAG_RRN, i);
-      uri = songGetStr (song, TAG_URI);
-      slistSetData (templist, uri, song);
-      ++musicdb->count;
+    song = dbReadEntry (musicdb, i);
+    if (song == NULL) {
+      dbSetRemovedEntry (musicdb, i);
+      continue;
     }
-  }
-
-  /* sort so that lookups can be done by uri */
-  slistSort (templist);
 
-  /* set the database index according to the sorted values */
-  /* a dual list setup is used so that the song data is easily updated */
-  /* on a rename */
+    dkey = songGetNum (song, TAG_DANCE);
+    if (dkey >= 0) {
+      nlistIncrement (musicdb->danceCounts, dkey);
+    }
 
-  dbidx = 0;
-  slistStartIterator (templist, &siteridx);
-  while ((song = slistIterateValueData (templist, &siteridx)) != NULL) {
-    slistSetNum (musicdb->songbyname, songGetStr (song, TAG_URI), dbidx);
-    nlistSetData (musicdb->songbyidx, dbidx, song);
+    /* a dual list setup is used so that the song data is easily updated */
+    /* on a rename */
+    dbidx = i - 1;
+    songSetNum (song, TAG_RRN, i);
     songSetNum (song, TAG_DBIDX, dbidx);
     songSetNum (song, TAG_DB_FLAGS, MUSICDB_STD);
-    ++dbidx;
+    slistSetNum (musicdb->songbyname, songGetStr (song, TAG_URI), dbidx);
+    nlistSetData (musicdb->songbyidx, dbidx, song);
   }
+  musicdb->count = racount;
 
+  /* sort so that lookups can be done by uri */
   slistSort (musicdb->songbyname);
   nlistSort (musicdb->songbyidx);
 
@@ -196,8 +191,6 @@ dbLoad (musicdb_t *musicdb)
     }
   }
 
-  slistFree (templist);
-
   raEndBatch (musicdb->radb);
   raClose (musicdb->radb);
   musicdb->radb = NULL;
@@ -504,6 +497,202 @@ dbAddTemporarySong (musicdb_t *musicdb, song_t *song)
   return dbidx;
 }
 
+/* the database update process records the entries that it writes */
+/* to the change list.  the other processes apply the change list to */
+/* their loaded database rather than re-loading the entire database. */
+void
+dbStartChangeList (musicdb_t *musicdb)
+{
+  if (musicdb == NULL || musicdb->ident != MUSICDB_IDENT) {
+    return;
+  }
+
+  nlistFree (musicdb->changes);
+  musicdb->changes = nlistAlloc ("db-changes", LIST_ORDERED, NULL);
+}
+
+/* writes the change list and starts a new change list */
+/* returns the serial number of the change list, or 0 on failure */
+int64_t
+dbSaveChangeList (musicdb_t *musicdb)
+{
+  char        fname [MAXPATHLEN];
+  char        tfname [MAXPATHLEN];
+  FILE        *fh;
+  nlistidx_t  iteridx;
+  dbidx_t     rrn;
+  int64_t     serial;
+
+  if (musicdb == NULL || musicdb->ident != MUSICDB_IDENT) {
+    return 0;
+  }
+  if (musicdb->changes == NULL) {
+    return 0;
+  }
+
+  snprintf (fname, sizeof (fname), "%s%s", musicdb->fn, MUSICDB_CHG_EXT);
+  snprintf (tfname, sizeof (tfname), "%s.tmp", fname);
+  fh = fileopOpen (tfname, "w");
+  if (fh == NULL) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "db-chg: unable to open %s", tfname);
+    return 0;
+  }
+
+  serial = (int64_t) mstime ();
+  fprintf (fh, "%" PRId64 "\n", serial);
+  nlistStartIterator (musicdb->changes, &iteridx);
+  while ((rrn = nlistIterateKey (musicdb->changes, &iteridx)) >= 0) {
+    fprintf (fh, "%" PRId32 "\n", rrn);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+  filemanipMove (tfname, fname);
+
+  logMsg (LOG_DBG, LOG_DB, "db-chg: save %" PRId64 " count: %" PRId32,
+      serial, nlistGetCount (musicdb->changes));
+  dbStartChangeList (musicdb);
+  return serial;
+}
+
+/* the database index is the record number less one, the same as */
+/* dbLoad(), so that a process that applies the change list and a */
+/* process that re-loads the database have the same database indexes. */
+/* new entries are added after the existing entries. */
+/* returns false if the change list cannot be applied, and the */
+/* database must be re-loaded */
+bool
+dbApplyChangeList (musicdb_t *musicdb, const char *serial)
+{
+  char        fname [MAXPATHLEN];
+  char        tbuff [40];
+  FILE        *fh;
+  nlist_t     *rrnlist;
+  nlistidx_t  iteridx;
+  song_t      *song;
+  dbidx_t     rrn;
+  dbidx_t     dbidx;
+  dbidx_t     maxrrn;
+  dbidx_t     tempidx;
+  dbidx_t     added = 0;
+  dbidx_t     updated = 0;
+  dbidx_t     removed = 0;
+  bool        ok = false;
+
+  if (musicdb == NULL || musicdb->ident != MUSICDB_IDENT) {
+    return false;
+  }
+  if (serial == NULL || ! *serial) {
+    return false;
+  }
+
+  snprintf (fname, sizeof (fname), "%s%s", musicdb->fn, MUSICDB_CHG_EXT);
+  fh = fileopOpen (fname, "r");
+  if (fh == NULL) {
+    return false;
+  }
+
+  /* the serial number must match, otherwise the change list is for */
+  /* some other database update */
+  if (fgets (tbuff, sizeof (tbuff), fh) != NULL) {
+    stringTrim (tbuff);
+    ok = strcmp (tbuff, serial) == 0;
+  }
+  rrnlist = nlistAlloc ("db-chg-list", LIST_UNORDERED, NULL);
+  while (ok && fgets (tbuff, sizeof (tbuff), fh) != NULL) {
+    nlistSetNum (rrnlist, atol (tbuff), 1);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+  nlistSort (rrnlist);
+
+  /* the new entries must not overlap the temporary songs */
+  maxrrn = 0;
+  if (nlistGetCount (rrnlist) > 0) {
+    maxrrn = nlistGetKeyByIdx (rrnlist, nlistGetCount (rrnlist) - 1);
+  }
+  nlistStartIterator (musicdb->tempSongs, &iteridx);
+  tempidx = nlistIterateKey (musicdb->tempSongs, &iteridx);
+  if (tempidx >= 0 && maxrrn > tempidx) {
+    ok = false;
+  }
+
+  if (! ok) {
+    logMsg (LOG_DBG, LOG_DB, "db-chg: %s not applied", serial);
+    nlistFree (rrnlist);
+    return false;
+  }
+
+  /* the database was written by another process, re-open the file */
+  /* so that the record count is current */
+  if (! musicdb->inbatch) {
+    raClose (musicdb->radb);
+    musicdb->radb = raOpen (musicdb->fn, MUSICDB_VERSION);
+    raStartBatch (musicdb->radb);
+  }
+
+  nlistStartIterator (rrnlist, &iteridx);
+  while ((rrn = nlistIterateKey (rrnlist, &iteridx)) >= 0) {
+    song_t      *oldsong = NULL;
+    const char  *olduri;
+    const char  *uri;
+
+    /* any records between the end of the loaded entries and */
+    /* this record are not in the change list */
+    while (musicdb->count < rrn - 1) {
+      ++musicdb->count;
+      dbSetRemovedEntry (musicdb, musicdb->count);
+    }
+
+    song = dbReadEntry (musicdb, rrn);
+    dbidx = rrn - 1;
+    if (dbidx < musicdb->count) {
+      oldsong = nlistGetData (musicdb->songbyidx, dbidx);
+    }
+
+    if (song == NULL) {
+      /* the audio file no longer exists */
+      if (oldsong != NULL) {
+        songSetNum (oldsong, TAG_DB_FLAGS, MUSICDB_REMOVED);
+      } else {
+        dbSetRemovedEntry (musicdb, rrn);
+        musicdb->count = rrn;
+      }
+      ++removed;
+      continue;
+    }
+
+    uri = songGetStr (song, TAG_URI);
+    if (oldsong == NULL) {
+      musicdb->count = rrn;
+      ++added;
+    } else {
+      olduri = songGetStr (oldsong, TAG_URI);
+      if (olduri != NULL && strcmp (olduri, uri) != 0) {
+        slistSetNum (musicdb->songbyname, olduri, LIST_VALUE_INVALID);
+      }
+      ++updated;
+    }
+
+    songSetNum (song, TAG_RRN, rrn);
+    songSetNum (song, TAG_DBIDX, dbidx);
+    songSetNum (song, TAG_DB_FLAGS, MUSICDB_STD);
+    slistSetNum (musicdb->songbyname, uri, dbidx);
+    /* the old song is freed */
+    nlistSetData (musicdb->songbyidx, dbidx, song);
+  }
+
+  if (! musicdb->inbatch) {
+    raEndBatch (musicdb->radb);
+  }
+
+  nlistFree (rrnlist);
+  dbRebuildDanceCounts (musicdb);
+
+  logMsg (LOG_DBG, LOG_DB, "db-chg: %s added: %" PRId32 " updated: %" PRId32 " removed: %" PRId32,
+      serial, added, updated, removed);
+  return true;
+}
+
 #if 0 /* for debugging */
 void
 dbDumpSongList (musicdb_t *musicdb)   /* KEEP */
@@ -544,6 +733,14 @@ dbWriteInternalSong (musicdb_t *musicdb, const char *fn,
   dbCreateSongEntryFromSong (tbuff, sizeof (tbuff), song, fn);
   len = raWrite (musicdb->radb, rrn, tbuff, -1);
 
+  if (musicdb->changes != NULL && len > 0) {
+    if (rrn == RAFILE_NEW) {
+      /* a new entry is always the last record */
+      rrn = raGetCount (musicdb->radb);
+    }
+    nlistSetNum (musicdb->changes, rrn, 1);
+  }
+
   return len;
 }
 
@@ -575,6 +772,19 @@ dbReadEntry (musicdb_t *musicdb, rafileidx_t rrn)
   return song;
 }
 
+/* the entry is kept so that the database indexes do not change */
+static void
+dbSetRemovedEntry (musicdb_t *musicdb, rafileidx_t rrn)
+{
+  song_t    *song;
+
+  song = songAlloc ();
+  songSetNum (song, TAG_RRN, rrn);
+  songSetNum (song, TAG_DBIDX, rrn - 1);
+  songSetNum (song, TAG_DB_FLAGS, MUSICDB_REMOVED);
+  nlistSetData (musicdb->songbyidx, rrn - 1, song);
+}
+
 static void
 dbRebuildDanceCounts (musicdb_t *musicdb)
 {
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * silence detection for trim-silence.
+ * only the beginning and the end of the song are decoded.  the audio
+ * (stereo, SILENCEDET_RATE) is split into 10ms blocks, and a block is
+ * silent if its peak is below the noise level, as with ffmpeg's
+ * silencedetect filter.
+ * a silencedet_t may be re-used for many songs, but may only be used
+ * by one thread at a time.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "aafilter.h"
+#include "mdebug.h"
+#include "silencedet.h"
+
+enum {
+  SD_BLOCK_FRAMES = SILENCEDET_RATE / 100,
+  SD_BLOCK_LEN = SD_BLOCK_FRAMES * SILENCEDET_CHANNELS,
+  /* the peak is calculated in this many independent lanes, */
+  /* which allows the compiler to vectorize the loop */
+  SD_LANES = 8,
+  /* the portion of the song decoded at a time */
+  SD_WINDOW = 15000,
+};
+
+typedef struct silencedet {
+  float     threshold;
+  float     lane [SD_LANES];
+  int       blockfill;
+  int64_t   frames;
+  int64_t   leadframes;
+  int64_t   runstart;
+  bool      sound;
+} silencedet_t;
+
+static void silencedetSampleCallback (void *udata, const float *samples, int count);
+static void silencedetPeak (float *lane, const float *samples, int count);
+static void silencedetBlockEnd (silencedet_t *sd);
+
+silencedet_t *
+silencedetAlloc (void)
+{
+  silencedet_t  *sd;
+
+  sd = mdmalloc (sizeof (silencedet_t));
+  silencedetReset (sd, -60);
+  return sd;
+}
+
+void
+silencedetFree (silencedet_t *sd)
+{
+  if (sd == NULL) {
+    return;
+  }
+  mdfree (sd);
+}
+
+/* noisedb : the noise level, in dB */
+void
+silencedetReset (silencedet_t *sd, int noisedb)
+{
+  if (sd == NULL) {
+    return;
+  }
+
+  sd->threshold = (float) pow (10.0, (double) noisedb / 20.0);
+  for (int i = 0; i < SD_LANES; ++i) {
+    sd->lane [i] = 0.0f;
+  }
+  sd->blockfill = 0;
+  sd->frames = 0;
+  sd->leadframes = 0;
+  sd->runstart = -1;
+  sd->sound = false;
+}
+
+/* samples : stereo, interleaved, at SILENCEDET_RATE */
+/* count : the number of sample frames */
+void
+silencedetAddSamples (silencedet_t *sd, const float *samples, int count)
+{
+  if (sd == NULL || samples == NULL) {
+    return;
+  }
+
+  count *= SILENCEDET_CHANNELS;
+  while (count > 0) {
+    int     len;
+
+    len = SD_BLOCK_LEN - sd->blockfill;
+    if (len > count) {
+      len = count;
+    }
+    silencedetPeak (sd->lane, samples, len);
+    sd->blockfill += len;
+    samples += len;
+    count -= len;
+
+    if (sd->blockfill == SD_BLOCK_LEN) {
+      silencedetBlockEnd (sd);
+    }
+  }
+}
+
+/* the length of the audio processed, in seconds */
+double
+silencedetLength (silencedet_t *sd)
+{
+  if (sd == NULL) {
+    return 0.0;
+  }
+
+  silencedetBlockEnd (sd);
+  return (double) sd->frames / (double) SILENCEDET_RATE;
+}
+
+/* the length of the silence at the beginning, in seconds */
+double
+silencedetLeading (silencedet_t *sd)
+{
+  if (sd == NULL) {
+    return 0.0;
+  }
+
+  silencedetBlockEnd (sd);
+  return (double) sd->leadframes / (double) SILENCEDET_RATE;
+}
+
+/* the start of the silence at the end, in seconds */
+/* if there is no silence at the end, the length is returned */
+double
+silencedetTrailing (silencedet_t *sd)
+{
+  if (sd == NULL) {
+    return 0.0;
+  }
+
+  silencedetBlockEnd (sd);
+  if (sd->runstart < 0) {
+    return (double) sd->frames / (double) SILENCEDET_RATE;
+  }
+  return (double) sd->runstart / (double) SILENCEDET_RATE;
+}
+
+/* the beginning and the end of the audio file are decoded and analyzed. */
+/* noisedb, mindur : as with ffmpeg's silencedetect filter */
+/* sstart : the end of the silence at the beginning of the song */
+/* send : the start of the silence at the end of the song */
+/* if there is no silence at the beginning or end, the value is zero */
+int
+silencedetFile (silencedet_t *sd, aafilter_t *aaf, const char *fn,
+    int noisedb, double mindur, double *sstart, double *send)
+{
+  int32_t   startms = 0;
+  int32_t   endms;
+  int32_t   durms = SD_WINDOW;
+  double    len;
+  double    val;
+  double    lead = 0.0;
+  double    trail = 0.0;
+  double    endpos = -1.0;
+  int       rc;
+
+  *sstart = 0.0;
+  *send = 0.0;
+
+  if (sd == NULL) {
+    return -1;
+  }
+
+  /* the silence at the beginning, continue until there is sound */
+  while (true) {
+    silencedetReset (sd, noisedb);
+    rc = aafilterSamples (aaf, fn, startms, durms, SILENCEDET_RATE,
+        SILENCEDET_CHANNELS, silencedetSampleCallback, sd);
+    if (rc != 0) {
+      return rc;
+    }
+    len = silencedetLength (sd);
+    val = silencedetLeading (sd);
+    lead += val;
+    if (val < len || len < (double) SD_WINDOW / 1000.0) {
+      break;
+    }
+    startms += SD_WINDOW;
+  }
+
+  if (val >= len) {
+    /* the entire song is silent */
+    return 0;
+  }
+
+  /* the silence at the end, continue backwards until there is sound */
+  endms = aafilterGetDuration (aaf);
+  startms = endms - SD_WINDOW;
+  if (startms < 0) {
+    startms = 0;
+  }
+  durms = 0;
+  while (true) {
+    silencedetReset (sd, noisedb);
+    rc = aafilterSamples (aaf, fn, startms, durms, SILENCEDET_RATE,
+        SILENCEDET_CHANNELS, silencedetSampleCallback, sd);
+    if (rc != 0) {
+      return rc;
+    }
+    len = silencedetLength (sd);
+    val = silencedetTrailing (sd);
+    if (endpos < 0.0 && len > 0.0) {
+      /* the container's duration may not be accurate */
+      endpos = (double) startms / 1000.0 + len;
+    }
+    trail += len - val;
+    if (val > 0.0 || startms == 0) {
+      break;
+    }
+    endms = startms;
+    startms -= SD_WINDOW;
+    if (startms < 0) {
+      startms = 0;
+    }
+    durms = endms - startms;
+  }
+
+  if (lead >= mindur) {
+    *sstart = lead;
+  }
+  if (endpos > 0.0 && trail >= mindur) {
+    *send = endpos - trail;
+  }
+  return 0;
+}
+
+/* internal routines */
+
+static void
+silencedetSampleCallback (void *udata, const float *samples, int count)
+{
+  silencedetAddSamples (udata, samples, count);
+}
+
+static void
+silencedetPeak (float *lane, const float *samples, int count)
+{
+  float   m [SD_LANES];
+  int     i;
+
+  for (int j = 0; j < SD_LANES; ++j) {
+    m [j] = lane [j];
+  }
+  for (i = 0; i + SD_LANES <= count; i += SD_LANES) {
+    for (int j = 0; j < SD_LANES; ++j) {
+      float   v = fabsf (samples [i + j]);
+
+      m [j] = v > m [j] ? v : m [j];
+    }
+  }
+  for ( ; i < count; ++i) {
+    float   v = fabsf (samples [i]);
+
+    m [0] = v > m [0] ? v : m [0];
+  }
+  for (int j = 0; j < SD_LANES; ++j) {
+    lane [j] = m [j];
+  }
+}
+
+static void
+silencedetBlockEnd (silencedet_t *sd)
+{
+  float     peak = 0.0f;
+  int64_t   bframes;
+
+  if (sd->blockfill == 0) {
+    return;
+  }
+
+  for (int j = 0; j < SD_LANES; ++j) {
+    if (sd->lane [j] > peak) {
+      peak = sd->lane [j];
+    }
+    sd->lane [j] = 0.0f;
+  }
+
+  bframes = sd->blockfill / SILENCEDET_CHANNELS;
+  if (peak < sd->threshold) {
+    if (sd->runstart < 0) {
+      sd->runstart = sd->frames;
+    }
+    if (! sd->sound) {
+      sd->leadframes += bframes;
+    }
+  } else {
+    sd->runstart = -1;
+    sd->sound = true;
+  }
+  sd->frames += bframes;
+  sd->blockfill = 0;
+}
@@ -81,10 +81,15 @@ static datafilekey_t songdfkeys [] = {
   { "DURATION",             TAG_DURATION,             VALUE_NUM, NULL, DF_NORM },
   { "FAVORITE",             TAG_FAVORITE,             VALUE_NUM, songFavoriteConv, DF_NORM },
   { "FILE",                 TAG_URI,                  VALUE_STR, NULL, DF_NO_WRITE },
+  { "FILEINODE",            TAG_FILE_INODE,           VALUE_NUM, NULL, DF_NORM },
+  { "FILEMISSING",          TAG_FILE_MISSING,         VALUE_NUM, convBoolean, DF_NORM },
+  { "FILEMTIME",            TAG_FILE_MTIME,           VALUE_NUM, NULL, DF_NORM },
+  { "FILESIZE",             TAG_FILE_SIZE,            VALUE_NUM, NULL, DF_NORM },
   { "GENRE",                TAG_GENRE,                VALUE_NUM, genreConv, DF_NORM },
   { "GROUPING",             TAG_GROUPING,             VALUE_STR, NULL, DF_NORM },
   { "KEYWORD",              TAG_KEYWORD,              VALUE_STR, NULL, DF_NORM },
   { "LASTUPDATED",          TAG_LAST_UPDATED,         VALUE_NUM, NULL, DF_NORM },
+  { "LOUDNESS",             TAG_LOUDNESS,             VALUE_DOUBLE, NULL, DF_NORM },
   { "MOVEMENTCOUNT",        TAG_MOVEMENTCOUNT,        VALUE_NUM, NULL, DF_NORM },
   { "MOVEMENTNAME",         TAG_MOVEMENTNAME,         VALUE_STR, NULL, DF_NORM },
   { "MOVEMENTNUM",          TAG_MOVEMENTNUM,          VALUE_NUM, NULL, DF_NORM },
@@ -103,6 +108,7 @@ static datafilekey_t songdfkeys [] = {
   { "TRACKNUMBER",          TAG_TRACKNUMBER,          VALUE_NUM, NULL, DF_NORM },
   { "TRACKTOTAL",           TAG_TRACKTOTAL,           VALUE_NUM, NULL, DF_NORM },
   { "TRACK_ID",             TAG_TRACK_ID,             VALUE_STR, NULL, DF_NORM },
+  { "TRUEPEAK",             TAG_TRUE_PEAK,            VALUE_DOUBLE, NULL, DF_NORM },
   { "URI",                  TAG_URI,                  VALUE_STR, NULL, DF_NORM },
   { "VOLUMEADJUSTPERC",     TAG_VOLUMEADJUSTPERC,     VALUE_DOUBLE, NULL, DF_NORM },
   { "WORK",                 TAG_WORK,                 VALUE_STR, NULL, DF_NORM },
@@ -31,6 +31,7 @@
 #include "songdb.h"
 #include "songlist.h"
 #include "tagdef.h"
+#include "tagwriter.h"
 
 enum {
   SONGDB_IDENT = 0xaa006264676e6f73,
@@ -41,10 +42,12 @@ typedef struct songdb {
   musicdb_t *musicdb;
   org_t     *org;
   org_t     *orgold;
+  /* not owned by songdb */
+  tagwriter_t *tagwriter;
 } songdb_t;
 
 static bool songdbNewName (songdb_t *songdb, song_t *song, char *newuri, size_t sz);
-static void songdbWriteAudioTags (song_t *song);
+static void songdbWriteAudioTags (songdb_t *songdb, song_t *song);
 static void songdbUpdateAllSonglists (song_t *song, const char *olduri);
 
 songdb_t *
@@ -60,6 +63,7 @@ songdbAlloc (musicdb_t *musicdb)
   torgpath = bdjoptGetStr (OPT_G_ORGPATH);
   songdb->org = orgAlloc (torgpath);
   songdb->orgold = NULL;
+  songdb->tagwriter = NULL;
   if (strstr (torgpath, "BYPASS") != NULL) {
     songdb->orgold = orgAlloc (bdjoptGetStr (OPT_G_OLDORGPATH));
   }
@@ -91,6 +95,17 @@ songdbSetMusicDB (songdb_t *songdb, musicdb_t *musicdb)
   songdb->musicdb = musicdb;
 }
 
+/* if set, the audio tags are written in the background */
+void
+songdbSetTagWriter (songdb_t *songdb, tagwriter_t *tagwriter)
+{
+  if (songdb == NULL || songdb->ident != SONGDB_IDENT) {
+    return;
+  }
+
+  songdb->tagwriter = tagwriter;
+}
+
 void
 songdbWriteDB (songdb_t *songdb, dbidx_t dbidx)
 {
@@ -168,6 +183,9 @@ songdbWriteDBSong (songdb_t *songdb, song_t *song, int *flags, dbidx_t rrn)
   if (dorename) {
     int     pfxlen;
 
+    /* any pending tag writes must be completed before a file is renamed */
+    tagwriterWait (songdb->tagwriter);
+
     pfxlen = songGetNum (song, TAG_PREFIX_LEN);
     audiosrcFullPath (olduri, ffn, sizeof (ffn), olduri, pfxlen);
     /* the prefix length and old filename must be supplied */
@@ -272,7 +290,7 @@ songdbWriteDBSong (songdb_t *songdb, song_t *song, int *flags, dbidx_t rrn)
   }
 
   if (bdjoptGetNum (OPT_G_WRITETAGS) != WRITE_TAGS_NONE) {
-    songdbWriteAudioTags (song);
+    songdbWriteAudioTags (songdb, song);
   }
 
   if (renamesuccess) {
@@ -345,7 +363,7 @@ songdbNewName (songdb_t *songdb, song_t *song, char *newuri, size_t sz)
 }
 
 static void
-songdbWriteAudioTags (song_t *song)
+songdbWriteAudioTags (songdb_t *songdb, song_t *song)
 {
   const char  *fn;
   char        ffn [MAXPATHLEN];
@@ -361,8 +379,14 @@ songdbWriteAudioTags (song_t *song)
 
   audiosrcFullPath (fn, ffn, sizeof (ffn),
       fn, songGetNum (song, TAG_PREFIX_LEN));
-  tagdata = audiotagParseData (ffn, &rewrite);
   newtaglist = songTagList (song);
+  if (songdb->tagwriter != NULL) {
+    tagwriterAdd (songdb->tagwriter, ffn, NULL, newtaglist,
+        AF_REWRITE_NONE, AT_UPDATE_MOD_TIME);
+    return;
+  }
+
+  tagdata = audiotagParseData (ffn, &rewrite);
   audiotagWriteTags (ffn, tagdata, newtaglist, AF_REWRITE_NONE, AT_UPDATE_MOD_TIME);
   slistFree (tagdata);
   slistFree (newtaglist);
@@ -0,0 +1,454 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * a cache of the parsed audio file tags, so that the database update
+ * does not need to re-parse audio files that have not changed.
+ * the cache entry is keyed by the full path, and is only used if the
+ * file size, modification time, change time and inode all match.
+ * the change time is checked as the modification time may be preserved
+ * when the audio tags are written.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if _lib_pthread_create
+# include <pthread.h>
+#endif
+
+#include "bdj4.h"
+#include "filemanip.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "slist.h"
+#include "tagcache.h"
+
+#define TAGCACHE_IDENT    "BDJ4TAGC"
+#define TAGCACHE_TMP_EXT  ".tmp"
+
+enum {
+  /* change the version if the parsed tag data changes */
+  TAGCACHE_VERSION = 1,
+  TAGCACHE_IDENT_LEN = 8,
+  /* sanity check for a damaged cache file */
+  TAGCACHE_MAX_DATA = 1024 * 1024,
+};
+
+typedef struct {
+  int64_t   size;
+  int64_t   mtime;
+  int64_t   ctime;
+  uint64_t  inode;
+  int32_t   rewrite;
+  uint32_t  count;
+  uint32_t  datalen;
+  /* key \0 value \0 ... */
+  char      *data;
+  bool      used;
+} tagcacheentry_t;
+
+typedef struct tagcache {
+  char            *fname;
+  /* the entries loaded from the cache file, sorted */
+  slist_t         *entries;
+  /* new entries are not inserted into the sorted list, */
+  /* as that is slow for a large list */
+  slist_t         *added;
+  int32_t         hits;
+  int32_t         misses;
+  bool            changed;
+#if _lib_pthread_create
+  /* the cache is used by the tag parsing worker threads */
+  pthread_mutex_t lock;
+#endif
+} tagcache_t;
+
+static void tagcacheEntryFree (void *data);
+static tagcacheentry_t * tagcacheReadEntry (FILE *fh, char *ffn, size_t sz);
+static bool tagcacheWriteEntry (FILE *fh, const char *ffn, tagcacheentry_t *entry);
+static bool tagcacheMatch (tagcacheentry_t *entry, fileopstat_t *fst);
+static void tagcacheLock (tagcache_t *tc);
+static void tagcacheUnlock (tagcache_t *tc);
+
+tagcache_t *
+tagcacheLoad (const char *fname)
+{
+  tagcache_t      *tc;
+  FILE            *fh;
+  char            ident [TAGCACHE_IDENT_LEN];
+  int32_t         version;
+  uint32_t        count;
+
+  tc = mdmalloc (sizeof (tagcache_t));
+  tc->fname = mdstrdup (fname);
+  tc->entries = slistAlloc ("tagcache", LIST_UNORDERED, tagcacheEntryFree);
+  tc->added = slistAlloc ("tagcache-add", LIST_UNORDERED, tagcacheEntryFree);
+  tc->hits = 0;
+  tc->misses = 0;
+  tc->changed = false;
+#if _lib_pthread_create
+  pthread_mutex_init (&tc->lock, NULL);
+#endif
+
+  fh = fileopOpen (fname, "rb");
+  if (fh == NULL) {
+    slistSort (tc->entries);
+    return tc;
+  }
+
+  if (fread (ident, TAGCACHE_IDENT_LEN, 1, fh) != 1 ||
+      memcmp (ident, TAGCACHE_IDENT, TAGCACHE_IDENT_LEN) != 0 ||
+      fread (&version, sizeof (version), 1, fh) != 1 ||
+      version != TAGCACHE_VERSION ||
+      fread (&count, sizeof (count), 1, fh) != 1) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: %s: bad header, not used", fname);
+    mdextfclose (fh);
+    fclose (fh);
+    tc->changed = true;
+    slistSort (tc->entries);
+    return tc;
+  }
+
+  slistSetSize (tc->entries, count);
+  for (uint32_t i = 0; i < count; ++i) {
+    tagcacheentry_t *entry;
+    char            ffn [MAXPATHLEN];
+
+    entry = tagcacheReadEntry (fh, ffn, sizeof (ffn));
+    if (entry == NULL) {
+      logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: %s: bad entry %" PRIu32, fname, i);
+      tc->changed = true;
+      break;
+    }
+    slistSetData (tc->entries, ffn, entry);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+
+  slistSort (tc->entries);
+  logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: loaded %" PRId32,
+      slistGetCount (tc->entries));
+  return tc;
+}
+
+void
+tagcacheFree (tagcache_t *tc)
+{
+  if (tc == NULL) {
+    return;
+  }
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: hits %" PRId32 " misses %" PRId32,
+      tc->hits, tc->misses);
+  slistFree (tc->entries);
+  slistFree (tc->added);
+  dataFree (tc->fname);
+#if _lib_pthread_create
+  pthread_mutex_destroy (&tc->lock);
+#endif
+  mdfree (tc);
+}
+
+/* if prune is set, the entries that were not used are not saved */
+/* prune should only be set if every audio file was looked up */
+void
+tagcacheSave (tagcache_t *tc, bool prune)
+{
+  char            tfname [MAXPATHLEN];
+  FILE            *fh;
+  slistidx_t      iteridx;
+  const char      *ffn;
+  tagcacheentry_t *entry;
+  int32_t         version = TAGCACHE_VERSION;
+  uint32_t        count = 0;
+  bool            ok = true;
+
+  if (tc == NULL) {
+    return;
+  }
+
+  slistStartIterator (tc->entries, &iteridx);
+  while ((entry = slistIterateValueData (tc->entries, &iteridx)) != NULL) {
+    if (prune && ! entry->used) {
+      tc->changed = true;
+      continue;
+    }
+    ++count;
+  }
+  count += slistGetCount (tc->added);
+
+  if (! tc->changed) {
+    return;
+  }
+
+  snprintf (tfname, sizeof (tfname), "%s%s", tc->fname, TAGCACHE_TMP_EXT);
+  fh = fileopOpen (tfname, "wb");
+  if (fh == NULL) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: unable to open %s", tfname);
+    return;
+  }
+
+  fwrite (TAGCACHE_IDENT, TAGCACHE_IDENT_LEN, 1, fh);
+  fwrite (&version, sizeof (version), 1, fh);
+  fwrite (&count, sizeof (count), 1, fh);
+
+  for (slistidx_t i = 0; ok && i < slistGetCount (tc->entries); ++i) {
+    ffn = slistGetKeyByIdx (tc->entries, i);
+    entry = slistGetDataByIdx (tc->entries, i);
+    if (prune && ! entry->used) {
+      continue;
+    }
+    ok = tagcacheWriteEntry (fh, ffn, entry);
+  }
+  for (slistidx_t i = 0; ok && i < slistGetCount (tc->added); ++i) {
+    ffn = slistGetKeyByIdx (tc->added, i);
+    entry = slistGetDataByIdx (tc->added, i);
+    ok = tagcacheWriteEntry (fh, ffn, entry);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+
+  if (! ok) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: unable to write %s", tfname);
+    fileopDelete (tfname);
+    return;
+  }
+
+  filemanipMove (tfname, tc->fname);
+  tc->changed = false;
+  logMsg (LOG_DBG, LOG_IMPORTANT, "tagcache: saved %" PRIu32, count);
+}
+
+/* returns a new tag list if the file has not changed, otherwise null */
+slist_t *
+tagcacheGet (tagcache_t *tc, const char *ffn, fileopstat_t *fst, int *rewrite)
+{
+  tagcacheentry_t *entry;
+  slist_t         *tagdata;
+  const char      *p;
+
+  if (tc == NULL) {
+    return NULL;
+  }
+
+  tagcacheLock (tc);
+  entry = slistGetData (tc->entries, ffn);
+  if (entry == NULL || ! tagcacheMatch (entry, fst)) {
+    ++tc->misses;
+    tagcacheUnlock (tc);
+    return NULL;
+  }
+
+  entry->used = true;
+  ++tc->hits;
+  *rewrite = entry->rewrite;
+
+  /* the data was saved in sorted order */
+  tagdata = slistAlloc ("atag", LIST_ORDERED, NULL);
+  slistSetSize (tagdata, entry->count);
+  p = entry->data;
+  for (uint32_t i = 0; i < entry->count; ++i) {
+    const char  *key;
+
+    key = p;
+    p += strlen (p) + 1;
+    slistSetStr (tagdata, key, p);
+    p += strlen (p) + 1;
+  }
+  tagcacheUnlock (tc);
+
+  return tagdata;
+}
+
+void
+tagcacheSet (tagcache_t *tc, const char *ffn, fileopstat_t *fst,
+    slist_t *tagdata, int rewrite)
+{
+  tagcacheentry_t *entry;
+  tagcacheentry_t *curr;
+  slistidx_t      iteridx;
+  const char      *tag;
+  size_t          len = 0;
+  char            *p;
+
+  if (tc == NULL || tagdata == NULL) {
+    return;
+  }
+
+  entry = mdmalloc (sizeof (tagcacheentry_t));
+  entry->size = fst->size;
+  entry->mtime = fst->mtime;
+  entry->ctime = fst->ctime;
+  entry->inode = fst->inode;
+  entry->rewrite = rewrite;
+  entry->count = 0;
+  entry->used = true;
+
+  slistStartIterator (tagdata, &iteridx);
+  while ((tag = slistIterateKey (tagdata, &iteridx)) != NULL) {
+    const char  *val;
+
+    val = slistGetStr (tagdata, tag);
+    if (val == NULL) {
+      continue;
+    }
+    len += strlen (tag) + 1 + strlen (val) + 1;
+  }
+  entry->datalen = len;
+  entry->data = mdmalloc (len > 0 ? len : 1);
+
+  p = entry->data;
+  slistStartIterator (tagdata, &iteridx);
+  while ((tag = slistIterateKey (tagdata, &iteridx)) != NULL) {
+    const char  *val;
+
+    val = slistGetStr (tagdata, tag);
+    if (val == NULL) {
+      continue;
+    }
+    len = strlen (tag) + 1;
+    memcpy (p, tag, len);
+    p += len;
+    len = strlen (val) + 1;
+    memcpy (p, val, len);
+    p += len;
+    ++entry->count;
+  }
+
+  tagcacheLock (tc);
+  curr = slistGetData (tc->entries, ffn);
+  if (curr != NULL) {
+    /* replace the data in place */
+    dataFree (curr->data);
+    memcpy (curr, entry, sizeof (tagcacheentry_t));
+    mdfree (entry);
+  } else {
+    slistSetData (tc->added, ffn, entry);
+  }
+  tc->changed = true;
+  tagcacheUnlock (tc);
+}
+
+/* internal routines */
+
+static void
+tagcacheEntryFree (void *data)
+{
+  tagcacheentry_t *entry = data;
+
+  if (entry == NULL) {
+    return;
+  }
+  dataFree (entry->data);
+  mdfree (entry);
+}
+
+static tagcacheentry_t *
+tagcacheReadEntry (FILE *fh, char *ffn, size_t sz)
+{
+  tagcacheentry_t *entry;
+  uint32_t        len;
+  const char      *p;
+  const char      *end;
+
+  if (fread (&len, sizeof (len), 1, fh) != 1 || len >= sz) {
+    return NULL;
+  }
+  if (fread (ffn, len, 1, fh) != 1) {
+    return NULL;
+  }
+  ffn [len] = '\0';
+
+  entry = mdmalloc (sizeof (tagcacheentry_t));
+  entry->data = NULL;
+  entry->used = false;
+  if (fread (&entry->size, sizeof (entry->size), 1, fh) != 1 ||
+      fread (&entry->mtime, sizeof (entry->mtime), 1, fh) != 1 ||
+      fread (&entry->ctime, sizeof (entry->ctime), 1, fh) != 1 ||
+      fread (&entry->inode, sizeof (entry->inode), 1, fh) != 1 ||
+      fread (&entry->rewrite, sizeof (entry->rewrite), 1, fh) != 1 ||
+      fread (&entry->count, sizeof (entry->count), 1, fh) != 1 ||
+      fread (&entry->datalen, sizeof (entry->datalen), 1, fh) != 1 ||
+      entry->datalen > TAGCACHE_MAX_DATA) {
+    mdfree (entry);
+    return NULL;
+  }
+
+  entry->data = mdmalloc (entry->datalen > 0 ? entry->datalen : 1);
+  if (entry->datalen > 0 &&
+      fread (entry->data, entry->datalen, 1, fh) != 1) {
+    tagcacheEntryFree (entry);
+    return NULL;
+  }
+
+  /* make sure the key/value strings are all terminated */
+  p = entry->data;
+  end = entry->data + entry->datalen;
+  for (uint32_t i = 0; i < entry->count * 2; ++i) {
+    p = memchr (p, '\0', end - p);
+    if (p == NULL) {
+      tagcacheEntryFree (entry);
+      return NULL;
+    }
+    ++p;
+  }
+
+  return entry;
+}
+
+static bool
+tagcacheWriteEntry (FILE *fh, const char *ffn, tagcacheentry_t *entry)
+{
+  uint32_t    len;
+  bool        ok = true;
+
+  len = strlen (ffn);
+  ok = ok && fwrite (&len, sizeof (len), 1, fh) == 1;
+  ok = ok && fwrite (ffn, len, 1, fh) == 1;
+  ok = ok && fwrite (&entry->size, sizeof (entry->size), 1, fh) == 1;
+  ok = ok && fwrite (&entry->mtime, sizeof (entry->mtime), 1, fh) == 1;
+  ok = ok && fwrite (&entry->ctime, sizeof (entry->ctime), 1, fh) == 1;
+  ok = ok && fwrite (&entry->inode, sizeof (entry->inode), 1, fh) == 1;
+  ok = ok && fwrite (&entry->rewrite, sizeof (entry->rewrite), 1, fh) == 1;
+  ok = ok && fwrite (&entry->count, sizeof (entry->count), 1, fh) == 1;
+  ok = ok && fwrite (&entry->datalen, sizeof (entry->datalen), 1, fh) == 1;
+  if (entry->datalen > 0) {
+    ok = ok && fwrite (entry->data, entry->datalen, 1, fh) == 1;
+  }
+  return ok;
+}
+
+static bool
+tagcacheMatch (tagcacheentry_t *entry, fileopstat_t *fst)
+{
+  if (entry->size != fst->size ||
+      entry->mtime != fst->mtime ||
+      entry->ctime != fst->ctime ||
+      entry->inode != fst->inode) {
+    return false;
+  }
+  return true;
+}
+
+static void
+tagcacheLock (tagcache_t *tc)
+{
+#if _lib_pthread_create
+  pthread_mutex_lock (&tc->lock);
+#endif
+}
+
+static void
+tagcacheUnlock (tagcache_t *tc)
+{
+#if _lib_pthread_create
+  pthread_mutex_unlock (&tc->lock);
+#endif
+}
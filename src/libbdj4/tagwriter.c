@@ -0,0 +1,293 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * writes the audio file tags in the background.
+ * the files are grouped by the device they reside on.  only one file
+ * per device is written at a time so that the disk is not thrashed,
+ * and different devices are written in parallel.
+ * each file is written to a copy, which then replaces the original.
+ * the caller must call tagwriterProcess() periodically.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "audiotag.h"
+#include "fileop.h"
+#include "log.h"
+#include "mdebug.h"
+#include "queue.h"
+#include "slist.h"
+#include "tagwriter.h"
+#include "tmutil.h"
+#include "workpool.h"
+
+enum {
+  TAGWRITER_THREADS = 4,
+};
+
+typedef struct {
+  char        *ffn;
+  slist_t     *tagdata;
+  slist_t     *newtaglist;
+  int         rewrite;
+  int         modTimeFlag;
+  int         grpidx;
+  int         rc;
+} tagwriterjob_t;
+
+typedef struct {
+  uint64_t    dev;
+  queue_t     *pending;
+  bool        busy;
+} tagwritergroup_t;
+
+typedef struct tagwriter {
+  workpool_t        *wp;
+  tagwritergroup_t  *groups;
+  int               groupcount;
+  /* queued and in-process jobs */
+  int32_t           count;
+  slist_t           *errors;
+} tagwriter_t;
+
+static void tagwriterStart (tagwriter_t *tw);
+static int  tagwriterGetGroup (tagwriter_t *tw, const char *ffn);
+static void tagwriterWorker (void *udata, void *tjob, int thridx);
+static void tagwriterJobFree (void *data);
+
+tagwriter_t *
+tagwriterAlloc (void)
+{
+  tagwriter_t   *tw;
+
+  tw = mdmalloc (sizeof (tagwriter_t));
+  tw->wp = workpoolAlloc ("tagwriter", TAGWRITER_THREADS,
+      tagwriterWorker, tw);
+  tw->groups = NULL;
+  tw->groupcount = 0;
+  tw->count = 0;
+  tw->errors = slistAlloc ("tagwriter-err", LIST_ORDERED, NULL);
+  return tw;
+}
+
+/* any pending writes are completed */
+void
+tagwriterFree (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return;
+  }
+
+  tagwriterWait (tw);
+  workpoolFree (tw->wp);
+  for (int i = 0; i < tw->groupcount; ++i) {
+    queueFree (tw->groups [i].pending);
+  }
+  dataFree (tw->groups);
+  slistFree (tw->errors);
+  mdfree (tw);
+}
+
+/* tagwriter takes ownership of the tagdata and newtaglist */
+/* if tagdata is null, the audio file will be parsed */
+void
+tagwriterAdd (tagwriter_t *tw, const char *ffn, slist_t *tagdata,
+    slist_t *newtaglist, int rewrite, int modTimeFlag)
+{
+  tagwriterjob_t  *job;
+
+  if (tw == NULL || ffn == NULL) {
+    slistFree (tagdata);
+    slistFree (newtaglist);
+    return;
+  }
+
+  job = mdmalloc (sizeof (tagwriterjob_t));
+  job->ffn = mdstrdup (ffn);
+  job->tagdata = tagdata;
+  job->newtaglist = newtaglist;
+  job->rewrite = rewrite;
+  job->modTimeFlag = modTimeFlag;
+  job->grpidx = tagwriterGetGroup (tw, ffn);
+  job->rc = AUDIOTAG_WRITE_OK;
+
+  queuePush (tw->groups [job->grpidx].pending, job);
+  ++tw->count;
+  tagwriterStart (tw);
+}
+
+/* returns the number of files that were completed */
+int32_t
+tagwriterProcess (tagwriter_t *tw)
+{
+  tagwriterjob_t  *job;
+  bool            cancelled;
+  int32_t         count = 0;
+
+  if (tw == NULL) {
+    return 0;
+  }
+
+  while ((job = workpoolProcess (tw->wp, &cancelled)) != NULL) {
+    tw->groups [job->grpidx].busy = false;
+    if (job->rc == AUDIOTAG_WRITE_FAILED) {
+      logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: tag write failed %s", job->ffn);
+      slistSetNum (tw->errors, job->ffn, job->rc);
+    }
+    tagwriterJobFree (job);
+    --tw->count;
+    ++count;
+  }
+
+  tagwriterStart (tw);
+  return count;
+}
+
+void
+tagwriterWait (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return;
+  }
+
+  while (! tagwriterIsIdle (tw)) {
+    if (tagwriterProcess (tw) == 0) {
+      mssleep (1);
+    }
+  }
+}
+
+bool
+tagwriterIsIdle (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return true;
+  }
+
+  return tw->count == 0;
+}
+
+/* the number of files that are queued or being written */
+int32_t
+tagwriterGetCount (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return 0;
+  }
+
+  return tw->count;
+}
+
+/* the number of devices that files have been queued for */
+int
+tagwriterGetDeviceCount (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return 0;
+  }
+
+  return tw->groupcount;
+}
+
+/* the list of files that could not be written */
+slist_t *
+tagwriterGetErrors (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return NULL;
+  }
+
+  return tw->errors;
+}
+
+void
+tagwriterClearErrors (tagwriter_t *tw)
+{
+  if (tw == NULL) {
+    return;
+  }
+
+  slistFree (tw->errors);
+  tw->errors = slistAlloc ("tagwriter-err", LIST_ORDERED, NULL);
+}
+
+/* internal routines */
+
+/* start the next job for each device that is not busy */
+static void
+tagwriterStart (tagwriter_t *tw)
+{
+  tagwriterjob_t  *job;
+
+  for (int i = 0; i < tw->groupcount; ++i) {
+    if (tw->groups [i].busy) {
+      continue;
+    }
+    job = queuePop (tw->groups [i].pending);
+    if (job == NULL) {
+      continue;
+    }
+    tw->groups [i].busy = true;
+    workpoolAdd (tw->wp, job);
+  }
+}
+
+static int
+tagwriterGetGroup (tagwriter_t *tw, const char *ffn)
+{
+  fileopstat_t  fst;
+  int           grpidx;
+
+  /* if the stat fails, the write will fail, the group does not matter */
+  fileopStat (ffn, &fst);
+
+  for (int i = 0; i < tw->groupcount; ++i) {
+    if (tw->groups [i].dev == fst.dev) {
+      return i;
+    }
+  }
+
+  grpidx = tw->groupcount;
+  tw->groupcount += 1;
+  tw->groups = mdrealloc (tw->groups,
+      sizeof (tagwritergroup_t) * tw->groupcount);
+  tw->groups [grpidx].dev = fst.dev;
+  tw->groups [grpidx].pending = queueAlloc ("tagwriter-q", tagwriterJobFree);
+  tw->groups [grpidx].busy = false;
+  return grpidx;
+}
+
+/* runs in a worker thread */
+static void
+tagwriterWorker (void *udata, void *tjob, int thridx)
+{
+  tagwriterjob_t  *job = tjob;
+  int             rewrite;
+
+  if (job->tagdata == NULL) {
+    job->tagdata = audiotagParseData (job->ffn, &rewrite);
+  }
+  job->rc = audiotagWriteTagsReplace (job->ffn, job->tagdata,
+      job->newtaglist, job->rewrite, job->modTimeFlag);
+}
+
+static void
+tagwriterJobFree (void *data)
+{
+  tagwriterjob_t  *job = data;
+
+  if (job == NULL) {
+    return;
+  }
+
+  dataFree (job->ffn);
+  slistFree (job->tagdata);
+  slistFree (job->newtaglist);
+  mdfree (job);
+}
@@ -11,16 +11,22 @@
 
 #include "bdjmsg.h"
 #include "bdjstring.h"
+#include "tmutil.h"
 
 enum {
   LSZ = sizeof (uint32_t),      /* four bytes */
 };
-#define MSG_RS      '~'
+
+static void msgSetUint16 (unsigned char *p, uint16_t val);
+static uint16_t msgGetUint16 (const unsigned char *p);
+static void msgSetInt64 (unsigned char *p, int64_t val);
+static int64_t msgGetInt64 (const unsigned char *p);
 
 /* for debugging */
 const char *bdjmsgroutetxt [ROUTE_MAX] = {
   [ROUTE_CONFIGUI] = "CONFIGUI",
   [ROUTE_DBUPDATE] = "DBUPDATE",
+  [ROUTE_DBWATCH] = "DBWATCH",
   [ROUTE_MAIN] = "MAIN",
   [ROUTE_MANAGEUI] = "MANAGEUI",
   [ROUTE_MARQUEE] = "MARQUEE",
@@ -71,6 +77,8 @@ const char *bdjmsgtxt [MSG_MAX] = {
   [MSG_DB_STOP_REQ] = "DB_STOP_REQ",
   [MSG_DB_WAIT] = "DB_WAIT",
   [MSG_DB_WAIT_FINISH] = "DB_WAIT_FINISH",
+  [MSG_DEBUG_IPC_STATS] = "DEBUG_IPC_STATS",
+  [MSG_DEBUG_IPC_STATS_DATA] = "DEBUG_IPC_STATS_DATA",
   [MSG_EXIT_REQUEST] = "EXIT_REQUEST",
   [MSG_FINISHED] = "FINISHED",
   [MSG_GET_DANCE_LIST] = "GET_DANCE_LIST",
@@ -92,6 +100,7 @@ const char *bdjmsgtxt [MSG_MAX] = {
   [MSG_MARQUEE_SHOW] = "MARQUEE_SHOW",
   [MSG_MARQUEE_STATUS] = "MARQUEE_STATUS",
   [MSG_MUSICQ_DATA_RESUME] = "MUSICQ_DATA_RESUME",
+  [MSG_MUSICQ_DATA_RESYNC] = "MUSICQ_DATA_RESYNC",
   [MSG_MUSICQ_DATA_SUSPEND] = "MUSICQ_DATA_SUSPEND",
   [MSG_MUSICQ_INSERT] = "MUSICQ_INSERT",
   [MSG_MUSICQ_MOVE_DOWN] = "MUSICQ_MOVE_DOWN",
@@ -105,10 +114,12 @@ const char *bdjmsgtxt [MSG_MAX] = {
   [MSG_MUSICQ_TOGGLE_PAUSE] = "MUSICQ_TOGGLE_PAUSE",
   [MSG_MUSICQ_TRUNCATE] = "MUSICQ_TRUNCATE",
   [MSG_MUSIC_QUEUE_DATA] = "MUSIC_QUEUE_DATA",
+  [MSG_MUSIC_QUEUE_DELTA] = "MUSIC_QUEUE_DELTA",
   [MSG_NULL] = "NULL",
   [MSG_PLAYBACK_BEGIN] = "PLAYBACK_BEGIN",
   [MSG_PLAYBACK_FINISH] = "PLAYBACK_FINISH",
   [MSG_PLAYBACK_FINISH_STOP] = "PLAYBACK_FINISH_STOP",
+  [MSG_PLAYBACK_PREROLL] = "PLAYBACK_PREROLL",
   [MSG_PLAYER_STATE] = "PLAYER_STATE",
   [MSG_PLAYER_STATUS_DATA] = "PLAYER_STATUS_DATA",
   [MSG_PROCESS_ACTIVE] = "PROCESS_ACTIVE",
@@ -145,12 +156,14 @@ const char *bdjmsgtxt [MSG_MAX] = {
   [MSG_DEBUG_LEVEL] = "DEBUG_LEVEL",
   [MSG_SET_PLAYBACK_FADEIN] = "SET_PLAYBACK_FADEIN",
   [MSG_SET_PLAYBACK_FADEOUT] = "SET_PLAYBACK_FADEOUT",
+  [MSG_SET_PLAYBACK_XFADE] = "SET_PLAYBACK_XFADE",
   [MSG_SET_PLAYBACK_GAP] = "SET_PLAYBACK_GAP",
   [MSG_SOCKET_CLOSE] = "SOCKET_CLOSE",
   [MSG_SONG_CLEAR_PREP] = "SONG_CLEAR_PREP",
   [MSG_SONG_FINISH] = "SONG_FINISH",
   [MSG_SONG_PLAY] = "SONG_PLAY",
   [MSG_SONG_PREP] = "SONG_PREP",
+  [MSG_SONG_PREROLL] = "SONG_PREROLL",
   [MSG_SONG_SELECT] = "SONG_SELECT",
   [MSG_START_MAIN] = "START_MAIN",
   [MSG_START_MARQUEE] = "START_MARQUEE",
@@ -163,26 +176,42 @@ size_t
 msgEncode (bdjmsgroute_t routefrom, bdjmsgroute_t route,
     bdjmsgmsg_t msg, char *msgbuff, size_t mlen)
 {
-  size_t      len;
+  unsigned char *p = (unsigned char *) msgbuff;
 
-  len = (size_t) snprintf (msgbuff, mlen, "%0*d%c%0*d%c%0*d%c",
-      LSZ, routefrom, MSG_RS, LSZ, route, MSG_RS, LSZ, msg, MSG_RS);
-  msgbuff [mlen - 1] = '\0';
-  if (len >= mlen) {
-    len = mlen - 1;
+  if (mlen < BDJMSG_HDR_SZ + 1) {
+    return 0;
   }
+
+  p [0] = BDJMSG_HDR_MAGIC;
+  p [1] = BDJMSG_HDR_VERSION;
+  msgSetUint16 (p + 2, routefrom);
+  msgSetUint16 (p + 4, route);
+  msgSetUint16 (p + 6, msg);
+  msgSetInt64 (p + BDJMSG_HDR_TIME_OFFSET, ustime ());
   /* always send the null byte so that there will be an empty args string */
   /* if the additional args are not specified */
-  ++len;
-  return len;
+  p [BDJMSG_HDR_SZ] = '\0';
+  return BDJMSG_HDR_SZ + 1;
 }
 
 void
 msgDecode (char *msgbuff, bdjmsgroute_t *routefrom, bdjmsgroute_t *route,
     bdjmsgmsg_t *msg, char **args)
 {
-  char        *p = NULL;
+  char          *p = NULL;
+  unsigned char *up = (unsigned char *) msgbuff;
 
+  if (up [0] == BDJMSG_HDR_MAGIC) {
+    *routefrom = (bdjmsgroute_t) msgGetUint16 (up + 2);
+    *route = (bdjmsgroute_t) msgGetUint16 (up + 4);
+    *msg = (bdjmsgmsg_t) msgGetUint16 (up + 6);
+    if (args != NULL) {
+      *args = msgbuff + BDJMSG_HDR_SZ;
+    }
+    return;
+  }
+
+  /* text prefix */
   p = msgbuff;
   *routefrom = (bdjmsgroute_t) atol (p);
   p += LSZ + 1;
@@ -195,6 +224,143 @@ msgDecode (char *msgbuff, bdjmsgroute_t *routefrom, bdjmsgroute_t *route,
   }
 }
 
+/* returns the time the message was encoded in microseconds, */
+/* or zero if the message prefix has no time */
+int64_t
+msgTimeSent (const char *msgbuff)
+{
+  const unsigned char *up = (const unsigned char *) msgbuff;
+
+  if (up [0] != BDJMSG_HDR_MAGIC) {
+    return 0;
+  }
+  return msgGetInt64 (up + BDJMSG_HDR_TIME_OFFSET);
+}
+
+/* the length of the arguments, including the trailing null byte */
+/* for text arguments */
+size_t
+msgArgsLen (const char *args)
+{
+  if (args == NULL) {
+    return 0;
+  }
+  if (msgArgsIsTLV (args)) {
+    return msgGetUint16 ((const unsigned char *) args + 1);
+  }
+  return strlen (args) + 1;
+}
+
+bool
+msgArgsIsTLV (const char *args)
+{
+  if (args == NULL) {
+    return false;
+  }
+  return *args == MSG_ARGS_TLV;
+}
+
+size_t
+msgTLVInit (char *buff, size_t sz)
+{
+  if (sz < MSG_TLV_HDR_SZ + 1) {
+    return 0;
+  }
+  buff [0] = MSG_ARGS_TLV;
+  msgSetUint16 ((unsigned char *) buff + 1, MSG_TLV_HDR_SZ);
+  return MSG_TLV_HDR_SZ;
+}
+
+/* returns the new offset, or zero if the buffer is too small */
+size_t
+msgTLVAddInt (char *buff, size_t sz, size_t offset, int type, int64_t val)
+{
+  unsigned char *p;
+  int           vlen;
+
+  if (offset == 0) {
+    return 0;
+  }
+
+  vlen = 8;
+  if (val >= INT8_MIN && val <= INT8_MAX) {
+    vlen = 1;
+  } else if (val >= INT16_MIN && val <= INT16_MAX) {
+    vlen = 2;
+  } else if (val >= INT32_MIN && val <= INT32_MAX) {
+    vlen = 4;
+  }
+
+  if (sz > MSG_TLV_MAX) {
+    sz = MSG_TLV_MAX;
+  }
+  /* leave room for the terminating null byte */
+  if (offset + 2 + (size_t) vlen + 1 > sz) {
+    return 0;
+  }
+
+  p = (unsigned char *) buff + offset;
+  *p++ = (unsigned char) type;
+  *p++ = (unsigned char) vlen;
+  for (int i = vlen - 1; i >= 0; --i) {
+    p [i] = (unsigned char) (val & 0xFF);
+    val >>= 8;
+  }
+  return offset + 2 + (size_t) vlen;
+}
+
+/* the binary arguments are null terminated so that they */
+/* may be safely logged */
+void
+msgTLVFinish (char *buff, size_t offset)
+{
+  if (offset == 0) {
+    return;
+  }
+  buff [offset] = '\0';
+  msgSetUint16 ((unsigned char *) buff + 1, (uint16_t) (offset + 1));
+}
+
+/* the fields are read in place, the arguments are not modified */
+/* returns NULL when there are no more fields */
+const char *
+msgTLVNext (const char *args, const char *p, int *type, int64_t *val)
+{
+  const unsigned char *up;
+  const unsigned char *end;
+  int                 vlen;
+  int64_t             tval;
+
+  if (! msgArgsIsTLV (args)) {
+    return NULL;
+  }
+
+  /* do not include the terminating null byte */
+  end = (const unsigned char *) args + msgArgsLen (args) - 1;
+  if (p == NULL) {
+    p = args + MSG_TLV_HDR_SZ;
+  }
+  up = (const unsigned char *) p;
+  if (up + 2 > end) {
+    return NULL;
+  }
+
+  *type = up [0];
+  vlen = up [1];
+  up += 2;
+  if (vlen < 1 || vlen > 8 || up + vlen > end) {
+    return NULL;
+  }
+
+  /* sign-extend */
+  tval = (up [0] & 0x80) ? -1 : 0;
+  for (int i = 0; i < vlen; ++i) {
+    tval = (int64_t) (((uint64_t) tval << 8) | up [i]);
+  }
+  *val = tval;
+  return (const char *) (up + vlen);
+}
+
 const char *
 msgDebugText (bdjmsgmsg_t msg)
 {
@@ -207,3 +373,39 @@ msgRouteDebugText (bdjmsgroute_t route)
   return bdjmsgroutetxt [route];
 }
 
+/* internal routines */
+
+static void
+msgSetUint16 (unsigned char *p, uint16_t val)
+{
+  p [0] = (unsigned char) ((val >> 8) & 0xFF);
+  p [1] = (unsigned char) (val & 0xFF);
+}
+
+static uint16_t
+msgGetUint16 (const unsigned char *p)
+{
+  return (uint16_t) ((p [0] << 8) | p [1]);
+}
+
+static void
+msgSetInt64 (unsigned char *p, int64_t val)
+{
+  uint64_t    uval = (uint64_t) val;
+
+  for (int i = 7; i >= 0; --i) {
+    p [i] = (unsigned char) (uval & 0xff);
+    uval >>= 8;
+  }
+}
+
+static int64_t
+msgGetInt64 (const unsigned char *p)
+{
+  uint64_t    uval = 0;
+
+  for (int i = 0; i < 8; ++i) {
+    uval = (uval << 8) | p [i];
+  }
+  return (int64_t) uval;
+}
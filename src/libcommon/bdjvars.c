@@ -36,6 +36,7 @@ static const char *bdjvarsldesc [BDJVL_MAX] = {
   [BDJVL_PORT_BPM_COUNTER] = "PORT_BPM_COUNTER",
   [BDJVL_PORT_CONFIGUI] = "PORT_CONFIGUI",
   [BDJVL_PORT_DBUPDATE] = "PORT_DBUPDATE",
+  [BDJVL_PORT_DBWATCH] = "PORT_DBWATCH",
   [BDJVL_PORT_HELPERUI] = "PORT_HELPERUI",
   [BDJVL_PORT_MAIN] = "PORT_MAIN",
   [BDJVL_PORT_MANAGEUI] = "PORT_MANAGEUI",
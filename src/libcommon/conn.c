@@ -19,16 +19,22 @@
 
 #include "bdj4.h"
 #include "bdjvars.h"
+#include "callback.h"
 #include "conn.h"
+#include "ipcstats.h"
 #include "log.h"
 #include "mdebug.h"
 #include "progstate.h"
+#include "shmring.h"
 #include "sock.h"
 #include "sockh.h"
+#include "sysvars.h"
 #include "tmutil.h"
 
 typedef struct conn {
   Sock_t        sock;
+  shmring_t     *ring;
+  sockhbuff_t   *outbuff;
   uint16_t      port;
   bdjmsgroute_t routefrom;
   mstime_t      connchk;
@@ -40,6 +46,7 @@ typedef struct conn {
 
 static bool     initialized = false;
 static uint16_t connports [ROUTE_MAX];
+static callback_t *connFlushCB = NULL;
 
 /**
  * Check and see if there are any connections active.
@@ -47,6 +54,9 @@ static uint16_t connports [ROUTE_MAX];
  * @return true if all connections are disconnected.  false otherwise.
  */
 static bool connCheckAll (conn_t *conn);
+static void connCloseRing (conn_t *conn, bdjmsgroute_t route);
+static bool connFlushCallback (void *udata);
+static void connLost (conn_t *conn, bdjmsgroute_t route);
 
 /* note that connInit() must be called after bdjvarsInit() */
 conn_t *
@@ -62,6 +72,8 @@ connInit (bdjmsgroute_t routefrom)
   }
 
   if (! initialized) {
+    sockSetTransport (sysvarsGetNum (SVL_IPC_LOCAL) ?
+        SOCK_TRANS_LOCAL : SOCK_TRANS_TCP);
     connports [ROUTE_NONE] = 0;
     connports [ROUTE_MAIN] = bdjvarsGetNum (BDJVL_PORT_MAIN);
     connports [ROUTE_PLAYERUI] = bdjvarsGetNum (BDJVL_PORT_PLAYERUI);
@@ -73,6 +85,7 @@ connInit (bdjmsgroute_t routefrom)
     connports [ROUTE_MARQUEE] = bdjvarsGetNum (BDJVL_PORT_MARQUEE);
     connports [ROUTE_STARTERUI] = bdjvarsGetNum (BDJVL_PORT_STARTERUI);
     connports [ROUTE_DBUPDATE] = bdjvarsGetNum (BDJVL_PORT_DBUPDATE);
+    connports [ROUTE_DBWATCH] = bdjvarsGetNum (BDJVL_PORT_DBWATCH);
     connports [ROUTE_HELPERUI] = bdjvarsGetNum (BDJVL_PORT_HELPERUI);
     connports [ROUTE_BPM_COUNTER] = bdjvarsGetNum (BDJVL_PORT_BPM_COUNTER);
     connports [ROUTE_TEST_SUITE] = bdjvarsGetNum (BDJVL_PORT_TEST_SUITE);
@@ -82,6 +95,8 @@ connInit (bdjmsgroute_t routefrom)
 
   for (bdjmsgroute_t i = ROUTE_NONE; i < ROUTE_MAX; ++i) {
     conn [i].sock = INVALID_SOCKET;
+    conn [i].ring = NULL;
+    conn [i].outbuff = NULL;
     conn [i].port = 0;
     conn [i].routefrom = routefrom;
     conn [i].handshakesent = false;
@@ -91,6 +106,12 @@ connInit (bdjmsgroute_t routefrom)
     mstimeset (&conn [i].connchk, 0);
   }
 
+  /* the outbound messages are sent at the end of each pass */
+  /* of the main loop */
+  callbackFree (connFlushCB);
+  connFlushCB = callbackInit (connFlushCallback, conn, NULL);
+  sockhSetFlushCallback (connFlushCB);
+
   return conn;
 }
 
@@ -98,7 +119,13 @@ void
 connFree (conn_t *conn)
 {
   if (conn != NULL) {
+    sockhSetFlushCallback (NULL);
+    callbackFree (connFlushCB);
+    connFlushCB = NULL;
     for (bdjmsgroute_t i = ROUTE_NONE; i < ROUTE_MAX; ++i) {
+      connCloseRing (conn, i);
+      sockhBuffFree (conn [i].outbuff);
+      conn [i].outbuff = NULL;
       conn [i].sock = INVALID_SOCKET;
       conn [i].port = 0;
       conn [i].connected = false;
@@ -164,6 +191,12 @@ connConnect (conn_t *conn, bdjmsgroute_t route)
         conn [route].handshake = true;
       }
       conn [route].connected = true;
+      /* the player status is sent via shared memory if available */
+      if (conn [route].routefrom == ROUTE_PLAYER &&
+          sockhStatusRingPort (connports [route])) {
+        connCloseRing (conn, route);
+        conn [route].ring = shmringOpen (connports [route]);
+      }
     }
   }
 }
@@ -180,6 +213,7 @@ connDisconnect (conn_t *conn, bdjmsgroute_t route)
   }
 
   if (conn [route].connected) {
+    sockhBuffFlush (conn [route].sock, conn [route].outbuff);
     logMsg (LOG_DBG, LOG_SOCKET, "disconnect %d/%s from:%d/%s",
         conn [route].routefrom, msgRouteDebugText (conn [route].routefrom),
         route, msgRouteDebugText (route));
@@ -189,6 +223,9 @@ connDisconnect (conn_t *conn, bdjmsgroute_t route)
     sockClose (conn [route].sock);
   }
 
+  connCloseRing (conn, route);
+  sockhBuffFree (conn [route].outbuff);
+  conn [route].outbuff = NULL;
   conn [route].sock = INVALID_SOCKET;
   conn [route].connected = false;
   conn [route].handshakesent = false;
@@ -267,17 +304,58 @@ connSendMessage (conn_t *conn, bdjmsgroute_t route,
     return;
   }
 
-  rc = sockhSendMessage (conn [route].sock, conn [route].routefrom,
-      route, msg, args);
+  rc = -1;
+  if (conn [route].ring != NULL && msg == MSG_PLAYER_STATUS_DATA) {
+    /* if the ring is full or closed, fall back to the socket */
+    rc = sockhRingSendMessage (conn [route].ring, conn [route].routefrom,
+        route, msg, args);
+    if (rc < 0 && shmringIsClosed (conn [route].ring)) {
+      connCloseRing (conn, route);
+    }
+  }
   if (rc < 0) {
-    logMsg (LOG_DBG, LOG_IMPORTANT, "lost connection to %d", route);
-    logMsg (LOG_DBG, LOG_SOCKET, "close sock %" PRId64, (int64_t) conn [route].sock);
-    sockClose (conn [route].sock);
-    conn [route].sock = INVALID_SOCKET;
-    conn [route].connected = false;
-    conn [route].handshakesent = false;
-    conn [route].handshakerecv = false;
-    conn [route].handshake = false;
+    /* messages are held and sent together by connFlush() */
+    if (conn [route].outbuff == NULL) {
+      conn [route].outbuff = sockhBuffAlloc ();
+    }
+    if (sockhBuffMessage (conn [route].outbuff, conn [route].routefrom,
+        route, msg, args)) {
+      rc = 0;
+    } else {
+      /* too large to buffer, keep the messages in order */
+      rc = sockhBuffFlush (conn [route].sock, conn [route].outbuff);
+      if (rc == 0) {
+        rc = sockhSendMessage (conn [route].sock, conn [route].routefrom,
+            route, msg, args);
+      }
+    }
+  }
+  if (rc < 0) {
+    connLost (conn, route);
+  }
+}
+
+void
+connFlush (conn_t *conn)
+{
+  int     rc;
+
+  if (conn == NULL) {
+    return;
+  }
+
+  for (bdjmsgroute_t i = ROUTE_NONE; i < ROUTE_MAX; ++i) {
+    if (sockhBuffIsEmpty (conn [i].outbuff)) {
+      continue;
+    }
+    if (! conn [i].connected || socketInvalid (conn [i].sock)) {
+      continue;
+    }
+
+    rc = sockhBuffFlush (conn [i].sock, conn [i].outbuff);
+    if (rc < 0) {
+      connLost (conn, i);
+    }
   }
 }
 
@@ -348,3 +426,37 @@ connCheckAll (conn_t *conn)
   return rc;
 }
 
+static void
+connCloseRing (conn_t *conn, bdjmsgroute_t route)
+{
+  if (conn [route].ring != NULL) {
+    shmringClose (conn [route].ring);
+    conn [route].ring = NULL;
+  }
+}
+
+static bool
+connFlushCallback (void *udata)
+{
+  conn_t    *conn = udata;
+
+  connFlush (conn);
+  return false;
+}
+
+static void
+connLost (conn_t *conn, bdjmsgroute_t route)
+{
+  logMsg (LOG_DBG, LOG_IMPORTANT, "lost connection to %d", route);
+  ipcstatsLost (route);
+  logMsg (LOG_DBG, LOG_SOCKET, "close sock %" PRId64, (int64_t) conn [route].sock);
+  sockClose (conn [route].sock);
+  connCloseRing (conn, route);
+  sockhBuffFree (conn [route].outbuff);
+  conn [route].outbuff = NULL;
+  conn [route].sock = INVALID_SOCKET;
+  conn [route].connected = false;
+  conn [route].handshakesent = false;
+  conn [route].handshakerecv = false;
+  conn [route].handshake = false;
+}
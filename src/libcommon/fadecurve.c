@@ -0,0 +1,49 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bdjopt.h"       // for the fade types
+#include "fadecurve.h"
+
+/* findex is the position within the fade, 0.0 to 1.0 */
+/* returns the gain, 0.0 to 1.0 */
+double
+fadecurveCalc (int fadeType, double findex)
+{
+  findex = fmax (0.0, fmin (1.0, findex));
+
+  switch (fadeType) {
+    case FADETYPE_EXPONENTIAL_SINE: {
+      findex = 1.0 - cos (M_PI / 4.0 * (pow (2.0 * findex - 1, 3) + 1));
+      break;
+    }
+    case FADETYPE_HALF_SINE: {
+      findex = (1.0 - cos (findex * M_PI)) / 2.0;
+      break;
+    }
+    case FADETYPE_INVERTED_PARABOLA: {
+      findex = 1.0 - (1.0 - findex) * (1.0 - findex);
+      break;
+    }
+    case FADETYPE_QUADRATIC: {
+      findex = findex * findex;
+      break;
+    }
+    case FADETYPE_QUARTER_SINE: {
+      findex = sin (findex * M_PI / 2.0);
+      break;
+    }
+    case FADETYPE_TRIANGLE: {
+      break;
+    }
+  }
+
+  /* the gain is applied directly to the audio, never amplify */
+  findex = fmax (0.0, fmin (1.0, findex));
+  return findex;
+}
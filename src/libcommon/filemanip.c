@@ -3,6 +3,8 @@
  */
 #include "config.h"
 
+#define _GNU_SOURCE 1   // for copy_file_range()
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -15,6 +17,16 @@
 #include <unistd.h>
 #include <wchar.h>
 
+#if _sys_ioctl
+# include <sys/ioctl.h>
+#endif
+#if _sys_sendfile
+# include <sys/sendfile.h>
+#endif
+#if _hdr_linux_fs
+# include <linux/fs.h>
+#endif
+
 #include <glib.h>
 
 #if _hdr_windows
@@ -24,7 +36,6 @@
 
 #include "bdj4.h"
 #include "bdjstring.h"
-#include "filedata.h"
 #include "filemanip.h"
 #include "fileop.h"
 #include "mdebug.h"
@@ -32,6 +43,12 @@
 #include "pathdisp.h"
 #include "sysvars.h"
 
+enum {
+  FILEMANIP_COPY_BUFF_SZ = 128 * 1024,
+};
+
+static int filemanipCopyFile (const char *fname, const char *nfn);
+
 int
 filemanipMove (const char *fname, const char *nfn)
 {
@@ -92,22 +109,7 @@ filemanipCopy (const char *fname, const char *nfn)
     fileopSetModTime (tnfn, origtm);
 #endif
   } else {
-    char    *data;
-    FILE    *fh;
-    size_t  len;
-    size_t  trc = 0;
-
-    data = filedataReadAll (fname, &len);
-    if (data != NULL) {
-      fh = fileopOpen (nfn, "w");
-      if (fh != NULL) {
-        trc = fwrite (data, len, 1, fh);
-        mdextfclose (fh);
-        fclose (fh);
-      }
-      mdfree (data);
-    }
-    rc = trc == 1 ? 0 : -1;
+    rc = filemanipCopyFile (fname, nfn);
   }
 
   fileopSetModTime (nfn, origtm);
@@ -115,6 +117,36 @@ filemanipCopy (const char *fname, const char *nfn)
   return rc;
 }
 
+/* the permissions, and if allowed the owner and group, of the */
+/* original file are set on the new file. */
+/* used when a copy of a file replaces the original */
+void
+filemanipCopyPermissions (const char *fname, const char *nfn)
+{
+  if (isWindows ()) {
+    return;
+  }
+
+#if ! _lib__wstat64
+  {
+    struct stat statbuf;
+    int         rc;
+
+    if (stat (fname, &statbuf) != 0) {
+      return;
+    }
+    /* an ordinary user may only change the group, and the owner */
+    /* can not be changed.  this is not an error. */
+    /* chown is done first, as it may reset the set-id bits */
+    rc = chown (nfn, statbuf.st_uid, statbuf.st_gid);
+    if (rc != 0) {
+      rc = chown (nfn, (uid_t) -1, statbuf.st_gid);
+    }
+    chmod (nfn, statbuf.st_mode & 07777);
+  }
+#endif
+}
+
 /* link if possible, otherwise copy */
 /* windows has had symlinks for ages, but they require either */
 /* admin permission, or have the machine in developer mode */
@@ -193,5 +225,126 @@ filemanipDeleteAll (const char *name)
   return;
 }
 
+/* internal routines */
+
+/* the audio files may be large, the file is never read into memory. */
+/* a reflink clone is tried first, then an in-kernel copy, and finally */
+/* a copy using a fixed size buffer. */
+/* each method continues from the current file offsets. */
+static int
+filemanipCopyFile (const char *fname, const char *nfn)
+{
+  int         ifd;
+  int         ofd;
+  struct stat statbuf;
+  off_t       remaining;
+  bool        done = false;
+  int         rc = -1;
+
+  ifd = open (fname, O_RDONLY);
+  if (ifd < 0) {
+    return rc;
+  }
+  mdextopen (ifd);
+  if (fstat (ifd, &statbuf) != 0) {
+    mdextclose (ifd);
+    close (ifd);
+    return rc;
+  }
+
+  ofd = open (nfn, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (ofd < 0) {
+    mdextclose (ifd);
+    close (ifd);
+    return rc;
+  }
+  mdextopen (ofd);
+
+  remaining = statbuf.st_size;
 
+#if _define_FICLONE
+  if (remaining > 0 && ioctl (ofd, FICLONE, ifd) == 0) {
+    remaining = 0;
+  }
+#endif
+
+#if _lib_copy_file_range && _GNU_SOURCE
+  while (remaining > 0) {
+    ssize_t   len;
+
+    len = copy_file_range (ifd, NULL, ofd, NULL, remaining, 0);
+    if (len <= 0) {
+      /* not supported, or a cross-device copy on an older kernel */
+      break;
+    }
+    remaining -= len;
+  }
+#endif
+
+#if _lib_sendfile && _sys_sendfile
+  while (remaining > 0) {
+    ssize_t   len;
+
+    len = sendfile (ofd, ifd, NULL, remaining);
+    if (len <= 0) {
+      break;
+    }
+    remaining -= len;
+  }
+#endif
+
+  if (remaining > 0) {
+    char      *buff;
+
+    buff = mdmalloc (FILEMANIP_COPY_BUFF_SZ);
+    while (! done) {
+      ssize_t   len;
+      ssize_t   wlen;
+      ssize_t   woffset;
+
+      len = read (ifd, buff, FILEMANIP_COPY_BUFF_SZ);
+      if (len < 0 && errno == EINTR) {
+        continue;
+      }
+      if (len <= 0) {
+        done = true;
+        if (len == 0) {
+          remaining = 0;
+        }
+        break;
+      }
+
+      woffset = 0;
+      while (woffset < len) {
+        wlen = write (ofd, buff + woffset, len - woffset);
+        if (wlen < 0 && errno == EINTR) {
+          continue;
+        }
+        if (wlen <= 0) {
+          done = true;
+          break;
+        }
+        woffset += wlen;
+      }
+    }
+    mdfree (buff);
+  }
+
+  if (remaining == 0) {
+    rc = 0;
+  }
 
+  mdextclose (ifd);
+  close (ifd);
+  mdextclose (ofd);
+  if (close (ofd) != 0) {
+    rc = -1;
+  }
+
+  if (rc != 0) {
+    /* do not leave a partial copy */
+    fileopDelete (nfn);
+  }
+
+  return rc;
+}
@@ -130,6 +130,53 @@ fileopModTime (const char *fname)
   return mtime;
 }
 
+/* the size, modification time and inode with a single stat() call */
+bool
+fileopStat (const char *fname, fileopstat_t *fst)
+{
+  bool    rc = false;
+
+  fst->size = -1;
+  fst->mtime = 0;
+  fst->ctime = 0;
+  fst->inode = 0;
+  fst->dev = 0;
+  fst->nlink = 1;
+
+#if _lib__wstat64
+  {
+    struct __stat64  statbuf;
+    wchar_t       *tfname = NULL;
+
+    tfname = osToWideChar (fname);
+    if (_wstat64 (tfname, &statbuf) == 0) {
+      fst->size = statbuf.st_size;
+      fst->mtime = statbuf.st_mtime;
+      fst->ctime = statbuf.st_ctime;
+      /* st_ino is not set on windows */
+      fst->dev = (uint64_t) statbuf.st_dev;
+      rc = true;
+    }
+    mdfree (tfname);
+  }
+#else
+  {
+    struct stat statbuf;
+
+    if (stat (fname, &statbuf) == 0) {
+      fst->size = statbuf.st_size;
+      fst->mtime = statbuf.st_mtime;
+      fst->ctime = statbuf.st_ctime;
+      fst->inode = (uint64_t) statbuf.st_ino;
+      fst->dev = (uint64_t) statbuf.st_dev;
+      fst->nlink = (uint32_t) statbuf.st_nlink;
+      rc = true;
+    }
+  }
+#endif
+  return rc;
+}
+
 void
 fileopSetModTime (const char *fname, time_t mtime)
 {
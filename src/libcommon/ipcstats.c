@@ -0,0 +1,264 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "bdjmsg.h"
+#include "bdjstring.h"
+#include "ipcstats.h"
+#include "tmutil.h"
+
+/* upper limit of each latency bucket in microseconds */
+static const int64_t ipclatbucket [] = {
+  50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, INT64_MAX,
+};
+enum {
+  IPC_LAT_MAX = sizeof (ipclatbucket) / sizeof (int64_t),
+};
+
+typedef struct {
+  uint64_t    count;
+  uint64_t    bytes;
+  uint64_t    ns;
+} ipccount_t;
+
+typedef struct {
+  ipccount_t  sent;
+  ipccount_t  rcvd;
+  uint64_t    superseded;
+} ipcmsgstats_t;
+
+typedef struct {
+  ipccount_t  sent;
+  ipccount_t  rcvd;
+  uint64_t    lost;
+  uint64_t    latcount;
+  uint64_t    lattot;
+  uint64_t    latmax;
+  uint64_t    lat [IPC_LAT_MAX];
+} ipcroutestats_t;
+
+typedef struct {
+  ipcmsgstats_t   msg [MSG_MAX];
+  ipcroutestats_t route [ROUTE_MAX];
+  ipccount_t      sockwrite;
+  ipccount_t      sockread;
+} ipcstats_t;
+
+static ipcstats_t   ipcstats;
+
+static int64_t ipcstatsNow (void);
+
+/* returns a start time for ipcstatsSent() and ipcstatsRcvd() */
+int64_t
+ipcstatsStart (void)
+{
+  return ipcstatsNow ();
+}
+
+void
+ipcstatsSent (bdjmsgroute_t route, bdjmsgmsg_t msg, size_t bytes,
+    int64_t start)
+{
+  int64_t     ns;
+
+  if (route >= ROUTE_MAX || msg >= MSG_MAX) {
+    return;
+  }
+
+  ns = ipcstatsNow () - start;
+  ipcstats.msg [msg].sent.count += 1;
+  ipcstats.msg [msg].sent.bytes += bytes;
+  ipcstats.msg [msg].sent.ns += (uint64_t) ns;
+  ipcstats.route [route].sent.count += 1;
+  ipcstats.route [route].sent.bytes += bytes;
+  ipcstats.route [route].sent.ns += (uint64_t) ns;
+}
+
+void
+ipcstatsSuperseded (bdjmsgmsg_t msg)
+{
+  if (msg >= MSG_MAX) {
+    return;
+  }
+  ipcstats.msg [msg].superseded += 1;
+}
+
+/* timesent is the time embedded in the message by the sender */
+void
+ipcstatsRcvd (bdjmsgroute_t routefrom, bdjmsgmsg_t msg, size_t bytes,
+    int64_t start, int64_t timesent)
+{
+  int64_t     ns;
+
+  if (routefrom >= ROUTE_MAX || msg >= MSG_MAX) {
+    return;
+  }
+
+  ns = ipcstatsNow () - start;
+  ipcstats.msg [msg].rcvd.count += 1;
+  ipcstats.msg [msg].rcvd.bytes += bytes;
+  ipcstats.msg [msg].rcvd.ns += (uint64_t) ns;
+  ipcstats.route [routefrom].rcvd.count += 1;
+  ipcstats.route [routefrom].rcvd.bytes += bytes;
+  ipcstats.route [routefrom].rcvd.ns += (uint64_t) ns;
+
+  if (timesent > 0) {
+    ipcroutestats_t *rs = &ipcstats.route [routefrom];
+    int64_t         lat;
+
+    lat = ustime () - timesent;
+    if (lat < 0) {
+      /* the clock was changed */
+      lat = 0;
+    }
+    for (int i = 0; i < IPC_LAT_MAX; ++i) {
+      if (lat < ipclatbucket [i]) {
+        rs->lat [i] += 1;
+        break;
+      }
+    }
+    rs->latcount += 1;
+    rs->lattot += (uint64_t) lat;
+    if ((uint64_t) lat > rs->latmax) {
+      rs->latmax = (uint64_t) lat;
+    }
+  }
+}
+
+void
+ipcstatsLost (bdjmsgroute_t route)
+{
+  if (route >= ROUTE_MAX) {
+    return;
+  }
+  ipcstats.route [route].lost += 1;
+}
+
+void
+ipcstatsSockWrite (size_t bytes)
+{
+  ipcstats.sockwrite.count += 1;
+  ipcstats.sockwrite.bytes += bytes;
+}
+
+void
+ipcstatsSockRead (size_t bytes)
+{
+  ipcstats.sockread.count += 1;
+  ipcstats.sockread.bytes += bytes;
+}
+
+void
+ipcstatsReset (void)
+{
+  memset (&ipcstats, 0, sizeof (ipcstats));
+}
+
+/* only the routes and messages with activity are reported */
+size_t
+ipcstatsReport (char *buff, size_t sz)
+{
+  char    *p = buff;
+  char    *end = buff + sz;
+  char    tbuff [300];
+
+  *buff = '\0';
+
+  snprintf (tbuff, sizeof (tbuff),
+      "sock write %" PRIu64 " %" PRIu64 "B read %" PRIu64 " %" PRIu64 "B\n",
+      ipcstats.sockwrite.count, ipcstats.sockwrite.bytes,
+      ipcstats.sockread.count, ipcstats.sockread.bytes);
+  p = stpecpy (p, end, tbuff);
+
+  for (int i = 0; i < ROUTE_MAX; ++i) {
+    ipcroutestats_t *rs = &ipcstats.route [i];
+
+    if (rs->sent.count == 0 && rs->rcvd.count == 0 && rs->lost == 0) {
+      continue;
+    }
+
+    snprintf (tbuff, sizeof (tbuff),
+        "route %-12s sent %" PRIu64 " %" PRIu64 "B"
+        " rcvd %" PRIu64 " %" PRIu64 "B lost %" PRIu64 "\n",
+        msgRouteDebugText (i),
+        rs->sent.count, rs->sent.bytes,
+        rs->rcvd.count, rs->rcvd.bytes, rs->lost);
+    p = stpecpy (p, end, tbuff);
+
+    if (rs->latcount > 0) {
+      char    *tp;
+      char    *tend = tbuff + sizeof (tbuff);
+      char    nbuff [40];
+
+      snprintf (nbuff, sizeof (nbuff), "latency %-12s", msgRouteDebugText (i));
+      tp = stpecpy (tbuff, tend, nbuff);
+      snprintf (nbuff, sizeof (nbuff), " avg %" PRIu64 "us max %" PRIu64 "us",
+          rs->lattot / rs->latcount, rs->latmax);
+      tp = stpecpy (tp, tend, nbuff);
+      for (int j = 0; j < IPC_LAT_MAX; ++j) {
+        if (ipclatbucket [j] == INT64_MAX) {
+          snprintf (nbuff, sizeof (nbuff), " more:%" PRIu64, rs->lat [j]);
+        } else {
+          snprintf (nbuff, sizeof (nbuff), " %" PRId64 ":%" PRIu64,
+              ipclatbucket [j], rs->lat [j]);
+        }
+        tp = stpecpy (tp, tend, nbuff);
+      }
+      tp = stpecpy (tp, tend, "\n");
+      p = stpecpy (p, end, tbuff);
+    }
+  }
+
+  for (int i = 0; i < MSG_MAX; ++i) {
+    ipcmsgstats_t *ms = &ipcstats.msg [i];
+    uint64_t      encns = 0;
+    uint64_t      decns = 0;
+
+    if (ms->sent.count == 0 && ms->rcvd.count == 0) {
+      continue;
+    }
+
+    if (ms->sent.count > 0) {
+      encns = ms->sent.ns / ms->sent.count;
+    }
+    if (ms->rcvd.count > 0) {
+      decns = ms->rcvd.ns / ms->rcvd.count;
+    }
+    snprintf (tbuff, sizeof (tbuff),
+        "msg %-28s sent %" PRIu64 " %" PRIu64 "B enc %" PRIu64 "ns"
+        " rcvd %" PRIu64 " %" PRIu64 "B dec %" PRIu64 "ns"
+        " superseded %" PRIu64 "\n",
+        msgDebugText (i),
+        ms->sent.count, ms->sent.bytes, encns,
+        ms->rcvd.count, ms->rcvd.bytes, decns,
+        ms->superseded);
+    p = stpecpy (p, end, tbuff);
+  }
+
+  return (size_t) (p - buff);
+}
+
+/* internal routines */
+
+/* nanoseconds */
+static int64_t
+ipcstatsNow (void)
+{
+#if _lib_clock_gettime
+  struct timespec   ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + (int64_t) ts.tv_nsec;
+#else
+  return ustime () * 1000;
+#endif
+}
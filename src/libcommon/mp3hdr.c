@@ -0,0 +1,346 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * mp3 duration from the frame headers, without decoding.
+ * a Xing/Info or VBRI header in the first frame has the number of
+ * frames.  the LAME extension to the Xing header has the encoder delay
+ * and padding.  if there is no header, the file is constant bit rate,
+ * and the duration is calculated from the size of the audio data.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fileop.h"
+#include "mdebug.h"
+#include "mp3hdr.h"
+
+enum {
+  MP3HDR_BUFF_SZ = 8192,
+  MP3HDR_HEAD_SZ = 4,
+  MP3HDR_ID_LEN = 4,
+  ID3V2_HEAD_SZ = 10,
+  ID3V2_FLAG_FOOTER = 0x10,
+  ID3V1_SZ = 128,
+  APE_FOOTER_SZ = 32,
+  APE_FLAG_HEADER = 0x80,
+  XING_FLAG_FRAMES = 0x01,
+  XING_FLAG_BYTES = 0x02,
+  XING_FLAG_TOC = 0x04,
+  XING_FLAG_QUALITY = 0x08,
+  XING_TOC_SZ = 100,
+  /* id, flags, frames */
+  XING_HEAD_SZ = 12,
+  LAME_DELAY_OFFSET = 21,
+  LAME_HEAD_SZ = LAME_DELAY_OFFSET + 3,
+  /* the vbri header is always 32 bytes after the frame header */
+  VBRI_OFFSET = MP3HDR_HEAD_SZ + 32,
+  VBRI_FRAMES_OFFSET = 14,
+  VBRI_HEAD_SZ = VBRI_FRAMES_OFFSET + 4,
+};
+
+enum {
+  MPEG_V25 = 0,
+  MPEG_RESERVED = 1,
+  MPEG_V2 = 2,
+  MPEG_V1 = 3,
+};
+
+/* kbit/s, indexed by [mpeg-1/mpeg-2][layer - 1][bitrate index] */
+static const int mp3bitrates [2][3][15] = {
+  {
+    { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+    { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+    { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 },
+  },
+  {
+    { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+    { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+    { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+  },
+};
+
+/* indexed by [version][samplerate index] */
+static const int mp3samplerates [4][3] = {
+  { 11025, 12000, 8000 },
+  { 0, 0, 0 },
+  { 22050, 24000, 16000 },
+  { 44100, 48000, 32000 },
+};
+
+typedef struct {
+  int     version;
+  int     layer;
+  int     bitrate;
+  int     samplerate;
+  int     framelen;
+  int     spf;
+  bool    mono;
+} mp3frame_t;
+
+static bool mp3hdrParseFrame (const unsigned char *p, mp3frame_t *frame);
+static bool mp3hdrVBRHeader (const unsigned char *p, size_t len, mp3frame_t *frame, int64_t *samples);
+static int64_t mp3hdrSkipID3 (FILE *fh);
+static int64_t mp3hdrTrailing (FILE *fh, int64_t fsize);
+static uint32_t mp3hdrBE32 (const unsigned char *p);
+
+/* returns the duration in milliseconds, or -1 if it cannot be determined */
+int32_t
+mp3hdrDuration (const char *fn)
+{
+  FILE          *fh;
+  unsigned char *buff;
+  mp3frame_t    frame;
+  mp3frame_t    next;
+  ssize_t       fsize;
+  int64_t       audiostart;
+  int64_t       audioend;
+  int64_t       samples = -1;
+  size_t        len = 0;
+  size_t        pos;
+  bool          found = false;
+
+  fsize = fileopSize (fn);
+  if (fsize <= 0) {
+    return -1;
+  }
+
+  fh = fileopOpen (fn, "rb");
+  if (fh == NULL) {
+    return -1;
+  }
+  mdextfopen (fh);
+
+  audiostart = mp3hdrSkipID3 (fh);
+  audioend = fsize - mp3hdrTrailing (fh, fsize);
+
+  buff = mdmalloc (MP3HDR_BUFF_SZ);
+  if (audiostart < audioend && fseek (fh, audiostart, SEEK_SET) == 0) {
+    len = fread (buff, 1, MP3HDR_BUFF_SZ, fh);
+  }
+  mdextfclose (fh);
+  fclose (fh);
+
+  /* locate the first frame, the following frame must also be valid */
+  for (pos = 0; pos + MP3HDR_HEAD_SZ <= len; ++pos) {
+    size_t    npos;
+
+    if (! mp3hdrParseFrame (buff + pos, &frame)) {
+      continue;
+    }
+
+    npos = pos + frame.framelen;
+    if (audiostart + (int64_t) npos >= audioend) {
+      found = true;
+      break;
+    }
+    if (npos + MP3HDR_HEAD_SZ > len) {
+      break;
+    }
+    if (mp3hdrParseFrame (buff + npos, &next) &&
+        next.version == frame.version &&
+        next.layer == frame.layer &&
+        next.samplerate == frame.samplerate) {
+      found = true;
+      break;
+    }
+  }
+
+  if (found) {
+    audiostart += pos;
+    if (! mp3hdrVBRHeader (buff + pos, len - pos, &frame, &samples)) {
+      samples = (audioend - audiostart) * 8 *
+          frame.samplerate / frame.bitrate;
+    }
+  }
+  mdfree (buff);
+
+  if (samples < 0) {
+    return -1;
+  }
+  return (int32_t) (samples * 1000 / frame.samplerate);
+}
+
+/* internal routines */
+
+static bool
+mp3hdrParseFrame (const unsigned char *p, mp3frame_t *frame)
+{
+  int     lidx;
+  int     bidx;
+  int     sidx;
+  int     padding;
+
+  if (p [0] != 0xff || (p [1] & 0xe0) != 0xe0) {
+    return false;
+  }
+
+  frame->version = (p [1] >> 3) & 0x03;
+  lidx = (p [1] >> 1) & 0x03;
+  bidx = (p [2] >> 4) & 0x0f;
+  sidx = (p [2] >> 2) & 0x03;
+  /* free format is not supported */
+  if (frame->version == MPEG_RESERVED || lidx == 0 ||
+      bidx == 0 || bidx == 0x0f || sidx == 0x03) {
+    return false;
+  }
+
+  frame->layer = 4 - lidx;
+  frame->bitrate = mp3bitrates [frame->version == MPEG_V1 ? 0 : 1]
+      [frame->layer - 1][bidx] * 1000;
+  frame->samplerate = mp3samplerates [frame->version][sidx];
+  frame->mono = ((p [3] >> 6) & 0x03) == 0x03;
+  padding = (p [2] >> 1) & 0x01;
+
+  if (frame->layer == 1) {
+    frame->spf = 384;
+    frame->framelen = (12 * frame->bitrate / frame->samplerate + padding) * 4;
+  } else {
+    frame->spf = 1152;
+    if (frame->layer == 3 && frame->version != MPEG_V1) {
+      frame->spf = 576;
+    }
+    frame->framelen = frame->spf / 8 * frame->bitrate /
+        frame->samplerate + padding;
+  }
+
+  return true;
+}
+
+/* returns true if the first frame has a vbr header */
+/* samples is set to -1 if the vbr header has no frame count */
+static bool
+mp3hdrVBRHeader (const unsigned char *p, size_t len,
+    mp3frame_t *frame, int64_t *samples)
+{
+  size_t    offset;
+  uint32_t  flags;
+
+  *samples = -1;
+
+  /* the xing header follows the side information (layer 3 only) */
+  offset = MP3HDR_HEAD_SZ;
+  if (frame->version == MPEG_V1) {
+    offset += frame->mono ? 17 : 32;
+  } else {
+    offset += frame->mono ? 9 : 17;
+  }
+
+  if (frame->layer == 3 && offset + XING_HEAD_SZ <= len &&
+      (memcmp (p + offset, "Xing", MP3HDR_ID_LEN) == 0 ||
+      memcmp (p + offset, "Info", MP3HDR_ID_LEN) == 0)) {
+    flags = mp3hdrBE32 (p + offset + MP3HDR_ID_LEN);
+    if ((flags & XING_FLAG_FRAMES) != XING_FLAG_FRAMES) {
+      return true;
+    }
+    *samples = (int64_t) mp3hdrBE32 (p + offset + 8) * frame->spf;
+
+    offset += XING_HEAD_SZ;
+    if ((flags & XING_FLAG_BYTES) == XING_FLAG_BYTES) {
+      offset += 4;
+    }
+    if ((flags & XING_FLAG_TOC) == XING_FLAG_TOC) {
+      offset += XING_TOC_SZ;
+    }
+    if ((flags & XING_FLAG_QUALITY) == XING_FLAG_QUALITY) {
+      offset += 4;
+    }
+
+    /* lame and ffmpeg both write the lame extension */
+    if (offset + LAME_HEAD_SZ <= len &&
+        (memcmp (p + offset, "LAME", MP3HDR_ID_LEN) == 0 ||
+        memcmp (p + offset, "Lavf", MP3HDR_ID_LEN) == 0 ||
+        memcmp (p + offset, "Lavc", MP3HDR_ID_LEN) == 0)) {
+      const unsigned char *lp;
+      int                 delay;
+      int                 padding;
+
+      lp = p + offset + LAME_DELAY_OFFSET;
+      delay = (lp [0] << 4) | (lp [1] >> 4);
+      padding = ((lp [1] & 0x0f) << 8) | lp [2];
+      if (delay + padding < *samples) {
+        *samples -= delay + padding;
+      }
+    }
+    return true;
+  }
+
+  if (VBRI_OFFSET + VBRI_HEAD_SZ <= len &&
+      memcmp (p + VBRI_OFFSET, "VBRI", MP3HDR_ID_LEN) == 0) {
+    *samples = (int64_t) mp3hdrBE32 (p + VBRI_OFFSET + VBRI_FRAMES_OFFSET) *
+        frame->spf;
+    return true;
+  }
+
+  return false;
+}
+
+/* returns the offset of the data following any id3v2 tags */
+static int64_t
+mp3hdrSkipID3 (FILE *fh)
+{
+  unsigned char   hdr [ID3V2_HEAD_SZ];
+  int64_t         pos = 0;
+
+  while (fseek (fh, pos, SEEK_SET) == 0 &&
+      fread (hdr, ID3V2_HEAD_SZ, 1, fh) == 1 &&
+      memcmp (hdr, "ID3", 3) == 0) {
+    uint32_t    sz;
+
+    /* syncsafe integer */
+    sz = ((uint32_t) (hdr [6] & 0x7f) << 21) |
+        ((uint32_t) (hdr [7] & 0x7f) << 14) |
+        ((uint32_t) (hdr [8] & 0x7f) << 7) |
+        (uint32_t) (hdr [9] & 0x7f);
+    pos += ID3V2_HEAD_SZ + sz;
+    if ((hdr [5] & ID3V2_FLAG_FOOTER) == ID3V2_FLAG_FOOTER) {
+      pos += ID3V2_HEAD_SZ;
+    }
+  }
+
+  return pos;
+}
+
+/* returns the size of the id3v1 and apev2 tags at the end of the file */
+static int64_t
+mp3hdrTrailing (FILE *fh, int64_t fsize)
+{
+  unsigned char   buff [APE_FOOTER_SZ];
+  int64_t         len = 0;
+
+  if (fsize >= ID3V1_SZ &&
+      fseek (fh, fsize - ID3V1_SZ, SEEK_SET) == 0 &&
+      fread (buff, 3, 1, fh) == 1 &&
+      memcmp (buff, "TAG", 3) == 0) {
+    len += ID3V1_SZ;
+  }
+
+  if (fsize - len >= APE_FOOTER_SZ &&
+      fseek (fh, fsize - len - APE_FOOTER_SZ, SEEK_SET) == 0 &&
+      fread (buff, APE_FOOTER_SZ, 1, fh) == 1 &&
+      memcmp (buff, "APETAGEX", 8) == 0) {
+    /* little-endian, the size includes the footer but not the header */
+    len += (int64_t) buff [12] | ((int64_t) buff [13] << 8) |
+        ((int64_t) buff [14] << 16) | ((int64_t) buff [15] << 24);
+    if ((buff [23] & APE_FLAG_HEADER) == APE_FLAG_HEADER) {
+      len += APE_FOOTER_SZ;
+    }
+  }
+
+  if (len > fsize) {
+    len = 0;
+  }
+  return len;
+}
+
+static uint32_t
+mp3hdrBE32 (const unsigned char *p)
+{
+  return ((uint32_t) p [0] << 24) | ((uint32_t) p [1] << 16) |
+      ((uint32_t) p [2] << 8) | (uint32_t) p [3];
+}
@@ -69,6 +69,13 @@ osDirOpen (const char *dirname)
 
 char *
 osDirIterate (dirhandle_t *dirh)
+{
+  return osDirIterateType (dirh, NULL);
+}
+
+/* the type is taken from the directory entry, no stat() is done */
+char *
+osDirIterateType (dirhandle_t *dirh, int *type)
 {
   char      *fname = NULL;
 #if _lib_FindFirstFileW
@@ -78,6 +85,10 @@ osDirIterate (dirhandle_t *dirh)
   struct dirent   *dirent = NULL;
 #endif
 
+  if (type != NULL) {
+    *type = OSDIR_TYPE_UNKNOWN;
+  }
+
   if (dirh == NULL) {
     return NULL;
   }
@@ -101,6 +112,16 @@ osDirIterate (dirhandle_t *dirh)
   fname = NULL;
   if (rc != 0) {
     fname = osFromWideChar (filedata.cFileName);
+    if (type != NULL) {
+      *type = OSDIR_TYPE_FILE;
+      if ((filedata.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) ==
+          FILE_ATTRIBUTE_REPARSE_POINT) {
+        *type = OSDIR_TYPE_LINK;
+      } else if ((filedata.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ==
+          FILE_ATTRIBUTE_DIRECTORY) {
+        *type = OSDIR_TYPE_DIR;
+      }
+    }
   }
 #else
   if (dirh->dh == NULL) {
@@ -111,6 +132,17 @@ osDirIterate (dirhandle_t *dirh)
   fname = NULL;
   if (dirent != NULL) {
     fname = mdstrdup (dirent->d_name);
+# if _define_DT_DIR
+    if (type != NULL) {
+      if (dirent->d_type == DT_REG) {
+        *type = OSDIR_TYPE_FILE;
+      } else if (dirent->d_type == DT_DIR) {
+        *type = OSDIR_TYPE_DIR;
+      } else if (dirent->d_type == DT_LNK) {
+        *type = OSDIR_TYPE_LINK;
+      }
+    }
+# endif
   }
 #endif
 
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#if _hdr_fcntl
+# include <fcntl.h>
+#endif
+#if _hdr_unistd
+# include <unistd.h>
+#endif
+#if _sys_mman
+# include <sys/mman.h>
+#endif
+#if _hdr_stdatomic
+# include <stdatomic.h>
+#endif
+
+#include "log.h"
+#include "mdebug.h"
+#include "shmring.h"
+
+#define SHMRING_ENABLED (_hdr_stdatomic && _sys_mman && _lib_shm_open)
+
+#if SHMRING_ENABLED
+
+enum {
+  SHMRING_IDENT = 0x62646a72,
+  SHMRING_CACHE_LINE = 64,
+};
+
+typedef struct {
+  uint32_t      len;
+  char          data [SHMRING_SLOT_SZ - sizeof (uint32_t)];
+} shmslot_t;
+
+/* the head and tail indexes are kept on separate cache lines so */
+/* that the producer and consumer do not contend */
+typedef struct {
+  _Alignas (SHMRING_CACHE_LINE) uint32_t ident;
+  atomic_uint   closed;
+  _Alignas (SHMRING_CACHE_LINE) atomic_uint head;
+  _Alignas (SHMRING_CACHE_LINE) atomic_uint tail;
+  _Alignas (SHMRING_CACHE_LINE) shmslot_t slots [SHMRING_SLOTS];
+} shmhdr_t;
+
+typedef struct shmring {
+  shmhdr_t      *hdr;
+  char          name [40];
+  bool          owner;
+} shmring_t;
+
+static void shmringMakeName (uint16_t port, char *buff, size_t sz);
+static shmring_t *shmringMap (const char *name, int flags, bool owner);
+
+#endif /* SHMRING_ENABLED */
+
+bool
+shmringAvailable (void)
+{
+  return SHMRING_ENABLED;
+}
+
+shmring_t *
+shmringCreate (uint16_t port)
+{
+#if SHMRING_ENABLED
+  shmring_t   *ring;
+  char        name [40];
+
+  shmringMakeName (port, name, sizeof (name));
+  /* a ring left over from a process that did not exit cleanly */
+  shm_unlink (name);
+  ring = shmringMap (name, O_RDWR | O_CREAT | O_EXCL, true);
+  if (ring == NULL) {
+    return NULL;
+  }
+
+  atomic_init (&ring->hdr->closed, 0);
+  atomic_init (&ring->hdr->head, 0);
+  atomic_init (&ring->hdr->tail, 0);
+  atomic_thread_fence (memory_order_release);
+  ring->hdr->ident = SHMRING_IDENT;
+  logMsg (LOG_DBG, LOG_SOCKET, "shmring: created %s", name);
+  return ring;
+#else
+  return NULL;
+#endif
+}
+
+shmring_t *
+shmringOpen (uint16_t port)
+{
+#if SHMRING_ENABLED
+  shmring_t   *ring;
+  char        name [40];
+
+  shmringMakeName (port, name, sizeof (name));
+  ring = shmringMap (name, O_RDWR, false);
+  if (ring == NULL) {
+    return NULL;
+  }
+
+  atomic_thread_fence (memory_order_acquire);
+  if (ring->hdr->ident != SHMRING_IDENT ||
+      atomic_load (&ring->hdr->closed)) {
+    shmringClose (ring);
+    return NULL;
+  }
+  return ring;
+#else
+  return NULL;
+#endif
+}
+
+void
+shmringClose (shmring_t *ring)
+{
+#if SHMRING_ENABLED
+  if (ring == NULL) {
+    return;
+  }
+
+  if (ring->owner) {
+    atomic_store_explicit (&ring->hdr->closed, 1, memory_order_release);
+  }
+  munmap (ring->hdr, sizeof (shmhdr_t));
+  if (ring->owner) {
+    shm_unlink (ring->name);
+  }
+  mdfree (ring);
+#endif
+}
+
+bool
+shmringIsClosed (shmring_t *ring)
+{
+#if SHMRING_ENABLED
+  if (ring == NULL) {
+    return true;
+  }
+  return atomic_load_explicit (&ring->hdr->closed, memory_order_acquire) != 0;
+#else
+  return true;
+#endif
+}
+
+/* producer side. returns false if the ring is full or closed */
+bool
+shmringPut (shmring_t *ring, const char *data, size_t len)
+{
+#if SHMRING_ENABLED
+  unsigned int  head;
+  unsigned int  tail;
+  shmslot_t     *slot;
+
+  if (ring == NULL || len > sizeof (slot->data)) {
+    return false;
+  }
+  if (atomic_load_explicit (&ring->hdr->closed, memory_order_acquire)) {
+    return false;
+  }
+
+  head = atomic_load_explicit (&ring->hdr->head, memory_order_relaxed);
+  tail = atomic_load_explicit (&ring->hdr->tail, memory_order_acquire);
+  if (head - tail >= SHMRING_SLOTS) {
+    return false;
+  }
+
+  slot = &ring->hdr->slots [head % SHMRING_SLOTS];
+  memcpy (slot->data, data, len);
+  slot->len = (uint32_t) len;
+  atomic_store_explicit (&ring->hdr->head, head + 1, memory_order_release);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* consumer side. returns false if the ring is empty */
+bool
+shmringGet (shmring_t *ring, char *buff, size_t sz, size_t *len)
+{
+#if SHMRING_ENABLED
+  unsigned int  head;
+  unsigned int  tail;
+  shmslot_t     *slot;
+  size_t        tlen;
+
+  *len = 0;
+  if (ring == NULL) {
+    return false;
+  }
+
+  tail = atomic_load_explicit (&ring->hdr->tail, memory_order_relaxed);
+  head = atomic_load_explicit (&ring->hdr->head, memory_order_acquire);
+  if (head == tail) {
+    return false;
+  }
+
+  slot = &ring->hdr->slots [tail % SHMRING_SLOTS];
+  tlen = slot->len;
+  if (tlen > sz) {
+    tlen = sz;
+  }
+  memcpy (buff, slot->data, tlen);
+  *len = tlen;
+  atomic_store_explicit (&ring->hdr->tail, tail + 1, memory_order_release);
+  return true;
+#else
+  *len = 0;
+  return false;
+#endif
+}
+
+/* internal routines */
+
+#if SHMRING_ENABLED
+
+static void
+shmringMakeName (uint16_t port, char *buff, size_t sz)
+{
+  snprintf (buff, sz, "/bdj4-ring-%" PRIu16, port);
+}
+
+static shmring_t *
+shmringMap (const char *name, int flags, bool owner)
+{
+  shmring_t   *ring;
+  int         fd;
+  void        *addr;
+
+  fd = shm_open (name, flags, 0600);
+  if (fd < 0) {
+    if (owner) {
+      logMsg (LOG_DBG, LOG_SOCKET, "shmring: shm_open %s failed %d", name, errno);
+    }
+    return NULL;
+  }
+  if (owner && ftruncate (fd, sizeof (shmhdr_t)) != 0) {
+    logMsg (LOG_DBG, LOG_SOCKET, "shmring: ftruncate %s failed %d", name, errno);
+    close (fd);
+    shm_unlink (name);
+    return NULL;
+  }
+
+  addr = mmap (NULL, sizeof (shmhdr_t), PROT_READ | PROT_WRITE,
+      MAP_SHARED, fd, 0);
+  /* the mapping remains valid after the descriptor is closed */
+  close (fd);
+  if (addr == MAP_FAILED) {
+    logMsg (LOG_DBG, LOG_SOCKET, "shmring: mmap %s failed %d", name, errno);
+    if (owner) {
+      shm_unlink (name);
+    }
+    return NULL;
+  }
+
+  ring = mdmalloc (sizeof (shmring_t));
+  ring->hdr = addr;
+  ring->owner = owner;
+  snprintf (ring->name, sizeof (ring->name), "%s", name);
+  return ring;
+}
+
+#endif /* SHMRING_ENABLED */
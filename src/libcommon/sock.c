@@ -14,6 +14,7 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <signal.h>
+#include <stddef.h>
 #include <string.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -35,6 +36,12 @@
 #if _sys_socket
 # include <sys/socket.h>
 #endif
+#if _sys_uio
+# include <sys/uio.h>
+#endif
+#if _sys_un
+# include <sys/un.h>
+#endif
 
 #if _hdr_winsock2
 # include <winsock2.h>
@@ -44,8 +51,10 @@
 #endif
 
 #include "bdjstring.h"
+#include "ipcstats.h"
 #include "log.h"
 #include "mdebug.h"
+#include "pathbld.h"
 #include "sock.h"
 #include "tmutil.h"
 
@@ -77,14 +86,36 @@ static void     sockInit (void);
 static void     sockCleanup (void);
 static Sock_t   sockSetOptions (Sock_t sock, int *err);
 static void     sockUpdateReadCheck (sockinfo_t *sockinfo);
+static int      sockFamily (void);
+static Socklen_t sockMakeAddr (uint16_t port, struct sockaddr_storage *saddr);
 
 static int      sockInitialized = 0;
 static int      sockCount = 0;
+static socktransport_t sockTransport = SOCK_TRANS_TCP;
+
+void
+sockSetTransport (socktransport_t transport)
+{
+#if ! _sys_un
+  if (transport == SOCK_TRANS_LOCAL) {
+    logMsg (LOG_DBG, LOG_SOCKET, "local sockets not supported");
+    transport = SOCK_TRANS_TCP;
+  }
+#endif
+  sockTransport = transport;
+}
+
+socktransport_t
+sockGetTransport (void)
+{
+  return sockTransport;
+}
 
 Sock_t
 sockServer (uint16_t listenPort, int *err)
 {
-  struct sockaddr_in  saddr;
+  struct sockaddr_storage saddr;
+  Socklen_t           alen;
   int                 rc;
   int                 count;
   int                 typ;
@@ -99,7 +130,7 @@ sockServer (uint16_t listenPort, int *err)
 #if _define_SOCK_CLOEXEC
   typ |= SOCK_CLOEXEC;
 #endif
-  lsock = socket (AF_INET, typ, 0);
+  lsock = socket (sockFamily (), typ, 0);
   if (socketInvalid (lsock)) {
     *err = errno;
     logError ("socket:");
@@ -110,18 +141,23 @@ sockServer (uint16_t listenPort, int *err)
   }
 
   mdextsock (lsock);
-  lsock = sockSetOptions (lsock, err);
-  memset (&saddr, 0, sizeof (struct sockaddr_in));
-  saddr.sin_family = AF_INET;
-  saddr.sin_addr.s_addr = inet_addr ("127.0.0.1");
-  saddr.sin_port = htons (listenPort);
+  if (sockTransport == SOCK_TRANS_TCP) {
+    lsock = sockSetOptions (lsock, err);
+  }
+  alen = sockMakeAddr (listenPort, &saddr);
+#if _sys_un && ! __linux__
+  if (sockTransport == SOCK_TRANS_LOCAL) {
+    /* a socket file left over from a previous run */
+    unlink (((struct sockaddr_un *) &saddr)->sun_path);
+  }
+#endif
 
   count = 0;
-  rc = bind (lsock, (struct sockaddr *) &saddr, sizeof (struct sockaddr_in));
+  rc = bind (lsock, (struct sockaddr *) &saddr, alen);
   while (rc != 0 && count < 1000 && (errno == EADDRINUSE)) {
     mssleep (100);
     ++count;
-    rc = bind (lsock, (struct sockaddr *) &saddr, sizeof (struct sockaddr_in));
+    rc = bind (lsock, (struct sockaddr *) &saddr, alen);
   }
   if (rc != 0) {
     *err = errno;
@@ -316,11 +352,11 @@ sockCheck (sockinfo_t *sockinfo)
 Sock_t
 sockAccept (Sock_t lsock, int *err)
 {
-  struct sockaddr_in  saddr;
+  struct sockaddr_storage saddr;
   Socklen_t           alen;
   Sock_t              nsock;
 
-  alen = sizeof (struct sockaddr_in);
+  alen = sizeof (struct sockaddr_storage);
   nsock = accept (lsock, (struct sockaddr *) &saddr, &alen);
   if (socketInvalid (nsock)) {
     *err = errno;
@@ -348,7 +384,8 @@ sockAccept (Sock_t lsock, int *err)
 Sock_t
 sockConnect (uint16_t connPort, int *connerr, Sock_t clsock)
 {
-  struct sockaddr_in  raddr;
+  struct sockaddr_storage raddr;
+  Socklen_t           alen;
   int                 rc;
   int                 typ;
   int                 err = 0;
@@ -363,7 +400,7 @@ sockConnect (uint16_t connPort, int *connerr, Sock_t clsock)
 #if _define_SOCK_CLOEXEC
     typ |= SOCK_CLOEXEC;
 #endif
-    clsock = socket (AF_INET, typ, 0);
+    clsock = socket (sockFamily (), typ, 0);
 
     if (socketInvalid (clsock)) {
       *connerr = SOCK_CONN_FAIL;
@@ -382,7 +419,9 @@ sockConnect (uint16_t connPort, int *connerr, Sock_t clsock)
       return INVALID_SOCKET;
     }
 
-    clsock = sockSetOptions (clsock, &err);
+    if (sockTransport == SOCK_TRANS_TCP) {
+      clsock = sockSetOptions (clsock, &err);
+    }
     if (err != 0) {
       *connerr = SOCK_CONN_FAIL;
       mdextclose (clsock);
@@ -391,12 +430,8 @@ sockConnect (uint16_t connPort, int *connerr, Sock_t clsock)
     }
   }
 
-  memset (&raddr, 0, sizeof (struct sockaddr_in));
-  raddr.sin_family = AF_INET;
-  raddr.sin_addr.s_addr = inet_addr ("127.0.0.1");
-  raddr.sin_port = htons (connPort);
-
-  rc = connect (clsock, (struct sockaddr *) &raddr, sizeof (struct sockaddr_in));
+  alen = sockMakeAddr (connPort, &raddr);
+  rc = connect (clsock, (struct sockaddr *) &raddr, alen);
 
   if (rc == 0) {
     *connerr = SOCK_CONN_OK;
@@ -441,6 +476,10 @@ sockConnect (uint16_t connPort, int *connerr, Sock_t clsock)
     /* EWOULDBLOCK == 11 (linux) */
     /* ECONNREFUSED == 111 */
     /* ECONNABORTED == 103 */
+    /* ENOENT: unix domain socket file not yet present */
+    if (err == ENOENT) {
+      err = ECONNREFUSED;
+    }
     if (err == EINPROGRESS || err == EAGAIN || err == EINTR || err == EWOULDBLOCK) {
       *connerr = SOCK_CONN_IN_PROGRESS;
       /* leave the socket open */
@@ -487,6 +526,7 @@ sockReadBuff (Sock_t sock, size_t *rlen, char *data, size_t maxlen)
     return NULL;
   }
 
+  ipcstatsSockRead (sizeof (len) + len);
   *rlen = len;
   return data;
 }
@@ -504,7 +544,63 @@ sockWriteBinary (Sock_t sock, const char *data, size_t dlen,
 
   sendlen = (uint32_t) dlen;
   sendlen += alen;
+  ipcstatsSockWrite (sizeof (sendlen) + sendlen);
   sendlen = htonl (sendlen);
+
+#if _sys_uio && _lib_writev
+  {
+    struct iovec  iov [3];
+    int           iovcnt = 0;
+    size_t        tot = 0;
+    size_t        wrote;
+
+    /* write the length, prefix and arguments with a single call */
+    /* so that the message is not split across multiple packets */
+    iov [iovcnt].iov_base = (void *) &sendlen;
+    iov [iovcnt].iov_len = sizeof (sendlen);
+    ++iovcnt;
+    iov [iovcnt].iov_base = (void *) data;
+    iov [iovcnt].iov_len = dlen;
+    ++iovcnt;
+    if (alen != 0) {
+      iov [iovcnt].iov_base = (void *) args;
+      iov [iovcnt].iov_len = alen;
+      ++iovcnt;
+    }
+    for (int i = 0; i < iovcnt; ++i) {
+      tot += iov [i].iov_len;
+    }
+
+    rc = writev (sock, iov, iovcnt);
+    if (rc < 0 &&
+        errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+      logError ("writev");
+      return -1;
+    }
+    if (rc < 0) {
+      rc = 0;
+    }
+    if ((size_t) rc == tot) {
+      return 0;
+    }
+
+    /* partial write, send the remainder */
+    wrote = (size_t) rc;
+    for (int i = 0; i < iovcnt; ++i) {
+      if (wrote >= iov [i].iov_len) {
+        wrote -= iov [i].iov_len;
+        continue;
+      }
+      rc = sockWriteData (sock, (char *) iov [i].iov_base + wrote,
+          iov [i].iov_len - wrote);
+      if (rc < 0) {
+        return -1;
+      }
+      wrote = 0;
+    }
+    return 0;
+  }
+#else
   rc = sockWriteData (sock, (char *) &sendlen, sizeof (sendlen));
   if (rc < 0) {
     return -1;
@@ -520,6 +616,25 @@ sockWriteBinary (Sock_t sock, const char *data, size_t dlen,
     }
   }
   return 0;
+#endif
+}
+
+/* the data must already be framed with the message lengths */
+int
+sockWriteBuff (Sock_t sock, const char *data, size_t dlen)
+{
+  if (socketInvalid (sock)) {
+    return -1;
+  }
+  if (dlen == 0) {
+    return 0;
+  }
+
+  ipcstatsSockWrite (dlen);
+  if (sockWriteData (sock, data, dlen) < 0) {
+    return -1;
+  }
+  return 0;
 }
 
 bool
@@ -850,3 +965,55 @@ sockUpdateReadCheck (sockinfo_t *sockinfo)
   }
 }
 
+static int
+sockFamily (void)
+{
+#if _sys_un
+  if (sockTransport == SOCK_TRANS_LOCAL) {
+    return AF_UNIX;
+  }
+#endif
+  return AF_INET;
+}
+
+static Socklen_t
+sockMakeAddr (uint16_t port, struct sockaddr_storage *saddr)
+{
+  struct sockaddr_in  *iaddr;
+  Socklen_t           alen;
+
+  memset (saddr, 0, sizeof (struct sockaddr_storage));
+
+#if _sys_un
+  if (sockTransport == SOCK_TRANS_LOCAL) {
+    struct sockaddr_un  *uaddr;
+
+    uaddr = (struct sockaddr_un *) saddr;
+    uaddr->sun_family = AF_UNIX;
+# if __linux__
+    /* linux: use the abstract namespace, no socket file is needed */
+    snprintf (uaddr->sun_path + 1, sizeof (uaddr->sun_path) - 1,
+        "bdj4-%" PRIu16, port);
+    alen = (Socklen_t) (offsetof (struct sockaddr_un, sun_path) + 1 +
+        strlen (uaddr->sun_path + 1));
+# else
+    {
+      char    tbuff [40];
+
+      snprintf (tbuff, sizeof (tbuff), "bdj4-%" PRIu16, port);
+      pathbldMakePath (uaddr->sun_path, sizeof (uaddr->sun_path),
+          tbuff, ".sock", PATHBLD_MP_DREL_TMP);
+      alen = sizeof (struct sockaddr_un);
+    }
+# endif
+    return alen;
+  }
+#endif
+
+  iaddr = (struct sockaddr_in *) saddr;
+  iaddr->sin_family = AF_INET;
+  iaddr->sin_addr.s_addr = inet_addr ("127.0.0.1");
+  iaddr->sin_port = htons (port);
+  alen = sizeof (struct sockaddr_in);
+  return alen;
+}
@@ -11,13 +11,20 @@
 #include <inttypes.h>
 #include <errno.h>
 
+#if _hdr_arpa_inet
+# include <arpa/inet.h>
+#endif
 #if _hdr_winsock2
 # include <winsock2.h>
 #endif
 
 #include "bdjmsg.h"
+#include "bdjvars.h"
+#include "callback.h"
+#include "ipcstats.h"
 #include "log.h"
 #include "mdebug.h"
+#include "shmring.h"
 #include "sock.h"
 #include "sockh.h"
 #include "tmutil.h"
@@ -28,9 +35,34 @@ enum {
   MAIN_FINISH,
 };
 
+/* only the most recent of these messages is of interest. */
+/* an older message still waiting in the outbound buffer is replaced. */
+static bdjmsgmsg_t sockhSuperseded [] = {
+  MSG_PLAYER_STATUS_DATA,
+  MSG_MUSICQ_STATUS_DATA,
+  MSG_MARQUEE_TIMER,
+};
+enum {
+  SOCKH_SUPERSEDED_MAX = sizeof (sockhSuperseded) / sizeof (bdjmsgmsg_t),
+  SOCKH_BUFF_INIT = 2048,
+};
+
+typedef struct sockhbuff {
+  char      *data;
+  size_t    len;
+  size_t    alloc;
+  /* location of the superseded messages in the buffer */
+  size_t    sofs [SOCKH_SUPERSEDED_MAX];
+  size_t    slen [SOCKH_SUPERSEDED_MAX];
+} sockhbuff_t;
+
+static callback_t   *sockhFlushCB = NULL;
+
 static sockserver_t * sockhStartServer (uint16_t listenPort);
 static void  sockhCloseServer (sockserver_t *sockserver);
 static int   sockhProcessMain (sockserver_t *sockserver, sockhProcessMsg_t msgProc, void *userData);
+static int   sockhProcessRing (sockserver_t *sockserver, sockhProcessMsg_t msgProc, void *userData);
+static void  sockhBuffRemove (sockhbuff_t *sb, int sidx);
 
 void
 sockhMainLoop (uint16_t listenPort, sockhProcessMsg_t msgFunc,
@@ -45,7 +77,10 @@ sockhMainLoop (uint16_t listenPort, sockhProcessMsg_t msgFunc,
     int     rc;
     int     tdone = 0;
 
-    tdone = sockhProcessMain (sockserver, msgFunc, userData);
+    tdone = sockhProcessRing (sockserver, msgFunc, userData);
+    if (tdone != MAIN_FINISH) {
+      tdone = sockhProcessMain (sockserver, msgFunc, userData);
+    }
     if (tdone == MAIN_FINISH) {
       rc = sockWaitClosed (sockserver->si);
       if (rc) {
@@ -53,6 +88,10 @@ sockhMainLoop (uint16_t listenPort, sockhProcessMsg_t msgFunc,
       }
     }
     tdone = processFunc (userData);
+    /* any messages generated during this pass are sent together */
+    if (sockhFlushCB != NULL) {
+      callbackHandler (sockhFlushCB);
+    }
     if (tdone == SOCKH_STOP) {
       rc = sockWaitClosed (sockserver->si);
       if (rc) {
@@ -78,31 +117,223 @@ sockhSendMessage (Sock_t sock, bdjmsgroute_t routefrom,
   size_t      pfxlen;
   int         rc;
   size_t      alen;
+  int64_t     tstart;
 
   if (sock == INVALID_SOCKET) {
     return -1;
   }
 
+  tstart = ipcstatsStart ();
   /* this is only to keep the log clean */
   pfxlen = msgEncode (routefrom, route, msg, msgbuff, sizeof (msgbuff));
   if (args != NULL) {
     /* if args is specified, do not send the null byte */
     pfxlen -= 1;
   }
-  alen = 0;
-  if (args != NULL) {
-    /* write out the null byte also.  the args string must be terminated */
-    alen = strlen (args) + 1;
-  }
+  /* text args: write out the null byte also. */
+  /* the args string must be terminated */
+  /* binary args carry their own length */
+  alen = msgArgsLen (args);
+  ipcstatsSent (route, msg, pfxlen + alen, tstart);
   rc = sockWriteBinary (sock, msgbuff, pfxlen, args, alen);
   if (rc == 0 &&
       msg != MSG_MUSICQ_STATUS_DATA && msg != MSG_PLAYER_STATUS_DATA) {
-    logMsg (LOG_DBG, LOG_SOCKET, "sent: msg:%d/%s to %d/%s rc:%d pfx:%s args:%s",
-        msg, msgDebugText (msg), route, msgRouteDebugText (route), rc, msgbuff, args);
+    logMsg (LOG_DBG, LOG_SOCKET, "sent: msg:%d/%s to %d/%s rc:%d args:%s",
+        msg, msgDebugText (msg), route, msgRouteDebugText (route), rc,
+        msgArgsIsTLV (args) ? "(binary)" : args);
   }
   return rc;
 }
 
+/* the flush callback is called once for each pass of the main loop */
+void
+sockhSetFlushCallback (callback_t *cb)
+{
+  sockhFlushCB = cb;
+}
+
+sockhbuff_t *
+sockhBuffAlloc (void)
+{
+  sockhbuff_t   *sb;
+
+  sb = mdmalloc (sizeof (sockhbuff_t));
+  sb->data = NULL;
+  sb->len = 0;
+  sb->alloc = 0;
+  for (int i = 0; i < SOCKH_SUPERSEDED_MAX; ++i) {
+    sb->slen [i] = 0;
+    sb->sofs [i] = 0;
+  }
+  return sb;
+}
+
+void
+sockhBuffFree (sockhbuff_t *sb)
+{
+  if (sb == NULL) {
+    return;
+  }
+
+  dataFree (sb->data);
+  mdfree (sb);
+}
+
+/* returns false if the message was not added to the buffer, */
+/* in which case the buffer should be flushed and the message */
+/* sent directly */
+bool
+sockhBuffMessage (sockhbuff_t *sb, bdjmsgroute_t routefrom,
+    bdjmsgroute_t route, bdjmsgmsg_t msg, const char *args)
+{
+  char        msgbuff [BDJMSG_MAX_PFX];
+  size_t      pfxlen;
+  size_t      alen;
+  size_t      flen;
+  uint32_t    sendlen;
+  int         sidx = -1;
+  int64_t     tstart;
+
+  if (sb == NULL) {
+    return false;
+  }
+
+  tstart = ipcstatsStart ();
+  pfxlen = msgEncode (routefrom, route, msg, msgbuff, sizeof (msgbuff));
+  if (args != NULL) {
+    pfxlen -= 1;
+  }
+  alen = msgArgsLen (args);
+  flen = sizeof (sendlen) + pfxlen + alen;
+
+  for (int i = 0; i < SOCKH_SUPERSEDED_MAX; ++i) {
+    if (msg == sockhSuperseded [i]) {
+      sidx = i;
+      break;
+    }
+  }
+  if (sidx >= 0 && sb->slen [sidx] > 0) {
+    sockhBuffRemove (sb, sidx);
+    ipcstatsSuperseded (msg);
+  }
+
+  if (sb->len + flen > SOCKH_BUFF_MAX) {
+    return false;
+  }
+
+  if (sb->len + flen > sb->alloc) {
+    sb->alloc += SOCKH_BUFF_INIT;
+    if (sb->alloc < sb->len + flen) {
+      sb->alloc = sb->len + flen;
+    }
+    sb->data = mdrealloc (sb->data, sb->alloc);
+  }
+
+  if (sidx >= 0) {
+    sb->sofs [sidx] = sb->len;
+    sb->slen [sidx] = flen;
+  }
+
+  sendlen = htonl ((uint32_t) (pfxlen + alen));
+  memcpy (sb->data + sb->len, &sendlen, sizeof (sendlen));
+  sb->len += sizeof (sendlen);
+  memcpy (sb->data + sb->len, msgbuff, pfxlen);
+  sb->len += pfxlen;
+  if (alen > 0) {
+    memcpy (sb->data + sb->len, args, alen);
+    sb->len += alen;
+  }
+  ipcstatsSent (route, msg, pfxlen + alen, tstart);
+
+  if (msg != MSG_MUSICQ_STATUS_DATA && msg != MSG_PLAYER_STATUS_DATA) {
+    logMsg (LOG_DBG, LOG_SOCKET, "queued: msg:%d/%s to %d/%s args:%s",
+        msg, msgDebugText (msg), route, msgRouteDebugText (route),
+        msgArgsIsTLV (args) ? "(binary)" : args);
+  }
+  return true;
+}
+
+bool
+sockhBuffIsEmpty (sockhbuff_t *sb)
+{
+  if (sb == NULL) {
+    return true;
+  }
+  return sb->len == 0;
+}
+
+/* the buffer is emptied whether or not the write succeeds */
+int
+sockhBuffFlush (Sock_t sock, sockhbuff_t *sb)
+{
+  int     rc;
+
+  if (sb == NULL || sb->len == 0) {
+    return 0;
+  }
+
+  rc = sockWriteBuff (sock, sb->data, sb->len);
+  sb->len = 0;
+  for (int i = 0; i < SOCKH_SUPERSEDED_MAX; ++i) {
+    sb->slen [i] = 0;
+  }
+  return rc;
+}
+
+/* the status ring is only used for the player status messages */
+/* sent from the player to main.  the player's other status messages */
+/* use the socket, so only main creates a ring. */
+bool
+sockhStatusRingPort (uint16_t port)
+{
+  if (sockGetTransport () != SOCK_TRANS_LOCAL) {
+    return false;
+  }
+  if (! shmringAvailable ()) {
+    return false;
+  }
+  if (! bdjvarsIsInitialized ()) {
+    return false;
+  }
+
+  return port == bdjvarsGetNum (BDJVL_PORT_MAIN);
+}
+
+/* returns -1 if the message could not be placed in the ring, */
+/* in which case the caller should send the message on the socket */
+int
+sockhRingSendMessage (shmring_t *ring, bdjmsgroute_t routefrom,
+    bdjmsgroute_t route, bdjmsgmsg_t msg, const char *args)
+{
+  char        msgbuff [SHMRING_SLOT_SZ];
+  size_t      pfxlen;
+  size_t      alen;
+  int64_t     tstart;
+
+  if (ring == NULL) {
+    return -1;
+  }
+
+  tstart = ipcstatsStart ();
+  pfxlen = msgEncode (routefrom, route, msg, msgbuff, sizeof (msgbuff));
+  alen = msgArgsLen (args);
+  if (alen > 0) {
+    pfxlen -= 1;
+  }
+  if (pfxlen + alen > sizeof (msgbuff) - sizeof (uint32_t)) {
+    return -1;
+  }
+  if (alen > 0) {
+    memcpy (msgbuff + pfxlen, args, alen);
+  }
+
+  if (! shmringPut (ring, msgbuff, pfxlen + alen)) {
+    return -1;
+  }
+  ipcstatsSent (route, msg, pfxlen + alen, tstart);
+  return 0;
+}
+
 /* internal routines */
 
 static sockserver_t *
@@ -114,8 +345,13 @@ sockhStartServer (uint16_t listenPort)
   sockserver = mdmalloc (sizeof (sockserver_t));
   sockserver->listenSock = INVALID_SOCKET;
   sockserver->si = NULL;
+  sockserver->ring = NULL;
 
   logProcBegin ();
+  /* the ring must exist before a connection can be made */
+  if (sockhStatusRingPort (listenPort)) {
+    sockserver->ring = shmringCreate (listenPort);
+  }
   sockserver->listenSock = sockServer (listenPort, &err);
   sockserver->si = sockAddCheck (sockserver->si, sockserver->listenSock);
   logMsg (LOG_DBG, LOG_SOCKET, "add listen sock %" PRId64,
@@ -130,6 +366,7 @@ sockhCloseServer (sockserver_t *sockserver)
     logMsg (LOG_DBG, LOG_SOCKET, "close listen sock %" PRId64, (int64_t) sockserver->listenSock);
     sockClose (sockserver->listenSock);
     sockFreeCheck (sockserver->si);
+    shmringClose (sockserver->ring);
     mdfree (sockserver);
   }
 }
@@ -149,6 +386,7 @@ sockhProcessMain (sockserver_t *sockserver, sockhProcessMsg_t msgFunc,
   int         rc = MAIN_NO_DATA;
   int         trc;
   int         err = 0;
+  int64_t     tstart;
 
 
   msgsock = sockCheck (sockserver->si);
@@ -181,13 +419,14 @@ sockhProcessMain (sockserver_t *sockserver, sockhProcessMsg_t msgFunc,
       return rc;
     }
 
-    logMsg (LOG_DBG, LOG_SOCKET, "rcvd message: %s", rval);
-
+    tstart = ipcstatsStart ();
     msgDecode (msgbuff, &routefrom, &route, &msg, &args);
+    ipcstatsRcvd (routefrom, msg, len, tstart, msgTimeSent (msgbuff));
     logMsg (LOG_DBG, LOG_SOCKET,
         "sockh: from: %d/%s route:%d/%s msg:%d/%s args:%s",
         routefrom, msgRouteDebugText (routefrom),
-        route, msgRouteDebugText (route), msg, msgDebugText (msg), args);
+        route, msgRouteDebugText (route), msg, msgDebugText (msg),
+        msgArgsIsTLV (args) ? "(binary)" : args);
     switch (msg) {
       case MSG_NULL: {
         break;
@@ -205,6 +444,20 @@ sockhProcessMain (sockserver_t *sockserver, sockhProcessMsg_t msgFunc,
         sockClose (msgsock);
         break;
       }
+      /* the statistics are answered directly on the socket */
+      /* the requester closes the socket once the response is read, */
+      /* so the active counter is incremented as for a handshake */
+      case MSG_DEBUG_IPC_STATS: {
+        char    *rbuff;
+
+        sockIncrActive (sockserver->si);
+        rbuff = mdmalloc (IPCSTATS_REPORT_MAX);
+        ipcstatsReport (rbuff, IPCSTATS_REPORT_MAX);
+        sockhSendMessage (msgsock, route, routefrom,
+            MSG_DEBUG_IPC_STATS_DATA, rbuff);
+        mdfree (rbuff);
+        break;
+      }
       /* extra handshake handling so that the active */
       /* counter can be incremented */
       case MSG_HANDSHAKE: {
@@ -227,3 +480,56 @@ sockhProcessMain (sockserver_t *sockserver, sockhProcessMsg_t msgFunc,
   return rc;
 }
 
+static void
+sockhBuffRemove (sockhbuff_t *sb, int sidx)
+{
+  size_t    ofs;
+  size_t    flen;
+
+  ofs = sb->sofs [sidx];
+  flen = sb->slen [sidx];
+  memmove (sb->data + ofs, sb->data + ofs + flen, sb->len - (ofs + flen));
+  sb->len -= flen;
+  sb->slen [sidx] = 0;
+
+  for (int i = 0; i < SOCKH_SUPERSEDED_MAX; ++i) {
+    if (sb->slen [i] > 0 && sb->sofs [i] > ofs) {
+      sb->sofs [i] -= flen;
+    }
+  }
+}
+
+static int
+sockhProcessRing (sockserver_t *sockserver, sockhProcessMsg_t msgFunc,
+    void *userData)
+{
+  char          msgbuff [SHMRING_SLOT_SZ];
+  size_t        len;
+  bdjmsgroute_t routefrom = ROUTE_NONE;
+  bdjmsgroute_t route = ROUTE_NONE;
+  bdjmsgmsg_t   msg = MSG_NULL;
+  char          *args;
+  int           rc = MAIN_NO_DATA;
+
+  if (sockserver->ring == NULL) {
+    return rc;
+  }
+
+  /* only the most recent status is of interest, but each message */
+  /* is passed on, as the status messages are tiny */
+  while (shmringGet (sockserver->ring, msgbuff, sizeof (msgbuff) - 1, &len)) {
+    int64_t   tstart;
+
+    msgbuff [len] = '\0';
+    rc = MAIN_HAD_DATA;
+    tstart = ipcstatsStart ();
+    msgDecode (msgbuff, &routefrom, &route, &msg, &args);
+    ipcstatsRcvd (routefrom, msg, len, tstart, msgTimeSent (msgbuff));
+    if (msgFunc (routefrom, route, msg, args, userData)) {
+      rc = MAIN_FINISH;
+      break;
+    }
+  }
+
+  return rc;
+}
@@ -119,6 +119,7 @@ static sysvarsdesc_t sysvarsldesc [SVL_MAX] = {
   [SVL_DATAPATH] = { "DATAPATH" },
   [SVL_HOME_SZ] = { "HOME_SZ" },
   [SVL_INITIAL_PORT] = { "INITIAL_PORT" },
+  [SVL_IPC_LOCAL] = { "IPC_LOCAL" },
   [SVL_IS_LINUX] = { "IS_LINUX" },
   [SVL_IS_MACOS] = { "IS_MACOS" },
   [SVL_IS_MSYS] = { "IS_MSYS" },
@@ -791,6 +792,13 @@ sysvarsInit (const char *argv0, int flags)
     }
   }
 
+  /* local (unix domain socket) ipc is used if the file exists */
+  lsysvars [SVL_IPC_LOCAL] = false;
+  snprintf (buff, sizeof (buff), "data/%s%s", IPC_LOCAL_FN, BDJ4_CONFIG_EXT);
+  if (fileopFileExists (buff)) {
+    lsysvars [SVL_IPC_LOCAL] = true;
+  }
+
   snprintf (buff, sizeof (buff), "data/%s%s", ALT_IDX_FN, BDJ4_CONFIG_EXT);
   if (fileopFileExists (buff)) {
     FILE    *fh;
@@ -102,6 +102,18 @@ mstime (void)
   return tot;
 }
 
+/* microseconds, used to time messages sent between processes */
+int64_t
+ustime (void)
+{
+  struct timeval    curr;
+  int64_t           tot;
+
+  gettimeofday (&curr, NULL);
+  tot = (int64_t) curr.tv_sec * 1000000 + (int64_t) curr.tv_usec;
+  return tot;
+}
+
 time_t
 mstimestartofday (void)
 {
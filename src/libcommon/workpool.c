@@ -0,0 +1,387 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * a bounded pool of worker threads.
+ * jobs are added by the main thread, processed by the workers, and
+ * the completed jobs are retrieved by the main thread using
+ * workpoolProcess(), which does not block.
+ * the job data is owned by the caller.
+ *
+ * if threads are not available, or the memory debugging code is
+ * enabled (not thread safe), workpoolProcess() runs one job in the
+ * calling thread.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if _hdr_pthread
+# include <pthread.h>
+#endif
+
+#include "bdjstring.h"
+#include "log.h"
+#include "mdebug.h"
+#include "queue.h"
+#include "sysvars.h"
+#include "workpool.h"
+
+#if _lib_pthread_create && ! defined (BDJ4_MEM_DEBUG)
+# define WORKPOOL_THREADS 1
+#else
+# define WORKPOOL_THREADS 0
+#endif
+
+enum {
+  WORKPOOL_MAX_THREADS = 16,
+};
+
+typedef struct {
+  workpool_t  *wp;
+  int         thridx;
+#if WORKPOOL_THREADS
+  pthread_t   thread;
+#endif
+} workthread_t;
+
+typedef struct {
+  void        *job;
+  bool        cancelled;
+} workdone_t;
+
+typedef struct workpool {
+  char            *tag;
+  workpoolcb_t    cb;
+  void            *udata;
+  queue_t         *pending;
+  queue_t         *done;
+  workthread_t    *threads;
+  int             numthreads;
+  int             running;
+  int             count;
+  int             tot;
+#if WORKPOOL_THREADS
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+#endif
+  bool            cancelled;
+  bool            stopping;
+} workpool_t;
+
+#if WORKPOOL_THREADS
+static void *workpoolThread (void *tdata);
+#endif
+static void workpoolPushDone (workpool_t *wp, void *job, bool cancelled);
+static void workpoolLock (workpool_t *wp);
+static void workpoolUnlock (workpool_t *wp);
+
+/* numthreads : if <= 0, the number of processors is used */
+workpool_t *
+workpoolAlloc (const char *tag, int numthreads, workpoolcb_t cb, void *udata)
+{
+  workpool_t  *wp;
+
+  wp = mdmalloc (sizeof (workpool_t));
+  wp->tag = mdstrdup (tag);
+  wp->cb = cb;
+  wp->udata = udata;
+  wp->pending = queueAlloc ("workpool-pending", NULL);
+  wp->done = queueAlloc ("workpool-done", NULL);
+  wp->running = 0;
+  wp->count = 0;
+  wp->tot = 0;
+  wp->cancelled = false;
+  wp->stopping = false;
+
+  if (numthreads <= 0) {
+    numthreads = sysvarsGetNum (SVL_NUM_PROC);
+  }
+  if (numthreads < 1) {
+    numthreads = 1;
+  }
+  if (numthreads > WORKPOOL_MAX_THREADS) {
+    numthreads = WORKPOOL_MAX_THREADS;
+  }
+#if ! WORKPOOL_THREADS
+  numthreads = 1;
+#endif
+  wp->numthreads = numthreads;
+  wp->threads = mdmalloc (sizeof (workthread_t) * numthreads);
+
+#if WORKPOOL_THREADS
+  pthread_mutex_init (&wp->mutex, NULL);
+  pthread_cond_init (&wp->cond, NULL);
+  for (int i = 0; i < numthreads; ++i) {
+    wp->threads [i].wp = wp;
+    wp->threads [i].thridx = i;
+    if (pthread_create (&wp->threads [i].thread, NULL,
+        workpoolThread, &wp->threads [i]) != 0) {
+      logMsg (LOG_DBG, LOG_IMPORTANT, "ERR: workpool: %s: thread create failed", tag);
+      wp->numthreads = i;
+      break;
+    }
+  }
+  if (wp->numthreads == 0) {
+    /* process in the main thread */
+    wp->numthreads = 1;
+    wp->threads [0].wp = wp;
+    wp->threads [0].thridx = -1;
+  }
+#else
+  wp->threads [0].wp = wp;
+  wp->threads [0].thridx = -1;
+#endif
+
+  logMsg (LOG_DBG, LOG_INFO, "workpool: %s: threads: %d", tag, wp->numthreads);
+  return wp;
+}
+
+/* any running jobs are waited for */
+/* the job data is not freed, the caller should use workpoolCancel() */
+/* and retrieve all of the jobs before freeing the pool */
+void
+workpoolFree (workpool_t *wp)
+{
+  if (wp == NULL) {
+    return;
+  }
+
+  workpoolLock (wp);
+  wp->stopping = true;
+  wp->cancelled = true;
+#if WORKPOOL_THREADS
+  pthread_cond_broadcast (&wp->cond);
+#endif
+  workpoolUnlock (wp);
+
+#if WORKPOOL_THREADS
+  if (wp->threads [0].thridx >= 0) {
+    for (int i = 0; i < wp->numthreads; ++i) {
+      pthread_join (wp->threads [i].thread, NULL);
+    }
+  }
+  pthread_cond_destroy (&wp->cond);
+  pthread_mutex_destroy (&wp->mutex);
+#endif
+
+  queueFree (wp->pending);
+  while (queueGetCount (wp->done) > 0) {
+    mdfree (queuePop (wp->done));
+  }
+  queueFree (wp->done);
+  dataFree (wp->threads);
+  dataFree (wp->tag);
+  mdfree (wp);
+}
+
+/* the number of threads, the caller may use this to allocate */
+/* per-thread data.  the thridx passed to the callback is in the range */
+/* 0 to count-1. */
+int
+workpoolThreadCount (workpool_t *wp)
+{
+  if (wp == NULL) {
+    return 0;
+  }
+  return wp->numthreads;
+}
+
+void
+workpoolAdd (workpool_t *wp, void *job)
+{
+  if (wp == NULL) {
+    return;
+  }
+
+  workpoolLock (wp);
+  if (wp->cancelled) {
+    workpoolPushDone (wp, job, true);
+    workpoolUnlock (wp);
+    return;
+  }
+  queuePush (wp->pending, job);
+  ++wp->tot;
+#if WORKPOOL_THREADS
+  pthread_cond_signal (&wp->cond);
+#endif
+  workpoolUnlock (wp);
+}
+
+/* called by the main thread, does not block when threads are in use */
+/* returns a completed (or cancelled) job, or null if there are none */
+void *
+workpoolProcess (workpool_t *wp, bool *cancelled)
+{
+  workdone_t  *wd;
+  void        *job = NULL;
+
+  *cancelled = false;
+  if (wp == NULL) {
+    return NULL;
+  }
+
+  workpoolLock (wp);
+  if (wp->threads [0].thridx < 0) {
+    /* no threads, run one job */
+    job = queuePop (wp->pending);
+    if (job != NULL) {
+      wp->running = 1;
+      workpoolUnlock (wp);
+      wp->cb (wp->udata, job, 0);
+      workpoolLock (wp);
+      wp->running = 0;
+      workpoolPushDone (wp, job, false);
+    }
+  }
+  wd = queuePop (wp->done);
+  workpoolUnlock (wp);
+
+  job = NULL;
+  if (wd != NULL) {
+    job = wd->job;
+    *cancelled = wd->cancelled;
+    mdfree (wd);
+  }
+  return job;
+}
+
+/* any pending jobs are returned by workpoolProcess() as cancelled */
+/* running jobs may check workpoolIsCancelled() */
+void
+workpoolCancel (workpool_t *wp)
+{
+  void    *job;
+
+  if (wp == NULL) {
+    return;
+  }
+
+  workpoolLock (wp);
+  wp->cancelled = true;
+  while ((job = queuePop (wp->pending)) != NULL) {
+    workpoolPushDone (wp, job, true);
+  }
+  workpoolUnlock (wp);
+}
+
+bool
+workpoolIsCancelled (workpool_t *wp)
+{
+  bool    rc;
+
+  if (wp == NULL) {
+    return true;
+  }
+
+  workpoolLock (wp);
+  rc = wp->cancelled;
+  workpoolUnlock (wp);
+  return rc;
+}
+
+/* no pending, running or un-retrieved jobs */
+bool
+workpoolIsIdle (workpool_t *wp)
+{
+  bool    rc;
+
+  if (wp == NULL) {
+    return true;
+  }
+
+  workpoolLock (wp);
+  rc = queueGetCount (wp->pending) == 0 &&
+      wp->running == 0 &&
+      queueGetCount (wp->done) == 0;
+  workpoolUnlock (wp);
+  return rc;
+}
+
+/* count : the number of jobs finished, tot : the number of jobs added */
+void
+workpoolGetCount (workpool_t *wp, int *count, int *tot)
+{
+  *count = 0;
+  *tot = 0;
+  if (wp == NULL) {
+    return;
+  }
+
+  workpoolLock (wp);
+  *count = wp->count;
+  *tot = wp->tot;
+  workpoolUnlock (wp);
+}
+
+/* internal routines */
+
+#if WORKPOOL_THREADS
+
+static void *
+workpoolThread (void *tdata)
+{
+  workthread_t  *wt = tdata;
+  workpool_t    *wp = wt->wp;
+  void          *job;
+
+  while (true) {
+    pthread_mutex_lock (&wp->mutex);
+    while (! wp->stopping && queueGetCount (wp->pending) == 0) {
+      pthread_cond_wait (&wp->cond, &wp->mutex);
+    }
+    if (wp->stopping) {
+      pthread_mutex_unlock (&wp->mutex);
+      break;
+    }
+    job = queuePop (wp->pending);
+    ++wp->running;
+    pthread_mutex_unlock (&wp->mutex);
+
+    wp->cb (wp->udata, job, wt->thridx);
+
+    pthread_mutex_lock (&wp->mutex);
+    --wp->running;
+    workpoolPushDone (wp, job, false);
+    pthread_mutex_unlock (&wp->mutex);
+  }
+
+  return NULL;
+}
+
+#endif
+
+/* the lock must be held */
+static void
+workpoolPushDone (workpool_t *wp, void *job, bool cancelled)
+{
+  workdone_t  *wd;
+
+  wd = mdmalloc (sizeof (workdone_t));
+  wd->job = job;
+  wd->cancelled = cancelled;
+  queuePush (wp->done, wd);
+  if (! cancelled) {
+    ++wp->count;
+  }
+}
+
+static void
+workpoolLock (workpool_t *wp)
+{
+#if WORKPOOL_THREADS
+  pthread_mutex_lock (&wp->mutex);
+#endif
+}
+
+static void
+workpoolUnlock (workpool_t *wp)
+{
+#if WORKPOOL_THREADS
+  pthread_mutex_unlock (&wp->mutex);
+#endif
+}
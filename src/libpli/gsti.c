@@ -11,6 +11,11 @@
  * modifying a playbin pipeline:
  * https://gstreamer.freedesktop.org/documentation/tutorials/playback/custom-playbin-sinks.html?gi-language=c
  *
+ * fades:
+ * the audio sink bin has a volume element with an interpolation
+ * control source.  The fade curve is scheduled as control points
+ * in stream time, and the volume element applies the gain per sample.
+ *
  */
 #include "config.h"
 
@@ -25,17 +30,24 @@
 #if _hdr_gst_gst
 
 # include <gst/gst.h>
+# if _hdr_gst_controller_controller
+#  include <gst/controller/controller.h>
+# endif
 # include <glib.h>
 
 #include "audiosrc.h"     // for audio-source type
 # include "bdj4.h"
 # include "bdjstring.h"
+# include "fadecurve.h"
 # include "mdebug.h"
 # include "gsti.h"
 # include "pli.h"
 
 enum {
   GSTI_IDENT = 0xccbbaa0069747367,
+  /* the number of control points used for a fade */
+  /* the volume element interpolates between the points */
+  GSTI_FADE_POINTS = 64,
 };
 
 /* gstreamer doesn't define these */
@@ -59,6 +71,8 @@ typedef struct gsti {
   uint64_t          ident;
   GMainContext      *mainctx;
   GstElement        *pipeline;
+  GstElement        *fadevol;
+  GstControlSource  *fadecs;
   guint             busId;
   plistate_t        state;
   double            rate;
@@ -69,6 +83,7 @@ static void gstiRunOnce (gsti_t *gsti);
 static gboolean gstiBusCallback (GstBus * bus, GstMessage * message, void *udata);
 static void gstiProcessState (gsti_t *gsti, GstState state);
 static void gstiWaitState (gsti_t *gsti, GstState want);
+static void gstiFadeClear (gsti_t *gsti);
 
 gsti_t *
 gstiInit (const char *plinm)
@@ -81,6 +96,7 @@ gstiInit (const char *plinm)
   GstElement        *convert;
   GstElement        *scaletempo;
   GstElement        *resample;
+  GstElement        *fadevol;
   GstElement        *sink;
   GstPlayFlags      flags;
 
@@ -89,6 +105,8 @@ gstiInit (const char *plinm)
   gsti = mdmalloc (sizeof (gsti_t));
   gsti->ident = GSTI_IDENT;
   gsti->pipeline = NULL;
+  gsti->fadevol = NULL;
+  gsti->fadecs = NULL;
   gsti->busId = 0;
   gsti->state = PLI_STATE_IDLE;
   gsti->rate = 1.0;
@@ -118,10 +136,26 @@ gstiInit (const char *plinm)
   g_object_set (G_OBJECT (resample), "quality", 8, NULL);
   gstiRunOnce (gsti);
 
+  fadevol = gst_element_factory_make ("volume", "fadevol");
+  gsti->fadevol = fadevol;
+#if _hdr_gst_controller_controller
+  gsti->fadecs = gst_interpolation_control_source_new ();
+  mdextalloc (gsti->fadecs);
+  g_object_set (G_OBJECT (gsti->fadecs), "mode",
+      GST_INTERPOLATION_MODE_LINEAR, NULL);
+  /* absolute: the control values are the volume property values */
+  gst_object_add_control_binding (GST_OBJECT (fadevol),
+      gst_direct_control_binding_new_absolute (GST_OBJECT (fadevol),
+      "volume", gsti->fadecs));
+  gst_object_set_control_binding_disabled (GST_OBJECT (fadevol),
+      "volume", TRUE);
+#endif
+
   sink = gst_element_factory_make ("autoaudiosink", "audio_sink");
   sinkbin = gst_bin_new ("audio_sink_bin");
-  gst_bin_add_many (GST_BIN (sinkbin), scaletempo, convert, resample, sink, NULL);
-  gst_element_link_many (scaletempo, convert, resample, sink, NULL);
+  gst_bin_add_many (GST_BIN (sinkbin), scaletempo, convert, fadevol,
+      resample, sink, NULL);
+  gst_element_link_many (scaletempo, convert, fadevol, resample, sink, NULL);
 
   pad = gst_element_get_static_pad (scaletempo, "sink");
   ghost_pad = gst_ghost_pad_new ("sink", pad);
@@ -163,6 +197,11 @@ gstiFree (gsti_t *gsti)
     gst_object_unref (gsti->pipeline);
   }
 
+  if (gsti->fadecs != NULL) {
+    mdextfree (gsti->fadecs);
+    gst_object_unref (gsti->fadecs);
+  }
+
   gstiRunOnce (gsti);
 
   mdfree (gsti);
@@ -192,6 +231,7 @@ gstiMedia (gsti_t *gsti, const char *fulluri, int sourceType)
   }
 
   gsti->rate = 1.0;
+  gstiFadeClear (gsti);
   g_object_set (G_OBJECT (gsti->pipeline), "uri", tbuff, NULL);
   gst_element_set_state (GST_ELEMENT (gsti->pipeline), GST_STATE_PAUSED);
   gsti->state = PLI_STATE_OPENING;
@@ -364,6 +404,69 @@ gstiSetRate (gsti_t *gsti, double rate)
   return rc;
 }
 
+bool
+gstiHaveFade (gsti_t *gsti)
+{
+  if (gsti == NULL || gsti->ident != GSTI_IDENT) {
+    return false;
+  }
+
+  return gsti->fadecs != NULL;
+}
+
+/* fadestart and fadelen are stream positions in milliseconds */
+void
+gstiFade (gsti_t *gsti, plifade_t fadedir, int fadeType,
+    int64_t fadestart, int64_t fadelen)
+{
+#if _hdr_gst_controller_controller
+  GstTimedValueControlSource  *tvcs;
+  GstClockTime                tstart;
+  GstClockTime                tlen;
+
+  if (gsti == NULL || gsti->ident != GSTI_IDENT || gsti->mainctx == NULL) {
+    return;
+  }
+  if (gsti->fadecs == NULL) {
+    return;
+  }
+
+  gstiFadeClear (gsti);
+  if (fadedir == PLI_FADE_NONE || fadelen <= 0) {
+    gstiRunOnce (gsti);
+    return;
+  }
+
+  if (fadestart < 0) {
+    fadestart = gstiGetPosition (gsti);
+  }
+  tstart = (GstClockTime) fadestart * GST_MSECOND;
+  tlen = (GstClockTime) fadelen * GST_MSECOND;
+
+  tvcs = GST_TIMED_VALUE_CONTROL_SOURCE (gsti->fadecs);
+  for (int i = 0; i <= GSTI_FADE_POINTS; ++i) {
+    double    findex;
+    double    gain;
+
+    findex = (double) i / (double) GSTI_FADE_POINTS;
+    if (fadedir == PLI_FADE_OUT) {
+      findex = 1.0 - findex;
+    }
+    gain = fadecurveCalc (fadeType, findex);
+    gst_timed_value_control_source_set (tvcs,
+        tstart + tlen * i / GSTI_FADE_POINTS, gain);
+  }
+
+  if (fadedir == PLI_FADE_IN) {
+    /* silent until the fade-in starts */
+    g_object_set (G_OBJECT (gsti->fadevol), "volume", 0.0, NULL);
+  }
+  gst_object_set_control_binding_disabled (GST_OBJECT (gsti->fadevol),
+      "volume", FALSE);
+  gstiRunOnce (gsti);
+#endif
+}
+
 int
 gstiGetVolume (gsti_t *gsti)
 {
@@ -485,6 +588,23 @@ gstiProcessState (gsti_t *gsti, GstState state)
   }
 }
 
+/* removes any scheduled fade and restores the full volume */
+static void
+gstiFadeClear (gsti_t *gsti)
+{
+#if _hdr_gst_controller_controller
+  if (gsti->fadecs == NULL) {
+    return;
+  }
+
+  gst_object_set_control_binding_disabled (GST_OBJECT (gsti->fadevol),
+      "volume", TRUE);
+  gst_timed_value_control_source_unset_all (
+      GST_TIMED_VALUE_CONTROL_SOURCE (gsti->fadecs));
+  g_object_set (G_OBJECT (gsti->fadevol), "volume", 1.0, NULL);
+#endif
+}
+
 static void
 gstiWaitState (gsti_t *gsti, GstState want)
 {
@@ -50,6 +50,7 @@ typedef struct pli {
   int               (*pliiSetAudioDevice) (plidata_t *plidata, const char *dev, int plidevtype);
   int               (*pliiAudioDeviceList) (plidata_t *plidata, volsinklist_t *sinklist);
   int               (*pliiSupported) (plidata_t *plidata);
+  void              (*pliiFade) (plidata_t *plidata, plifade_t fadedir, int fadeType, ssize_t fadestart, ssize_t fadelen);
   int               (*pliiGetVolume) (plidata_t *plidata);
   plidata_t         *plidata;
 } pli_t;
@@ -79,6 +80,7 @@ pliInit (const char *plipkg, const char *plinm)
   pli->pliiAudioDeviceList = NULL;
   pli->pliiSupported = NULL;
   pli->pliiGetVolume = NULL;
+  pli->pliiFade = NULL;
 
   pathbldMakePath (dlpath, sizeof (dlpath),
       plipkg, sysvarsGetStr (SV_SHLIB_EXT), PATHBLD_MP_DIR_EXEC);
@@ -108,6 +110,7 @@ pliInit (const char *plipkg, const char *plinm)
   pli->pliiAudioDeviceList = dylibLookup (pli->dlHandle, "pliiAudioDeviceList");
   pli->pliiSupported = dylibLookup (pli->dlHandle, "pliiSupported");
   pli->pliiGetVolume = dylibLookup (pli->dlHandle, "pliiGetVolume");
+  pli->pliiFade = dylibLookup (pli->dlHandle, "pliiFade");
 #pragma clang diagnostic pop
 
   if (pli->pliiInit != NULL) {
@@ -265,6 +268,18 @@ pliSupported (pli_t *pli)
   return rc;
 }
 
+/* fadestart and fadelen are media positions in milliseconds. */
+/* a fadestart < 0 starts the fade at the current position. */
+/* PLI_FADE_NONE removes any fade and restores the full volume. */
+void
+pliFade (pli_t *pli, plifade_t fadedir, int fadeType,
+    ssize_t fadestart, ssize_t fadelen)
+{
+  if (pli != NULL && pli->pliiFade != NULL) {
+    pli->pliiFade (pli->plidata, fadedir, fadeType, fadestart, fadelen);
+  }
+}
+
 const char *
 pliStateText (pli_t *pli)
 {
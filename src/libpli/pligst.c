@@ -20,13 +20,21 @@
 #include "tmutil.h"
 #include "volsink.h"
 
+enum {
+  PLII_START_WAIT = 10000,
+};
+
 typedef struct plidata {
   gsti_t            *gsti;
   int               state;
   int               supported;
+  ssize_t           startpos;
+  ssize_t           startspeed;
+  mstime_t          startcheck;
+  bool              startpending;
 } plidata_t;
 
-static void pliiWaitUntilPlaying (plidata_t *plidata);
+static plistate_t pliiStartPending (plidata_t *plidata, plistate_t state);
 
 void
 pliiDesc (const char **ret, int max)
@@ -45,9 +53,18 @@ pliiInit (const char *plinm)
   plidata = mdmalloc (sizeof (plidata_t));
   plidata->gsti = gstiInit (plinm);
   plidata->state = PLI_STATE_STOPPED;
+  plidata->startpos = 0;
+  plidata->startspeed = 100;
+  plidata->startpending = false;
+  mstimeset (&plidata->startcheck, TM_TIMER_OFF);
   plidata->supported = PLI_SUPPORT_NONE;
   plidata->supported |= PLI_SUPPORT_SEEK;
   plidata->supported |= PLI_SUPPORT_SPEED;
+  if (gstiHaveFade (plidata->gsti)) {
+    plidata->supported |= PLI_SUPPORT_FADE;
+    /* a second instance is used for the overlap */
+    plidata->supported |= PLI_SUPPORT_XFADE;
+  }
 
   return plidata;
 }
@@ -73,6 +90,7 @@ pliiMediaSetup (plidata_t *plidata, const char *mediaPath,
     return;
   }
 
+  plidata->startpending = false;
   gstiMedia (plidata->gsti, fullMediaPath, sourceType);
   plidata->state = PLI_STATE_STOPPED;
 }
@@ -92,9 +110,16 @@ pliiStartPlayback (plidata_t *plidata, ssize_t dpos, ssize_t speed)
   }
 
   pliiPlay (plidata);
+  plidata->startpending = false;
   if (dpos > 0 || speed != 100) {
     /* GStreamer must be in a paused or playing state to seek/set rate */
-    pliiWaitUntilPlaying (plidata);
+    /* the pipeline state changes are received on the bus, and */
+    /* pliiState() sets the rate and position once it has started */
+    plidata->startpos = dpos;
+    plidata->startspeed = speed;
+    plidata->startpending = true;
+    mstimeset (&plidata->startcheck, PLII_START_WAIT);
+    return;
   }
   /* set the rate first */
   pliiRate (plidata, speed);
@@ -130,6 +155,7 @@ pliiStop (plidata_t *plidata)
     return;
   }
 
+  plidata->startpending = false;
   gstiStop (plidata->gsti);
   plidata->state = PLI_STATE_STOPPED;
 }
@@ -168,6 +194,7 @@ pliiClose (plidata_t *plidata)
     return;
   }
 
+  plidata->startpending = false;
   plidata->state = PLI_STATE_STOPPED;
 }
 
@@ -207,6 +234,9 @@ pliiState (plidata_t *plidata)
   }
 
   plistate = gstiState (plidata->gsti);
+  if (plidata->startpending) {
+    plistate = pliiStartPending (plidata, plistate);
+  }
   plidata->state = plistate;
   return plistate;
 }
@@ -229,6 +259,17 @@ pliiSupported (plidata_t *plidata)
   return plidata->supported;
 }
 
+void
+pliiFade (plidata_t *plidata, plifade_t fadedir, int fadeType,
+    ssize_t fadestart, ssize_t fadelen)
+{
+  if (plidata == NULL) {
+    return;
+  }
+
+  gstiFade (plidata->gsti, fadedir, fadeType, fadestart, fadelen);
+}
+
 int
 pliiGetVolume (plidata_t *plidata)
 {
@@ -240,25 +281,29 @@ pliiGetVolume (plidata_t *plidata)
 
 /* internal routines */
 
-static void
-pliiWaitUntilPlaying (plidata_t *plidata)
+/* until the pipeline has started, the state is reported as opening */
+static plistate_t
+pliiStartPending (plidata_t *plidata, plistate_t state)
 {
-  plistate_t  state;
-  long        count;
-
-  state = gstiState (plidata->gsti);
-  count = 0;
-  while (state == PLI_STATE_IDLE ||
-         state == PLI_STATE_OPENING ||
-         state == PLI_STATE_BUFFERING ||
-         state == PLI_STATE_STOPPED) {
-    mssleep (1);
-    state = gstiState (plidata->gsti);
-    ++count;
-    if (count > 10000) {
-      break;
+  if (state == PLI_STATE_IDLE ||
+      state == PLI_STATE_OPENING ||
+      state == PLI_STATE_BUFFERING ||
+      state == PLI_STATE_STOPPED) {
+    if (! mstimeCheck (&plidata->startcheck)) {
+      return PLI_STATE_OPENING;
     }
+    /* give up, and let the caller process the state */
+    plidata->startpending = false;
+    return state;
+  }
+
+  plidata->startpending = false;
+  if (state == PLI_STATE_PLAYING || state == PLI_STATE_PAUSED) {
+    /* set the rate first */
+    pliiRate (plidata, plidata->startspeed);
+    pliiSeek (plidata, plidata->startpos);
   }
+  return state;
 }
 
 #endif /* _hdr_gst */
@@ -23,6 +23,10 @@
 
 #define VLCLOGGING 0
 
+enum {
+  PLII_START_WAIT = 10000,
+};
+
 typedef struct plidata {
   char              *name;
   vlcdata_t         *vlcdata;
@@ -30,6 +34,10 @@ typedef struct plidata {
   ssize_t           playTime;
   plistate_t        state;
   int               supported;
+  ssize_t           startpos;
+  ssize_t           startspeed;
+  mstime_t          startcheck;
+  bool              startpending;
 } plidata_t;
 
 static char *vlcDefaultOptions [] = {
@@ -59,7 +67,7 @@ enum {
   VLC_DFLT_OPT_SZ = (sizeof (vlcDefaultOptions) / sizeof (char *))
 };
 
-static void pliiWaitUntilPlaying (plidata_t *pliData);
+static plistate_t pliiStartPending (plidata_t *pliData, plistate_t state);
 
 void
 pliiDesc (const char **ret, int max)
@@ -94,7 +102,16 @@ pliiInit (const char *plinm)
   vlcOptions [0] = NULL;
   pliData->vlcdata = vlcInit (VLC_DFLT_OPT_SZ, vlcDefaultOptions, vlcOptions);
   pliData->name = "Integrated VLC";
+  pliData->startpos = 0;
+  pliData->startspeed = 100;
+  pliData->startpending = false;
+  mstimeset (&pliData->startcheck, TM_TIMER_OFF);
   pliData->supported = PLI_SUPPORT_SEEK | PLI_SUPPORT_SPEED;
+  if (vlcHaveFade (pliData->vlcdata)) {
+    pliData->supported |= PLI_SUPPORT_FADE;
+    /* a second instance is used for the overlap */
+    pliData->supported |= PLI_SUPPORT_XFADE;
+  }
   /* VLC uses the default sink set by the application */
   /* there is no need to process the audio device list */
 
@@ -126,6 +143,7 @@ pliiMediaSetup (plidata_t *pliData, const char *mediaPath,
     return;
   }
 
+  pliData->startpending = false;
   vlcMedia (pliData->vlcdata, mediaPath);
 }
 
@@ -136,19 +154,16 @@ pliiStartPlayback (plidata_t *pliData, ssize_t dpos, ssize_t speed)
     return;
   }
 
-  /* Do the busy loop so that the seek can be done immediately as */
-  /* vlc starts playing.  This should help avoid startup glitches */
+  /* vlc must be playing before the position and rate can be set */
+  /* pliiState() does the seek as soon as vlc reports that it is */
+  /* playing, the player's loop is not blocked while the media opens */
   vlcPlay (pliData->vlcdata);
-  if (dpos > 0) {
-    pliiWaitUntilPlaying (pliData);
-    vlcSeek (pliData->vlcdata, dpos);
-  }
-  if (speed != 100) {
-    double    drate;
-
-    pliiWaitUntilPlaying (pliData);
-    drate = (double) speed / 100.0;
-    vlcRate (pliData->vlcdata, drate);
+  pliData->startpending = false;
+  if (dpos > 0 || speed != 100) {
+    pliData->startpos = dpos;
+    pliData->startspeed = speed;
+    pliData->startpending = true;
+    mstimeset (&pliData->startcheck, PLII_START_WAIT);
   }
 }
 
@@ -179,6 +194,7 @@ pliiStop (plidata_t *pliData)
     return;
   }
 
+  pliData->startpending = false;
   vlcStop (pliData->vlcdata);
 }
 
@@ -219,6 +235,7 @@ pliiClose (plidata_t *pliData)
     return;
   }
 
+  pliData->startpending = false;
   vlcClose (pliData->vlcdata);
   pliData->vlcdata = NULL;
 }
@@ -259,6 +276,9 @@ pliiState (plidata_t *pliData)
   }
 
   plistate = vlcState (pliData->vlcdata);
+  if (pliData->startpending) {
+    plistate = pliiStartPending (pliData, plistate);
+  }
   return plistate;
 }
 
@@ -293,6 +313,17 @@ pliiSupported (plidata_t *pliData)
   return pliData->supported;
 }
 
+void
+pliiFade (plidata_t *pliData, plifade_t fadedir, int fadeType,
+    ssize_t fadestart, ssize_t fadelen)
+{
+  if (pliData == NULL || pliData->vlcdata == NULL) {
+    return;
+  }
+
+  vlcFade (pliData->vlcdata, fadedir, fadeType, fadestart, fadelen);
+}
+
 int
 pliiGetVolume (plidata_t *pliData)
 {
@@ -304,25 +335,35 @@ pliiGetVolume (plidata_t *pliData)
 
 /* internal routines */
 
-static void
-pliiWaitUntilPlaying (plidata_t *pliData)
+/* until vlc is playing, the state is reported as opening */
+static plistate_t
+pliiStartPending (plidata_t *pliData, plistate_t state)
 {
-  plistate_t  state;
-  long        count;
-
-  state = vlcState (pliData->vlcdata);
-  count = 0;
-  while (state == PLI_STATE_IDLE ||
-         state == PLI_STATE_OPENING ||
-         state == PLI_STATE_BUFFERING ||
-         state == PLI_STATE_STOPPED) {
-    mssleep (1);
-    state = vlcState (pliData->vlcdata);
-    ++count;
-    if (count > 10000) {
-      break;
+  if (state == PLI_STATE_IDLE ||
+      state == PLI_STATE_OPENING ||
+      state == PLI_STATE_BUFFERING ||
+      state == PLI_STATE_STOPPED) {
+    if (! mstimeCheck (&pliData->startcheck)) {
+      return PLI_STATE_OPENING;
+    }
+    /* give up, and let the caller process the state */
+    pliData->startpending = false;
+    return state;
+  }
+
+  pliData->startpending = false;
+  if (state == PLI_STATE_PLAYING || state == PLI_STATE_PAUSED) {
+    if (pliData->startpos > 0) {
+      vlcSeek (pliData->vlcdata, pliData->startpos);
+    }
+    if (pliData->startspeed != 100) {
+      double    drate;
+
+      drate = (double) pliData->startspeed / 100.0;
+      vlcRate (pliData->vlcdata, drate);
     }
   }
+  return state;
 }
 
 #endif /* have libvlc_new */
@@ -17,18 +17,28 @@
 #include <string.h>
 #include <math.h>
 
+#if _lib_pthread_create
+# include <pthread.h>
+#endif
+
 #include <vlc/vlc.h>
 #include <vlc/libvlc_version.h>
 
 #include "bdjstring.h"
+#include "fadecurve.h"
 #include "fileop.h"
 #include "mdebug.h"
 #include "pli.h"
+#include "tmutil.h"
 #include "vlci.h"
 
 #define VLCDEBUG 0
 #define SILENCE_LOG 1
 
+enum {
+  VLC_FADE_TIMESLICE = 10,
+};
+
 typedef struct vlcdata {
   libvlc_instance_t       *inst;
   char                    version [40];
@@ -40,6 +50,17 @@ typedef struct vlcdata {
   char                    *device;
   int                     devtype;
   FILE                    *logfh;
+#if _lib_pthread_create
+  pthread_t               fadethread;
+  pthread_mutex_t         fadelock;
+#endif
+  plifade_t               fadedir;
+  int                     fadetype;
+  libvlc_time_t           fadestart;
+  libvlc_time_t           fadelen;
+  int                     fadevol;
+  bool                    havefade;
+  bool                    fadequit;
 } vlcdata_t;
 
 # if VLCDEBUG
@@ -74,6 +95,13 @@ static void vlcReleaseMedia (vlcdata_t *vlcdata);
 static void vlcSetAudioOutput (vlcdata_t *vlcdata);
 static void vlcCreateNewMediaPlayer (vlcdata_t *vlcdata);
 static void vlcSetPosition (vlcdata_t *vlcdata, double dpos);
+static void vlcFadeLock (vlcdata_t *vlcdata);
+static void vlcFadeUnlock (vlcdata_t *vlcdata);
+static void vlcFadeReset (vlcdata_t *vlcdata);
+#if _lib_pthread_create
+static void *vlcFadeThread (void *udata);
+static void vlcFadeProcess (vlcdata_t *vlcdata);
+#endif
 
 #if VLCDEBUG
 static void vlclog (vlcdata_t *vlcdata, const char *msg, ...);
@@ -319,6 +347,9 @@ vlcMedia (vlcdata_t *vlcdata, const char *fn)
     }
   }
 #endif
+  vlcFadeLock (vlcdata);
+  vlcFadeReset (vlcdata);
+  vlcFadeUnlock (vlcdata);
   libvlc_media_player_set_rate (vlcdata->mp, 1.0);
   libvlc_media_player_set_media (vlcdata->mp, vlcdata->media);
 
@@ -329,6 +360,49 @@ vlcMedia (vlcdata_t *vlcdata, const char *fn)
   return 0;
 }
 
+/* fades */
+
+bool
+vlcHaveFade (vlcdata_t *vlcdata)
+{
+  if (vlcdata == NULL) {
+    return false;
+  }
+  return vlcdata->havefade;
+}
+
+/* libvlc has no scheduled gain control. */
+/* the fade thread sets the player's volume from the media time */
+void
+vlcFade (vlcdata_t *vlcdata, plifade_t fadedir, int fadeType,
+    ssize_t fadestart, ssize_t fadelen)
+{
+  if (vlcdata == NULL || vlcdata->inst == NULL || vlcdata->mp == NULL) {
+    return;
+  }
+  if (! vlcdata->havefade) {
+    return;
+  }
+
+  vlcFadeLock (vlcdata);
+  vlcFadeReset (vlcdata);
+  if (fadedir != PLI_FADE_NONE && fadelen > 0) {
+    if (fadestart < 0) {
+      fadestart = libvlc_media_player_get_time (vlcdata->mp);
+    }
+    vlcdata->fadetype = fadeType;
+    vlcdata->fadestart = fadestart;
+    vlcdata->fadelen = fadelen;
+    vlcdata->fadedir = fadedir;
+    if (fadedir == PLI_FADE_IN) {
+      /* silent until the fade-in starts */
+      vlcdata->fadevol = 0;
+      libvlc_audio_set_volume (vlcdata->mp, vlcdata->fadevol);
+    }
+  }
+  vlcFadeUnlock (vlcdata);
+}
+
 /* initialization and cleanup */
 
 vlcdata_t *
@@ -349,6 +423,16 @@ vlcInit (int vlcargc, char *vlcargv [], char *vlcopt [])
   vlcdata->device = NULL;
   vlcdata->devtype = PLI_DEFAULT_DEV;
   vlcdata->logfh = NULL;
+  vlcdata->fadedir = PLI_FADE_NONE;
+  vlcdata->fadetype = 0;
+  vlcdata->fadestart = 0;
+  vlcdata->fadelen = 0;
+  vlcdata->fadevol = 100;
+  vlcdata->havefade = false;
+  vlcdata->fadequit = false;
+#if _lib_pthread_create
+  pthread_mutex_init (&vlcdata->fadelock, NULL);
+#endif
 
 #if VLCDEBUG
   vlcdata->logfh = fopen ("vlc-out.txt", "a");
@@ -394,6 +478,13 @@ vlcInit (int vlcargc, char *vlcargv [], char *vlcopt [])
   /* to be released and re-created per medium. */
   vlcCreateNewMediaPlayer (vlcdata);
 
+#if _lib_pthread_create
+  if (pthread_create (&vlcdata->fadethread, NULL,
+      vlcFadeThread, vlcdata) == 0) {
+    vlcdata->havefade = true;
+  }
+#endif
+
   return vlcdata;
 }
 
@@ -406,6 +497,16 @@ vlcClose (vlcdata_t *vlcdata)
     if (vlcdata->logfh != NULL) {
       fclose (vlcdata->logfh);
     }
+#if _lib_pthread_create
+    if (vlcdata->havefade) {
+      vlcFadeLock (vlcdata);
+      vlcdata->fadequit = true;
+      vlcFadeUnlock (vlcdata);
+      pthread_join (vlcdata->fadethread, NULL);
+      vlcdata->havefade = false;
+    }
+    pthread_mutex_destroy (&vlcdata->fadelock);
+#endif
     vlcReleaseMedia (vlcdata);
     if (vlcdata->mp != NULL) {
       vlcStop (vlcdata);
@@ -486,12 +587,16 @@ vlcCreateNewMediaPlayer (vlcdata_t *vlcdata)
     return;
   }
 
+  vlcFadeLock (vlcdata);
   if (vlcdata->mp != NULL) {
     mdextfree (vlcdata->mp);
     libvlc_media_player_release (vlcdata->mp);
   }
   vlcdata->mp = libvlc_media_player_new (vlcdata->inst);
   mdextalloc (vlcdata->mp);
+  vlcdata->fadedir = PLI_FADE_NONE;
+  vlcdata->fadevol = 100;
+  vlcFadeUnlock (vlcdata);
 
   if (vlcdata->inst != NULL && vlcdata->mp != NULL) {
     libvlc_audio_set_volume (vlcdata->mp, 100);
@@ -518,6 +623,90 @@ vlcSetPosition (vlcdata_t *vlcdata, double dpos)
   vlcdata->state = libvlc_media_player_get_state (vlcdata->mp);
 }
 
+static void
+vlcFadeLock (vlcdata_t *vlcdata)
+{
+#if _lib_pthread_create
+  pthread_mutex_lock (&vlcdata->fadelock);
+#endif
+}
+
+static void
+vlcFadeUnlock (vlcdata_t *vlcdata)
+{
+#if _lib_pthread_create
+  pthread_mutex_unlock (&vlcdata->fadelock);
+#endif
+}
+
+/* the fade lock must be held */
+static void
+vlcFadeReset (vlcdata_t *vlcdata)
+{
+  vlcdata->fadedir = PLI_FADE_NONE;
+  if (vlcdata->fadevol != 100 && vlcdata->mp != NULL) {
+    vlcdata->fadevol = 100;
+    libvlc_audio_set_volume (vlcdata->mp, vlcdata->fadevol);
+  }
+}
+
+#if _lib_pthread_create
+
+static void *
+vlcFadeThread (void *udata)
+{
+  vlcdata_t   *vlcdata = udata;
+  bool        quit = false;
+
+  while (! quit) {
+    vlcFadeLock (vlcdata);
+    quit = vlcdata->fadequit;
+    if (! quit &&
+        vlcdata->fadedir != PLI_FADE_NONE &&
+        vlcdata->mp != NULL) {
+      vlcFadeProcess (vlcdata);
+    }
+    vlcFadeUnlock (vlcdata);
+    mssleep (VLC_FADE_TIMESLICE);
+  }
+
+  return NULL;
+}
+
+/* the fade lock must be held */
+static void
+vlcFadeProcess (vlcdata_t *vlcdata)
+{
+  libvlc_time_t   tm;
+  double          findex;
+  int             vol;
+  bool            done;
+
+  tm = libvlc_media_player_get_time (vlcdata->mp);
+  if (tm < vlcdata->fadestart) {
+    return;
+  }
+
+  findex = (double) (tm - vlcdata->fadestart) / (double) vlcdata->fadelen;
+  done = findex >= 1.0;
+  if (vlcdata->fadedir == PLI_FADE_OUT) {
+    findex = 1.0 - findex;
+  }
+
+  vol = (int) round (fadecurveCalc (vlcdata->fadetype, findex) * 100.0);
+  if (vol != vlcdata->fadevol) {
+    libvlc_audio_set_volume (vlcdata->mp, vol);
+    vlcdata->fadevol = vol;
+  }
+
+  if (done) {
+    /* the volume is left as is until the next media or fade */
+    vlcdata->fadedir = PLI_FADE_NONE;
+  }
+}
+
+#endif /* _lib_pthread_create */
+
 /* tests if the interface was linked with the correct libvlc version */
 bool
 vlcVersionLinkCheck (void)
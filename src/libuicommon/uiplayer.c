@@ -16,6 +16,7 @@
 #include "bdj4.h"
 #include "bdj4intl.h"
 #include "bdj4ui.h"
+#include "bdjmsg.h"
 #include "bdjopt.h"
 #include "bdjvarsdf.h"
 #include "callback.h"
@@ -704,7 +705,12 @@ uiplayerProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
   /* the management ui has two uiplayer instances */
   /* therefore the original message must be preserved */
   if (args != NULL) {
-    targs = mdstrdup (args);
+    size_t    alen;
+
+    /* the arguments may be binary */
+    alen = msgArgsLen (args);
+    targs = mdmalloc (alen);
+    memcpy (targs, args, alen);
   }
 
   switch (route) {
@@ -967,16 +973,16 @@ uiplayerProcessPlayerStatusData (uiplayer_t *uiplayer, char *args)
   ssize_t       timeleft = 0;
   ssize_t       position = 0;
   ssize_t       dur = 0;
-  mp_playerstatus_t *ps = NULL;
+  mp_playerstatus_t ps;
 
   logProcBegin ();
 
-  ps = msgparsePlayerStatusData (args);
+  msgparsePlayerStatus (&ps, args);
 
   /* repeat */
   uiplayer->repeatLock = true;
-  uiplayer->repeat = ps->repeat;
-  if (ps->repeat) {
+  uiplayer->repeat = ps.repeat;
+  if (ps.repeat) {
     uiImageClear (uiplayer->images [UIPL_IMG_REPEAT]);
     uiImageSetFromPixbuf (uiplayer->images [UIPL_IMG_REPEAT], uiplayer->images [UIPL_PIX_REPEAT]);
     uiToggleButtonSetValue (uiplayer->wcont [UIPL_W_REPEAT_B], UI_TOGGLE_BUTTON_ON);
@@ -985,41 +991,41 @@ uiplayerProcessPlayerStatusData (uiplayer_t *uiplayer, char *args)
     uiToggleButtonSetValue (uiplayer->wcont [UIPL_W_REPEAT_B], UI_TOGGLE_BUTTON_OFF);
   }
   uiplayer->repeatLock = false;
-  controllerSetRepeatState (uiplayer->controller, ps->repeat);
+  controllerSetRepeatState (uiplayer->controller, ps.repeat);
 
   /* pauseatend */
-  uiplayerProcessPauseatend (uiplayer, ps->pauseatend);
+  uiplayerProcessPauseatend (uiplayer, ps.pauseatend);
 
   /* current vol */
   if (! uiplayer->volumeLock) {
-    snprintf (tbuff, sizeof (tbuff), "%3d", ps->currentVolume);
+    snprintf (tbuff, sizeof (tbuff), "%3d", ps.currentVolume);
     uiLabelSetText (uiplayer->wcont [UIPL_W_VOLUME_DISP], tbuff);
-    dval = (double) ps->currentVolume;
+    dval = (double) ps.currentVolume;
     uiScaleSetValue (uiplayer->wcont [UIPL_W_VOLUME], dval);
-    controllerSetVolume (uiplayer->controller, ps->currentVolume);
+    controllerSetVolume (uiplayer->controller, ps.currentVolume);
   }
 
   /* speed */
   if (! uiplayer->speedLock) {
-    snprintf (tbuff, sizeof (tbuff), "%3d", ps->currentSpeed);
+    snprintf (tbuff, sizeof (tbuff), "%3d", ps.currentSpeed);
     uiLabelSetText (uiplayer->wcont [UIPL_W_SPEED_DISP], tbuff);
-    dval = (double) ps->currentSpeed;
+    dval = (double) ps.currentSpeed;
     uiScaleSetValue (uiplayer->wcont [UIPL_W_SPEED], dval);
     uiplayer->speedLastValue = dval;
-    controllerSetRate (uiplayer->controller, ps->currentSpeed);
+    controllerSetRate (uiplayer->controller, ps.currentSpeed);
   }
 
   /* base vol */
-  uiplayer->baseVolume = ps->baseVolume;
+  uiplayer->baseVolume = ps.baseVolume;
 
   /* playedtime */
-  position = ps->playedtime;
-  dval = (double) ps->playedtime;    // used below for scale
-  controllerSetPosition (uiplayer->controller, ps->playedtime);
+  position = ps.playedtime;
+  dval = (double) ps.playedtime;    // used below for scale
+  controllerSetPosition (uiplayer->controller, ps.playedtime);
 
   /* duration */
-  ddur = (double) ps->duration;
-  dur = ps->duration;
+  ddur = (double) ps.duration;
+  dur = ps.duration;
   if (ddur > 0.0 && dur != uiplayer->lastdur) {
     tmutilToMS (dur, tbuff, sizeof (tbuff));
     uiLabelSetText (uiplayer->wcont [UIPL_W_DURATION], tbuff);
@@ -1042,7 +1048,6 @@ uiplayerProcessPlayerStatusData (uiplayer_t *uiplayer, char *args)
     }
   }
 
-  msgparsePlayerStatusFree (ps);
 
   logProcEnd ("");
 }
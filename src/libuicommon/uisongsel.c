@@ -216,6 +216,6 @@ uisongselProcessMusicQueueData (uisongsel_t *uisongsel,
     }
   }
 
-  uisongselPopulateData (uisongsel);
+  uisongselPopulateMarks (uisongsel);
 }
 
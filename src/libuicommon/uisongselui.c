@@ -5,6 +5,7 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
@@ -44,6 +45,11 @@ enum {
   SONGSEL_COL_MAX,
 };
 
+enum {
+  /* the number of rows of display data that are cached */
+  SONGSEL_ROW_CACHE_SZ = 150,
+};
+
 enum {
   UISONGSEL_FIRST,
   UISONGSEL_NEXT,
@@ -79,6 +85,13 @@ enum {
   SONGSEL_W_MAX,
 };
 
+/* the formatted display data for a row */
+typedef struct {
+  dbidx_t             dbidx;
+  int64_t             lastused;
+  nlist_t             *tdlist;
+} ssrowcache_t;
+
 typedef struct ss_internal {
   callback_t          *callbacks [SONGSEL_CB_MAX];
   uiwcont_t           *wcont [SONGSEL_W_MAX];
@@ -97,6 +110,9 @@ typedef struct ss_internal {
   /* for shift-click */
   nlistidx_t          shiftfirstidx;
   nlistidx_t          shiftlastidx;
+  /* row display data cache */
+  ssrowcache_t        rowcache [SONGSEL_ROW_CACHE_SZ];
+  int64_t             rowcacheuse;
   bool                inapply : 1;
   bool                inchange : 1;
 } ss_internal_t;
@@ -116,6 +132,9 @@ static void uisongselMoveSelection (void *udata, int where);
 static bool uisongselUIDanceSelectCallback (void *udata, int32_t idx, int32_t count);
 static bool uisongselSongEditCallback (void *udata);
 static void uisongselFillRow (void *udata, uivirtlist_t *vl, int32_t rownum);
+static nlist_t *uisongselGetRowData (ss_internal_t *ssint, dbidx_t dbidx, song_t *song);
+static void uisongselClearRowCache (ss_internal_t *ssint);
+static void uisongselPopulate (uisongsel_t *uisongsel);
 static void uisongselFillMark (uisongsel_t *uisongsel, ss_internal_t *ssint, dbidx_t dbidx, int32_t rownum);
 static bool uisongselStartSFDialog (void *udata);
 
@@ -134,6 +153,12 @@ uisongselUIInit (uisongsel_t *uisongsel)
   ssint->selectedBackup = NULL;
   ssint->selectListKey = -1;
   ssint->favcolumn = -1;
+  for (int i = 0; i < SONGSEL_ROW_CACHE_SZ; ++i) {
+    ssint->rowcache [i].dbidx = -1;
+    ssint->rowcache [i].lastused = 0;
+    ssint->rowcache [i].tdlist = NULL;
+  }
+  ssint->rowcacheuse = 0;
   for (int i = 0; i < SONGSEL_CB_MAX; ++i) {
     ssint->callbacks [i] = NULL;
   }
@@ -169,6 +194,7 @@ uisongselUIFree (uisongsel_t *uisongsel)
 
   nlistFree (ssint->selectedBackup);
   slistFree (ssint->sscolorlist);
+  uisongselClearRowCache (ssint);
   for (int i = 0; i < SONGSEL_CB_MAX; ++i) {
     callbackFree (ssint->callbacks [i]);
   }
@@ -356,15 +382,22 @@ uisongselPopulateData (uisongsel_t *uisongsel)
 
   ssint = uisongsel->ssInternalData;
 
-  /* re-fetch the count, as the songfilter process may not have been */
-  /* processed by this instance */
-  uisongsel->numrows = songfilterGetCount (uisongsel->songfilter);
-  /* set-num-rows calls uivlpopulate */
-  uivlSetNumRows (ssint->uivl, uisongsel->numrows);
+  /* the song data may have changed */
+  uisongselClearRowCache (ssint);
+  uisongselPopulate (uisongsel);
 
   logProcEnd ("");
 }
 
+/* only the marks have changed, the cached row data is still valid */
+void
+uisongselPopulateMarks (uisongsel_t *uisongsel)
+{
+  logProcBegin ();
+  uisongselPopulate (uisongsel);
+  logProcEnd ("");
+}
+
 bool
 uisongselSelectCallback (void *udata)
 {
@@ -985,7 +1018,7 @@ uisongselFillRow (void *udata, uivirtlist_t *vl, int32_t rownum)
 
   ssint->inchange = true;
 
-  tdlist = uisongGetDisplayList (ssint->sellist, NULL, song);
+  tdlist = uisongselGetRowData (ssint, dbidx, song);
   slistStartIterator (ssint->sellist, &seliteridx);
   for (int colidx = SONGSEL_COL_MAX; colidx < ssint->colcount; ++colidx) {
     int         tagidx;
@@ -1009,7 +1042,6 @@ uisongselFillRow (void *udata, uivirtlist_t *vl, int32_t rownum)
       uivlSetRowColumnClass (ssint->uivl, rownum, colidx, name);
     }
   }
-  nlistFree (tdlist);
 
   uisongselFillMark (uisongsel, ssint, dbidx, rownum);
 
@@ -1017,6 +1049,58 @@ uisongselFillRow (void *udata, uivirtlist_t *vl, int32_t rownum)
   logProcEnd ("");
 }
 
+/* the least recently used row is replaced */
+static nlist_t *
+uisongselGetRowData (ss_internal_t *ssint, dbidx_t dbidx, song_t *song)
+{
+  ssrowcache_t    *rc;
+  ssrowcache_t    *lru = NULL;
+
+  ++ssint->rowcacheuse;
+  for (int i = 0; i < SONGSEL_ROW_CACHE_SZ; ++i) {
+    rc = &ssint->rowcache [i];
+    if (rc->dbidx == dbidx) {
+      rc->lastused = ssint->rowcacheuse;
+      return rc->tdlist;
+    }
+    if (lru == NULL || rc->lastused < lru->lastused) {
+      lru = rc;
+    }
+  }
+
+  nlistFree (lru->tdlist);
+  lru->tdlist = uisongGetDisplayList (ssint->sellist, NULL, song);
+  lru->dbidx = dbidx;
+  lru->lastused = ssint->rowcacheuse;
+  return lru->tdlist;
+}
+
+static void
+uisongselClearRowCache (ss_internal_t *ssint)
+{
+  for (int i = 0; i < SONGSEL_ROW_CACHE_SZ; ++i) {
+    nlistFree (ssint->rowcache [i].tdlist);
+    ssint->rowcache [i].tdlist = NULL;
+    ssint->rowcache [i].dbidx = -1;
+    ssint->rowcache [i].lastused = 0;
+  }
+  ssint->rowcacheuse = 0;
+}
+
+static void
+uisongselPopulate (uisongsel_t *uisongsel)
+{
+  ss_internal_t   * ssint;
+
+  ssint = uisongsel->ssInternalData;
+
+  /* re-fetch the count, as the songfilter process may not have been */
+  /* processed by this instance */
+  uisongsel->numrows = songfilterGetCount (uisongsel->songfilter);
+  /* set-num-rows calls uivlpopulate */
+  uivlSetNumRows (ssint->uivl, uisongsel->numrows);
+}
+
 
 static void
 uisongselFillMark (uisongsel_t *uisongsel, ss_internal_t *ssint,
@@ -42,14 +42,19 @@ typedef struct uiaa {
   uiwcont_t       *statusMsg;
   uiwcont_t       *cbTrim;
   uiwcont_t       *cbAdjust;
+  uiwcont_t       *cbApplyAll;
   callback_t      *callbacks [UIAA_CB_MAX];
   callback_t      *responsecb;
+  callback_t      *cancelcb;
   song_t          *song;
   const char      *pleasewaitmsg;
+  int             selcount;
   bool            isactive : 1;
+  bool            applyall : 1;
+  bool            processing : 1;
 } uiaa_t;
 
-static void   uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig);
+static void   uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig, int selcount);
 static void   uiaaInitDisplay (uiaa_t *uiaa);
 static bool   uiaaResponseHandler (void *udata, int32_t responseid);
 
@@ -66,11 +71,16 @@ uiaaInit (uiwcont_t *windowp, nlist_t *opts)
   uiaa->statusMsg = NULL;
   uiaa->cbTrim = NULL;
   uiaa->cbAdjust = NULL;
+  uiaa->cbApplyAll = NULL;
   for (int i = 0; i < UIAA_CB_MAX; ++i) {
     uiaa->callbacks [i] = NULL;
   }
   uiaa->responsecb = NULL;
+  uiaa->cancelcb = NULL;
+  uiaa->selcount = 0;
   uiaa->isactive = false;
+  uiaa->applyall = false;
+  uiaa->processing = false;
   /* CONTEXT: apply adjustments: please wait... status message */
   uiaa->pleasewaitmsg = _("Please wait\xe2\x80\xa6");
 
@@ -87,6 +97,7 @@ uiaaFree (uiaa_t *uiaa)
     uiaaDialogClear (uiaa);
     uiwcontFree (uiaa->cbTrim);
     uiwcontFree (uiaa->cbAdjust);
+    uiwcontFree (uiaa->cbApplyAll);
     for (int i = 0; i < UIAA_CB_MAX; ++i) {
       callbackFree (uiaa->callbacks [i]);
     }
@@ -106,8 +117,19 @@ uiaaSetResponseCallback (uiaa_t *uiaa, callback_t *uicb)
   uiaa->responsecb = uicb;
 }
 
+void
+uiaaSetCancelCallback (uiaa_t *uiaa, callback_t *uicb)
+{
+  if (uiaa == NULL) {
+    return;
+  }
+  uiaa->cancelcb = uicb;
+}
+
+/* selcount : the number of selected songs the adjustments may be */
+/*            applied to */
 bool
-uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
+uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig, int selcount)
 {
   int         x, y;
 
@@ -116,7 +138,7 @@ uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
   }
 
   logProcBegin ();
-  uiaaCreateDialog (uiaa, aaflags, hasorig);
+  uiaaCreateDialog (uiaa, aaflags, hasorig, selcount);
   uiaaInitDisplay (uiaa);
   uiDialogShow (uiaa->aaDialog);
   uiaa->isactive = true;
@@ -131,9 +153,21 @@ uiaaDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
   return UICB_CONT;
 }
 
+/* whether the user chose to apply the adjustments to all of the */
+/* selected songs */
+bool
+uiaaApplyAll (uiaa_t *uiaa)
+{
+  if (uiaa == NULL) {
+    return false;
+  }
+  return uiaa->applyall;
+}
+
 void
 uiaaDialogClear (uiaa_t *uiaa)
 {
+  uiaa->processing = false;
   uiwcontFree (uiaa->statusMsg);
   uiaa->statusMsg = NULL;
   uiDialogDestroy (uiaa->aaDialog);
@@ -144,11 +178,12 @@ uiaaDialogClear (uiaa_t *uiaa)
 /* internal routines */
 
 static void
-uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
+uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig, int selcount)
 {
   uiwcont_t    *vbox;
   uiwcont_t    *hbox;
   uiwcont_t    *uiwidgetp;
+  char         tbuff [200];
 
   logProcBegin ();
 
@@ -167,6 +202,9 @@ uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
       /* CONTEXT: apply adjustment dialog: closes the dialog */
       _("Close"),
       RESPONSE_CLOSE,
+      /* CONTEXT: apply adjustment dialog: stops the adjustments in progress */
+      _("Cancel"),
+      RESPONSE_CANCEL,
       NULL);
   if (hasorig) {
     uiDialogAddButtons (uiaa->aaDialog,
@@ -217,6 +255,23 @@ uiaaCreateDialog (uiaa_t *uiaa, int aaflags, bool hasorig)
   uiBoxPackStart (hbox, uiwidgetp);
   uiaa->cbAdjust = uiwidgetp;
 
+  /* apply to all selected songs */
+  uiwcontFree (uiaa->cbApplyAll);
+  uiaa->cbApplyAll = NULL;
+  uiaa->selcount = selcount;
+  if (selcount > 1) {
+    uiwcontFree (hbox);
+    hbox = uiCreateHorizBox ();
+    uiBoxPackStart (vbox, hbox);
+
+    /* the user must confirm that the selected songs are to be changed */
+    /* CONTEXT: apply adjustments: apply to all of the selected songs checkbox */
+    snprintf (tbuff, sizeof (tbuff), _("Apply to all %d selected songs"), selcount);
+    uiwidgetp = uiCreateCheckButton (tbuff, false);
+    uiBoxPackStart (hbox, uiwidgetp);
+    uiaa->cbApplyAll = uiwidgetp;
+  }
+
   uiwcontFree (hbox);
   uiwcontFree (vbox);
 
@@ -236,11 +291,32 @@ uiaaResponseHandler (void *udata, int32_t responseid)
 {
   uiaa_t  *uiaa = udata;
   int         x, y, ws;
+  bool        cancelled = false;
 
   uiWindowGetPosition (uiaa->aaDialog, &x, &y, &ws);
   nlistSetNum (uiaa->options, APPLY_ADJ_POSITION_X, x);
   nlistSetNum (uiaa->options, APPLY_ADJ_POSITION_Y, y);
 
+  /* closing the dialog while the adjustments are being applied */
+  /* also cancels them */
+  if (uiaa->processing &&
+      (responseid == RESPONSE_DELETE_WIN ||
+      responseid == RESPONSE_CLOSE ||
+      responseid == RESPONSE_CANCEL)) {
+    logMsg (LOG_DBG, LOG_ACTIONS, "= action: apply adjust: cancel");
+    uiaa->processing = false;
+    cancelled = true;
+    if (uiaa->cancelcb != NULL) {
+      callbackHandler (uiaa->cancelcb);
+    }
+  }
+
+  uiaa->applyall = false;
+  if (uiaa->cbApplyAll != NULL &&
+      (responseid == RESPONSE_RESET || responseid == RESPONSE_APPLY)) {
+    uiaa->applyall = uiToggleButtonIsActive (uiaa->cbApplyAll);
+  }
+
   switch (responseid) {
     case RESPONSE_DELETE_WIN: {
       logMsg (LOG_DBG, LOG_ACTIONS, "= action: apply adjust: del window");
@@ -248,7 +324,12 @@ uiaaResponseHandler (void *udata, int32_t responseid)
       uiaa->aaDialog = NULL;
       break;
     }
+    case RESPONSE_CANCEL:
     case RESPONSE_CLOSE: {
+      if (cancelled && responseid == RESPONSE_CANCEL) {
+        /* the dialog is cleared when the adjustments have stopped */
+        break;
+      }
       logMsg (LOG_DBG, LOG_ACTIONS, "= action: apply adjust: close window");
       /* dialog should be destroyed, as the buttons are re-created each time */
       uiDialogDestroy (uiaa->aaDialog);
@@ -260,7 +341,8 @@ uiaaResponseHandler (void *udata, int32_t responseid)
       logMsg (LOG_DBG, LOG_ACTIONS, "= action: apply adjust: restore orig");
       uiLabelSetText (uiaa->statusMsg, uiaa->pleasewaitmsg);
       if (uiaa->responsecb != NULL) {
-        callbackHandlerI (uiaa->responsecb, SONG_ADJUST_RESTORE);
+        uiaa->processing = callbackHandlerI (uiaa->responsecb,
+            SONG_ADJUST_RESTORE) == UICB_CONT;
       }
       break;
     }
@@ -276,7 +358,8 @@ uiaaResponseHandler (void *udata, int32_t responseid)
       }
       uiLabelSetText (uiaa->statusMsg, uiaa->pleasewaitmsg);
       if (uiaa->responsecb != NULL) {
-        callbackHandlerI (uiaa->responsecb, aaflags);
+        uiaa->processing =
+            callbackHandlerI (uiaa->responsecb, aaflags) == UICB_CONT;
       }
       break;
     }
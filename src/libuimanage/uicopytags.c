@@ -22,6 +22,7 @@
 #include "log.h"
 #include "mdebug.h"
 #include "nlist.h"
+#include "tagwriter.h"
 #include "ui.h"
 #include "uicopytags.h"
 #include "uiselectfile.h"
@@ -45,6 +46,7 @@ typedef struct uict {
   uiwcont_t       *targetsel;
   uisfcb_t        targetsfcb;
   callback_t      *callbacks [UICT_CB_MAX];
+  tagwriter_t     *tagwriter;
   int             state;
   bool            isactive : 1;
 } uict_t;
@@ -69,6 +71,7 @@ uicopytagsInit (uiwcont_t *windowp, nlist_t *opts)
   for (int i = 0; i < UICT_CB_MAX; ++i) {
     uict->callbacks [i] = NULL;
   }
+  uict->tagwriter = NULL;
   uict->isactive = false;
   uict->state = BDJ4_STATE_OFF;
 
@@ -104,6 +107,18 @@ uicopytagsFree (uict_t *uict)
   }
 }
 
+/* if set, any pending background tag writes are completed */
+/* before the tags are copied */
+void
+uicopytagsSetTagWriter (uict_t *uict, tagwriter_t *tagwriter)
+{
+  if (uict == NULL) {
+    return;
+  }
+
+  uict->tagwriter = tagwriter;
+}
+
 bool
 uicopytagsDialog (uict_t *uict)
 {
@@ -304,6 +319,8 @@ uicopytagsResponseHandler (void *udata, int32_t responseid)
         uiLabelSetText (uict->statusMsg, _("Invalid Selections"));
         break;
       }
+      /* the tag writer replaces the file when it is done */
+      tagwriterWait (uict->tagwriter);
       sdata = audiotagSaveTags (infn);
       audiotagRestoreTags (outfn, sdata);
       audiotagFreeSavedTags (outfn, sdata);
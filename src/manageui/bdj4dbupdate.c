@@ -9,6 +9,11 @@
  *      rebuild and replace the database in its entirety.
  *    - check for new
  *      check for new files and changes and add them.
+ *    - update changed
+ *      the same as check for new, except that the audio files that
+ *      are already in the database are re-parsed if the file size,
+ *      modification time or inode has changed.
+ *      audio files in the database that no longer exist are flagged.
  *    - update from tags
  *      update db from tags in audio files.
  *      this is the same as checknew, except that all audio files tags
@@ -26,6 +31,20 @@
  *      use the organization settings to reorganize the files.
  *    - update from itunes
  *      update the database data from the data found in itunes.
+ *    - bpm detect
+ *      analyze the audio files that do not have a bpm set, and
+ *      set the bpm.  the analysis is done by a pool of worker threads.
+ *    - loudness
+ *      measure the loudness of the audio files that have not been
+ *      analyzed or have changed, and set the volume adjustment.
+ *      the analysis is done by a pool of worker threads.
+ *    - watch
+ *      started along with the player.  watches the music folder
+ *      and processes the audio files that have been changed, renamed
+ *      or removed, using the same processing as update changed.
+ *      renamed files are not re-parsed.
+ *      if the music folder cannot be watched in its entirety, the
+ *      music folder is scanned periodically.
  *
  */
 
@@ -39,7 +58,9 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <signal.h>
+#include <math.h>
 
+#include "aafilter.h"
 #include "audiofile.h"
 #include "audiosrc.h"
 #include "audiotag.h"
@@ -52,15 +73,21 @@
 #include "bdjstring.h"
 #include "bdjvarsdf.h"
 #include "bdjvars.h"
+#include "bpmdetect.h"
+#include "callback.h"
 #include "conn.h"
 #include "dance.h"
+#include "dirwatch.h"
 #include "fileop.h"
 #include "filemanip.h"
 #include "itunes.h"
 #include "level.h"
+#include "lock.h"
 #include "log.h"
+#include "loudness.h"
 #include "mdebug.h"
 #include "musicdb.h"
+#include "nlist.h"
 #include "orgopt.h"
 #include "orgutil.h"
 #include "ossignal.h"
@@ -75,24 +102,30 @@
 #include "song.h"
 #include "songdb.h"
 #include "sysvars.h"
+#include "tagcache.h"
 #include "tagdef.h"
+#include "tagwriter.h"
 #include "tmutil.h"
+#include "workpool.h"
 
 enum {
   DB_UPD_INIT,
   DB_UPD_PREP,
   DB_UPD_PROC_FN,
   DB_UPD_PROCESS,
+  DB_UPD_WATCH,
   DB_UPD_FINISH,
 };
 
 enum {
+  C_AUDIO_TAGS_CACHED,
   C_AUDIO_TAGS_PARSED,
   C_FILE_COUNT,
   C_FILE_PROC,
   C_FILE_QUEUED,
   C_FILE_SKIPPED,
   C_IN_DB,
+  C_MISSING,
   C_NEW,
   C_QUEUE_MAX,
   C_RENAMED,
@@ -112,8 +145,28 @@ typedef struct {
   char        *ffn;
   char        *songfn;
   char        *relfn;
+  /* set by the tag parsing worker threads */
+  slist_t     *tagdata;
+  int         rewrite;
+  bool        cached;
+  dbidx_t     seq;
 } tagdataitem_t;
 
+typedef struct {
+  dbidx_t     dbidx;
+  char        *ffn;
+  int32_t     startms;
+  int32_t     durms;
+  double      lowbpm;
+  double      highbpm;
+  int         beats;
+  double      bpm;
+  int         confidence;
+  double      lufs;
+  double      truepeak;
+  int         rc;
+} anajob_t;
+
 typedef struct {
   progstate_t       *progstate;
   procutil_t        *processes [ROUTE_MAX];
@@ -140,7 +193,36 @@ typedef struct {
   int               stopwaitcount;
   const char        *olddirlist;
   itunes_t          *itunes;
+  callback_t        *itunesprogresscb;
   queue_t           *tagdataq;
+  /* audio tag parsing */
+  workpool_t        *tagpool;
+  tagcache_t        *tagcache;
+  tagdataitem_t     **tagdone;
+  int               tagwindow;
+  int               tagqueued;
+  dbidx_t           tagseq;
+  dbidx_t           tagnext;
+  /* write tags */
+  tagwriter_t       *tagwriter;
+  /* audio analysis: bpm detection, loudness */
+  workpool_t        *anapool;
+  aafilter_t        **anaaaf;
+  bpmdetect_t       **bpmd;
+  loudness_t        **loud;
+  int               anathreads;
+  int               anaqueued;
+  /* update changed: the database entries found in the music dir */
+  bool              *seen;
+  dbidx_t           seencount;
+  /* watch */
+  bdjmsgroute_t     route;
+  bdjmsgroute_t     uiroute;
+  dirwatch_t        *dirwatch;
+  slist_t           *watchlist;
+  slistidx_t        watchiter;
+  nlist_t           *watchupd;
+  mstime_t          watchscantm;
   /* base database operations */
   bool              checknew : 1;
   bool              compact : 1;
@@ -149,6 +231,10 @@ typedef struct {
   bool              updfromitunes : 1;
   bool              updfromtags : 1;
   bool              writetags : 1;
+  bool              bpmdetect : 1;
+  bool              loudness : 1;
+  bool              updchanged : 1;
+  bool              watch : 1;
   /* database handling */
   bool              cleandatabase : 1;
   /* other stuff */
@@ -162,13 +248,36 @@ typedef struct {
   bool              stoprequest : 1;
   bool              usingmusicdir : 1;
   bool              verbose : 1;
+  bool              watchdbchg : 1;
+  bool              watchdblock : 1;
+  bool              watchscan : 1;
 } dbupdate_t;
 
 enum {
   FNAMES_SENT_PER_ITER = 30,
   QUEUE_PROCESS_LIMIT = 30,
+  /* the number of files queued per tag parsing thread */
+  TAG_QUEUE_PER_THREAD = 4,
+  /* the number of songs queued per worker thread */
+  ANA_QUEUE_PER_THREAD = 2,
+  /* the number of files queued for the tag writer */
+  TAG_WRITE_QUEUE_MAX = 40,
+  /* the portion of the song that is analyzed */
+  BPM_ANALYZE_DUR = 60000,
+  /* the detected bpm is not used if the confidence is lower */
+  BPM_MIN_CONFIDENCE = 30,
+  /* used if the dance does not have a bpm range */
+  BPM_DEFAULT_LOW = 60,
+  BPM_DEFAULT_HIGH = 200,
+  /* the time to wait for the audio file to be completely written */
+  WATCH_DEBOUNCE = 2000,
+  /* used if the music folder cannot be watched */
+  WATCH_SCAN_INTERVAL = 600000,
 };
 
+/* the bpm range of the dance is widened by this amount */
+#define BPM_RANGE_MARGIN 0.08
+
 static int      dbupdateProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
                     bdjmsgmsg_t msg, char *args, void *udata);
 static int      dbupdateProcessing (void *udata);
@@ -181,16 +290,43 @@ static void     dbupdateQueueFile (dbupdate_t *dbupdate, const char *ffn, const
 static void     dbupdateTagDataFree (void *data);
 static void     dbupdateProcessFileQueue (dbupdate_t *dbupdate);
 static void     dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi);
+static bool     dbupdateNeedTagData (dbupdate_t *dbupdate);
+static void     dbupdateTagProcess (dbupdate_t *dbupdate);
+static void     dbupdateTagAlloc (dbupdate_t *dbupdate);
+static void     dbupdateTagWorker (void *udata, void *tjob, int thridx);
+static slist_t  *dbupdateParseTags (dbupdate_t *dbupdate, const char *ffn, int *rewrite, bool *cached);
+static bool     dbupdateFileChanged (dbupdate_t *dbupdate, song_t *song, const char *ffn);
+static void     dbupdateSetFileStat (song_t *song, const char *ffn);
+static void     dbupdateFlagMissing (dbupdate_t *dbupdate);
 static void     dbupdateWriteTags (dbupdate_t *dbupdate, tagdataitem_t *tdi, slist_t *tagdata);
+static void     dbupdateWriteTagsProcess (dbupdate_t *dbupdate);
 static void     dbupdateFromiTunes (dbupdate_t *dbupdate, tagdataitem_t *tdi);
 static void     dbupdateReorganize (dbupdate_t *dbupdate, tagdataitem_t *tdi, int songdbdefault);
+static void     dbupdateBPMQueue (dbupdate_t *dbupdate, tagdataitem_t *tdi);
+static void     dbupdateAnaProcess (dbupdate_t *dbupdate);
+static void     dbupdateBPMFinish (dbupdate_t *dbupdate, anajob_t *job);
+static void     dbupdateLoudnessQueue (dbupdate_t *dbupdate, tagdataitem_t *tdi);
+static void     dbupdateLoudnessFinish (dbupdate_t *dbupdate, anajob_t *job);
+static void     dbupdateAnaAlloc (dbupdate_t *dbupdate);
+static void     dbupdateAnaWorker (void *udata, void *tjob, int thridx);
+static void     dbupdateAnaJobFree (anajob_t *job);
 static void     dbupdateSigHandler (int sig);
 static void     dbupdateOutputProgress (dbupdate_t *dbupdate);
+static bool     dbupdateiTunesProgress (void *udata, double dval);
+static void     dbupdateSendFileCount (dbupdate_t *dbupdate);
 static bool     checkOldDirList (dbupdate_t *dbupdate, const char *fn);
 static void     dbupdateIncCount (dbupdate_t *dbupdate, int tag);
 static void     dbupdateWriteSong (dbupdate_t *dbupdate, song_t *song, int *songdbflags, dbidx_t rrn);
 static musicdb_t * dbupdateSetCurrentDB (dbupdate_t *dbupdate);
 static const char * dbupdateIterate (dbupdate_t *dbupdate);
+static void     dbupdateWatchInit (dbupdate_t *dbupdate);
+static void     dbupdateWatch (dbupdate_t *dbupdate);
+static void     dbupdateWatchStart (dbupdate_t *dbupdate);
+static void     dbupdateWatchFinish (dbupdate_t *dbupdate);
+static void     dbupdateWatchNotify (dbupdate_t *dbupdate);
+static nlist_t  *dbupdateWatchFind (dbupdate_t *dbupdate, const char *path, bool isdir);
+static void     dbupdateWatchRemove (dbupdate_t *dbupdate, const char *path, bool isdir);
+static void     dbupdateWatchRename (dbupdate_t *dbupdate, const char *oldpath, const char *path, bool isdir);
 
 static int  gKillReceived = 0;
 
@@ -217,7 +353,30 @@ main (int argc, char *argv[])
   dbupdate.maxWriteLen = 0;
   dbupdate.stopwaitcount = 0;
   dbupdate.itunes = NULL;
+  dbupdate.itunesprogresscb = NULL;
   dbupdate.tagdataq = queueAlloc ("tagdata-q", dbupdateTagDataFree);
+  dbupdate.tagpool = NULL;
+  dbupdate.tagcache = NULL;
+  dbupdate.tagdone = NULL;
+  dbupdate.tagwindow = 0;
+  dbupdate.tagqueued = 0;
+  dbupdate.tagseq = 0;
+  dbupdate.tagnext = 0;
+  dbupdate.anapool = NULL;
+  dbupdate.tagwriter = NULL;
+  dbupdate.anaaaf = NULL;
+  dbupdate.bpmd = NULL;
+  dbupdate.loud = NULL;
+  dbupdate.anathreads = 0;
+  dbupdate.anaqueued = 0;
+  dbupdate.seen = NULL;
+  dbupdate.seencount = 0;
+  dbupdate.route = ROUTE_DBUPDATE;
+  dbupdate.uiroute = ROUTE_MANAGEUI;
+  dbupdate.dirwatch = NULL;
+  dbupdate.watchlist = NULL;
+  dbupdate.watchupd = NULL;
+  mstimeset (&dbupdate.watchscantm, 0);
   dbupdate.org = NULL;
   dbupdate.orgold = NULL;
   dbupdate.checknew = false;
@@ -227,6 +386,10 @@ main (int argc, char *argv[])
   dbupdate.updfromitunes = false;
   dbupdate.updfromtags = false;
   dbupdate.writetags = false;
+  dbupdate.bpmdetect = false;
+  dbupdate.loudness = false;
+  dbupdate.updchanged = false;
+  dbupdate.watch = false;
   dbupdate.cleandatabase = false;
   dbupdate.cli = false;
   dbupdate.haveolddirlist = false;
@@ -237,6 +400,9 @@ main (int argc, char *argv[])
   dbupdate.stoprequest = false;
   dbupdate.usingmusicdir = true;
   dbupdate.verbose = false;
+  dbupdate.watchdbchg = false;
+  dbupdate.watchdblock = false;
+  dbupdate.watchscan = false;
   mstimeset (&dbupdate.outputTimer, 0);
   dbupdate.autoorg = false;
   dbupdate.dancefromgenre = false;
@@ -257,9 +423,18 @@ main (int argc, char *argv[])
 
   osSetStandardSignals (dbupdateSigHandler);
 
+  /* the watcher runs at the same time as the database update */
+  /* the route must be known before the lock is acquired */
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp (argv [i], "--watch") == 0) {
+      dbupdate.route = ROUTE_DBWATCH;
+      dbupdate.uiroute = ROUTE_STARTERUI;
+    }
+  }
+
   dbupdate.startflags = BDJ4_INIT_ALL;
   bdj4startup (argc, argv, &dbupdate.musicdb,
-      "dbup", ROUTE_DBUPDATE, &dbupdate.startflags);
+      "dbup", dbupdate.route, &dbupdate.startflags);
   logProcBegin ();
 
   dbupdate.autoorg = bdjoptGetNum (OPT_G_AUTOORGANIZE);
@@ -291,6 +466,18 @@ main (int argc, char *argv[])
     dbupdate.iterfromaudiosrc = true;
     logMsg (LOG_DBG, LOG_IMPORTANT, "== check-new");
   }
+  if ((dbupdate.startflags & BDJ4_ARG_DB_UPD_CHANGED) == BDJ4_ARG_DB_UPD_CHANGED) {
+    dbupdate.updchanged = true;
+    dbupdate.iterfromaudiosrc = true;
+    logMsg (LOG_DBG, LOG_IMPORTANT, "== upd-changed");
+  }
+  if ((dbupdate.startflags & BDJ4_ARG_DB_WATCH) == BDJ4_ARG_DB_WATCH) {
+    /* the changed files are processed as for update-changed */
+    dbupdate.watch = true;
+    dbupdate.updchanged = true;
+    dbupdate.iterfromaudiosrc = true;
+    logMsg (LOG_DBG, LOG_IMPORTANT, "== watch");
+  }
   if ((dbupdate.startflags & BDJ4_ARG_DB_COMPACT) == BDJ4_ARG_DB_COMPACT) {
     dbupdate.compact = true;
     dbupdate.iterfromdb = true;
@@ -315,6 +502,7 @@ main (int argc, char *argv[])
   if ((dbupdate.startflags & BDJ4_ARG_DB_WRITE_TAGS) == BDJ4_ARG_DB_WRITE_TAGS) {
     dbupdate.writetags = true;
     dbupdate.iterfromdb = true;
+    dbupdate.tagwriter = tagwriterAlloc ();
     logMsg (LOG_DBG, LOG_IMPORTANT, "== write-tags");
   }
   if ((dbupdate.startflags & BDJ4_ARG_DB_REORG) == BDJ4_ARG_DB_REORG) {
@@ -322,6 +510,29 @@ main (int argc, char *argv[])
     dbupdate.iterfromdb = true;
     logMsg (LOG_DBG, LOG_IMPORTANT, "== reorganize");
   }
+  if ((dbupdate.startflags & BDJ4_ARG_DB_BPM_DETECT) == BDJ4_ARG_DB_BPM_DETECT) {
+    dbupdate.bpmdetect = true;
+    dbupdate.iterfromdb = true;
+    logMsg (LOG_DBG, LOG_IMPORTANT, "== bpm-detect");
+  }
+  if ((dbupdate.startflags & BDJ4_ARG_DB_LOUDNESS) == BDJ4_ARG_DB_LOUDNESS) {
+    dbupdate.loudness = true;
+    dbupdate.iterfromdb = true;
+    logMsg (LOG_DBG, LOG_IMPORTANT, "== loudness");
+  }
+  if (dbupdate.bpmdetect || dbupdate.loudness) {
+    dbupdateAnaAlloc (&dbupdate);
+  }
+  if (dbupdateNeedTagData (&dbupdate)) {
+    dbupdateTagAlloc (&dbupdate);
+    if (! dbupdate.watch) {
+      char  tbuff [MAXPATHLEN];
+
+      pathbldMakePath (tbuff, sizeof (tbuff),
+          TAGCACHE_FNAME, TAGCACHE_EXT, PATHBLD_MP_DREL_DATA);
+      dbupdate.tagcache = tagcacheLoad (tbuff);
+    }
+  }
   if ((dbupdate.startflags & BDJ4_ARG_PROGRESS) == BDJ4_ARG_PROGRESS) {
     dbupdate.progress = true;
   }
@@ -335,9 +546,12 @@ main (int argc, char *argv[])
     dbupdate.verbose = true;
   }
 
-  dbupdate.conn = connInit (ROUTE_DBUPDATE);
+  dbupdate.conn = connInit (dbupdate.route);
 
   listenPort = bdjvarsGetNum (BDJVL_PORT_DBUPDATE);
+  if (dbupdate.watch) {
+    listenPort = bdjvarsGetNum (BDJVL_PORT_DBWATCH);
+  }
   sockhMainLoop (listenPort, dbupdateProcessMsg, dbupdateProcessing, &dbupdate);
   connFree (dbupdate.conn);
   progstateFree (dbupdate.progstate);
@@ -367,7 +581,8 @@ dbupdateProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
 
   switch (route) {
     case ROUTE_NONE:
-    case ROUTE_DBUPDATE: {
+    case ROUTE_DBUPDATE:
+    case ROUTE_DBWATCH: {
       switch (msg) {
         case MSG_HANDSHAKE: {
           connProcessHandshake (dbupdate->conn, routefrom);
@@ -430,6 +645,15 @@ dbupdateProcessing (void *udata)
 
   connProcessUnconnected (dbupdate->conn);
 
+  if (dbupdate->state == DB_UPD_INIT && dbupdate->watch) {
+    dbupdateWatchInit (dbupdate);
+    dbupdate->state = DB_UPD_WATCH;
+  }
+
+  if (dbupdate->state == DB_UPD_WATCH) {
+    dbupdateWatch (dbupdate);
+  }
+
   if (dbupdate->state == DB_UPD_INIT) {
     char  tbuff [MAXPATHLEN];
 
@@ -453,13 +677,22 @@ dbupdateProcessing (void *udata)
 
     logMsg (LOG_DBG, LOG_BASIC, "existing db count: %" PRId32, dbCount (dbupdate->musicdb));
     dbStartBatch (dbupdate->musicdb);
+    if (! dbupdate->cleandatabase) {
+      dbStartChangeList (dbupdate->musicdb);
+    }
+
+    if (dbupdate->updchanged) {
+      dbupdate->seencount = dbCount (dbupdate->musicdb);
+      dbupdate->seen = mdmalloc (sizeof (bool) * (dbupdate->seencount + 1));
+      for (dbidx_t i = 0; i < dbupdate->seencount; ++i) {
+        dbupdate->seen [i] = false;
+      }
+    }
 
     dbupdate->state = DB_UPD_PREP;
   }
 
   if (dbupdate->state == DB_UPD_PREP) {
-    char  tmp [40];
-    char  tbuff [200];
     char  *tstr;
 
     mstimestart (&dbupdate->starttm);
@@ -482,17 +715,17 @@ dbupdateProcessing (void *udata)
     }
     dbupdate->processmusicdirlen = strlen (dbupdate->processmusicdir) + 1;
 
-    if (dbupdate->iterfromaudiosrc) {
+    if (dbupdate->watch && ! dbupdate->watchscan) {
+      dbupdate->counts [C_FILE_COUNT] = slistGetCount (dbupdate->watchlist);
+      slistStartIterator (dbupdate->watchlist, &dbupdate->watchiter);
+      logMsg (LOG_DBG, LOG_IMPORTANT, "watch: %" PRId32 " files changed",
+          dbupdate->counts [C_FILE_COUNT]);
+    } else if (dbupdate->iterfromaudiosrc) {
       logMsg (LOG_DBG, LOG_BASIC, "processmusicdir %s", dbupdate->processmusicdir);
 
+      /* the directories are read as the files are processed, */
+      /* the file count is updated as the files are found */
       dbupdate->asiter = audiosrcStartIterator (dbupdate->processmusicdir);
-
-      if (dbupdate->asiter != NULL) {
-        dbupdate->counts [C_FILE_COUNT] = audiosrcIterCount (dbupdate->asiter);
-        logMsg (LOG_DBG, LOG_IMPORTANT, "read directory %s: %" PRId64 " ms",
-            dbupdate->processmusicdir, (int64_t) mstimeend (&dbupdate->starttm));
-        logMsg (LOG_DBG, LOG_IMPORTANT, "  %" PRId32 " files found", dbupdate->counts [C_FILE_COUNT]);
-      }
     }
 
     if (dbupdate->iterfromdb) {
@@ -503,11 +736,9 @@ dbupdateProcessing (void *udata)
       logMsg (LOG_DBG, LOG_IMPORTANT, "  %" PRId32 " files found", dbupdate->counts [C_FILE_COUNT]);
     }
 
-    /* message to manageui */
-    snprintf (tmp, sizeof (tmp), "%" PRId32, dbupdate->counts [C_FILE_COUNT]);
-    /* CONTEXT: database update: status message */
-    snprintf (tbuff, sizeof (tbuff), _("%s files found"), tmp);
-    connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_STATUS_MSG, tbuff);
+    if (dbupdate->asiter == NULL) {
+      dbupdateSendFileCount (dbupdate);
+    }
 
     dbupdate->state = DB_UPD_PROC_FN;
   }
@@ -627,6 +858,23 @@ dbupdateProcessing (void *udata)
           dbupdateIncCount (dbupdate, C_IN_DB);
           logMsg (LOG_DBG, LOG_DBUPDATE, "  in-database (%" PRId32 ") ", dbupdate->counts [C_IN_DB]);
 
+          /* if doing an update-changed, only the audio files that */
+          /* have changed are processed */
+          if (dbupdate->updchanged) {
+            dbidx_t   dbidx;
+
+            dbidx = songGetNum (song, TAG_DBIDX);
+            if (dbidx >= 0 && dbidx < dbupdate->seencount) {
+              dbupdate->seen [dbidx] = true;
+            }
+            if (! dbupdateFileChanged (dbupdate, song, ffn)) {
+              dbupdateIncCount (dbupdate, C_FILE_SKIPPED);
+              dbupdateOutputProgress (dbupdate);
+              continue;
+            }
+            logMsg (LOG_DBG, LOG_DBUPDATE, "  changed");
+          }
+
           /* if doing a checknew, no need for further processing */
           /* if doing a compact, the information must be written to */
           /* the new database. */
@@ -672,6 +920,12 @@ dbupdateProcessing (void *udata)
     }
 
     if (fn == NULL) {
+      if (dbupdate->asiter != NULL) {
+        logMsg (LOG_DBG, LOG_IMPORTANT, "read directory %s: %" PRId64 " ms",
+            dbupdate->processmusicdir, (int64_t) mstimeend (&dbupdate->starttm));
+        logMsg (LOG_DBG, LOG_IMPORTANT, "  %" PRId32 " files found", dbupdate->counts [C_FILE_COUNT]);
+        dbupdateSendFileCount (dbupdate);
+      }
       logMsg (LOG_DBG, LOG_IMPORTANT, "-- skipped (%" PRId32 ")", dbupdate->counts [C_FILE_SKIPPED]);
       logMsg (LOG_DBG, LOG_IMPORTANT, "-- all filenames sent (%" PRId32 "): %" PRId64 " ms",
           dbupdate->counts [C_FILE_QUEUED], (int64_t) mstimeend (&dbupdate->starttm));
@@ -690,10 +944,16 @@ dbupdateProcessing (void *udata)
         dbupdate->counts [C_FILE_PROC] + dbupdate->counts [C_FILE_SKIPPED],
         dbupdate->counts [C_FILE_COUNT]);
 
-    if (dbupdate->counts [C_FILE_PROC] + dbupdate->counts [C_FILE_SKIPPED] >=
+    /* the file count is not final until all filenames are sent */
+    if (dbupdate->state == DB_UPD_PROCESS &&
+        dbupdate->counts [C_FILE_PROC] + dbupdate->counts [C_FILE_SKIPPED] >=
         dbupdate->counts [C_FILE_COUNT]) {
       logMsg (LOG_DBG, LOG_DBUPDATE, "  done");
       dbupdate->state = DB_UPD_FINISH;
+      if (dbupdate->watch) {
+        dbupdateWatchFinish (dbupdate);
+        dbupdate->state = DB_UPD_WATCH;
+      }
 
       if (dbupdate->cli) {
         if (dbupdate->progress) {
@@ -726,14 +986,68 @@ dbupdateProcessing (void *udata)
   if (dbupdate->state == DB_UPD_FINISH) {
     char  tbuff [MAXPATHLEN];
     char  dbfname [MAXPATHLEN];
+    char  serial [40];
 
     pathbldMakePath (tbuff, sizeof (tbuff),
         MUSICDB_TMP_FNAME, MUSICDB_EXT, PATHBLD_MP_DREL_DATA);
     pathbldMakePath (dbfname, sizeof (dbfname),
         MUSICDB_FNAME, MUSICDB_EXT, PATHBLD_MP_DREL_DATA);
 
+    if (dbupdate->tagpool != NULL) {
+      /* on a stop request, there may be files still being parsed */
+      workpoolCancel (dbupdate->tagpool);
+      while (! workpoolIsIdle (dbupdate->tagpool)) {
+        tagdataitem_t *tdi;
+        bool          cancelled;
+
+        while ((tdi = workpoolProcess (dbupdate->tagpool, &cancelled)) != NULL) {
+          dbupdateTagDataFree (tdi);
+        }
+        mssleep (10);
+      }
+    }
+
+    if (dbupdate->anapool != NULL) {
+      /* on a stop request, there may be songs still being analyzed */
+      workpoolCancel (dbupdate->anapool);
+      for (int i = 0; i < dbupdate->anathreads; ++i) {
+        aafilterCancel (dbupdate->anaaaf [i]);
+      }
+      while (! workpoolIsIdle (dbupdate->anapool)) {
+        dbupdateAnaProcess (dbupdate);
+        mssleep (10);
+      }
+    }
+
+    if (dbupdate->updchanged && ! dbupdate->stoprequest) {
+      dbupdateFlagMissing (dbupdate);
+    }
+
+    if (dbupdate->tagwriter != NULL) {
+      logMsg (LOG_DBG, LOG_IMPORTANT, "tag write failures: %" PRId32,
+          slistGetCount (tagwriterGetErrors (dbupdate->tagwriter)));
+    }
+
+    /* a rebuild looks up every audio file, the entries for files */
+    /* that no longer exist can be removed */
+    tagcacheSave (dbupdate->tagcache,
+        dbupdate->rebuild && ! dbupdate->stoprequest);
+
     dbEndBatch (dbupdate->musicdb);
 
+    /* the other processes apply the change list rather than re-loading */
+    /* the entire database.  rebuild and compact create a new database */
+    /* and have no change list */
+    *serial = '\0';
+    if (! dbupdate->cleandatabase) {
+      int64_t   tserial;
+
+      tserial = dbSaveChangeList (dbupdate->musicdb);
+      if (tserial > 0) {
+        snprintf (serial, sizeof (serial), "%" PRId64, tserial);
+      }
+    }
+
     if (dbupdate->cleandatabase) {
       dbEndBatch (dbupdate->newmusicdb);
       dbClose (dbupdate->newmusicdb);
@@ -767,7 +1081,14 @@ dbupdateProcessing (void *udata)
       connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_STATUS_MSG, tbuff);
     }
 
-    if (dbupdate->reorganize || dbupdate->checknew || dbupdate->rebuild) {
+    if (dbupdate->updchanged) {
+      /* CONTEXT: database update: status message: number of audio files that are missing */
+      snprintf (tbuff, sizeof (tbuff), "%s : %" PRId32 "", _("Missing"), dbupdate->counts [C_MISSING]);
+      connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_STATUS_MSG, tbuff);
+    }
+
+    if (dbupdate->reorganize || dbupdate->checknew ||
+        dbupdate->updchanged || dbupdate->rebuild) {
       if (dbupdate->counts [C_RENAMED] > 0) {
         /* CONTEXT: database update: status message: number of files renamed */
         snprintf (tbuff, sizeof (tbuff), "%s : %" PRId32 "", _("Renamed"), dbupdate->counts [C_RENAMED]);
@@ -813,7 +1134,9 @@ dbupdateProcessing (void *udata)
     logMsg (LOG_DBG, LOG_IMPORTANT, "processed: %" PRId32 "", dbupdate->counts [C_FILE_PROC]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "queue-max: %" PRId32 "", dbupdate->counts [C_QUEUE_MAX]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "    in-db: %" PRId32 "", dbupdate->counts [C_IN_DB]);
+    logMsg (LOG_DBG, LOG_IMPORTANT, "  missing: %" PRId32 "", dbupdate->counts [C_MISSING]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "audio-tag: %" PRId32 "", dbupdate->counts [C_AUDIO_TAGS_PARSED]);
+    logMsg (LOG_DBG, LOG_IMPORTANT, "tag-cache: %" PRId32 "", dbupdate->counts [C_AUDIO_TAGS_CACHED]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "      new: %" PRId32 "", dbupdate->counts [C_NEW]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "  updated: %" PRId32 "", dbupdate->counts [C_UPDATED]);
     logMsg (LOG_DBG, LOG_IMPORTANT, "  renamed: %" PRId32 "", dbupdate->counts [C_RENAMED]);
@@ -828,7 +1151,8 @@ dbupdateProcessing (void *udata)
     logMsg (LOG_DBG, LOG_IMPORTANT, "max-write: %" PRIu64, (uint64_t) dbupdate->maxWriteLen);
 
     connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_PROGRESS, "END");
-    connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_FINISH, NULL);
+    connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_FINISH,
+        *serial ? serial : NULL);
     connDisconnect (dbupdate->conn, ROUTE_MANAGEUI);
 
     progstateShutdownProcess (dbupdate->progstate);
@@ -855,13 +1179,13 @@ dbupdateConnectingCallback (void *tdbupdate, programstate_t programState)
 
   if ((dbupdate->startflags & BDJ4_INIT_NO_START) != BDJ4_INIT_NO_START) {
     if (! dbupdate->cli &&
-        ! connIsConnected (dbupdate->conn, ROUTE_MANAGEUI)) {
-      connConnect (dbupdate->conn, ROUTE_MANAGEUI);
+        ! connIsConnected (dbupdate->conn, dbupdate->uiroute)) {
+      connConnect (dbupdate->conn, dbupdate->uiroute);
     }
   }
 
   if (dbupdate->cli ||
-      connIsConnected (dbupdate->conn, ROUTE_MANAGEUI)) {
+      connIsConnected (dbupdate->conn, dbupdate->uiroute)) {
     rc = STATE_FINISHED;
   }
 
@@ -880,12 +1204,19 @@ dbupdateHandshakeCallback (void *tdbupdate, programstate_t programState)
   connProcessUnconnected (dbupdate->conn);
 
   if (dbupdate->cli ||
-      connHaveHandshake (dbupdate->conn, ROUTE_MANAGEUI)) {
+      connHaveHandshake (dbupdate->conn, dbupdate->uiroute)) {
     rc = STATE_FINISHED;
   }
 
   if (rc == STATE_FINISHED && dbupdate->updfromitunes) {
     connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_WAIT, NULL);
+    /* the parse runs to completion here, the outbound messages */
+    /* must be sent now rather than at the end of the main loop pass */
+    connFlush (dbupdate->conn);
+    if (dbupdate->itunesprogresscb == NULL) {
+      dbupdate->itunesprogresscb = callbackInitD (dbupdateiTunesProgress, dbupdate);
+      itunesSetProgressCallback (dbupdate->itunes, dbupdate->itunesprogresscb);
+    }
     itunesParse (dbupdate->itunes);
     connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_WAIT_FINISH, NULL);
   }
@@ -902,7 +1233,7 @@ dbupdateStoppingCallback (void *tdbupdate, programstate_t programState)
   logProcBegin ();
 
   procutilStopAllProcess (dbupdate->processes, dbupdate->conn, PROCUTIL_NORM_TERM);
-  connDisconnect (dbupdate->conn, ROUTE_MANAGEUI);
+  connDisconnect (dbupdate->conn, dbupdate->uiroute);
   logProcEnd ("");
   return STATE_FINISHED;
 }
@@ -925,8 +1256,10 @@ dbupdateClosingCallback (void *tdbupdate, programstate_t programState)
   logProcBegin ();
 
   audiosrcCleanIterator (dbupdate->asiter);
+  /* any pending tag writes are completed */
+  tagwriterFree (dbupdate->tagwriter);
 
-  bdj4shutdown (ROUTE_DBUPDATE, dbupdate->musicdb);
+  bdj4shutdown (dbupdate->route, dbupdate->musicdb);
   dbClose (dbupdate->newmusicdb);
 
   procutilStopAllProcess (dbupdate->processes, dbupdate->conn, PROCUTIL_FORCE_TERM);
@@ -934,10 +1267,30 @@ dbupdateClosingCallback (void *tdbupdate, programstate_t programState)
 
   songdbFree (dbupdate->songdb);
   itunesFree (dbupdate->itunes);
+  callbackFree (dbupdate->itunesprogresscb);
   orgFree (dbupdate->org);
   orgFree (dbupdate->orgold);
   regexFree (dbupdate->badfnregex);
   queueFree (dbupdate->tagdataq);
+  workpoolFree (dbupdate->tagpool);
+  tagcacheFree (dbupdate->tagcache);
+  for (int i = 0; i < dbupdate->tagwindow; ++i) {
+    dbupdateTagDataFree (dbupdate->tagdone [i]);
+  }
+  dataFree (dbupdate->tagdone);
+  workpoolFree (dbupdate->anapool);
+  for (int i = 0; i < dbupdate->anathreads; ++i) {
+    aafilterFree (dbupdate->anaaaf [i]);
+    bpmdetectFree (dbupdate->bpmd [i]);
+    loudnessFree (dbupdate->loud [i]);
+  }
+  dataFree (dbupdate->anaaaf);
+  dataFree (dbupdate->bpmd);
+  dataFree (dbupdate->loud);
+  dataFree (dbupdate->seen);
+  dirwatchFree (dbupdate->dirwatch);
+  slistFree (dbupdate->watchlist);
+  nlistFree (dbupdate->watchupd);
 
   logProcEnd ("");
   return STATE_FINISHED;
@@ -961,6 +1314,10 @@ dbupdateQueueFile (dbupdate_t *dbupdate, const char *ffn,
   tdi->ffn = mdstrdup (ffn);
   tdi->songfn = mdstrdup (songfn);
   tdi->relfn = mdstrdup (relfn);
+  tdi->tagdata = NULL;
+  tdi->rewrite = 0;
+  tdi->cached = false;
+  tdi->seq = 0;
   queuePush (dbupdate->tagdataq, tdi);
   count = queueGetCount (dbupdate->tagdataq);
   // fprintf (stderr, "q-push: %s %" PRId32 "\n", ffn, count);
@@ -978,6 +1335,7 @@ dbupdateTagDataFree (void *data)
     dataFree (tdi->ffn);
     dataFree (tdi->songfn);
     dataFree (tdi->relfn);
+    slistFree (tdi->tagdata);
     mdfree (tdi);
   }
 }
@@ -987,6 +1345,25 @@ dbupdateProcessFileQueue (dbupdate_t *dbupdate)
 {
   tagdataitem_t *tdi;
 
+  if (dbupdate->anapool != NULL) {
+    dbupdateAnaProcess (dbupdate);
+    if (dbupdate->anaqueued >= dbupdate->anathreads * ANA_QUEUE_PER_THREAD) {
+      return;
+    }
+  }
+
+  if (dbupdate->tagwriter != NULL) {
+    dbupdateWriteTagsProcess (dbupdate);
+    if (tagwriterGetCount (dbupdate->tagwriter) >= TAG_WRITE_QUEUE_MAX) {
+      return;
+    }
+  }
+
+  if (dbupdate->tagpool != NULL) {
+    dbupdateTagProcess (dbupdate);
+    return;
+  }
+
   if (queueGetCount (dbupdate->tagdataq) <= 0) {
     return;
   }
@@ -1007,19 +1384,25 @@ dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi)
   song_t      *song = NULL;
   const char  *val = NULL;
   int         rewrite;
+  bool        cached;
   int         songdbflags;
 
   logMsg (LOG_DBG, LOG_DBUPDATE, "__ process %s", tdi->ffn);
 
-  if (! dbupdate->updfromitunes &&
-      ! dbupdate->reorganize &&
-      ! dbupdate->compact) {
-    /* write-tags needs the tag-data to determine updates */
-    /* new audio files need the tag-data */
-    /* compact gets the tag-data from the database */
-
-    tagdata = audiotagParseData (tdi->ffn, &rewrite);
-    dbupdateIncCount (dbupdate, C_AUDIO_TAGS_PARSED);
+  if (dbupdateNeedTagData (dbupdate)) {
+    /* the tag-data may have already been parsed by a worker thread */
+    tagdata = tdi->tagdata;
+    tdi->tagdata = NULL;
+    rewrite = tdi->rewrite;
+    cached = tdi->cached;
+    if (tagdata == NULL) {
+      tagdata = dbupdateParseTags (dbupdate, tdi->ffn, &rewrite, &cached);
+    }
+    if (cached) {
+      dbupdateIncCount (dbupdate, C_AUDIO_TAGS_CACHED);
+    } else {
+      dbupdateIncCount (dbupdate, C_AUDIO_TAGS_PARSED);
+    }
     if (slistGetCount (tagdata) == 0) {
       /* if there is not even a duration, then file is no good */
       /* probably not an audio file */
@@ -1033,7 +1416,6 @@ dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi)
   /* write-tags has its own processing */
   if (dbupdate->writetags) {
     dbupdateWriteTags (dbupdate, tdi, tagdata);
-    slistFree (tagdata);
     return;
   }
 
@@ -1049,6 +1431,18 @@ dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi)
     return;
   }
 
+  /* bpm-detect has its own processing */
+  if (dbupdate->bpmdetect) {
+    dbupdateBPMQueue (dbupdate, tdi);
+    return;
+  }
+
+  /* loudness has its own processing */
+  if (dbupdate->loudness) {
+    dbupdateLoudnessQueue (dbupdate, tdi);
+    return;
+  }
+
   /* check-for-new, compact, rebuild, update-from-tags */
 
   if (dbupdate->dancefromgenre) {
@@ -1169,6 +1563,7 @@ dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi)
   song = songAlloc ();
   songFromTagList (song, tagdata);
   songSetStr (song, TAG_URI, tdi->songfn);
+  dbupdateSetFileStat (song, tdi->ffn);
   songdbflags = SONGDB_NONE;
   if (dbupdate->autoorg && (dbupdate->checknew || dbupdate->rebuild)) {
     songdbflags = SONGDB_NONE;
@@ -1188,6 +1583,202 @@ dbupdateProcessFile (dbupdate_t *dbupdate, tagdataitem_t *tdi)
   dbupdateIncCount (dbupdate, C_FILE_PROC);
 }
 
+static bool
+dbupdateNeedTagData (dbupdate_t *dbupdate)
+{
+  /* write-tags needs the tag-data to determine updates */
+  /* new audio files need the tag-data */
+  /* compact gets the tag-data from the database */
+  return ! dbupdate->updfromitunes &&
+      ! dbupdate->reorganize &&
+      ! dbupdate->bpmdetect &&
+      ! dbupdate->loudness &&
+      ! dbupdate->compact;
+}
+
+/* the audio tags are parsed by the worker threads. */
+/* the database is updated here, in the order that the files were queued, */
+/* so that the new database is the same as with a single thread */
+static void
+dbupdateTagProcess (dbupdate_t *dbupdate)
+{
+  tagdataitem_t *tdi;
+  bool          cancelled;
+  int           idx;
+
+  while ((tdi = workpoolProcess (dbupdate->tagpool, &cancelled)) != NULL) {
+    if (cancelled) {
+      --dbupdate->tagqueued;
+      dbupdateTagDataFree (tdi);
+      continue;
+    }
+    dbupdate->tagdone [tdi->seq % dbupdate->tagwindow] = tdi;
+  }
+
+  idx = dbupdate->tagnext % dbupdate->tagwindow;
+  while (dbupdate->tagdone [idx] != NULL) {
+    tdi = dbupdate->tagdone [idx];
+    dbupdate->tagdone [idx] = NULL;
+    ++dbupdate->tagnext;
+    --dbupdate->tagqueued;
+    dbupdateProcessFile (dbupdate, tdi);
+    dbupdateTagDataFree (tdi);
+    idx = dbupdate->tagnext % dbupdate->tagwindow;
+  }
+
+  while (dbupdate->tagqueued < dbupdate->tagwindow &&
+      queueGetCount (dbupdate->tagdataq) > 0) {
+    tdi = queuePop (dbupdate->tagdataq);
+    tdi->seq = dbupdate->tagseq;
+    ++dbupdate->tagseq;
+    ++dbupdate->tagqueued;
+    workpoolAdd (dbupdate->tagpool, tdi);
+  }
+}
+
+static void
+dbupdateTagAlloc (dbupdate_t *dbupdate)
+{
+  dbupdate->tagpool = workpoolAlloc ("dbupd-tags", 0,
+      dbupdateTagWorker, dbupdate);
+  dbupdate->tagwindow = workpoolThreadCount (dbupdate->tagpool) *
+      TAG_QUEUE_PER_THREAD;
+  dbupdate->tagdone = mdmalloc (sizeof (tagdataitem_t *) * dbupdate->tagwindow);
+  for (int i = 0; i < dbupdate->tagwindow; ++i) {
+    dbupdate->tagdone [i] = NULL;
+  }
+}
+
+/* runs in a worker thread */
+static void
+dbupdateTagWorker (void *udata, void *tjob, int thridx)
+{
+  dbupdate_t    *dbupdate = udata;
+  tagdataitem_t *tdi = tjob;
+
+  tdi->tagdata = dbupdateParseTags (dbupdate, tdi->ffn, &tdi->rewrite,
+      &tdi->cached);
+}
+
+/* may run in a worker thread */
+/* the tag cache is checked before the audio file is parsed */
+/* cached is set if the tag data came from the tag cache */
+static slist_t *
+dbupdateParseTags (dbupdate_t *dbupdate, const char *ffn, int *rewrite,
+    bool *cached)
+{
+  slist_t       *tagdata = NULL;
+  fileopstat_t  fst;
+  bool          havestat;
+
+  *cached = false;
+  havestat = fileopStat (ffn, &fst);
+  if (havestat) {
+    tagdata = tagcacheGet (dbupdate->tagcache, ffn, &fst, rewrite);
+  }
+  if (tagdata != NULL) {
+    *cached = true;
+    return tagdata;
+  }
+
+  tagdata = audiotagParseData (ffn, rewrite);
+  if (havestat && slistGetCount (tagdata) > 0) {
+    tagcacheSet (dbupdate->tagcache, ffn, &fst, tagdata, *rewrite);
+  }
+  return tagdata;
+}
+
+/* returns false if the file size, modification time and inode */
+/* are unchanged */
+static bool
+dbupdateFileChanged (dbupdate_t *dbupdate, song_t *song, const char *ffn)
+{
+  fileopstat_t  fst;
+  listnum_t     size;
+
+  if (! fileopStat (ffn, &fst)) {
+    return true;
+  }
+
+  size = songGetNum (song, TAG_FILE_SIZE);
+  if (size == LIST_VALUE_INVALID) {
+    /* a database entry from before the file information was saved. */
+    /* if the audio file has not been modified since the database */
+    /* entry was written, only the file information needs to be saved */
+    if (fst.mtime > songGetNum (song, TAG_LAST_UPDATED)) {
+      return true;
+    }
+  } else {
+    if (size != fst.size ||
+        songGetNum (song, TAG_FILE_MTIME) != (listnum_t) fst.mtime ||
+        songGetNum (song, TAG_FILE_INODE) != (listnum_t) fst.inode) {
+      return true;
+    }
+    if (songGetNum (song, TAG_FILE_MISSING) != true) {
+      return false;
+    }
+  }
+
+  /* the audio files are not being modified, using dbWriteSong() */
+  /* here is ok */
+  dbupdateSetFileStat (song, ffn);
+  dbWriteSong (dbupdate->musicdb, song);
+  return false;
+}
+
+static void
+dbupdateSetFileStat (song_t *song, const char *ffn)
+{
+  fileopstat_t  fst;
+
+  if (! fileopStat (ffn, &fst)) {
+    return;
+  }
+
+  songSetNum (song, TAG_FILE_SIZE, fst.size);
+  songSetNum (song, TAG_FILE_MTIME, fst.mtime);
+  songSetNum (song, TAG_FILE_INODE, (listnum_t) fst.inode);
+  songSetNum (song, TAG_FILE_MISSING, false);
+}
+
+/* any file audio source that was not found when traversing the music */
+/* dir is checked, as it may be located elsewhere */
+static void
+dbupdateFlagMissing (dbupdate_t *dbupdate)
+{
+  slistidx_t  dbiteridx;
+  song_t      *song;
+  dbidx_t     dbidx;
+  const char  *fn;
+  char        ffn [MAXPATHLEN];
+
+  dbStartIterator (dbupdate->musicdb, &dbiteridx);
+  while ((song = dbIterate (dbupdate->musicdb, &dbidx, &dbiteridx)) != NULL) {
+    if (dbidx >= 0 && dbidx < dbupdate->seencount && dbupdate->seen [dbidx]) {
+      continue;
+    }
+
+    fn = songGetStr (song, TAG_URI);
+    if (audiosrcGetType (fn) != AUDIOSRC_TYPE_FILE) {
+      continue;
+    }
+
+    audiosrcFullPath (fn, ffn, sizeof (ffn), NULL, 0);
+    if (fileopFileExists (ffn)) {
+      continue;
+    }
+
+    dbupdateIncCount (dbupdate, C_MISSING);
+    logMsg (LOG_DBG, LOG_DBUPDATE, "  missing: %s", fn);
+    if (songGetNum (song, TAG_FILE_MISSING) == true) {
+      continue;
+    }
+    songSetNum (song, TAG_FILE_MISSING, true);
+    dbWriteSong (dbupdate->musicdb, song);
+  }
+}
+
+/* the tag writer takes ownership of the tagdata */
 static void
 dbupdateWriteTags (dbupdate_t *dbupdate, tagdataitem_t *tdi, slist_t *tagdata)
 {
@@ -1195,20 +1786,33 @@ dbupdateWriteTags (dbupdate_t *dbupdate, tagdataitem_t *tdi, slist_t *tagdata)
   slist_t     *newtaglist;
 
   if (tdi->ffn == NULL) {
+    slistFree (tagdata);
     return;
   }
 
   song = dbGetByName (dbupdate->musicdb, tdi->songfn);
   if (song == NULL) {
+    slistFree (tagdata);
     dbupdateIncCount (dbupdate, C_FILE_PROC);
     return;
   }
 
+  /* the file is counted as processed when the tag writer is finished */
   newtaglist = songTagList (song);
-  audiotagWriteTags (tdi->ffn, tagdata, newtaglist, AF_REWRITE_NONE, AT_UPDATE_MOD_TIME);
-  slistFree (newtaglist);
-  dbupdateIncCount (dbupdate, C_FILE_PROC);
-  dbupdateIncCount (dbupdate, C_WRITE_TAGS);
+  tagwriterAdd (dbupdate->tagwriter, tdi->ffn, tagdata, newtaglist,
+      AF_REWRITE_NONE, AT_UPDATE_MOD_TIME);
+}
+
+static void
+dbupdateWriteTagsProcess (dbupdate_t *dbupdate)
+{
+  int32_t     count;
+
+  count = tagwriterProcess (dbupdate->tagwriter);
+  for (int32_t i = 0; i < count; ++i) {
+    dbupdateIncCount (dbupdate, C_FILE_PROC);
+    dbupdateIncCount (dbupdate, C_WRITE_TAGS);
+  }
 }
 
 static void
@@ -1304,12 +1908,288 @@ dbupdateReorganize (dbupdate_t *dbupdate, tagdataitem_t *tdi,
   dbupdateIncCount (dbupdate, C_FILE_PROC);
 }
 
+/* the song is analyzed by the worker threads */
+static void
+dbupdateBPMQueue (dbupdate_t *dbupdate, tagdataitem_t *tdi)
+{
+  song_t      *song = NULL;
+  dance_t     *dances;
+  anajob_t    *job;
+  ilistidx_t  danceidx;
+  int32_t     dur;
+  int         timesig;
+  int         low, high;
+
+  if (tdi->ffn == NULL) {
+    return;
+  }
+
+  song = dbGetByName (dbupdate->musicdb, tdi->songfn);
+  if (song == NULL || songGetNum (song, TAG_BPM) > 0) {
+    /* the bpm has already been set */
+    dbupdateIncCount (dbupdate, C_FILE_PROC);
+    return;
+  }
+
+  job = mdmalloc (sizeof (anajob_t));
+  job->dbidx = songGetNum (song, TAG_DBIDX);
+  job->ffn = mdstrdup (tdi->ffn);
+  job->bpm = 0.0;
+  job->confidence = 0;
+  job->lufs = LOUDNESS_NONE;
+  job->truepeak = LOUDNESS_NONE;
+  job->rc = -1;
+
+  /* the beginning of a song may not be in tempo, use the middle */
+  dur = songGetNum (song, TAG_DURATION);
+  job->startms = 0;
+  job->durms = BPM_ANALYZE_DUR;
+  if (dur > BPM_ANALYZE_DUR) {
+    job->startms = (dur - BPM_ANALYZE_DUR) / 2;
+  }
+
+  /* the dances have the range in measures per minute */
+  danceidx = songGetNum (song, TAG_DANCE);
+  timesig = danceGetTimeSignature (danceidx);
+  job->beats = danceTimesigValues [timesig];
+  job->lowbpm = BPM_DEFAULT_LOW;
+  job->highbpm = BPM_DEFAULT_HIGH;
+  if (danceidx >= 0) {
+    dances = bdjvarsdfGet (BDJVDF_DANCES);
+    low = danceGetNum (dances, danceidx, DANCE_MPM_LOW);
+    high = danceGetNum (dances, danceidx, DANCE_MPM_HIGH);
+    if (low > 0 && high >= low) {
+      job->lowbpm = low * job->beats * (1.0 - BPM_RANGE_MARGIN);
+      job->highbpm = high * job->beats * (1.0 + BPM_RANGE_MARGIN);
+    }
+  }
+
+  ++dbupdate->anaqueued;
+  workpoolAdd (dbupdate->anapool, job);
+}
+
+static void
+dbupdateAnaProcess (dbupdate_t *dbupdate)
+{
+  anajob_t  *job;
+  bool      cancelled;
+
+  while ((job = workpoolProcess (dbupdate->anapool, &cancelled)) != NULL) {
+    --dbupdate->anaqueued;
+    if (! cancelled && dbupdate->bpmdetect) {
+      dbupdateBPMFinish (dbupdate, job);
+    } else if (! cancelled && dbupdate->loudness) {
+      dbupdateLoudnessFinish (dbupdate, job);
+    }
+    dbupdateAnaJobFree (job);
+  }
+}
+
+static void
+dbupdateBPMFinish (dbupdate_t *dbupdate, anajob_t *job)
+{
+  song_t    *song;
+  int       songdbflags;
+  int       mpm;
+
+  dbupdateIncCount (dbupdate, C_FILE_PROC);
+
+  logMsg (LOG_DBG, LOG_DBUPDATE, "bpm: %s: rc %d bpm %.2f conf %d",
+      job->ffn, job->rc, job->bpm, job->confidence);
+  if (job->rc != 0 || job->bpm <= 0.0 ||
+      job->confidence < BPM_MIN_CONFIDENCE) {
+    return;
+  }
+
+  song = dbGetByIdx (dbupdate->musicdb, job->dbidx);
+  if (song == NULL) {
+    return;
+  }
+
+  /* the database holds measures per minute */
+  mpm = (int) (job->bpm / (double) job->beats + 0.5);
+  if (mpm <= 0) {
+    return;
+  }
+
+  dbupdateSetCurrentDB (dbupdate);
+  songSetNum (song, TAG_BPM, mpm);
+  songdbflags = SONGDB_NONE;
+  dbupdateWriteSong (dbupdate, song, &songdbflags, songGetNum (song, TAG_RRN));
+  dbupdateIncCount (dbupdate, C_UPDATED);
+}
+
+/* the entire song is analyzed by the worker threads */
+static void
+dbupdateLoudnessQueue (dbupdate_t *dbupdate, tagdataitem_t *tdi)
+{
+  song_t      *song = NULL;
+  anajob_t    *job;
+
+  if (tdi->ffn == NULL) {
+    return;
+  }
+
+  song = dbGetByName (dbupdate->musicdb, tdi->songfn);
+  if (song == NULL) {
+    dbupdateIncCount (dbupdate, C_FILE_PROC);
+    return;
+  }
+
+  /* the song has already been analyzed, and the audio file has not */
+  /* been changed since the database entry was updated */
+  if (songGetDouble (song, TAG_LOUDNESS) != LIST_DOUBLE_INVALID &&
+      fileopModTime (tdi->ffn) <= songGetNum (song, TAG_LAST_UPDATED)) {
+    dbupdateIncCount (dbupdate, C_FILE_PROC);
+    return;
+  }
+
+  job = mdmalloc (sizeof (anajob_t));
+  job->dbidx = songGetNum (song, TAG_DBIDX);
+  job->ffn = mdstrdup (tdi->ffn);
+  job->startms = 0;
+  job->durms = 0;
+  job->bpm = 0.0;
+  job->confidence = 0;
+  job->lufs = LOUDNESS_NONE;
+  job->truepeak = LOUDNESS_NONE;
+  job->rc = -1;
+
+  ++dbupdate->anaqueued;
+  workpoolAdd (dbupdate->anapool, job);
+}
+
+static void
+dbupdateLoudnessFinish (dbupdate_t *dbupdate, anajob_t *job)
+{
+  song_t    *song;
+  int       songdbflags;
+  double    voladj;
+  double    prevlufs;
+  double    target;
+  bool      replace;
+
+  dbupdateIncCount (dbupdate, C_FILE_PROC);
+
+  logMsg (LOG_DBG, LOG_DBUPDATE, "loudness: %s: rc %d lufs %.2f tp %.2f",
+      job->ffn, job->rc, job->lufs, job->truepeak);
+  if (job->rc != 0 || job->lufs <= LOUDNESS_NONE) {
+    return;
+  }
+
+  song = dbGetByIdx (dbupdate->musicdb, job->dbidx);
+  if (song == NULL) {
+    return;
+  }
+
+  /* a volume adjustment set by the user is not replaced. */
+  /* the volume adjustment is only replaced if it is not set, or if */
+  /* it is still the value set by the prior analysis */
+  target = (double) bdjoptGetNum (OPT_G_LOUDNESS_TARGET);
+  voladj = songGetDouble (song, TAG_VOLUMEADJUSTPERC);
+  prevlufs = songGetDouble (song, TAG_LOUDNESS);
+  replace = voladj == LIST_DOUBLE_INVALID || voladj == 0.0;
+  if (! replace && prevlufs != LIST_DOUBLE_INVALID) {
+    double    prevtp;
+    double    prevadj;
+
+    prevtp = songGetDouble (song, TAG_TRUE_PEAK);
+    if (prevtp == LIST_DOUBLE_INVALID) {
+      prevtp = LOUDNESS_NONE;
+    }
+    prevadj = loudnessVolumeAdjust (prevlufs, prevtp, target);
+    /* the adjustment is rounded to one decimal place */
+    replace = fabs (voladj - prevadj) < 0.05;
+  }
+
+  dbupdateSetCurrentDB (dbupdate);
+  songSetDouble (song, TAG_LOUDNESS, job->lufs);
+  songSetDouble (song, TAG_TRUE_PEAK, job->truepeak);
+  if (replace) {
+    voladj = loudnessVolumeAdjust (job->lufs, job->truepeak, target);
+    songSetDouble (song, TAG_VOLUMEADJUSTPERC, voladj);
+  }
+  songdbflags = SONGDB_NONE;
+  dbupdateWriteSong (dbupdate, song, &songdbflags, songGetNum (song, TAG_RRN));
+  dbupdateIncCount (dbupdate, C_UPDATED);
+}
+
+/* runs in a worker thread */
+static void
+dbupdateAnaWorker (void *udata, void *tjob, int thridx)
+{
+  dbupdate_t  *dbupdate = udata;
+  anajob_t    *job = tjob;
+
+  if (! dbupdate->bpmdetect) {
+    job->rc = loudnessFile (dbupdate->loud [thridx],
+        dbupdate->anaaaf [thridx], job->ffn);
+    if (job->rc == 0) {
+      job->lufs = loudnessIntegrated (dbupdate->loud [thridx]);
+      job->truepeak = loudnessTruePeak (dbupdate->loud [thridx]);
+    }
+    return;
+  }
+
+  job->rc = bpmdetectFile (dbupdate->bpmd [thridx], dbupdate->anaaaf [thridx],
+      job->ffn, job->startms, job->durms);
+  if (job->rc == 0) {
+    job->bpm = bpmdetectCalc (dbupdate->bpmd [thridx],
+        job->lowbpm, job->highbpm, &job->confidence);
+  }
+}
+
+static void
+dbupdateAnaJobFree (anajob_t *job)
+{
+  if (job == NULL) {
+    return;
+  }
+  dataFree (job->ffn);
+  mdfree (job);
+}
+
+static void
+dbupdateAnaAlloc (dbupdate_t *dbupdate)
+{
+  dbupdate->anapool = workpoolAlloc ("dbupd-analyze", 0,
+      dbupdateAnaWorker, dbupdate);
+  dbupdate->anathreads = workpoolThreadCount (dbupdate->anapool);
+  dbupdate->anaaaf = mdmalloc (sizeof (aafilter_t *) * dbupdate->anathreads);
+  dbupdate->bpmd = mdmalloc (sizeof (bpmdetect_t *) * dbupdate->anathreads);
+  dbupdate->loud = mdmalloc (sizeof (loudness_t *) * dbupdate->anathreads);
+  for (int i = 0; i < dbupdate->anathreads; ++i) {
+    dbupdate->anaaaf [i] = aafilterAlloc ();
+    dbupdate->bpmd [i] = NULL;
+    dbupdate->loud [i] = NULL;
+    if (dbupdate->bpmdetect) {
+      dbupdate->bpmd [i] = bpmdetectAlloc ();
+    }
+    if (dbupdate->loudness) {
+      dbupdate->loud [i] = loudnessAlloc ();
+    }
+  }
+}
+
 static void
 dbupdateSigHandler (int sig)
 {
   gKillReceived = 1;
 }
 
+static void
+dbupdateSendFileCount (dbupdate_t *dbupdate)
+{
+  char    tmp [40];
+  char    tbuff [200];
+
+  /* message to manageui */
+  snprintf (tmp, sizeof (tmp), "%" PRId32, dbupdate->counts [C_FILE_COUNT]);
+  /* CONTEXT: database update: status message */
+  snprintf (tbuff, sizeof (tbuff), _("%s files found"), tmp);
+  connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_STATUS_MSG, tbuff);
+}
+
 static void
 dbupdateOutputProgress (dbupdate_t *dbupdate)
 {
@@ -1350,6 +2230,28 @@ dbupdateOutputProgress (dbupdate_t *dbupdate)
   }
 }
 
+/* the itunes xml file may be large, display the parse progress */
+static bool
+dbupdateiTunesProgress (void *udata, double dval)
+{
+  dbupdate_t  *dbupdate = udata;
+  char        tbuff [40];
+
+  if (! dbupdate->progress) {
+    return false;
+  }
+
+  snprintf (tbuff, sizeof (tbuff), "PROG %.2f", dval);
+  if (dbupdate->cli) {
+    fprintf (stdout, "\r%6.2f", dval * 100.0);
+    fflush (stdout);
+  } else {
+    connSendMessage (dbupdate->conn, ROUTE_MANAGEUI, MSG_DB_PROGRESS, tbuff);
+    connFlush (dbupdate->conn);
+  }
+  return false;
+}
+
 static bool
 checkOldDirList (dbupdate_t *dbupdate, const char *fn)
 {
@@ -1426,8 +2328,22 @@ dbupdateIterate (dbupdate_t *dbupdate)
   dbidx_t     dbidx;
   song_t      *song;
 
+  if (dbupdate->watch && ! dbupdate->watchscan) {
+    fn = slistIterateKey (dbupdate->watchlist, &dbupdate->watchiter);
+    if (fn == NULL) {
+      return fn;
+    }
+    song = dbGetByName (dbupdate->musicdb, audiosrcRelativePath (fn, 0));
+    if (song != NULL) {
+      /* the entry may have been changed by another process */
+      dbLoadEntry (dbupdate->musicdb, songGetNum (song, TAG_DBIDX));
+    }
+    return fn;
+  }
+
   if (dbupdate->iterfromaudiosrc) {
     fn = audiosrcIterate (dbupdate->asiter);
+    dbupdate->counts [C_FILE_COUNT] = audiosrcIterCount (dbupdate->asiter);
   }
   if (dbupdate->iterfromdb) {
     song = dbIterate (dbupdate->musicdb, &dbidx, &dbupdate->dbiter);
@@ -1436,3 +2352,317 @@ dbupdateIterate (dbupdate_t *dbupdate)
 
   return fn;
 }
+
+static void
+dbupdateWatchInit (dbupdate_t *dbupdate)
+{
+  const char  *musicdir;
+
+  musicdir = bdjoptGetStr (OPT_M_DIR_MUSIC);
+  dbupdate->dirwatch = dirwatchAlloc (musicdir, WATCH_DEBOUNCE);
+  dbupdate->watchlist = slistAlloc ("dbup-watch", LIST_ORDERED, NULL);
+  dbupdate->watchupd = nlistAlloc ("dbup-watch-upd", LIST_ORDERED, NULL);
+  dbStartChangeList (dbupdate->musicdb);
+  if (! dirwatchIsComplete (dbupdate->dirwatch)) {
+    /* the watch limit was reached, or watching is not supported */
+    logMsg (LOG_DBG, LOG_IMPORTANT, "watch: %s incomplete, periodic scan", musicdir);
+  }
+  mstimeset (&dbupdate->watchscantm, WATCH_SCAN_INTERVAL);
+}
+
+static void
+dbupdateWatch (dbupdate_t *dbupdate)
+{
+  dirwatchevent_t ev;
+  const char      *path;
+  const char      *oldpath;
+  bool            inbatch = false;
+
+  dirwatchProcess (dbupdate->dirwatch);
+
+  /* the database must not be written while a database update is running */
+  /* the events are held until the database update is finished */
+  if (lockExists (lockName (ROUTE_DBUPDATE), PATHBLD_MP_USEIDX) > 0) {
+    dbupdate->watchdblock = true;
+    return;
+  }
+  if (dbupdate->watchdblock) {
+    /* the database update may have replaced the database */
+    dbupdate->musicdb = bdj4ReloadDatabase (dbupdate->musicdb);
+    songdbSetMusicDB (dbupdate->songdb, dbupdate->musicdb);
+    dbStartChangeList (dbupdate->musicdb);
+    dbupdate->watchdblock = false;
+  }
+
+  while ((ev = dirwatchNext (dbupdate->dirwatch, &path, &oldpath)) !=
+      DIRWATCH_NONE) {
+    logMsg (LOG_DBG, LOG_DBUPDATE, "watch: %d %s", ev, path);
+    if (! inbatch) {
+      dbStartBatch (dbupdate->musicdb);
+      inbatch = true;
+    }
+    switch (ev) {
+      case DIRWATCH_CHANGED: {
+        slistSetNum (dbupdate->watchlist, path, 0);
+        break;
+      }
+      case DIRWATCH_REMOVED:
+      case DIRWATCH_DIR_REMOVED: {
+        dbupdateWatchRemove (dbupdate, path, ev == DIRWATCH_DIR_REMOVED);
+        break;
+      }
+      case DIRWATCH_RENAMED:
+      case DIRWATCH_DIR_RENAMED: {
+        dbupdateWatchRename (dbupdate, oldpath, path, ev == DIRWATCH_DIR_RENAMED);
+        break;
+      }
+      case DIRWATCH_RESCAN: {
+        dbupdate->watchscan = true;
+        break;
+      }
+      case DIRWATCH_NONE: {
+        break;
+      }
+    }
+  }
+  if (inbatch) {
+    dbEndBatch (dbupdate->musicdb);
+  }
+
+  if (! dirwatchIsComplete (dbupdate->dirwatch) &&
+      mstimeCheck (&dbupdate->watchscantm)) {
+    dbupdate->watchscan = true;
+  }
+
+  if (dbupdate->watchscan || slistGetCount (dbupdate->watchlist) > 0) {
+    dbupdateWatchStart (dbupdate);
+    return;
+  }
+
+  dbupdateWatchNotify (dbupdate);
+}
+
+/* starts processing the changed audio files, or a scan of the */
+/* entire music folder */
+static void
+dbupdateWatchStart (dbupdate_t *dbupdate)
+{
+  for (int i = 0; i < C_MAX; ++i) {
+    dbupdate->counts [i] = 0;
+  }
+
+  if (dbupdate->watchscan) {
+    logMsg (LOG_DBG, LOG_IMPORTANT, "watch: scan music folder");
+    /* the scan will find any changed files */
+    slistFree (dbupdate->watchlist);
+    dbupdate->watchlist = slistAlloc ("dbup-watch", LIST_ORDERED, NULL);
+    dbupdate->seencount = dbCount (dbupdate->musicdb);
+    dbupdate->seen = mdmalloc (sizeof (bool) * (dbupdate->seencount + 1));
+    for (dbidx_t i = 0; i < dbupdate->seencount; ++i) {
+      dbupdate->seen [i] = false;
+    }
+    mstimeset (&dbupdate->watchscantm, WATCH_SCAN_INTERVAL);
+  }
+
+  dbStartBatch (dbupdate->musicdb);
+  dbupdate->state = DB_UPD_PREP;
+}
+
+static void
+dbupdateWatchFinish (dbupdate_t *dbupdate)
+{
+  slistidx_t  iteridx;
+  const char  *fn;
+  song_t      *song;
+
+  if (dbupdate->watchscan) {
+    dbupdateFlagMissing (dbupdate);
+    audiosrcCleanIterator (dbupdate->asiter);
+    dbupdate->asiter = NULL;
+    dataFree (dbupdate->seen);
+    dbupdate->seen = NULL;
+    dbupdate->seencount = 0;
+    /* any number of entries may have changed */
+    dbupdate->watchdbchg = true;
+    dbupdate->watchscan = false;
+  }
+
+  dbEndBatch (dbupdate->musicdb);
+
+  /* new entries are not in the loaded database */
+  if (dbupdate->counts [C_NEW] > 0 || dbupdate->counts [C_RENAMED] > 0) {
+    dbupdate->watchdbchg = true;
+  }
+
+  slistStartIterator (dbupdate->watchlist, &iteridx);
+  while ((fn = slistIterateKey (dbupdate->watchlist, &iteridx)) != NULL) {
+    dbidx_t   dbidx;
+
+    song = dbGetByName (dbupdate->musicdb, audiosrcRelativePath (fn, 0));
+    if (song == NULL) {
+      continue;
+    }
+    dbidx = songGetNum (song, TAG_DBIDX);
+    dbLoadEntry (dbupdate->musicdb, dbidx);
+    nlistSetNum (dbupdate->watchupd, dbidx, 1);
+  }
+  slistFree (dbupdate->watchlist);
+  dbupdate->watchlist = slistAlloc ("dbup-watch", LIST_ORDERED, NULL);
+
+  logMsg (LOG_DBG, LOG_IMPORTANT, "watch: finish: %" PRId64 " ms new: %" PRId32 " updated: %" PRId32,
+      (int64_t) mstimeend (&dbupdate->starttm),
+      dbupdate->counts [C_NEW], dbupdate->counts [C_UPDATED]);
+  dbupdateWatchNotify (dbupdate);
+}
+
+/* let the other processes know about the changed entries */
+static void
+dbupdateWatchNotify (dbupdate_t *dbupdate)
+{
+  nlistidx_t  iteridx;
+  dbidx_t     dbidx;
+  char        tmp [40];
+
+  if (dbupdate->watchdbchg) {
+    int64_t   serial;
+
+    /* new entries are not in the loaded database */
+    serial = dbSaveChangeList (dbupdate->musicdb);
+    snprintf (tmp, sizeof (tmp), "%" PRId64, serial);
+    if (serial == 0 || ! dbApplyChangeList (dbupdate->musicdb, tmp)) {
+      dbupdate->musicdb = bdj4ReloadDatabase (dbupdate->musicdb);
+      songdbSetMusicDB (dbupdate->songdb, dbupdate->musicdb);
+      dbStartChangeList (dbupdate->musicdb);
+    }
+    connSendMessage (dbupdate->conn, ROUTE_STARTERUI, MSG_DATABASE_UPDATE,
+        serial > 0 ? tmp : NULL);
+  } else {
+    nlistStartIterator (dbupdate->watchupd, &iteridx);
+    while ((dbidx = nlistIterateKey (dbupdate->watchupd, &iteridx)) >= 0) {
+      snprintf (tmp, sizeof (tmp), "%" PRId32, dbidx);
+      connSendMessage (dbupdate->conn, ROUTE_STARTERUI, MSG_DB_ENTRY_UPDATE, tmp);
+    }
+  }
+
+  if (nlistGetCount (dbupdate->watchupd) > 0) {
+    nlistFree (dbupdate->watchupd);
+    dbupdate->watchupd = nlistAlloc ("dbup-watch-upd", LIST_ORDERED, NULL);
+    /* the changed entries have been sent individually */
+    if (! dbupdate->watchdbchg) {
+      dbStartChangeList (dbupdate->musicdb);
+    }
+  }
+  dbupdate->watchdbchg = false;
+}
+
+/* returns the database entries for the path */
+/* for a directory, all of the entries within the directory */
+static nlist_t *
+dbupdateWatchFind (dbupdate_t *dbupdate, const char *path, bool isdir)
+{
+  nlist_t     *dblist;
+  const char  *relfn;
+  song_t      *song;
+  dbidx_t     dbidx;
+  slistidx_t  dbiteridx;
+  size_t      len;
+
+  dblist = nlistAlloc ("dbup-watch-find", LIST_ORDERED, NULL);
+  relfn = audiosrcRelativePath (path, 0);
+
+  if (! isdir) {
+    song = dbGetByName (dbupdate->musicdb, relfn);
+    if (song != NULL) {
+      nlistSetNum (dblist, songGetNum (song, TAG_DBIDX), 1);
+    }
+    return dblist;
+  }
+
+  len = strlen (relfn);
+  dbStartIterator (dbupdate->musicdb, &dbiteridx);
+  while ((song = dbIterate (dbupdate->musicdb, &dbidx, &dbiteridx)) != NULL) {
+    const char  *uri;
+
+    uri = songGetStr (song, TAG_URI);
+    if (strncmp (uri, relfn, len) == 0 && uri [len] == '/') {
+      nlistSetNum (dblist, dbidx, 1);
+    }
+  }
+
+  return dblist;
+}
+
+static void
+dbupdateWatchRemove (dbupdate_t *dbupdate, const char *path, bool isdir)
+{
+  nlist_t     *dblist;
+  nlistidx_t  iteridx;
+  dbidx_t     dbidx;
+
+  dblist = dbupdateWatchFind (dbupdate, path, isdir);
+  nlistStartIterator (dblist, &iteridx);
+  while ((dbidx = nlistIterateKey (dblist, &iteridx)) >= 0) {
+    song_t    *song;
+
+    dbLoadEntry (dbupdate->musicdb, dbidx);
+    song = dbGetByIdx (dbupdate->musicdb, dbidx);
+    if (song == NULL || songGetNum (song, TAG_FILE_MISSING) == true) {
+      continue;
+    }
+    logMsg (LOG_DBG, LOG_DBUPDATE, "  missing: %s", songGetStr (song, TAG_URI));
+    songSetNum (song, TAG_FILE_MISSING, true);
+    /* the audio files are not being modified, using dbWriteSong() */
+    /* here is ok */
+    dbWriteSong (dbupdate->musicdb, song);
+    nlistSetNum (dbupdate->watchupd, dbidx, 1);
+  }
+  nlistFree (dblist);
+}
+
+/* the database entries are renamed, the audio files are not re-parsed */
+static void
+dbupdateWatchRename (dbupdate_t *dbupdate, const char *oldpath,
+    const char *path, bool isdir)
+{
+  nlist_t     *dblist;
+  nlistidx_t  iteridx;
+  dbidx_t     dbidx;
+  const char  *newrel;
+  size_t      oldlen;
+
+  dblist = dbupdateWatchFind (dbupdate, oldpath, isdir);
+  if (! isdir) {
+    /* the renamed file may have been changed also */
+    /* the file information is checked, it is only re-parsed if changed */
+    slistSetNum (dbupdate->watchlist, path, 0);
+  }
+
+  oldlen = strlen (audiosrcRelativePath (oldpath, 0));
+  newrel = audiosrcRelativePath (path, 0);
+
+  nlistStartIterator (dblist, &iteridx);
+  while ((dbidx = nlistIterateKey (dblist, &iteridx)) >= 0) {
+    song_t    *song;
+    char      *olduri;
+    char      newuri [MAXPATHLEN];
+
+    dbLoadEntry (dbupdate->musicdb, dbidx);
+    song = dbGetByIdx (dbupdate->musicdb, dbidx);
+    if (song == NULL) {
+      continue;
+    }
+
+    olduri = mdstrdup (songGetStr (song, TAG_URI));
+    snprintf (newuri, sizeof (newuri), "%s%s", newrel, olduri + oldlen);
+    logMsg (LOG_DBG, LOG_DBUPDATE, "  rename: %s %s", olduri, newuri);
+    songSetStr (song, TAG_URI, newuri);
+    /* the audio files are not being modified, using dbWriteSong() */
+    /* here is ok */
+    dbWriteSong (dbupdate->musicdb, song);
+    dbMarkEntryRenamed (dbupdate->musicdb, olduri, newuri, dbidx);
+    mdfree (olduri);
+    /* the other processes must reload the names */
+    dbupdate->watchdbchg = true;
+  }
+  nlistFree (dblist);
+}
@@ -61,6 +61,7 @@
 #include "songutil.h"
 #include "sysvars.h"
 #include "tagdef.h"
+#include "tagwriter.h"
 #include "tmutil.h"
 #include "ui.h"
 #include "uiapplyadj.h"
@@ -160,6 +161,8 @@ enum {
   MANAGE_CB_CFPL_DIALOG,
   MANAGE_CB_ITUNES_DIALOG,
   MANAGE_CB_APPLY_ADJ,
+  MANAGE_CB_AA_SONG,
+  MANAGE_CB_AA_CANCEL,
   MANAGE_CB_SL_SEL_FILE,
   MANAGE_CB_BDJ4_EXP,
   MANAGE_CB_BDJ4_IMP,
@@ -216,6 +219,8 @@ typedef struct {
   musicdb_t         *musicdb;
   grouping_t        *grouping;
   songdb_t          *songdb;
+  tagwriter_t       *tagwriter;
+  int32_t           tagwriteerrcount;
   samesong_t        *samesong;
   musicqidx_t       musicqPlayIdx;
   musicqidx_t       musicqManageIdx;
@@ -261,6 +266,8 @@ typedef struct {
   int               editmode;
   int               lastinsertlocation;
   mp_musicqupdate_t *musicqupdate [MUSICQ_MAX];
+  /* the parts of the music queue data received so far */
+  mp_musicqupdate_t *musicqpending [MUSICQ_MAX];
   /* sequence */
   manageseq_t       *manageseq;
   /* playlist management */
@@ -277,6 +284,10 @@ typedef struct {
   uiaa_t            *uiaa;
   int               aaflags;
   int               applyadjstate;
+  aabatch_t         *aabatch;
+  mstime_t          aaChkTime;
+  bool              aachanged;
+  bool              aaapplyall;
   int               impitunesstate;
   /* export playlist */
   uiexppl_t         *uiexppl;
@@ -289,6 +300,8 @@ typedef struct {
   datafile_t        *optiondf;
   /* remove song */
   nlist_t           *removelist;
+  /* the songs saved during an edit-all apply */
+  nlist_t           *editallsaved;
   /* various flags */
   bool              bpmcounterstarted : 1;
   bool              cfplactive : 1;
@@ -300,6 +313,7 @@ typedef struct {
   bool              importbdj4active : 1;
   bool              importitunesactive : 1;
   bool              ineditall : 1;
+  bool              ineditallapply : 1;
   bool              inload : 1;
   bool              musicqueueprocessflag : 1;
   bool              musicqupdated : 1;
@@ -370,7 +384,11 @@ static void     manageSetEditMenuItems (manageui_t *manage);
 static bool     manageTrimSilence (void *udata);
 static bool     manageApplyAdjDialog (void *udata);
 static bool     manageApplyAdjCallback (void *udata, int32_t aaflags);
+static bool     manageApplyAdjCancel (void *udata);
 static bool     manageRestoreOrigCallback (void *udata);
+static bool     manageApplyAdjSongFinished (void *udata, int32_t dbidx, int32_t changed);
+static nlist_t  *manageApplyAdjSelection (manageui_t *manage);
+static void     manageApplyAdjStart (manageui_t *manage);
 static bool     manageCopyTagsStart (void *udata);
 static bool     manageEditAllStart (void *udata);
 static bool     manageEditAllApply (void *udata);
@@ -417,6 +435,7 @@ static bool     manageQueueProcessSonglist (void *udata, int32_t dbidx);
 static bool     manageQueueProcessSBSSongList (void *udata, int32_t dbidx);
 static void     manageQueueProcess (void *udata, dbidx_t dbidx, int mqidx, int dispsel, int action);
 static nlistidx_t manageLoadMusicQueue (manageui_t *manage, int mqidx);
+static void     manageProcessMusicQueueData (manageui_t *manage, musicqidx_t mqidx);
 /* playlist */
 static bool     managePlaylistExport (void *udata);
 static bool     managePlaylistImport (void *udata);
@@ -434,7 +453,8 @@ static void     manageSwitchPage (manageui_t *manage, int pagenum, int which);
 static void     manageSetDisplayPerSelection (manageui_t *manage, int lastmaintab);
 static void     manageSetMenuCallback (manageui_t *manage, int midx, callbackFunc cb);
 static void     manageSonglistLoadCheck (manageui_t *manage);
-static void     manageProcessDatabaseUpdate (manageui_t *manage);
+static void     manageProcessDatabaseUpdate (manageui_t *manage, const char *serial);
+static void     manageReloadDatabase (manageui_t *manage, const char *serial);
 static uimusicq_t * manageGetCurrMusicQ (manageui_t *manage);
 /* bpm counter */
 static bool     manageStartBPMCounter (void *udata);
@@ -535,11 +555,15 @@ main (int argc, char *argv[])
   manage.importbdj4active = false;
   manage.importitunesactive = false;
   manage.ineditall = false;
+  manage.ineditallapply = false;
   manage.musicqueueprocessflag = false;
   manage.musicqupdated = false;
   manage.pluiActive = false;
   manage.sbssonglist = true;
   manage.applyadjstate = BDJ4_STATE_OFF;
+  manage.aabatch = NULL;
+  manage.aachanged = false;
+  manage.aaapplyall = false;
   manage.impitunesstate = BDJ4_STATE_OFF;
   manage.uict = NULL;
   manage.ctstate = BDJ4_STATE_OFF;
@@ -549,8 +573,10 @@ main (int argc, char *argv[])
   }
   for (int i = 0; i < MUSICQ_MAX; ++i) {
     manage.musicqupdate [i] = NULL;
+    manage.musicqpending [i] = NULL;
   }
   manage.removelist = nlistAlloc ("remove-list", LIST_ORDERED, NULL);
+  manage.editallsaved = NULL;
 
   /* CONTEXT: management ui: please wait... status message */
   manage.minfo.pleasewaitmsg = _("Please wait\xe2\x80\xa6");
@@ -565,6 +591,11 @@ main (int argc, char *argv[])
   manage.grouping = groupingAlloc (manage.musicdb);
 
   manage.songdb = songdbAlloc (manage.musicdb);
+  /* the audio tags are written in the background, so that the user */
+  /* may continue to work while a large edit-all is processed */
+  manage.tagwriter = tagwriterAlloc ();
+  manage.tagwriteerrcount = 0;
+  songdbSetTagWriter (manage.songdb, manage.tagwriter);
   manage.minfo.dispsel = dispselAlloc (DISP_SEL_LOAD_MANAGE);
 
   listenPort = bdjvarsGetNum (BDJVL_PORT_MANAGEUI);
@@ -705,6 +736,7 @@ manageClosingCallback (void *udata, programstate_t programState)
 
   for (int i = 0; i < MUSICQ_MAX; ++i) {
     msgparseMusicQueueDataFree (manage->musicqupdate [i]);
+    msgparseMusicQueueDataFree (manage->musicqpending [i]);
   }
   for (int i = 0; i < MANAGE_W_MAX; ++i) {
     if (i == MANAGE_W_SL_MUSICQ_TAB ||
@@ -719,6 +751,8 @@ manageClosingCallback (void *udata, programstate_t programState)
   samesongFree (manage->samesong);
   uicopytagsFree (manage->uict);
   uiaaFree (manage->uiaa);
+  /* any songs not yet processed are skipped */
+  aaBatchFree (manage->aabatch);
   uieibdj4Free (manage->uieibdj4);
   eibdj4Free (manage->eibdj4);
   uiexpplFree (manage->uiexppl);
@@ -730,6 +764,9 @@ manageClosingCallback (void *udata, programstate_t programState)
   datafileSave (manage->optiondf, NULL, manage->minfo.options, DF_NO_OFFSET, 1);
 
   groupingFree (manage->grouping);
+  /* any pending tag writes are completed */
+  tagwriterFree (manage->tagwriter);
+  songdbSetTagWriter (manage->songdb, NULL);
   bdj4shutdown (ROUTE_MANAGEUI, manage->musicdb);
   manageSequenceFree (manage->manageseq);
   managePlaylistFree (manage->managepl);
@@ -1184,7 +1221,7 @@ manageMainLoop (void *tmanage)
 
     if (eibdj4Process (manage->eibdj4)) {
       if (eibdj4DatabaseChanged (manage->eibdj4)) {
-        manageProcessDatabaseUpdate (manage);
+        manageProcessDatabaseUpdate (manage, NULL);
       }
       uiutilsProgressStatus (manage->minfo.statusMsg, -1, -1);
       uieibdj4UpdateStatus (manage->uieibdj4, -1, -1);
@@ -1205,6 +1242,26 @@ manageMainLoop (void *tmanage)
   manageDbProcess (manage->managedb);
   uicopytagsProcess (manage->uict);
 
+  if (tagwriterProcess (manage->tagwriter) > 0) {
+    slist_t     *errors;
+    int32_t     errcount;
+
+    /* the error list is cumulative, the files are listed in the log */
+    errors = tagwriterGetErrors (manage->tagwriter);
+    errcount = slistGetCount (errors);
+    if (errcount != manage->tagwriteerrcount) {
+      char    tbuff [200];
+
+      logMsg (LOG_DBG, LOG_IMPORTANT, "tag write failures: %" PRId32,
+          errcount);
+      /* CONTEXT: manage ui: status message: the number of audio files where the tags could not be written */
+      snprintf (tbuff, sizeof (tbuff), "%s : %" PRId32,
+          _("Unable to write tags"), errcount);
+      uiLabelSetText (manage->minfo.statusMsg, tbuff);
+      manage->tagwriteerrcount = errcount;
+    }
+  }
+
   /* copy tags processing */
 
   if (manage->ctstate == BDJ4_STATE_PROCESS) {
@@ -1265,26 +1322,32 @@ manageMainLoop (void *tmanage)
   /* apply adjustments processing */
 
   if (manage->applyadjstate == BDJ4_STATE_PROCESS) {
-    bool    changed = false;
-
-    changed = aaApplyAdjustments (manage->musicdb, manage->songeditdbidx, manage->aaflags);
-
-    if (changed) {
-      char    tmp [40];
+    if (mstimeCheck (&manage->aaChkTime)) {
+      int   count, tot;
 
-      manageRePopulateData (manage);
-      manageReloadSongData (manage);
+      aaBatchGetCount (manage->aabatch, &count, &tot);
+      if (tot > 1) {
+        uiutilsProgressStatus (manage->minfo.statusMsg, count, tot);
+      }
+      mstimeset (&manage->aaChkTime, 200);
+    }
 
-      snprintf (tmp, sizeof (tmp), "%" PRId32, manage->songeditdbidx);
-      connSendMessage (manage->conn, ROUTE_STARTERUI, MSG_DB_ENTRY_UPDATE, tmp);
+    if (aaBatchProcess (manage->aabatch)) {
+      aaBatchFree (manage->aabatch);
+      manage->aabatch = NULL;
+      if (manage->aachanged) {
+        manageRePopulateData (manage);
+      }
+      uiutilsProgressStatus (manage->minfo.statusMsg, -1, -1);
+      uiLabelSetText (manage->minfo.statusMsg, "");
+      uiaaDialogClear (manage->uiaa);
+      manage->applyadjstate = BDJ4_STATE_OFF;
     }
-    uiLabelSetText (manage->minfo.statusMsg, "");
-    uiaaDialogClear (manage->uiaa);
-    manage->applyadjstate = BDJ4_STATE_OFF;
   }
 
   if (manage->applyadjstate == BDJ4_STATE_START) {
     uiLabelSetText (manage->minfo.statusMsg, manage->minfo.pleasewaitmsg);
+    manageApplyAdjStart (manage);
     manage->applyadjstate = BDJ4_STATE_PROCESS;
   }
 
@@ -1474,36 +1537,55 @@ manageProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
 
           /* the database has been updated, tell the other processes to */
           /* reload it, and reload it ourselves */
-          manageProcessDatabaseUpdate (manage);
+          /* args: the change list serial number */
+          manageProcessDatabaseUpdate (manage, args);
           manageDbResetButtons (manage->managedb);
           break;
         }
         case MSG_MUSIC_QUEUE_DATA: {
-          mp_musicqupdate_t   *musicqupdate;
-          nlistidx_t          newcount = 0;
+          int     mqidx;
+          int     rc;
+          char    tmp [40];
 
-          musicqupdate = msgparseMusicQueueData (args);
-          if (musicqupdate == NULL) {
+          mqidx = atoi (args);
+          if (mqidx < 0 || mqidx >= MUSICQ_MAX) {
             break;
           }
 
-          msgparseMusicQueueDataFree (manage->musicqupdate [musicqupdate->mqidx]);
-          manage->musicqupdate [musicqupdate->mqidx] = musicqupdate;
-          if (musicqupdate->mqidx == manage->musicqManageIdx) {
-            uimusicqSetMusicQueueData (manage->slmusicq, musicqupdate);
-            uimusicqSetMusicQueueData (manage->slsbsmusicq, musicqupdate);
-            newcount = manageLoadMusicQueue (manage, musicqupdate->mqidx);
-            manageStatsProcessData (manage->slstats, musicqupdate);
-
-            /* the music queue data is used to display the mark */
-            /* indicating that the song is already in the song list */
-            uisongselProcessMusicQueueData (manage->slsbssongsel, musicqupdate);
-            uisongselProcessMusicQueueData (manage->slsongsel, musicqupdate);
+          rc = msgparseMusicQueueData (&manage->musicqpending [mqidx], args);
+          if (rc == MSGPARSE_MQ_PARTIAL) {
+            break;
           }
-          if (newcount > 0) {
-            manage->musicqupdated = true;
+          if (rc == MSGPARSE_MQ_RESYNC) {
+            logMsg (LOG_DBG, LOG_INFO, "music queue %d data: resync", mqidx);
+            snprintf (tmp, sizeof (tmp), "%d", mqidx);
+            connSendMessage (manage->conn, ROUTE_MAIN, MSG_MUSICQ_DATA_RESYNC, tmp);
+            break;
           }
-          manage->musicqueueprocessflag = true;
+
+          msgparseMusicQueueDataFree (manage->musicqupdate [mqidx]);
+          manage->musicqupdate [mqidx] = manage->musicqpending [mqidx];
+          manage->musicqpending [mqidx] = NULL;
+          manageProcessMusicQueueData (manage, mqidx);
+          break;
+        }
+        case MSG_MUSIC_QUEUE_DELTA: {
+          int     mqidx;
+          char    tmp [40];
+
+          mqidx = atoi (args);
+          if (mqidx < 0 || mqidx >= MUSICQ_MAX) {
+            break;
+          }
+
+          if (msgparseMusicQueueDelta (manage->musicqupdate [mqidx], args) ==
+              MSGPARSE_MQ_RESYNC) {
+            logMsg (LOG_DBG, LOG_INFO, "music queue %d delta: resync", mqidx);
+            snprintf (tmp, sizeof (tmp), "%d", mqidx);
+            connSendMessage (manage->conn, ROUTE_MAIN, MSG_MUSICQ_DATA_RESYNC, tmp);
+            break;
+          }
+          manageProcessMusicQueueData (manage, mqidx);
           break;
         }
         case MSG_SONG_SELECT: {
@@ -1535,6 +1617,11 @@ manageProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           }
           break;
         }
+        case MSG_DATABASE_UPDATE: {
+          /* the music folder watcher has changed the database */
+          manageReloadDatabase (manage, args);
+          break;
+        }
         case MSG_DB_ENTRY_UPDATE: {
           dbLoadEntry (manage->musicdb, atol (args));
           manageRePopulateData (manage);
@@ -1839,7 +1926,8 @@ manageSongEditSaveCallback (void *udata, int32_t dbidx)
 
   logProcBegin ();
 
-  if (manage->dbchangecount > MANAGE_DB_COUNT_SAVE) {
+  if (! manage->ineditallapply &&
+      manage->dbchangecount > MANAGE_DB_COUNT_SAVE) {
     dbBackup ();
     manage->dbchangecount = 0;
   }
@@ -1847,6 +1935,17 @@ manageSongEditSaveCallback (void *udata, int32_t dbidx)
   /* this fetches the song from in-memory, which has already been updated */
   songdbWriteDB (manage->songdb, dbidx);
 
+  ++manage->dbchangecount;
+
+  if (manage->ineditallapply) {
+    /* the database batch has not been written yet, the other */
+    /* processes and the display are updated once the edit-all */
+    /* is finished */
+    nlistSetNum (manage->editallsaved, dbidx, 1);
+    logProcEnd ("edit-all");
+    return UICB_CONT;
+  }
+
   /* the database has been updated, tell the other processes to reload  */
   /* this particular entry */
   snprintf (tmp, sizeof (tmp), "%" PRId32, dbidx);
@@ -1863,8 +1962,6 @@ manageSongEditSaveCallback (void *udata, int32_t dbidx)
   manage->songeditdbidx = dbidx;
   manageReloadSongData (manage);
 
-  ++manage->dbchangecount;
-
   logProcEnd ("");
   return UICB_CONT;
 }
@@ -1939,6 +2036,8 @@ manageApplyAdjDialog (void *udata)
   bool          rc;
   bool          hasorig;
   song_t        *song;
+  nlist_t       *sellist;
+  int           selcount;
 
   if (manage->songeditdbidx < 0) {
     return UICB_STOP;
@@ -1946,7 +2045,11 @@ manageApplyAdjDialog (void *udata)
 
   song = dbGetByIdx (manage->musicdb, manage->songeditdbidx);
   hasorig = audiosrcOriginalExists (songGetStr (song, TAG_URI));
-  rc = uiaaDialog (manage->uiaa, songGetNum (song, TAG_ADJUSTFLAGS), hasorig);
+  sellist = manageApplyAdjSelection (manage);
+  selcount = nlistGetCount (sellist);
+  nlistFree (sellist);
+  rc = uiaaDialog (manage->uiaa, songGetNum (song, TAG_ADJUSTFLAGS),
+      hasorig, selcount);
   return rc;
 }
 
@@ -1959,12 +2062,35 @@ manageApplyAdjCallback (void *udata, int32_t aaflags)
     return UICB_STOP;
   }
 
+  if (manage->applyadjstate != BDJ4_STATE_OFF) {
+    return UICB_STOP;
+  }
+
   manage->aaflags = aaflags;
+  manage->aaapplyall = uiaaApplyAll (manage->uiaa);
   manage->applyadjstate = BDJ4_STATE_START;
 
   return UICB_CONT;
 }
 
+static bool
+manageApplyAdjCancel (void *udata)
+{
+  manageui_t  *manage = udata;
+
+  if (manage->applyadjstate == BDJ4_STATE_START) {
+    uiLabelSetText (manage->minfo.statusMsg, "");
+    uiaaDialogClear (manage->uiaa);
+    manage->applyadjstate = BDJ4_STATE_OFF;
+  }
+  if (manage->applyadjstate == BDJ4_STATE_PROCESS) {
+    /* the batch finishes in the main loop once the conversions stop */
+    aaBatchCancel (manage->aabatch);
+  }
+
+  return UICB_CONT;
+}
+
 static bool
 manageRestoreOrigCallback (void *udata)
 {
@@ -1974,12 +2100,81 @@ manageRestoreOrigCallback (void *udata)
     return UICB_STOP;
   }
 
+  if (manage->applyadjstate != BDJ4_STATE_OFF) {
+    return UICB_STOP;
+  }
+
   manage->aaflags = SONG_ADJUST_RESTORE;
+  /* there is no confirmation, only the song being edited is restored */
+  manage->aaapplyall = false;
   manage->applyadjstate = BDJ4_STATE_START;
 
   return UICB_CONT;
 }
 
+/* called as each song is finished */
+static bool
+manageApplyAdjSongFinished (void *udata, int32_t dbidx, int32_t changed)
+{
+  manageui_t    *manage = udata;
+  char          tmp [40];
+
+  if (! changed) {
+    return UICB_CONT;
+  }
+
+  manage->aachanged = true;
+  if (dbidx == manage->songeditdbidx) {
+    manageReloadSongData (manage);
+  }
+  snprintf (tmp, sizeof (tmp), "%" PRId32, dbidx);
+  connSendMessage (manage->conn, ROUTE_STARTERUI, MSG_DB_ENTRY_UPDATE, tmp);
+
+  return UICB_CONT;
+}
+
+/* if the song being edited is one of the selected songs in the */
+/* music manager, the adjustments may be applied to all of the selected songs */
+static nlist_t *
+manageApplyAdjSelection (manageui_t *manage)
+{
+  nlist_t     *sellist;
+
+  sellist = uisongselGetSelectedList (manage->mmsongsel);
+  if (nlistGetCount (sellist) <= 1 ||
+      nlistGetNum (sellist, manage->songeditdbidx) == LIST_VALUE_INVALID) {
+    nlistFree (sellist);
+    sellist = nlistAlloc ("aa-sel", LIST_ORDERED, NULL);
+    nlistSetNum (sellist, manage->songeditdbidx, 0);
+  }
+
+  return sellist;
+}
+
+/* the selected songs are only changed if the user confirmed it */
+static void
+manageApplyAdjStart (manageui_t *manage)
+{
+  nlist_t     *sellist;
+
+  if (manage->aaapplyall) {
+    sellist = manageApplyAdjSelection (manage);
+  } else {
+    sellist = nlistAlloc ("aa-sel", LIST_ORDERED, NULL);
+    nlistSetNum (sellist, manage->songeditdbidx, 0);
+  }
+
+  if (manage->callbacks [MANAGE_CB_AA_SONG] == NULL) {
+    manage->callbacks [MANAGE_CB_AA_SONG] = callbackInitII (
+        manageApplyAdjSongFinished, manage);
+  }
+  manage->aachanged = false;
+  manage->aabatch = aaBatchAlloc (manage->musicdb, sellist,
+      manage->aaflags, manage->callbacks [MANAGE_CB_AA_SONG]);
+  aaBatchSetTagWriter (manage->aabatch, manage->tagwriter);
+  mstimeset (&manage->aaChkTime, 200);
+}
+
 static bool
 manageCopyTagsStart (void *udata)
 {
@@ -2011,14 +2206,38 @@ static bool
 manageEditAllApply (void *udata)
 {
   manageui_t  *manage = udata;
+  nlistidx_t  iteridx;
+  dbidx_t     dbidx;
 
   if (! manage->ineditall) {
     return UICB_STOP;
   }
+  /* the database changes are written as a single batch */
+  manage->editallsaved = nlistAlloc ("editall-saved", LIST_ORDERED, NULL);
+  manage->ineditallapply = true;
+  dbStartBatch (manage->musicdb);
   uisongeditEditAllApply (manage->mmsongedit);
+  dbEndBatch (manage->musicdb);
+  manage->ineditallapply = false;
+
+  /* now that the database has been written, */
+  /* tell the other processes to reload the changed entries */
+  nlistStartIterator (manage->editallsaved, &iteridx);
+  while ((dbidx = nlistIterateKey (manage->editallsaved, &iteridx)) >= 0) {
+    char    tmp [40];
+
+    snprintf (tmp, sizeof (tmp), "%" PRId32, dbidx);
+    connSendMessage (manage->conn, ROUTE_STARTERUI, MSG_DB_ENTRY_UPDATE, tmp);
+  }
+  nlistFree (manage->editallsaved);
+  manage->editallsaved = NULL;
   uisongeditEditAllSetFields (manage->mmsongedit, UISONGEDIT_EDITALL_OFF);
   manage->ineditall = false;
 
+  manageRePopulateData (manage);
+  groupingRebuild (manage->grouping, manage->musicdb);
+  manageReloadSongData (manage);
+
   return UICB_CONT;
 }
 
@@ -2313,10 +2532,14 @@ manageBuildUIMusicManager (manageui_t *manage)
   /* music manager: song editor tab */
 
   manage->uict = uicopytagsInit (manage->minfo.window, manage->minfo.options);
+  uicopytagsSetTagWriter (manage->uict, manage->tagwriter);
   manage->uiaa = uiaaInit (manage->minfo.window, manage->minfo.options);
   manage->callbacks [MANAGE_CB_APPLY_ADJ] = callbackInitI (
       manageApplyAdjCallback, manage);
   uiaaSetResponseCallback (manage->uiaa, manage->callbacks [MANAGE_CB_APPLY_ADJ]);
+  manage->callbacks [MANAGE_CB_AA_CANCEL] = callbackInit (
+      manageApplyAdjCancel, manage, NULL);
+  uiaaSetCancelCallback (manage->uiaa, manage->callbacks [MANAGE_CB_AA_CANCEL]);
 
   uip = uisongeditBuildUI (manage->mmsongsel, manage->mmsongedit, manage->minfo.window, manage->minfo.errorMsg);
   /* CONTEXT: manage-ui: name of song editor notebook tab */
@@ -3300,6 +3523,30 @@ manageLoadMusicQueue (manageui_t *manage, int mqidx)
   return newcount;
 }
 
+static void
+manageProcessMusicQueueData (manageui_t *manage, musicqidx_t mqidx)
+{
+  mp_musicqupdate_t   *musicqupdate;
+  nlistidx_t          newcount = 0;
+
+  musicqupdate = manage->musicqupdate [mqidx];
+  if (mqidx == manage->musicqManageIdx) {
+    uimusicqSetMusicQueueData (manage->slmusicq, musicqupdate);
+    uimusicqSetMusicQueueData (manage->slsbsmusicq, musicqupdate);
+    newcount = manageLoadMusicQueue (manage, mqidx);
+    manageStatsProcessData (manage->slstats, musicqupdate);
+
+    /* the music queue data is used to display the mark */
+    /* indicating that the song is already in the song list */
+    uisongselProcessMusicQueueData (manage->slsbssongsel, musicqupdate);
+    uisongselProcessMusicQueueData (manage->slsongsel, musicqupdate);
+  }
+  if (newcount > 0) {
+    manage->musicqupdated = true;
+  }
+  manage->musicqueueprocessflag = true;
+}
+
 /* export and import (m3u, xspf, jspf) */
 
 static bool
@@ -3872,29 +4119,53 @@ manageSonglistLoadCheck (manageui_t *manage)
 }
 
 static void
-manageProcessDatabaseUpdate (manageui_t *manage)
+manageProcessDatabaseUpdate (manageui_t *manage, const char *serial)
+{
+  manageReloadDatabase (manage, serial);
+  connSendMessage (manage->conn, ROUTE_STARTERUI, MSG_DATABASE_UPDATE, serial);
+}
+
+static void
+manageReloadDatabase (manageui_t *manage, const char *serial)
 {
+  bool    reloaded = false;
+
   samesongFree (manage->samesong);
-  manage->musicdb = bdj4ReloadDatabase (manage->musicdb);
+  /* if the change list cannot be applied in place, */
+  /* the entire database is re-loaded */
+  if (! dbApplyChangeList (manage->musicdb, serial)) {
+    manage->musicdb = bdj4ReloadDatabase (manage->musicdb);
+    reloaded = true;
+  }
   manage->samesong = samesongAlloc (manage->musicdb);
 
-  manageStatsSetDatabase (manage->slstats, manage->musicdb);
-  uiplayerSetDatabase (manage->slplayer, manage->musicdb);
-  uiplayerSetDatabase (manage->mmplayer, manage->musicdb);
-  uisongselSetDatabase (manage->slsongsel, manage->musicdb);
+  if (reloaded) {
+    manageStatsSetDatabase (manage->slstats, manage->musicdb);
+    uiplayerSetDatabase (manage->slplayer, manage->musicdb);
+    uiplayerSetDatabase (manage->mmplayer, manage->musicdb);
+    uisongselSetDatabase (manage->slsongsel, manage->musicdb);
+    uisongselSetDatabase (manage->slsbssongsel, manage->musicdb);
+    uisongselSetDatabase (manage->mmsongsel, manage->musicdb);
+    uimusicqSetDatabase (manage->slmusicq, manage->musicdb);
+    uimusicqSetDatabase (manage->slsbsmusicq, manage->musicdb);
+    uisongeditSetDatabase (manage->mmsongedit, manage->musicdb);
+    songdbSetMusicDB (manage->songdb, manage->musicdb);
+  }
   uisongselSetSamesong (manage->slsongsel, manage->samesong);
-  uisongselSetDatabase (manage->slsbssongsel, manage->musicdb);
   uisongselSetSamesong (manage->slsbssongsel, manage->samesong);
-  uisongselSetDatabase (manage->mmsongsel, manage->musicdb);
   uisongselSetSamesong (manage->mmsongsel, manage->samesong);
-  uimusicqSetDatabase (manage->slmusicq, manage->musicdb);
-  uimusicqSetDatabase (manage->slsbsmusicq, manage->musicdb);
-  uisongeditSetDatabase (manage->mmsongedit, manage->musicdb);
-  songdbSetMusicDB (manage->songdb, manage->musicdb);
-
-  connSendMessage (manage->conn, ROUTE_STARTERUI, MSG_DATABASE_UPDATE, NULL);
+  groupingRebuild (manage->grouping, manage->musicdb);
 
   uisongselApplySongFilter (manage->slsongsel);
+  /* the song selection displays cache the song data */
+  manageRePopulateData (manage);
+
+  if (! reloaded) {
+    if (manage->maincurrtab == MANAGE_TAB_MAIN_MM &&
+        manage->mmcurrtab == MANAGE_TAB_SONGEDIT) {
+      manageReloadSongData (manage);
+    }
+  }
 }
 
 static uimusicq_t *
@@ -31,11 +31,14 @@
 
 enum {
   MANAGE_DB_CHECK_NEW,
+  MANAGE_DB_UPD_CHANGED,
   MANAGE_DB_COMPACT,
   MANAGE_DB_REORGANIZE,
   MANAGE_DB_UPD_FROM_TAGS,
   MANAGE_DB_WRITE_TAGS,
   MANAGE_DB_UPD_FROM_ITUNES,
+  MANAGE_DB_BPM_DETECT,
+  MANAGE_DB_LOUDNESS,
   MANAGE_DB_REBUILD,
 };
 
@@ -112,6 +115,12 @@ manageDbAlloc (manageinfo_t *minfo, conn_t *conn, procutil_t **processes)
       /* CONTEXT: database update: check for new: help text */
       _("Checks for new audio files."));
 
+  /* CONTEXT: database update: updates the database for audio files that have changed */
+  nlistSetStr (tlist, MANAGE_DB_UPD_CHANGED, _("Update Changed Files"));
+  nlistSetStr (hlist, MANAGE_DB_UPD_CHANGED,
+      /* CONTEXT: database update: update changed files: help text */
+      _("Checks for new audio files, updates the information for audio files that have been modified, and flags audio files that are missing."));
+
   /* CONTEXT: database update: check for new audio files */
   nlistSetStr (tlist, MANAGE_DB_COMPACT, _("Compact"));
   nlistSetStr (hlist, MANAGE_DB_COMPACT,
@@ -145,6 +154,18 @@ manageDbAlloc (manageinfo_t *minfo, conn_t *conn, procutil_t **processes)
       ITUNES_NAME);
   nlistSetStr (hlist, MANAGE_DB_UPD_FROM_ITUNES, tbuff);
 
+  /* CONTEXT: database update: detect the BPM of the audio files */
+  nlistSetStr (tlist, MANAGE_DB_BPM_DETECT, _("Detect BPM"));
+  nlistSetStr (hlist, MANAGE_DB_BPM_DETECT,
+      /* CONTEXT: database update: detect bpm: help text */
+      _("Analyzes the audio files that do not have a BPM set, and sets the BPM."));
+
+  /* CONTEXT: database update: measure the loudness of the audio files */
+  nlistSetStr (tlist, MANAGE_DB_LOUDNESS, _("Analyze Loudness"));
+  nlistSetStr (hlist, MANAGE_DB_LOUDNESS,
+      /* CONTEXT: database update: analyze loudness: help text */
+      _("Measures the loudness of the audio files, and sets the volume adjustment."));
+
   /* CONTEXT: database update: rebuilds the database */
   nlistSetStr (tlist, MANAGE_DB_REBUILD, _("Rebuild Database"));
   nlistSetStr (hlist, MANAGE_DB_REBUILD,
@@ -454,6 +475,10 @@ manageDbStart (void *udata)
       targv [targc++] = "--checknew";
       break;
     }
+    case MANAGE_DB_UPD_CHANGED: {
+      targv [targc++] = "--updchanged";
+      break;
+    }
     case MANAGE_DB_COMPACT: {
       managedb->compact = true;
       targv [targc++] = "--compact";
@@ -476,6 +501,14 @@ manageDbStart (void *udata)
       targv [targc++] = "--writetags";
       break;
     }
+    case MANAGE_DB_BPM_DETECT: {
+      targv [targc++] = "--bpmdetect";
+      break;
+    }
+    case MANAGE_DB_LOUDNESS: {
+      targv [targc++] = "--loudness";
+      break;
+    }
     case MANAGE_DB_REBUILD: {
       targv [targc++] = "--rebuild";
       break;
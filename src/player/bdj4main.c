@@ -110,6 +110,9 @@ typedef struct {
   int               songplaysentcount;        // for testsuite
   int               musicqChanged [MUSICQ_MAX];
   bool              changeSuspend [MUSICQ_MAX];
+  /* the last music queue data sent, used to build the deltas */
+  mp_musicqupdate_t *musicqSent [MUSICQ_MAX];
+  int32_t           musicqSeq [MUSICQ_MAX];
   time_t            stopTime [MUSICQ_MAX];
   time_t            nStopTime [MUSICQ_MAX];
   int32_t           lastGapSent;
@@ -132,6 +135,8 @@ static bool mainStoppingCallback (void *tmaindata, programstate_t programState);
 static bool mainStopWaitCallback (void *tmaindata, programstate_t programState);
 static bool mainClosingCallback (void *tmaindata, programstate_t programState);
 static void mainSendMusicQueueData (maindata_t *mainData, int musicqidx);
+static mp_musicqupdate_t *mainMusicQueueSnapshot (maindata_t *mainData, int musicqidx);
+static void mainMusicqResync (maindata_t *mainData, int mqidx);
 static void mainSendMarqueeData (maindata_t *mainData);
 static const char * mainSongGetDanceDisplay (maindata_t *mainData, int mqidx, int idx);
 static void mainQueueClear (maindata_t *mainData, char *args);
@@ -157,6 +162,7 @@ static void mainMusicqSendQueueConfig (maindata_t *mainData);
 static void mainMusicqSwitch (maindata_t *mainData, int newidx);
 static void mainPlaybackBegin (maindata_t *mainData);
 static void mainMusicQueuePlay (maindata_t *mainData);
+static void mainMusicQueuePreroll (maindata_t *mainData);
 static void mainMusicQueueFinish (maindata_t *mainData, const char *args);
 static void mainMusicQueueNext (maindata_t *mainData, const char *args);
 static ilistidx_t mainMusicQueueLookup (void *mainData, ilistidx_t idx);
@@ -242,6 +248,8 @@ main (int argc, char *argv[])
     mainData.playlistQueue [i] = NULL;
     mainData.musicqChanged [i] = MAIN_CHG_CLEAR;
     mainData.changeSuspend [i] = false;
+    mainData.musicqSent [i] = NULL;
+    mainData.musicqSeq [i] = 0;
     mainData.stopTime [i] = 0;
     mainData.nStopTime [i] = 0;
   }
@@ -333,6 +341,10 @@ mainClosingCallback (void *tmaindata, programstate_t programState)
     musicqFree (mainData->musicQueue);
     mainData->musicQueue = NULL;
   }
+  for (musicqidx_t i = 0; i < MUSICQ_MAX; ++i) {
+    msgparseMusicQueueDataFree (mainData->musicqSent [i]);
+    mainData->musicqSent [i] = NULL;
+  }
   slistFree (mainData->announceList);
   dataFree (mainData->mobmqUserkey);
   dispselFree (mainData->dispsel);
@@ -441,6 +453,10 @@ mainProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           }
           break;
         }
+        case MSG_PLAYBACK_PREROLL: {
+          mainMusicQueuePreroll (mainData);
+          break;
+        }
         case MSG_PLAYBACK_FINISH: {
           mainMusicQueueNext (mainData, args);
           if (mainData->waitforpbfinish) {
@@ -508,6 +524,10 @@ mainProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           mainMusicqSetSuspend (mainData, args, false);
           break;
         }
+        case MSG_MUSICQ_DATA_RESYNC: {
+          mainMusicqResync (mainData, atoi (args));
+          break;
+        }
         case MSG_PLAYER_ANN_FINISHED: {
           mainData->inannounce = false;
           break;
@@ -554,6 +574,12 @@ mainProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           break;
         }
         case MSG_DATABASE_UPDATE: {
+          /* args: change list serial */
+          if (dbApplyChangeList (mainData->musicdb, args)) {
+            groupingRebuild (mainData->grouping, mainData->musicdb);
+            mainSetMusicQueuesChanged (mainData);
+            break;
+          }
           mainData->musicdb = bdj4ReloadDatabase (mainData->musicdb);
           musicqSetDatabase (mainData->musicQueue, mainData->musicdb);
           mainSetMusicQueuesChanged (mainData);
@@ -898,33 +924,75 @@ mainStopMarquee (maindata_t *mainData)
 static void
 mainSendMusicQueueData (maindata_t *mainData, int musicqidx)
 {
-  char        tbuff [200];
-  char        *sbuff = NULL;
-  int         musicqLen;
-  slistidx_t  dbidx;
-  song_t      *song;
-  int         flags;
-  int         pauseind;
-  int         dispidx;
-  int32_t     uniqueidx;
-  int64_t     qDuration;
-  char        *p;
-  char        *end;
+  char              *sbuff = NULL;
+  bdjmsgroute_t     route;
+  mp_musicqupdate_t *musicqupdate;
+  bool              delta = false;
+  bool              final;
+  nlistidx_t        start;
 
 
   logProcBegin ();
 
-  musicqLen = musicqGetLen (mainData->musicQueue, musicqidx);
+  /* only the displayable queues need to be updated in the playerui */
+  /* only the song list and the internal playback queue need updating in */
+  /* the manageui */
+  route = ROUTE_PLAYERUI;
+  if (musicqidx >= MUSICQ_DISP_MAX) {
+    route = ROUTE_MANAGEUI;
+  }
+
+  if (! connHaveHandshake (mainData->conn, route)) {
+    /* the complete queue will be sent once the ui is connected */
+    msgparseMusicQueueDataFree (mainData->musicqSent [musicqidx]);
+    mainData->musicqSent [musicqidx] = NULL;
+    logProcEnd ("not-connected");
+    return;
+  }
 
-  qDuration = musicqGetDuration (mainData->musicQueue, musicqidx);
-  dbidx = musicqGetByIdx (mainData->musicQueue, musicqidx, 0);
+  musicqupdate = mainMusicQueueSnapshot (mainData, musicqidx);
+  ++mainData->musicqSeq [musicqidx];
+  musicqupdate->seq = mainData->musicqSeq [musicqidx];
 
   sbuff = mdmalloc (BDJMSG_MAX);
-  snprintf (sbuff, BDJMSG_MAX, "%d%c%" PRId64 "%c%" PRId32 "%c",
-      musicqidx, MSG_ARGS_RS, qDuration, MSG_ARGS_RS,
-      dbidx, MSG_ARGS_RS);
-  p = sbuff + strlen (sbuff);
-  end = sbuff + BDJMSG_MAX;
+  if (mainData->musicqSent [musicqidx] != NULL) {
+    delta = msgbuildMusicQueueDelta (sbuff, BDJMSG_MAX_ARGS,
+        mainData->musicqSent [musicqidx], musicqupdate);
+  }
+
+  if (delta) {
+    connSendMessage (mainData->conn, route, MSG_MUSIC_QUEUE_DELTA, sbuff);
+  } else {
+    /* a long music queue is sent in several parts */
+    start = 0;
+    do {
+      final = msgbuildMusicQueueData (sbuff, BDJMSG_MAX_ARGS,
+          musicqupdate, &start);
+      connSendMessage (mainData->conn, route, MSG_MUSIC_QUEUE_DATA, sbuff);
+    } while (! final);
+  }
+
+  msgparseMusicQueueDataFree (mainData->musicqSent [musicqidx]);
+  mainData->musicqSent [musicqidx] = musicqupdate;
+  dataFree (sbuff);
+  logProcEnd ("");
+}
+
+static mp_musicqupdate_t *
+mainMusicQueueSnapshot (maindata_t *mainData, int musicqidx)
+{
+  mp_musicqupdate_t *musicqupdate;
+  int               musicqLen;
+  dbidx_t           dbidx;
+  song_t            *song;
+  int               flags;
+  int               pauseind;
+
+  musicqupdate = msgparseMusicQueueAlloc (musicqidx);
+  musicqupdate->tottime = musicqGetDuration (mainData->musicQueue, musicqidx);
+  musicqupdate->currdbidx = musicqGetByIdx (mainData->musicQueue, musicqidx, 0);
+
+  musicqLen = musicqGetLen (mainData->musicQueue, musicqidx);
 
   /* main keeps the current song in queue position 0 */
   for (int i = 1; i < musicqLen; ++i) {
@@ -935,36 +1003,31 @@ mainSendMusicQueueData (maindata_t *mainData, int musicqidx)
       continue;
     }
 
-    dispidx = musicqGetDispIdx (mainData->musicQueue, musicqidx, i);
-    snprintf (tbuff, sizeof (tbuff), "%d%c", dispidx, MSG_ARGS_RS);
-    p = stpecpy (p, end, tbuff);
-    uniqueidx = musicqGetUniqueIdx (mainData->musicQueue, musicqidx, i);
-    snprintf (tbuff, sizeof (tbuff), "%" PRId32 "%c", uniqueidx, MSG_ARGS_RS);
-    p = stpecpy (p, end, tbuff);
-    snprintf (tbuff, sizeof (tbuff), "%" PRId32 "%c", dbidx, MSG_ARGS_RS);
-    p = stpecpy (p, end, tbuff);
     flags = musicqGetFlags (mainData->musicQueue, musicqidx, i);
     pauseind = false;
     if ((flags & MUSICQ_FLAG_PAUSE) == MUSICQ_FLAG_PAUSE) {
       pauseind = true;
     }
-    snprintf (tbuff, sizeof (tbuff), "%d%c", pauseind, MSG_ARGS_RS);
-    p = stpecpy (p, end, tbuff);
+    msgparseMusicQueueAppend (musicqupdate,
+        musicqGetDispIdx (mainData->musicQueue, musicqidx, i),
+        musicqGetUniqueIdx (mainData->musicQueue, musicqidx, i),
+        dbidx, pauseind);
   }
 
-  /* only the displayable queues need to be updated in the playerui */
-  if (musicqidx < MUSICQ_DISP_MAX &&
-      connHaveHandshake (mainData->conn, ROUTE_PLAYERUI)) {
-    connSendMessage (mainData->conn, ROUTE_PLAYERUI, MSG_MUSIC_QUEUE_DATA, sbuff);
-  }
-  /* only the song list and the internal playback queue need updating in */
-  /* the manageui */
-  if (musicqidx >= MUSICQ_DISP_MAX &&
-      connHaveHandshake (mainData->conn, ROUTE_MANAGEUI)) {
-    connSendMessage (mainData->conn, ROUTE_MANAGEUI, MSG_MUSIC_QUEUE_DATA, sbuff);
+  return musicqupdate;
+}
+
+/* the ui could not apply a delta, send the complete queue */
+static void
+mainMusicqResync (maindata_t *mainData, int mqidx)
+{
+  if (mqidx < 0 || mqidx >= MUSICQ_MAX) {
+    return;
   }
-  dataFree (sbuff);
-  logProcEnd ("");
+
+  msgparseMusicQueueDataFree (mainData->musicqSent [mqidx]);
+  mainData->musicqSent [mqidx] = NULL;
+  mainData->musicqChanged [mqidx] = MAIN_CHG_START;
 }
 
 static void
@@ -1977,6 +2040,9 @@ mainMusicqSendQueueConfig (maindata_t *mainData)
   snprintf (tmp, sizeof (tmp), "%" PRId64,
       (int64_t) bdjoptGetNumPerQueue (OPT_Q_FADEOUTTIME, mainData->musicqPlayIdx));
   connSendMessage (mainData->conn, ROUTE_PLAYER, MSG_SET_PLAYBACK_FADEOUT, tmp);
+  snprintf (tmp, sizeof (tmp), "%" PRId64,
+      (int64_t) bdjoptGetNumPerQueue (OPT_Q_XFADE, mainData->musicqPlayIdx));
+  connSendMessage (mainData->conn, ROUTE_PLAYER, MSG_SET_PLAYBACK_XFADE, tmp);
 }
 
 static void
@@ -2158,6 +2224,54 @@ mainMusicQueuePlay (maindata_t *mainData)
   logProcEnd ("");
 }
 
+/* the player is preparing a crossfade, and wants to know the song */
+/* that will be played after the current song.  the queue does not */
+/* change, the song will be played after the player's finish message */
+static void
+mainMusicQueuePreroll (maindata_t *mainData)
+{
+  musicqflag_t  flags;
+  dbidx_t       dbidx;
+  int32_t       uniqueidx;
+  song_t        *song;
+  char          tmp [1024];
+
+  logProcBegin ();
+
+  if (mainData->finished ||
+      mainData->playerState == PL_STATE_PAUSED ||
+      mainData->musicqDeferredPlayIdx != MAIN_NOT_SET) {
+    logProcEnd ("not-playing");
+    return;
+  }
+
+  if (musicqGetLen (mainData->musicQueue, mainData->musicqPlayIdx) < 2) {
+    logProcEnd ("no-next-song");
+    return;
+  }
+
+  /* the song must already be prepped; announcements are not pre-rolled */
+  flags = musicqGetFlags (mainData->musicQueue, mainData->musicqPlayIdx, 1);
+  if ((flags & MUSICQ_FLAG_PREP) != MUSICQ_FLAG_PREP ||
+      (flags & MUSICQ_FLAG_ANNOUNCE) == MUSICQ_FLAG_ANNOUNCE) {
+    logProcEnd ("not-prepped");
+    return;
+  }
+
+  dbidx = musicqGetByIdx (mainData->musicQueue, mainData->musicqPlayIdx, 1);
+  song = dbGetByIdx (mainData->musicdb, dbidx);
+  if (song == NULL) {
+    logProcEnd ("no-song");
+    return;
+  }
+
+  uniqueidx = musicqGetUniqueIdx (mainData->musicQueue, mainData->musicqPlayIdx, 1);
+  snprintf (tmp, sizeof (tmp), "%" PRId32 "%c%s",
+      uniqueidx, MSG_ARGS_RS, songGetStr (song, TAG_URI));
+  connSendMessage (mainData->conn, ROUTE_PLAYER, MSG_SONG_PREROLL, tmp);
+  logProcEnd ("");
+}
+
 static void
 mainMusicQueueFinish (maindata_t *mainData, const char *args)
 {
@@ -2346,7 +2460,7 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
   char        *jsbuff = NULL;
   int         jsonflag;
   const char  *p;
-  mp_playerstatus_t *ps;
+  mp_playerstatus_t ps;
   char        *tp;
   char        *tend;
   char        *jp;
@@ -2356,7 +2470,7 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
 
   jsonflag = bdjoptGetNum (OPT_P_REMOTECONTROL);
 
-  ps = msgparsePlayerStatusData (playerResp);
+  msgparsePlayerStatus (&ps, playerResp);
 
   if (mainData->marqueestarted) {
     char  *timerbuff = NULL;
@@ -2366,10 +2480,10 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
     tp = timerbuff;
     tend = timerbuff + BDJMSG_MAX;
 
-    snprintf (tbuff, sizeof (tbuff), "%" PRIu32 "%c", ps->playedtime, MSG_ARGS_RS);
+    snprintf (tbuff, sizeof (tbuff), "%" PRIu32 "%c", ps.playedtime, MSG_ARGS_RS);
     tp = stpecpy (tp, tend, tbuff);
 
-    snprintf (tbuff, sizeof (tbuff), "%" PRId32, ps->duration);
+    snprintf (tbuff, sizeof (tbuff), "%" PRId32, ps.duration);
     tp = stpecpy (tp, tend, tbuff);
 
     connSendMessage (mainData->conn, ROUTE_MARQUEE, MSG_MARQUEE_TIMER, timerbuff);
@@ -2377,7 +2491,6 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
   }
 
   if (! jsonflag) {
-    msgparsePlayerStatusFree (ps);
     return;
   }
 
@@ -2418,34 +2531,34 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
-      "\"repeat\" : \"%d\"", ps->repeat);
+      "\"repeat\" : \"%d\"", ps.repeat);
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
-      "\"pauseatend\" : \"%d\"", ps->pauseatend);
+      "\"pauseatend\" : \"%d\"", ps.pauseatend);
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
-      "\"vol\" : \"%d%%\"", ps->currentVolume);
+      "\"vol\" : \"%d%%\"", ps.currentVolume);
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
-      "\"speed\" : \"%d%%\"", ps->currentSpeed);
+      "\"speed\" : \"%d%%\"", ps.currentSpeed);
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
       "\"playedtime\" : \"%s\"",
-      tmutilToMS (ps->playedtime, tbuff2, sizeof (tbuff2)));
+      tmutilToMS (ps.playedtime, tbuff2, sizeof (tbuff2)));
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
   snprintf (tbuff, sizeof (tbuff),
       "\"duration\" : \"%s\"",
-      tmutilToMS (ps->duration, tbuff2, sizeof (tbuff2)));
+      tmutilToMS (ps.duration, tbuff2, sizeof (tbuff2)));
   jp = stpecpy (jp, jend, ", ");
   jp = stpecpy (jp, jend, tbuff);
 
@@ -2454,7 +2567,6 @@ mainSendPlayerStatus (maindata_t *mainData, char *playerResp)
 
   connSendMessage (mainData->conn, ROUTE_REMCTRL, MSG_PLAYER_STATUS_DATA, jsbuff);
 
-  msgparsePlayerStatusFree (ps);
   dataFree (jsbuff);
 
   logProcEnd ("");
@@ -2918,6 +3030,11 @@ mainStatusRequest (maindata_t *mainData, bdjmsgroute_t routefrom)
 {
   char  tmp [40];
 
+  /* the requestor needs the complete music queues */
+  for (musicqidx_t i = 0; i < MUSICQ_MAX; ++i) {
+    msgparseMusicQueueDataFree (mainData->musicqSent [i]);
+    mainData->musicqSent [i] = NULL;
+  }
   mainSetMusicQueuesChanged (mainData);
   snprintf (tmp, sizeof (tmp), "%d", mainData->musicqPlayIdx);
   connSendMessage (mainData->conn, routefrom, MSG_MAIN_CURR_PLAY, tmp);
@@ -31,6 +31,7 @@
 #include "bdjvars.h"
 #include "conn.h"
 #include "dyintfc.h"
+#include "fadecurve.h"
 #include "filemanip.h"
 #include "fileop.h"
 #include "ilist.h"
@@ -63,6 +64,9 @@ enum {
   STATUS_FORCE = 1,
   FADEIN_TIMESLICE = 50,
   FADEOUT_TIMESLICE = 100,
+  /* main is asked for the next song this long before the overlap */
+  /* starts, so that the next song can be pre-rolled */
+  XFADE_LEAD_TIME = 3000,
 };
 
 enum {
@@ -93,6 +97,11 @@ typedef struct {
   char            *locknm;
   long            globalCount;
   pli_t           *pli;
+  /* the idle player interface, used to pre-roll the next song */
+  pli_t           *plinext;
+  prepqueue_t     *prerollSong;
+  /* the prior song, still fading out on plinext */
+  prepqueue_t     *xfadeSong;
   volume_t        *volume;
   queue_t         *prepRequestQueue;
   queue_t         *prepQueue;
@@ -141,12 +150,21 @@ typedef struct {
   int             fadeSamples;
   time_t          fadeTimeStart;
   mstime_t        fadeTimeNext;
+  listnum_t       xfadeTime;
+  mstime_t        xfadeLeadCheck;
+  mstime_t        xfadeStartCheck;
+  mstime_t        xfadeEndCheck;
   int             stopNextsongFlag;
   int             stopwaitcount;
   bool            inFade : 1;
   bool            inFadeIn : 1;
   bool            inFadeOut : 1;
   bool            inGap : 1;
+  bool            prerollReq : 1;   // main was asked for the next song
+  bool            inXfade : 1;      // the prior song is fading out on plinext
+  bool            xfadePlanned : 1;
+  bool            xfadeStart : 1;
+  bool            xfadeVolPending : 1;
   bool            mute : 1;
   bool            newsong : 1;      // used in the player status msg
   bool            pauseAtEnd : 1;
@@ -191,6 +209,9 @@ static void     playerFadeVolSet (playerdata_t *playerData);
 static double   calcFadeIndex (playerdata_t *playerData, int fadeType);
 static void     playerStartFadeOut (playerdata_t *playerData);
 static void     playerSetCheckTimes (playerdata_t *playerData, prepqueue_t *pq);
+static bool     playerXfadeAllowed (playerdata_t *playerData, prepqueue_t *pq);
+static void     playerXfadePreroll (playerdata_t *playerData, char *args);
+static void     playerXfadeStop (playerdata_t *playerData);
 static void     playerSetPlayerState (playerdata_t *playerData, playerstate_t pstate);
 static void     playerSendStatus (playerdata_t *playerData, bool forceFlag);
 static int      playerLimitVolume (int vol);
@@ -235,6 +256,9 @@ main (int argc, char *argv[])
   playerData.priorGap = 2000;
   playerData.gap = 2000;
   playerData.pli = NULL;
+  playerData.plinext = NULL;
+  playerData.prerollSong = NULL;
+  playerData.xfadeSong = NULL;
   playerData.pliSupported = PLI_SUPPORT_NONE;
   playerData.prepQueue = queueAlloc ("prep-q", playerPrepQueueFree);
   playerData.prepRequestQueue = queueAlloc ("prep-req", playerPrepQueueFree);
@@ -246,6 +270,11 @@ main (int argc, char *argv[])
   playerData.inFadeIn = false;
   playerData.inFadeOut = false;
   playerData.inGap = false;
+  playerData.prerollReq = false;
+  playerData.inXfade = false;
+  playerData.xfadePlanned = false;
+  playerData.xfadeStart = false;
+  playerData.xfadeVolPending = false;
   playerData.mute = false;
   playerData.newsong = false;
   playerData.pauseAtEnd = false;
@@ -272,6 +301,10 @@ main (int argc, char *argv[])
   playerData.fadeType = bdjoptGetNum (OPT_P_FADETYPE);
   playerData.fadeinTime = bdjoptGetNumPerQueue (OPT_Q_FADEINTIME, 0);
   playerData.fadeoutTime = bdjoptGetNumPerQueue (OPT_Q_FADEOUTTIME, 0);
+  playerData.xfadeTime = bdjoptGetNumPerQueue (OPT_Q_XFADE, 0);
+  mstimeset (&playerData.xfadeLeadCheck, TM_TIMER_OFF);
+  mstimeset (&playerData.xfadeStartCheck, TM_TIMER_OFF);
+  mstimeset (&playerData.xfadeEndCheck, TM_TIMER_OFF);
 
   playerData.currentSink = "";  // default
   playerData.currentSpeed = 100;
@@ -317,6 +350,13 @@ main (int argc, char *argv[])
   /* vlc needs to have the audio device set */
   pliSetAudioDevice (playerData.pli, playerData.actualSink, plidevtype);
 
+  /* gapless playback and crossfades use a second player interface */
+  /* the next song is pre-rolled in the idle interface */
+  if (pliCheckSupport (playerData.pliSupported, PLI_SUPPORT_XFADE)) {
+    playerData.plinext = pliInit (plintfc, bdjoptGetStr (OPT_M_PLAYER_INTFC_NM));
+    pliSetAudioDevice (playerData.plinext, playerData.actualSink, plidevtype);
+  }
+
   playerSetDefaultVolume (&playerData);
 
   listenPort = bdjvarsGetNum (BDJVL_PORT_PLAYER);
@@ -374,6 +414,10 @@ playerClosingCallback (void *tpdata, programstate_t programState)
       playerData->currentSong = NULL;
     }
   }
+  if (playerData->xfadeSong != NULL) {
+    playerPrepQueueFree (playerData->xfadeSong);
+    playerData->xfadeSong = NULL;
+  }
 
   bdj4shutdown (ROUTE_PLAYER, NULL);
 
@@ -382,6 +426,11 @@ playerClosingCallback (void *tpdata, programstate_t programState)
     pliClose (playerData->pli);
     pliFree (playerData->pli);
   }
+  if (playerData->plinext != NULL) {
+    pliStop (playerData->plinext);
+    pliClose (playerData->plinext);
+    pliFree (playerData->plinext);
+  }
 
   /* do the volume reset last, give time for the player to stop */
 
@@ -493,6 +542,7 @@ playerProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
         }
         case MSG_PLAY_STOP: {
           logMsg (LOG_DBG, LOG_MSGS, "got: stop");
+          playerXfadeStop (playerData);
           playerStop (playerData);
           playerData->pauseAtEnd = false;
           playerSendPauseAtEndState (playerData);
@@ -521,6 +571,10 @@ playerProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           playerSongPlay (playerData, args);
           break;
         }
+        case MSG_SONG_PREROLL: {
+          playerXfadePreroll (playerData, args);
+          break;
+        }
         case MSG_MAIN_READY: {
           mstimeset (&playerData->statusCheck, 0);
           break;
@@ -538,6 +592,10 @@ playerProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           playerData->fadeoutTime = atol (args);
           break;
         }
+        case MSG_SET_PLAYBACK_XFADE: {
+          playerData->xfadeTime = atol (args);
+          break;
+        }
         case MSG_PLAY_RESET_VOLUME: {
           playerData->currentVolume = playerData->baseVolume;
           break;
@@ -551,6 +609,7 @@ playerProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           break;
         }
         case MSG_CHK_CLEAR_PREP_Q: {
+          playerData->prerollSong = NULL;
           queueClear (playerData->prepQueue, 0);
           queueRemoveByIdx (playerData->prepQueue, 0);
           break;
@@ -601,6 +660,11 @@ playerProcessing (void *udata)
     }
   }
 
+  if (playerData->inXfade &&
+      mstimeCheck (&playerData->xfadeEndCheck)) {
+    playerXfadeStop (playerData);
+  }
+
   if (playerData->playerState == PL_STATE_IN_GAP &&
       playerData->inGap) {
     if (mstimeCheck (&playerData->gapFinishTime)) {
@@ -616,6 +680,8 @@ playerProcessing (void *udata)
     prepqueue_t   *pq = NULL;
     playrequest_t *preq = NULL;
     bool          temprepeat = false;
+    bool          prerolled = false;
+    bool          deferVolume = false;
     char          tempffn [MAXPATHLEN];
     int           sourceType;
     int           tspeed;
@@ -665,6 +731,19 @@ playerProcessing (void *udata)
     }
     playerData->repeat = temprepeat;
 
+    /* the player interfaces were swapped when the prior song finished */
+    /* if crossfading, the prior song is still fading out */
+    if (playerData->prerollSong != NULL && pq == playerData->prerollSong) {
+      prerolled = true;
+      logMsg (LOG_DBG, LOG_BASIC, "pre-rolled %s", pq->songname);
+    }
+    playerData->prerollSong = NULL;
+
+    /* the system volume is shared with the prior song, which is still */
+    /* fading out.  the volume adjustment is applied when the */
+    /* crossfade finishes */
+    deferVolume = prerolled && playerData->inXfade;
+
     /* save the prior current volume before playing a song */
     playerData->baseVolume = playerData->currentVolume;
     playerData->realVolume = playerData->currentVolume;
@@ -680,6 +759,7 @@ playerProcessing (void *udata)
 
     if ((pq->announce == PREP_ANNOUNCE ||
         playerData->fadeinTime == 0) &&
+        ! deferVolume &&
         ! playerData->mute) {
       playerData->realVolume = playerData->currentVolume;
       volumeSet (playerData->volume, playerData->currentSink, playerData->realVolume);
@@ -687,12 +767,27 @@ playerProcessing (void *udata)
       logMsg (LOG_DBG, LOG_VOLUME, "no fade-in set volume: %d", playerData->realVolume);
     }
 
+    /* when the player interface applies the fade-in, the system volume */
+    /* is set once, and is not stepped */
+    if (pq->announce == PREP_SONG &&
+        playerData->fadeinTime > 0 &&
+        pliCheckSupport (playerData->pliSupported, PLI_SUPPORT_FADE) &&
+        ! deferVolume &&
+        ! playerData->mute) {
+      volumeSet (playerData->volume, playerData->currentSink, playerData->realVolume);
+      playerData->actualVolume = playerData->realVolume;
+      logMsg (LOG_DBG, LOG_VOLUME, "pli fade-in set volume: %d", playerData->realVolume);
+    }
+    playerData->xfadeVolPending = deferVolume;
+
     /* some pli need the full path */
     pathbldMakePath (tempffn, sizeof (tempffn), pq->tempname, "",
         PATHBLD_MP_DIR_DATATOP);
     sourceType = audiosrcGetType (tempffn);
 
-    pliMediaSetup (playerData->pli, pq->tempname, tempffn, sourceType);
+    if (! prerolled) {
+      pliMediaSetup (playerData->pli, pq->tempname, tempffn, sourceType);
+    }
     /* pq->songstart is normalized */
 
     tspeed = pq->speed;
@@ -700,6 +795,16 @@ playerProcessing (void *udata)
       /* if repeating, use the current speed */
       tspeed = playerData->currentSpeed;
     }
+    /* a crossfade has its fade-in set when the song is pre-rolled */
+    if (pq->announce == PREP_SONG &&
+        playerData->fadeinTime > 0 &&
+        ! (prerolled && playerData->inXfade) &&
+        pliCheckSupport (playerData->pliSupported, PLI_SUPPORT_FADE)) {
+      /* the fade-in is scheduled before playback starts */
+      /* the fade length is in media time */
+      pliFade (playerData->pli, PLI_FADE_IN, FADETYPE_TRIANGLE,
+          pq->songstart, playerData->fadeinTime * tspeed / 100);
+    }
     pliStartPlayback (playerData->pli, pq->songstart, tspeed);
     playerData->currentSpeed = tspeed;
     playerSetPlayerState (playerData, PL_STATE_LOADING);
@@ -729,7 +834,9 @@ playerProcessing (void *udata)
       playerData->playTimePlayed = 0;
       playerSetCheckTimes (playerData, pq);
 
-      if (pq->announce == PREP_SONG && playerData->fadeinTime > 0) {
+      if (pq->announce == PREP_SONG &&
+          playerData->fadeinTime > 0 &&
+          ! pliCheckSupport (playerData->pliSupported, PLI_SUPPORT_FADE)) {
         playerData->inFade = true;
         playerData->inFadeIn = true;
         playerData->fadeCount = 1;
@@ -759,10 +866,48 @@ playerProcessing (void *udata)
       playerData->playerState == PL_STATE_IN_FADEOUT) {
     prepqueue_t       *pq = playerData->currentSong;
 
+    if (playerData->xfadePlanned) {
+      if (! playerData->prerollReq &&
+          mstimeCheck (&playerData->xfadeLeadCheck)) {
+        if (playerXfadeAllowed (playerData, pq)) {
+          /* ask main for the next song so that it can be pre-rolled */
+          /* main is not told that this song is finished until the */
+          /* crossfade starts */
+          playerData->prerollReq = true;
+          connSendMessage (playerData->conn, ROUTE_MAIN,
+              MSG_PLAYBACK_PREROLL, NULL);
+        } else {
+          playerData->xfadePlanned = false;
+        }
+      }
+
+      /* the crossfade is only started if the next song was pre-rolled */
+      if (playerData->xfadeTime > 0 &&
+          mstimeCheck (&playerData->xfadeStartCheck)) {
+        if (playerData->prerollSong != NULL &&
+            ! playerData->inFade &&
+            playerXfadeAllowed (playerData, pq)) {
+          if (playerData->inXfade) {
+            playerXfadeStop (playerData);
+          }
+          /* the fade length is in media time */
+          pliFade (playerData->pli, PLI_FADE_OUT, playerData->fadeType,
+              -1, playerData->xfadeTime * playerData->currentSpeed / 100);
+          playerData->xfadeStart = true;
+          logMsg (LOG_DBG, LOG_BASIC, "crossfade start");
+        }
+        /* otherwise the regular fade-out is used */
+        playerData->xfadePlanned = false;
+      }
+    }
+
     /* announcements have no fade-out */
+    /* a crossfade replaces the fade-out */
     if (pq->announce == PREP_SONG &&
         playerData->fadeoutTime > 0 &&
         ! playerData->inFade &&
+        ! (playerData->xfadePlanned && playerData->xfadeTime > 0) &&
+        ! playerData->xfadeStart &&
         mstimeCheck (&playerData->fadeTimeCheck)) {
 
       /* before going into the fade, check the system volume */
@@ -773,6 +918,7 @@ playerProcessing (void *udata)
     }
 
     if (playerData->stopPlaying ||
+        playerData->xfadeStart ||
         mstimeCheck (&playerData->playTimeCheck)) {
       int32_t     plitm;
       plistate_t  plistate;
@@ -795,14 +941,24 @@ playerProcessing (void *udata)
           plistate == PLI_STATE_ENDED ||
           plistate == PLI_STATE_ERROR ||
           playerData->stopPlaying ||
+          playerData->xfadeStart ||
           plitm >= pq->plidur ||
           mstimeCheck (&playerData->playEndCheck)) {
         char  nsflag [20];
+        bool  swap = false;
 
         /* done, go on to next song, history is determined by */
         /* the stopnextsongflag */
         snprintf (nsflag, sizeof (nsflag), "%d", playerData->stopNextsongFlag);
 
+        /* the pre-rolled song is played next, unless the user */
+        /* has stopped the song or changed the settings */
+        if (playerData->prerollSong != NULL) {
+          swap = playerData->xfadeStart ||
+              (plistate != PLI_STATE_ERROR &&
+              playerXfadeAllowed (playerData, pq));
+        }
+
         /* stop any fade */
         playerData->inFade = false;
         playerData->inFadeOut = false;
@@ -822,7 +978,24 @@ playerProcessing (void *udata)
 
         logMsg (LOG_DBG, LOG_BASIC, "actual play time: %" PRId64,
             (int64_t) mstimeend (&playerData->playTimeStart) + playerData->playTimePlayed);
-        playerStop (playerData);
+        if (playerData->xfadeStart) {
+          /* after the swap, the prior song continues to fade out */
+          /* on the idle player interface */
+          playerData->inXfade = true;
+          mstimeset (&playerData->xfadeEndCheck, playerData->xfadeTime);
+        } else {
+          playerStop (playerData);
+        }
+        if (swap) {
+          pli_t   *tpli;
+
+          /* the next song is already loaded in the idle player interface */
+          tpli = playerData->pli;
+          playerData->pli = playerData->plinext;
+          playerData->plinext = tpli;
+        } else {
+          playerData->prerollSong = NULL;
+        }
 
         if (pq->announce == PREP_SONG) {
           if (playerData->pauseAtEnd) {
@@ -875,8 +1048,10 @@ playerProcessing (void *udata)
         }
 
         /* there is no gap after an announcement */
+        /* a crossfade replaces the gap */
         if (pq->announce == PREP_SONG &&
-            playerData->gap > 0) {
+            playerData->gap > 0 &&
+            ! playerData->xfadeStart) {
           playerSetPlayerState (playerData, PL_STATE_IN_GAP);
           playerData->realVolume = 0;
           volumeSet (playerData->volume, playerData->currentSink, 0);
@@ -894,10 +1069,20 @@ playerProcessing (void *udata)
           playerData->gap = playerData->priorGap;
 
           if (! playerData->repeat) {
-            playerPrepQueueFree (playerData->currentSong);
+            if (playerData->xfadeStart) {
+              /* the song is still fading out, the temporary file */
+              /* is removed when the crossfade finishes */
+              playerData->xfadeSong = playerData->currentSong;
+            } else {
+              playerPrepQueueFree (playerData->currentSong);
+            }
             playerData->currentSong = NULL;
           }
         }
+
+        playerData->prerollReq = false;
+        playerData->xfadePlanned = false;
+        playerData->xfadeStart = false;
       } /* has stopped */
     } /* time to check...*/
   } /* is playing */
@@ -1069,6 +1254,9 @@ playerSongClearPrep (playerdata_t *playerData, char *args)
     tpq = queueIterateRemoveNode (playerData->prepQueue, &playerData->prepiteridx);
     /* prevent any issues by checking the uniqueidx again */
     if (tpq != NULL && tpq->uniqueidx == uniqueidx) {
+      if (tpq == playerData->prerollSong) {
+        playerData->prerollSong = NULL;
+      }
       logMsg (LOG_DBG, LOG_INFO, "prep-clear: %" PRId32 " %s r:%d p:%" PRId32, tpq->uniqueidx, tpq->songname, queueGetCount (playerData->prepRequestQueue), queueGetCount (playerData->prepQueue));
       playerPrepQueueFree (tpq);
     }
@@ -1246,6 +1434,11 @@ playerPause (playerdata_t *playerData)
 
   plistate = pliState (playerData->pli);
 
+  if (playerData->inXfade) {
+    /* the prior song is not left playing */
+    playerXfadeStop (playerData);
+  }
+
   if (playerData->inFadeOut) {
     playerData->pauseAtEnd = true;
   } else if (plistate == PLI_STATE_PLAYING) {
@@ -1303,6 +1496,9 @@ playerNextSong (playerdata_t *playerData)
 
   logProcBegin ();
 
+  /* the prior song is not left playing */
+  playerXfadeStop (playerData);
+
   playerData->repeat = false;
   playerData->priorGap = playerData->gap;
   playerData->gap = 0;
@@ -1339,6 +1535,9 @@ playerNextSong (playerdata_t *playerData)
 
       /* stopped */
       tpq = queuePop (playerData->prepQueue);
+      if (tpq == playerData->prerollSong) {
+        playerData->prerollSong = NULL;
+      }
       playerPrepQueueFree (tpq);
       playerData->gap = playerData->priorGap;
     }
@@ -1727,6 +1926,18 @@ playerFadeVolSet (playerdata_t *playerData)
 
   logProcBegin ();
 
+  if (pliCheckSupport (playerData->pliSupported, PLI_SUPPORT_FADE)) {
+    /* the player interface applied the fade, it is finished */
+    if (playerData->inFadeOut) {
+      /* leave inFade set to prevent race conditions in the main loop */
+      playerData->inFadeOut = false;
+      logMsg (LOG_DBG, LOG_VOLUME, "pli fade-out done time: %" PRId64,
+          (int64_t) mstimeend (&playerData->playEndCheck));
+    }
+    logProcEnd ("pli-fade");
+    return;
+  }
+
   fadeType = playerData->fadeType;
   if (playerData->inFadeIn) {
     fadeType = FADETYPE_TRIANGLE;
@@ -1789,33 +2000,7 @@ calcFadeIndex (playerdata_t *playerData, int fadeType)
 
   logProcBegin ();
 
-  findex = fmax(0.0, fmin (1.0, index / range));
-
-  switch (fadeType) {
-    case FADETYPE_EXPONENTIAL_SINE: {
-      findex = 1.0 - cos (M_PI / 4.0 * (pow (2.0 * findex - 1, 3) + 1));
-      break;
-    }
-    case FADETYPE_HALF_SINE: {
-      findex = 1.0 - cos (findex * M_PI) / 2.0;
-      break;
-    }
-    case FADETYPE_INVERTED_PARABOLA: {
-      findex = 1.0 - (1.0 - findex) * (1.0 - findex);
-      break;
-    }
-    case FADETYPE_QUADRATIC: {
-      findex = findex * findex;
-      break;
-    }
-    case FADETYPE_QUARTER_SINE: {
-      findex = sin (findex * M_PI / 2.0);
-      break;
-    }
-    case FADETYPE_TRIANGLE: {
-      break;
-    }
-  }
+  findex = fadecurveCalc (fadeType, index / range);
   logProcEnd ("");
   return findex;
 }
@@ -1831,6 +2016,19 @@ playerStartFadeOut (playerdata_t *playerData)
   playerData->inFadeOut = true;
   tm = pq->dur - playerCalcPlayedTime (playerData);
   tm = tm < playerData->fadeoutTime ? tm : playerData->fadeoutTime;
+
+  if (pliCheckSupport (playerData->pliSupported, PLI_SUPPORT_FADE)) {
+    /* the player interface applies the fade from the current position */
+    /* the fade length is in media time */
+    pliFade (playerData->pli, PLI_FADE_OUT, playerData->fadeType,
+        -1, tm * playerData->currentSpeed / 100);
+    logMsg (LOG_DBG, LOG_VOLUME, "fade: pli: %" PRId64, (int64_t) tm);
+    mstimeset (&playerData->fadeTimeNext, tm);
+    playerSetPlayerState (playerData, PL_STATE_IN_FADEOUT);
+    logProcEnd ("pli-fade");
+    return;
+  }
+
   playerData->fadeSamples = tm / FADEOUT_TIMESLICE;
   playerData->fadeCount = playerData->fadeSamples;
   logMsg (LOG_DBG, LOG_VOLUME, "fade: samples: %d", playerData->fadeCount);
@@ -1860,6 +2058,14 @@ playerSetCheckTimes (playerdata_t *playerData, prepqueue_t *pq)
   if (pq->announce == PREP_SONG && playerData->fadeoutTime > 0) {
     mstimeset (&playerData->fadeTimeCheck, newdur - playerData->fadeoutTime);
   }
+  playerData->xfadePlanned = playerXfadeAllowed (playerData, pq);
+  if (playerData->xfadePlanned) {
+    int32_t   xfstart;
+
+    xfstart = newdur - playerData->xfadeTime;
+    mstimeset (&playerData->xfadeStartCheck, xfstart);
+    mstimeset (&playerData->xfadeLeadCheck, xfstart - XFADE_LEAD_TIME);
+  }
   logMsg (LOG_DBG, LOG_INFO, "pq->dur: %" PRId32, pq->dur);
   logMsg (LOG_DBG, LOG_INFO, "newdur: %" PRId32, newdur);
   logMsg (LOG_DBG, LOG_INFO, "playTimeStart: %" PRId64, (int64_t) mstimeend (&playerData->playTimeStart));
@@ -1869,6 +2075,123 @@ playerSetCheckTimes (playerdata_t *playerData, prepqueue_t *pq)
   logProcEnd ("");
 }
 
+/* gapless playback (no gap) or a crossfade is possible */
+static bool
+playerXfadeAllowed (playerdata_t *playerData, prepqueue_t *pq)
+{
+  if (playerData->plinext == NULL || pq == NULL) {
+    return false;
+  }
+  if (pq->announce != PREP_SONG) {
+    return false;
+  }
+  if (playerData->repeat ||
+      playerData->pauseAtEnd ||
+      playerData->stopPlaying) {
+    return false;
+  }
+  if (playerData->xfadeTime <= 0 && playerData->gap > 0) {
+    return false;
+  }
+  if (pq->dur < playerData->xfadeTime * 2 + XFADE_LEAD_TIME) {
+    return false;
+  }
+  return true;
+}
+
+/* main has sent the song after the current song. */
+/* only a song that is already prepped is loaded into the idle */
+/* player interface */
+static void
+playerXfadePreroll (playerdata_t *playerData, char *args)
+{
+  prepqueue_t   *pq = NULL;
+  prepqueue_t   *tpq;
+  qidx_t        iteridx;
+  int32_t       uniqueidx;
+  char          *p;
+  char          *tokstr;
+  char          tempffn [MAXPATHLEN];
+  int           sourceType;
+
+  if (! playerData->xfadePlanned ||
+      playerData->prerollSong != NULL ||
+      playerData->playerState != PL_STATE_PLAYING) {
+    return;
+  }
+
+  logProcBegin ();
+
+  p = strtok_r (args, MSG_ARGS_RS_STR, &tokstr);
+  if (p == NULL) {
+    logProcEnd ("bad-msg");
+    return;
+  }
+  uniqueidx = atol (p);
+
+  queueStartIterator (playerData->prepQueue, &iteridx);
+  while ((tpq = queueIterateData (playerData->prepQueue, &iteridx)) != NULL) {
+    if (tpq->announce == PREP_SONG && tpq->uniqueidx == uniqueidx) {
+      pq = tpq;
+      break;
+    }
+  }
+
+  if (pq == NULL || ! fileopFileExists (pq->tempname)) {
+    playerData->xfadePlanned = false;
+    logProcEnd ("not-prepped");
+    return;
+  }
+
+  pathbldMakePath (tempffn, sizeof (tempffn), pq->tempname, "",
+      PATHBLD_MP_DIR_DATATOP);
+  sourceType = audiosrcGetType (tempffn);
+  pliMediaSetup (playerData->plinext, pq->tempname, tempffn, sourceType);
+  if (playerData->xfadeTime > 0) {
+    /* the fade length is in media time */
+    pliFade (playerData->plinext, PLI_FADE_IN, playerData->fadeType,
+        pq->songstart, playerData->xfadeTime * pq->speed / 100);
+  }
+  playerData->prerollSong = pq;
+  logMsg (LOG_DBG, LOG_BASIC, "pre-roll %s", pq->songname);
+  logProcEnd ("");
+}
+
+/* the prior song has finished its fade-out */
+static void
+playerXfadeStop (playerdata_t *playerData)
+{
+  plistate_t  plistate;
+
+  if (! playerData->inXfade) {
+    return;
+  }
+
+  playerData->inXfade = false;
+  mstimeset (&playerData->xfadeEndCheck, TM_TIMER_OFF);
+  plistate = pliState (playerData->plinext);
+  if (plistate == PLI_STATE_PLAYING ||
+      plistate == PLI_STATE_PAUSED) {
+    pliStop (playerData->plinext);
+  }
+
+  /* the prior song's temporary file is no longer in use */
+  if (playerData->xfadeSong != NULL) {
+    playerPrepQueueFree (playerData->xfadeSong);
+    playerData->xfadeSong = NULL;
+  }
+
+  if (playerData->xfadeVolPending) {
+    playerData->xfadeVolPending = false;
+    if (! playerData->mute) {
+      volumeSet (playerData->volume, playerData->currentSink, playerData->realVolume);
+      playerData->actualVolume = playerData->realVolume;
+      logMsg (LOG_DBG, LOG_VOLUME, "crossfade finish set volume: %d", playerData->realVolume);
+    }
+  }
+  logMsg (LOG_DBG, LOG_BASIC, "crossfade finish");
+}
+
 static void
 playerSetPlayerState (playerdata_t *playerData, playerstate_t pstate)
 {
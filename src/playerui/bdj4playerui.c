@@ -147,6 +147,8 @@ typedef struct {
   int             reloadrcvd;
   nlistidx_t      lastLoc [MUSICQ_MAX];
   mp_musicqupdate_t *musicqupdate [MUSICQ_MAX];
+  /* the parts of the music queue data received so far */
+  mp_musicqupdate_t *musicqpending [MUSICQ_MAX];
   /* quick edit */
   uiqe_t          *uiqe;
   int             resetvolume;
@@ -267,6 +269,7 @@ static bool     pluiQuickEditSelected (void *udata);
 static bool     pluiQuickEditCallback (void *udata);
 static bool     pluiReload (void *udata);
 static void     pluiReloadCurrent (playerui_t *plui);
+static void     pluiProcessMusicQueueData (playerui_t *plui, int mqidx);
 static void     pluiReloadSave (playerui_t *plui, int mqidx);
 static void     pluiReloadSaveCurrent (playerui_t *plui);
 static bool     pluiEventEvent (void *udata);
@@ -343,6 +346,7 @@ main (int argc, char *argv[])
   for (int i = 0; i < MUSICQ_MAX; ++i) {
     plui.lastLoc [i] = -1;
     plui.musicqupdate [i] = NULL;
+    plui.musicqpending [i] = NULL;
   }
 
   osSetStandardSignals (pluiSigHandler);
@@ -478,6 +482,7 @@ pluiClosingCallback (void *udata, programstate_t programState)
 
   for (int i = 0; i < MUSICQ_MAX; ++i) {
     msgparseMusicQueueDataFree (plui->musicqupdate [i]);
+    msgparseMusicQueueDataFree (plui->musicqpending [i]);
   }
   for (int i = 0; i < PLUI_CB_MAX; ++i) {
     callbackFree (plui->callbacks [i]);
@@ -1099,6 +1104,7 @@ pluiProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
 
   if (PLUI_DBG_MSGS == 1 ||
       (msg != MSG_MUSIC_QUEUE_DATA &&
+      msg != MSG_MUSIC_QUEUE_DELTA &&
       msg != MSG_PLAYER_STATUS_DATA)) {
     logMsg (LOG_DBG, LOG_MSGS, "got: from:%d/%s route:%d/%s msg:%d/%s args:%s",
         routefrom, msgRouteDebugText (routefrom),
@@ -1166,51 +1172,66 @@ pluiProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           break;
         }
         case MSG_MUSIC_QUEUE_DATA: {
-          mp_musicqupdate_t   *musicqupdate;
+          int     mqidx;
+          int     rc;
+          char    tmp [40];
 
           if (plui->stopping) {
             break;
           }
 
-          musicqupdate = msgparseMusicQueueData (args);
-          if (musicqupdate == NULL) {
+          mqidx = atoi (args);
+          if (mqidx < 0 || mqidx >= MUSICQ_MAX) {
             break;
           }
 
-          msgparseMusicQueueDataFree (plui->musicqupdate [musicqupdate->mqidx]);
-          plui->musicqupdate [musicqupdate->mqidx] = musicqupdate;
-
-          if ((int) musicqupdate->mqidx >= MUSICQ_DISP_MAX ||
-              ! bdjoptGetNumPerQueue (OPT_Q_DISPLAY, musicqupdate->mqidx)) {
-            logMsg (LOG_DBG, LOG_INFO, "ERR: music queue data: mq idx %d not valid", musicqupdate->mqidx);
+          rc = msgparseMusicQueueData (&plui->musicqpending [mqidx], args);
+          if (rc == MSGPARSE_MQ_PARTIAL) {
             break;
           }
-
-          if ((int) musicqupdate->mqidx < MUSICQ_DISP_MAX) {
-            /* if displayed */
-            if (bdjoptGetNumPerQueue (OPT_Q_DISPLAY, musicqupdate->mqidx)) {
-              uimusicqSetMusicQueueData (plui->uimusicq, musicqupdate);
-              uimusicqProcessMusicQueueData (plui->uimusicq, musicqupdate->mqidx);
-              /* the music queue data is used to display the mark */
-              /* indicating that the song is already in the song list */
-              uisongselProcessMusicQueueData (plui->uisongsel, musicqupdate);
-            }
+          if (rc == MSGPARSE_MQ_RESYNC) {
+            logMsg (LOG_DBG, LOG_INFO, "music queue %d data: resync", mqidx);
+            snprintf (tmp, sizeof (tmp), "%d", mqidx);
+            connSendMessage (plui->conn, ROUTE_MAIN, MSG_MUSICQ_DATA_RESYNC, tmp);
+            break;
           }
 
-          pluiReloadSave (plui, musicqupdate->mqidx);
+          msgparseMusicQueueDataFree (plui->musicqupdate [mqidx]);
+          plui->musicqupdate [mqidx] = plui->musicqpending [mqidx];
+          plui->musicqpending [mqidx] = NULL;
+          pluiProcessMusicQueueData (plui, mqidx);
+          break;
+        }
+        case MSG_MUSIC_QUEUE_DELTA: {
+          int     mqidx;
+          char    tmp [40];
 
-          if (musicqupdate->mqidx == MUSICQ_HISTORY) {
-            /* CONTEXT: playerui: name of the saved history playlist */
-            const char  *name = _("History");
+          if (plui->stopping) {
+            break;
+          }
 
-            uimusicqSave (plui->musicdb,
-                plui->musicqupdate [MUSICQ_HISTORY], name);
+          mqidx = atoi (args);
+          if (mqidx < 0 || mqidx >= MUSICQ_MAX) {
+            break;
           }
 
-          plui->lastLoc [musicqupdate->mqidx] = -1;
+          if (msgparseMusicQueueDelta (plui->musicqupdate [mqidx], args) ==
+              MSGPARSE_MQ_RESYNC) {
+            logMsg (LOG_DBG, LOG_INFO, "music queue %d delta: resync", mqidx);
+            snprintf (tmp, sizeof (tmp), "%d", mqidx);
+            connSendMessage (plui->conn, ROUTE_MAIN, MSG_MUSICQ_DATA_RESYNC, tmp);
+            break;
+          }
+          pluiProcessMusicQueueData (plui, mqidx);
           break;
         }
         case MSG_DATABASE_UPDATE: {
+          /* args: change list serial */
+          if (dbApplyChangeList (plui->musicdb, args)) {
+            groupingRebuild (plui->grouping, plui->musicdb);
+            uisongselApplySongFilter (plui->uisongsel);
+            break;
+          }
           plui->musicdb = bdj4ReloadDatabase (plui->musicdb);
           uiplayerSetDatabase (plui->uiplayer, plui->musicdb);
           uisongselSetDatabase (plui->uisongsel, plui->musicdb);
@@ -2049,6 +2070,43 @@ pluiReloadCurrent (playerui_t *plui)
   uiNotebookSetPage (plui->wcont [PLUI_W_NOTEBOOK], tmqmngidx);
 }
 
+static void
+pluiProcessMusicQueueData (playerui_t *plui, int mqidx)
+{
+  mp_musicqupdate_t   *musicqupdate;
+
+  musicqupdate = plui->musicqupdate [mqidx];
+
+  if (mqidx >= MUSICQ_DISP_MAX ||
+      ! bdjoptGetNumPerQueue (OPT_Q_DISPLAY, mqidx)) {
+    logMsg (LOG_DBG, LOG_INFO, "ERR: music queue data: mq idx %d not valid", mqidx);
+    return;
+  }
+
+  if (mqidx < MUSICQ_DISP_MAX) {
+    /* if displayed */
+    if (bdjoptGetNumPerQueue (OPT_Q_DISPLAY, mqidx)) {
+      uimusicqSetMusicQueueData (plui->uimusicq, musicqupdate);
+      uimusicqProcessMusicQueueData (plui->uimusicq, mqidx);
+      /* the music queue data is used to display the mark */
+      /* indicating that the song is already in the song list */
+      uisongselProcessMusicQueueData (plui->uisongsel, musicqupdate);
+    }
+  }
+
+  pluiReloadSave (plui, mqidx);
+
+  if (mqidx == MUSICQ_HISTORY) {
+    /* CONTEXT: playerui: name of the saved history playlist */
+    const char  *name = _("History");
+
+    uimusicqSave (plui->musicdb,
+        plui->musicqupdate [MUSICQ_HISTORY], name);
+  }
+
+  plui->lastLoc [mqidx] = -1;
+}
+
 static void
 pluiReloadSave (playerui_t *plui, int mqidx)
 {
@@ -118,12 +118,16 @@ main (int argc, char * argv[])
     { "pli",            required_argument,  NULL,   'P' },
     { "wait",           no_argument,        NULL,   'w' },
     /* dbupdate options */
+    { "bpmdetect",      no_argument,        NULL,   0 },
     { "checknew",       no_argument,        NULL,   0 },
     { "compact",        no_argument,        NULL,   0 },
+    { "loudness",       no_argument,        NULL,   0 },
     { "musicdir",       required_argument,  NULL,   0 },
     { "rebuild",        no_argument,        NULL,   0 },
     { "reorganize",     no_argument,        NULL,   0 },
+    { "updchanged",     no_argument,        NULL,   0 },
     { "updfromtags",    no_argument,        NULL,   0 },
+    { "watch",          no_argument,        NULL,   0 },
     { "writetags",      no_argument,        NULL,   0 },
     /* bdjtags */
     { "cleantags",      no_argument,        NULL,   0 },
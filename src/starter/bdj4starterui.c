@@ -1160,9 +1160,12 @@ starterProcessMsg (bdjmsgroute_t routefrom, bdjmsgroute_t route,
           break;
         }
         case MSG_DATABASE_UPDATE: {
-          /* only comes from manage ui */
+          /* comes from manage ui or the music folder watcher */
           connSendMessage (starter->conn, ROUTE_MAIN, msg, args);
           connSendMessage (starter->conn, ROUTE_PLAYERUI, msg, args);
+          if (routefrom != ROUTE_MANAGEUI) {
+            connSendMessage (starter->conn, ROUTE_MANAGEUI, msg, args);
+          }
           break;
         }
         case MSG_DEBUG_LEVEL: {
@@ -1247,6 +1250,17 @@ starterStartMain (startui_t *starter, bdjmsgroute_t routefrom, char *args)
 
     starter->processes [ROUTE_MAIN] = procutilStartProcess (
         ROUTE_MAIN, "bdj4main", flags, targv);
+
+    /* the music folder watcher runs while the player is running */
+    if (bdjoptGetNum (OPT_G_DB_WATCH) &&
+        starter->started [ROUTE_DBWATCH] == 0) {
+      targc = 0;
+      targv [targc++] = "--watch";
+      targv [targc++] = NULL;
+      starter->processes [ROUTE_DBWATCH] = procutilStartProcess (
+          ROUTE_DBWATCH, "bdj4dbupdate", PROCUTIL_DETACH, targv);
+      ++starter->started [ROUTE_DBWATCH];
+    }
   }
 
   /* if the ui process already requested a start, let the ui process know */
@@ -1277,6 +1291,11 @@ starterStopMain (startui_t *starter, bdjmsgroute_t routefrom)
       procutilStopProcess (starter->processes [ROUTE_MAIN],
           starter->conn, ROUTE_MAIN, PROCUTIL_NORM_TERM);
       starter->started [ROUTE_MAIN] = 0;
+      if (starter->started [ROUTE_DBWATCH]) {
+        procutilStopProcess (starter->processes [ROUTE_DBWATCH],
+            starter->conn, ROUTE_DBWATCH, PROCUTIL_NORM_TERM);
+        starter->started [ROUTE_DBWATCH] = 0;
+      }
     }
     starter->mainstart [routefrom] = 0;
   }
@@ -50,6 +50,7 @@ starterStopAllProcesses (conn_t *conn)
   connSendMessage (conn, ROUTE_MANAGEUI, MSG_EXIT_REQUEST, NULL);
   starterQuickConnect (conn, ROUTE_CONFIGUI);
   connSendMessage (conn, ROUTE_CONFIGUI, MSG_EXIT_REQUEST, NULL);
+  connFlush (conn);
 
   logMsg (LOG_DBG, LOG_IMPORTANT, "after-ui sleeping");
   mssleep (1000);
@@ -69,6 +70,7 @@ starterStopAllProcesses (conn_t *conn)
   starterQuickConnect (conn, ROUTE_MAIN);
   logMsg (LOG_DBG, LOG_IMPORTANT, "send exit request to main");
   connSendMessage (conn, ROUTE_MAIN, MSG_EXIT_REQUEST, NULL);
+  connFlush (conn);
   logMsg (LOG_DBG, LOG_IMPORTANT, "after-main sleeping");
   mssleep (1500);
 
@@ -101,6 +103,7 @@ starterStopAllProcesses (conn_t *conn)
     return;
   }
 
+  connFlush (conn);
   logMsg (LOG_DBG, LOG_IMPORTANT, "after-exit-all sleeping");
   mssleep (1500);
 
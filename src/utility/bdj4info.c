@@ -25,12 +25,18 @@
 #include "bdj4.h"
 #include "bdj4arg.h"
 #include "bdjopt.h"
+#include "bdjmsg.h"
 #include "bdjvars.h"
+#include "conn.h"
 #include "fileop.h"
+#include "ipcstats.h"
 #include "localeutil.h"
 #include "mdebug.h"
 #include "osenv.h"
+#include "sock.h"
+#include "sockh.h"
 #include "sysvars.h"
+#include "tmutil.h"
 
 static const char *envitems [] = {
   "DESKTOP_SESSION",
@@ -62,12 +68,19 @@ enum {
   ENV_MAX = sizeof (envitems) / sizeof (const char *),
 };
 
+enum {
+  INFO_IPC_WAIT = 1000,
+};
+
+static void infoIPCStats (void);
+
 int
 main (int argc, char *argv [])
 {
   int     c = 0;
   int     option_index = 0;
   bool    isbdj4 = false;
+  bool    ipcstats = false;
   bdj4arg_t   *bdj4arg;
   const char  *targ;
 
@@ -77,6 +90,7 @@ main (int argc, char *argv [])
     { "datatopdir",   required_argument,  NULL,   't' },
     { "profile",      required_argument,  NULL,   'p' },
     { "locale",       required_argument,  NULL,   'L' },
+    { "ipcstats",     no_argument,        NULL,   'I' },
     /* ignored */
     { "debugself",    no_argument,        NULL,   0 },
     { "nodetach",     no_argument,        NULL,   0 },
@@ -134,6 +148,10 @@ main (int argc, char *argv [])
         isbdj4 = true;
         break;
       }
+      case 'I': {
+        ipcstats = true;
+        break;
+      }
       default: {
         break;
       }
@@ -147,6 +165,18 @@ main (int argc, char *argv [])
 
   bdjvarsUpdateData ();
 
+  if (ipcstats) {
+    infoIPCStats ();
+    bdjvarsCleanup ();
+    localeCleanup ();
+    bdj4argCleanup (bdj4arg);
+#if BDJ4_MEM_DEBUG
+    mdebugReport ();
+    mdebugCleanup ();
+#endif
+    return 0;
+  }
+
   /* C language: integer sizes */
 
   fprintf (stdout, " i: bool   %d\n", (int) sizeof (bool));
@@ -245,3 +275,84 @@ main (int argc, char *argv [])
 #endif
   return 0;
 }
+
+/* internal routines */
+
+/* ask each running process for its ipc statistics */
+static void
+infoIPCStats (void)
+{
+  conn_t      *conn;
+  char        *buff;
+  size_t      sz;
+
+  conn = connInit (ROUTE_NONE);
+  if (conn == NULL) {
+    return;
+  }
+
+  sz = IPCSTATS_REPORT_MAX + BDJMSG_MAX_PFX;
+  buff = mdmalloc (sz);
+
+  for (bdjmsgroute_t route = ROUTE_NONE + 1; route < ROUTE_MAX; ++route) {
+    Sock_t      sock = INVALID_SOCKET;
+    sockinfo_t  *si;
+    uint16_t    port;
+    int         connerr = SOCK_CONN_IN_PROGRESS;
+    int         count;
+    mstime_t    tm;
+    bool        rcvd = false;
+
+    port = connPort (conn, route);
+    if (port == 0) {
+      continue;
+    }
+
+    count = 0;
+    while (connerr == SOCK_CONN_IN_PROGRESS && count < 10) {
+      sock = sockConnect (port, &connerr, sock);
+      if (connerr == SOCK_CONN_IN_PROGRESS) {
+        mssleep (10);
+      }
+      ++count;
+    }
+    if (connerr != SOCK_CONN_OK) {
+      /* not running */
+      sockClose (sock);
+      continue;
+    }
+
+    sockhSendMessage (sock, ROUTE_NONE, route, MSG_DEBUG_IPC_STATS, NULL);
+
+    si = sockAddCheck (NULL, sock);
+    mstimeset (&tm, INFO_IPC_WAIT);
+    while (! mstimeCheck (&tm)) {
+      if (sockCheck (si) == sock) {
+        size_t          len;
+        bdjmsgroute_t   routefrom;
+        bdjmsgroute_t   troute;
+        bdjmsgmsg_t     msg;
+        char            *args;
+
+        if (sockReadBuff (sock, &len, buff, sz) != NULL) {
+          msgDecode (buff, &routefrom, &troute, &msg, &args);
+          if (msg == MSG_DEBUG_IPC_STATS_DATA) {
+            fprintf (stdout, "== %s ==\n", msgRouteDebugText (route));
+            fprintf (stdout, "%s", args);
+            rcvd = true;
+          }
+        }
+        break;
+      }
+    }
+    if (! rcvd) {
+      fprintf (stdout, "== %s == no response\n", msgRouteDebugText (route));
+    }
+
+    sockFreeCheck (si);
+    sockClose (sock);
+  }
+
+  mdfree (buff);
+  connFree (conn);
+}
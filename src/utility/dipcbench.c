@@ -0,0 +1,302 @@
+/*
+ * Copyright 2021-2024 Brad Lanam Pleasant Hill CA
+ */
+/*
+ * ipc round-trip benchmark.
+ * a status sized message is echoed back by a child process
+ * using tcp, unix domain sockets and the shared memory ring.
+ */
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/types.h>
+
+#if _sys_wait
+# include <sys/wait.h>
+#endif
+
+#include "bdjmsg.h"
+#include "shmring.h"
+#include "sock.h"
+#include "tmutil.h"
+
+enum {
+  BENCH_PORT = 39110,
+  BENCH_COUNT = 20000,
+};
+
+static size_t benchMakeMessage (char *buff, size_t sz);
+static void   benchSocket (const char *name, socktransport_t transport, uint16_t port, int count, const char *data, size_t dlen);
+static void   benchRing (uint16_t port, int count, const char *data, size_t dlen);
+static Sock_t benchAccept (sockinfo_t **si, Sock_t lsock);
+static bool   benchRead (sockinfo_t *si, Sock_t sock, char *buff, size_t sz, size_t *len);
+static int64_t benchNow (void);
+static void   benchReport (const char *name, int count, int64_t ns);
+
+int
+main (int argc, char *argv [])
+{
+  char      data [SHMRING_SLOT_SZ];
+  size_t    dlen;
+  int       count = BENCH_COUNT;
+  uint16_t  port = BENCH_PORT;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp (argv [i], "--count") == 0 && i + 1 < argc) {
+      ++i;
+      count = atoi (argv [i]);
+    } else if (strcmp (argv [i], "--port") == 0 && i + 1 < argc) {
+      ++i;
+      port = (uint16_t) atoi (argv [i]);
+    } else {
+      fprintf (stderr, "usage: %s [--count <n>] [--port <port>]\n", argv [0]);
+      exit (1);
+    }
+  }
+  if (count <= 0) {
+    count = BENCH_COUNT;
+  }
+
+  dlen = benchMakeMessage (data, sizeof (data));
+  fprintf (stdout, "message size: %" PRIu64 " bytes, round trips: %d\n",
+      (uint64_t) dlen, count);
+
+  benchSocket ("tcp", SOCK_TRANS_TCP, port, count, data, dlen);
+#if _sys_un
+  benchSocket ("unix", SOCK_TRANS_LOCAL, port + 1, count, data, dlen);
+#endif
+  if (shmringAvailable ()) {
+    benchRing (port + 2, count, data, dlen);
+  }
+
+  return 0;
+}
+
+/* internal routines */
+
+/* build a message the size of a player status message */
+static size_t
+benchMakeMessage (char *buff, size_t sz)
+{
+  char    args [BDJMSG_MAX_ARGS];
+  size_t  offset;
+  size_t  pfxlen;
+  size_t  alen;
+
+  offset = msgTLVInit (args, sizeof (args));
+  for (int i = 0; i < 9; ++i) {
+    offset = msgTLVAddInt (args, sizeof (args), offset, i + 1,
+        (int64_t) 180000 + i);
+  }
+  msgTLVFinish (args, offset);
+  alen = msgArgsLen (args);
+
+  pfxlen = msgEncode (ROUTE_PLAYER, ROUTE_MAIN, MSG_PLAYER_STATUS_DATA,
+      buff, sz);
+  pfxlen -= 1;
+  memcpy (buff + pfxlen, args, alen);
+  return pfxlen + alen;
+}
+
+static void
+benchSocket (const char *name, socktransport_t transport, uint16_t port,
+    int count, const char *data, size_t dlen)
+{
+  pid_t       pid;
+  Sock_t      sock = INVALID_SOCKET;
+  sockinfo_t  *si = NULL;
+  char        buff [BDJMSG_MAX];
+  size_t      len;
+  int         connerr;
+  int         err = 0;
+  int64_t     start;
+  int64_t     tot;
+
+  sockSetTransport (transport);
+  if (sockGetTransport () != transport) {
+    return;
+  }
+
+  pid = fork ();
+  if (pid < 0) {
+    fprintf (stderr, "fork failed\n");
+    return;
+  }
+
+  if (pid == 0) {
+    Sock_t    lsock;
+
+    /* echo server */
+    lsock = sockServer (port, &err);
+    si = sockAddCheck (NULL, lsock);
+    sock = benchAccept (&si, lsock);
+    for (int i = 0; i < count; ++i) {
+      if (! benchRead (si, sock, buff, sizeof (buff), &len)) {
+        break;
+      }
+      if (sockWriteBinary (sock, buff, len, NULL, 0) < 0) {
+        break;
+      }
+    }
+    sockClose (sock);
+    sockClose (lsock);
+    sockFreeCheck (si);
+    _exit (0);
+  }
+
+  connerr = SOCK_CONN_IN_PROGRESS;
+  while (connerr != SOCK_CONN_OK) {
+    sock = sockConnect (port, &connerr, sock);
+    if (connerr != SOCK_CONN_OK) {
+      mssleep (5);
+    }
+  }
+  si = sockAddCheck (NULL, sock);
+
+  tot = 0;
+  for (int i = 0; i < count; ++i) {
+    start = benchNow ();
+    if (sockWriteBinary (sock, data, dlen, NULL, 0) < 0) {
+      count = i;
+      break;
+    }
+    if (! benchRead (si, sock, buff, sizeof (buff), &len)) {
+      count = i;
+      break;
+    }
+    tot += benchNow () - start;
+  }
+
+  sockClose (sock);
+  sockFreeCheck (si);
+  waitpid (pid, NULL, 0);
+  benchReport (name, count, tot);
+}
+
+/* the rings are created before the fork, the child process */
+/* inherits the shared mappings */
+static void
+benchRing (uint16_t port, int count, const char *data, size_t dlen)
+{
+  shmring_t   *req;
+  shmring_t   *resp;
+  pid_t       pid;
+  char        buff [SHMRING_SLOT_SZ];
+  size_t      len;
+  int64_t     start;
+  int64_t     tot;
+
+  req = shmringCreate (port);
+  resp = shmringCreate (port + 1);
+  if (req == NULL || resp == NULL) {
+    shmringClose (req);
+    shmringClose (resp);
+    return;
+  }
+
+  pid = fork ();
+  if (pid < 0) {
+    fprintf (stderr, "fork failed\n");
+    return;
+  }
+
+  if (pid == 0) {
+    /* echo */
+    for (int i = 0; i < count; ++i) {
+      while (! shmringGet (req, buff, sizeof (buff), &len)) {
+        if (shmringIsClosed (req)) {
+          _exit (0);
+        }
+        sched_yield ();
+      }
+      while (! shmringPut (resp, buff, len)) {
+        sched_yield ();
+      }
+    }
+    _exit (0);
+  }
+
+  tot = 0;
+  for (int i = 0; i < count; ++i) {
+    start = benchNow ();
+    while (! shmringPut (req, data, dlen)) {
+      sched_yield ();
+    }
+    while (! shmringGet (resp, buff, sizeof (buff), &len)) {
+      sched_yield ();
+    }
+    tot += benchNow () - start;
+  }
+
+  waitpid (pid, NULL, 0);
+  shmringClose (req);
+  shmringClose (resp);
+  benchReport ("shm-ring", count, tot);
+}
+
+static Sock_t
+benchAccept (sockinfo_t **si, Sock_t lsock)
+{
+  Sock_t    sock = INVALID_SOCKET;
+  Sock_t    tsock;
+  int       err = 0;
+
+  while (socketInvalid (sock)) {
+    tsock = sockCheck (*si);
+    if (tsock == lsock) {
+      sock = sockAccept (lsock, &err);
+    }
+  }
+  *si = sockAddCheck (*si, sock);
+  return sock;
+}
+
+static bool
+benchRead (sockinfo_t *si, Sock_t sock, char *buff, size_t sz, size_t *len)
+{
+  Sock_t    tsock;
+
+  tsock = 0;
+  while (tsock != sock) {
+    tsock = sockCheck (si);
+    if (socketInvalid (tsock)) {
+      return false;
+    }
+  }
+
+  return sockReadBuff (sock, len, buff, sz) != NULL;
+}
+
+static int64_t
+benchNow (void)
+{
+  struct timespec   ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000000 + (int64_t) ts.tv_nsec;
+}
+
+static void
+benchReport (const char *name, int count, int64_t ns)
+{
+  double    avg;
+  double    rate;
+
+  if (count <= 0 || ns <= 0) {
+    fprintf (stdout, "%-10s failed\n", name);
+    return;
+  }
+
+  avg = (double) ns / (double) count / 1000.0;
+  rate = (double) count * 1000000000.0 / (double) ns;
+  fprintf (stdout, "%-10s %10.2f usec/round-trip %12.0f msgs/sec\n",
+      name, avg, rate);
+}
@@ -986,6 +986,7 @@ tsScriptSleep (testsuite_t *testsuite, const char *tcmd)
     return TS_BAD_COMMAND;
   }
   t = atol (p);
+  connFlush (testsuite->conn);
   mssleep (t);
   mdfree (tstr);
   return TS_OK;
@@ -1538,19 +1539,24 @@ resetPlayer (testsuite_t *testsuite)
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_CHK_MAIN_SET_PLAY_WHEN_QUEUED, "0");
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_QUEUE_CLEAR, "0");
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_QUEUE_CLEAR, "1");
+  connFlush (testsuite->conn);
   mssleep (100);
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_MUSICQ_SET_PLAYBACK, "0");
   connSendMessage (testsuite->conn, ROUTE_PLAYER, MSG_PLAY_NEXTSONG, NULL);
+  connFlush (testsuite->conn);
   mssleep (100);
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_MUSICQ_SET_PLAYBACK, "1");
   connSendMessage (testsuite->conn, ROUTE_PLAYER, MSG_PLAY_NEXTSONG, NULL);
+  connFlush (testsuite->conn);
   mssleep (100);
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_MUSICQ_SET_PLAYBACK, "0");
   connSendMessage (testsuite->conn, ROUTE_PLAYER, MSG_CHK_CLEAR_PREP_Q, NULL);
   /* wait a bit for all the messages to clear */
+  connFlush (testsuite->conn);
   mssleep (200);
   connSendMessage (testsuite->conn, ROUTE_MAIN, MSG_QUEUE_SWITCH_EMPTY, "0");
   /* wait some more for all the messages to clear */
+  connFlush (testsuite->conn);
   mssleep (200);
 }
 
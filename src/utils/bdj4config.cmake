@@ -173,10 +173,15 @@ endif()
 #### tag parsing modules
 
 # ffmpeg : libavformat / libavutil
+# libavcodec / libavfilter : audio adjustments
 if (WIN32)
+  set (LIBAVCODEC_LDFLAGS "${PROJECT_SOURCE_DIR}/../plocal/bin/avcodec-61.dll")
+  set (LIBAVFILTER_LDFLAGS "${PROJECT_SOURCE_DIR}/../plocal/bin/avfilter-10.dll")
   set (LIBAVFORMAT_LDFLAGS "${PROJECT_SOURCE_DIR}/../plocal/bin/avformat-61.dll")
   set (LIBAVUTIL_LDFLAGS "${PROJECT_SOURCE_DIR}/../plocal/bin/avutil-59.dll")
 else()
+  pkg_check_modules (LIBAVCODEC libavcodec)
+  pkg_check_modules (LIBAVFILTER libavfilter)
   pkg_check_modules (LIBAVFORMAT libavformat)
   pkg_check_modules (LIBAVUTIL libavutil)
 endif()
@@ -184,6 +189,7 @@ endif()
 # gstreamer
 
 pkg_check_modules (GST gstreamer-1.0)
+pkg_check_modules (GSTCTRL gstreamer-controller-1.0)
 
 # libid3tag
 pkg_check_modules (LIBID3TAG id3tag)
@@ -409,6 +415,7 @@ check_include_file (fcntl.h _hdr_fcntl)
 check_include_file (intrin.h _hdr_intrin)
 check_include_file (io.h _hdr_io)
 check_include_file (libintl.h _hdr_libintl)
+check_include_file (linux/fs.h _hdr_linux_fs)
 check_include_file (MacTypes.h _hdr_MacTypes)
 check_include_file (math.h _hdr_math)
 check_include_file (netdb.h _hdr_netdb)
@@ -437,12 +444,18 @@ set (CMAKE_REQUIRED_INCLUDES "")
 
 set (CMAKE_REQUIRED_INCLUDES ${GST_INCLUDE_DIRS})
 check_include_file (gst/gst.h _hdr_gst_gst)
+set (CMAKE_REQUIRED_INCLUDES ${GSTCTRL_INCLUDE_DIRS})
+check_include_file (gst/controller/controller.h _hdr_gst_controller_controller)
 set (CMAKE_REQUIRED_INCLUDES "")
 
 set (CMAKE_REQUIRED_INCLUDES ${GIO_INCLUDE_DIRS})
 check_include_file (gio/gio.h _hdr_gio_gio)
 set (CMAKE_REQUIRED_INCLUDES "")
 
+set (CMAKE_REQUIRED_INCLUDES ${LIBAVFILTER_INCLUDE_DIRS})
+check_include_file (libavfilter/avfilter.h _hdr_libavfilter_avfilter)
+set (CMAKE_REQUIRED_INCLUDES "")
+
 set (CMAKE_REQUIRED_INCLUDES ${LIBVLC_INCLUDE_DIR})
 check_include_file (vlc/vlc.h _hdr_vlc_vlc)
 set (CMAKE_REQUIRED_INCLUDES "")
@@ -462,12 +475,18 @@ if (BDJ4_UI STREQUAL "GTK3" OR BDJ4_UI STREQUAL "gtk3" OR
   set (CMAKE_REQUIRED_INCLUDES "")
 endif()
 
+check_include_file (sys/inotify.h _sys_inotify)
+check_include_file (sys/ioctl.h _sys_ioctl)
+check_include_file (sys/mman.h _sys_mman)
 check_include_file (sys/resource.h _sys_resource)
 check_include_file (sys/select.h _sys_select)
+check_include_file (sys/sendfile.h _sys_sendfile)
 check_include_file (sys/signal.h _sys_signal)
 check_include_file (sys/socket.h _sys_socket)
 check_include_file (sys/stat.h _sys_stat)
 check_include_file (sys/time.h _sys_time)
+check_include_file (sys/uio.h _sys_uio)
+check_include_file (sys/un.h _sys_un)
 check_include_file (sys/utsname.h _sys_utsname)
 check_include_file (sys/wait.h _sys_wait)
 check_include_file (sys/xattr.h _sys_xattr)
@@ -525,6 +544,7 @@ endif()
 
 
 set (CMAKE_REQUIRED_LIBRARIES ws2_32)
+check_function_exists (inotify_init1 _lib_inotify_init1)
 check_function_exists (ioctlsocket _lib_ioctlsocket)
 check_function_exists (select _lib_select)
 check_function_exists (socket _lib_socket)
@@ -551,6 +571,9 @@ check_function_exists (libintl_wbindtextdomain _lib_wbindtextdomain)
 set (CMAKE_REQUIRED_LIBRARIES "")
 
 check_function_exists (backtrace _lib_backtrace)
+check_function_exists (clock_gettime _lib_clock_gettime)
+# requires _GNU_SOURCE to be declared
+check_function_exists (copy_file_range _lib_copy_file_range)
 check_function_exists (fcntl _lib_fcntl)
 check_function_exists (fork _lib_fork)
 check_function_exists (fsync _lib_fsync)
@@ -564,8 +587,17 @@ check_function_exists (random _lib_random)
 check_function_exists (realpath _lib_realpath)
 check_function_exists (removexattr _lib_removexattr)
 check_function_exists (round _lib_lm)
+check_function_exists (sendfile _lib_sendfile)
 check_function_exists (setenv _lib_setenv)
 check_function_exists (setrlimit _lib_setrlimit)
+check_function_exists (shm_open _lib_shm_open)
+# glibc before 2.34 has shm_open in librt
+if (NOT _lib_shm_open)
+  check_library_exists (rt shm_open "" _lib_rt_shm_open)
+  if (_lib_rt_shm_open)
+    set (_lib_shm_open 1)
+  endif()
+endif()
 check_function_exists (sigaction _lib_sigaction)
 check_function_exists (signal _lib_signal)
 check_function_exists (srandom _lib_srandom)
@@ -578,6 +610,7 @@ check_function_exists (symlink _lib_symlink)
 check_function_exists (sysconf _lib_sysconf)
 check_function_exists (timegm _lib_timegm)
 check_function_exists (uname _lib_uname)
+check_function_exists (writev _lib_writev)
 
 if (LIBVLC_FOUND)
   set (CMAKE_REQUIRED_LIBRARIES ${LIBVLC_LDFLAGS} ${LIBVLC_LIBRARY})
@@ -610,6 +643,10 @@ endif()
 # st_birthtime is a define pointing to a member of the structure
 check_symbol_exists (st_birthtime sys/stat.h _mem_struct_stat_st_birthtime)
 
+# the directory entry type is not available on all systems
+check_symbol_exists (DT_DIR dirent.h _define_DT_DIR)
+# reflink copies
+check_symbol_exists (FICLONE "sys/ioctl.h;linux/fs.h" _define_FICLONE)
 check_symbol_exists (INVALID_SOCKET winsock2.h;ws2tcpip.h;windows.h _define_INVALID_SOCKET)
 if (WIN32)
   # another cmake bug
@@ -19,6 +19,13 @@ macro (addIOKitFramework name)
   endif()
 endmacro()
 
+# shm_open() is in librt on older linux systems
+macro (addRtLibrary name)
+  if (_lib_rt_shm_open)
+    target_link_libraries (${name} PRIVATE rt)
+  endif()
+endmacro()
+
 macro (addWinSockLibrary name)
   if (WIN32)
     target_link_libraries (${name} PRIVATE ws2_32)